@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+# Measure small evaluations through liblazyscript (lsapi.h) against one lazyscript process each.
+# The embedded run loads the prelude once and compiles the program once, then applies it to N
+# arguments; the process run starts `lazyscript -e` M times.
+# Usage: scripts/bench_api.sh [N] [M]
+#   N  in-process evaluations (default 100000)
+#   M  process spawns (default 200)
+# Environment:
+#   LSAPI_LIB     embedding library to link (default src/.libs/liblazyscript.so)
+#   LSAPI_LDLIBS  extra link flags (default "-lgc -ldl -lm -lpthread")
+# `~~builtin` modules are found through LAZYSCRIPT_BUILTIN_PATH (default: the build tree), since
+# the benchmark host does not live next to them.
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+LSAPI_LIB=${LSAPI_LIB:-$ROOT/src/.libs/liblazyscript.so}
+LSAPI_LDLIBS=${LSAPI_LDLIBS:--lgc -ldl -lm -lpthread}
+PLUGINS="$ROOT/src/plugins/.libs"
+export LAZYSCRIPT_BUILTIN_PATH=${LAZYSCRIPT_BUILTIN_PATH:-$PLUGINS}
+if [[ ! -f "$LSAPI_LIB" ]]; then echo "E: library not found: $LSAPI_LIB" >&2; exit 1; fi
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+N=${1:-100000}
+M=${2:-200}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+cat > "$WORK/embed.c" <<'C'
+#include "lsapi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int main(int argc, char** argv) {
+  long            n  = atol(argv[1]);
+  struct timespec s, e;
+  clock_gettime(CLOCK_MONOTONIC, &s);
+  ls_runtime_t* rt = ls_runtime_new(NULL);
+  if (rt == NULL)
+    return 1;
+  ls_program_t* prog = ls_program_compile(rt, "<bench>", "\\~x -> (~~builtin \"core\") .add ~x 1");
+  if (prog == NULL)
+    return 1;
+  int sum = 0;
+  for (long i = 0; i < n; i++) {
+    ls_value_t* arg = ls_value_new_int(rt, (int)(i & 1023));
+    ls_value_t* ret = ls_program_run(rt, prog, 1, &arg);
+    int         x;
+    if (ls_value_get_int(rt, ret, &x) != 0)
+      return 1;
+    sum += x;
+    ls_value_release(rt, arg);
+    ls_value_release(rt, ret);
+  }
+  ls_runtime_free(rt);
+  clock_gettime(CLOCK_MONOTONIC, &e);
+  double sec = (e.tv_sec - s.tv_sec) + (e.tv_nsec - s.tv_nsec) / 1e9;
+  printf("%.0f %d\n", n / sec, sum);
+  return 0;
+}
+C
+if ! cc -std=gnu11 -O2 -I"$ROOT/src" "$WORK/embed.c" -o "$WORK/embed" "$LSAPI_LIB" $LSAPI_LDLIBS \
+  -Wl,-rpath,"$(dirname "$LSAPI_LIB")"; then
+  echo "E: cannot build the benchmark" >&2
+  exit 1
+fi
+
+if ! out=$("$WORK/embed" "$N"); then echo "E: embedded run failed" >&2; exit 1; fi
+embed=${out%% *}
+
+s=$(date +%s%N)
+for ((i = 0; i < M; i++)); do
+  if ! "$BIN" -e "(~~builtin \"core\") .add $i 1" > /dev/null 2>&1; then
+    echo "E: lazyscript -e failed" >&2
+    exit 1
+  fi
+done
+e=$(date +%s%N)
+spawn=$(awk "BEGIN { printf \"%.0f\", $M / (($e - $s) / 1e9) }")
+
+printf "%-22s %12s\n" mode "evals/s"
+printf "%-22s %12s\n" "liblazyscript ($N)" "$embed"
+printf "%-22s %12s\n" "lazyscript -e ($M)" "$spawn"
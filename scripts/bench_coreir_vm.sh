@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+# Compare the Core IR bytecode VM (lscoreir --vm) with the tree-walking Core IR evaluator
+# (lscoreir) and the thunk evaluator (lazyscript) on the same generated programs.
+# Usage: scripts/bench_coreir_vm.sh [N] [RUNS]
+#   N     bindings in the generated chain programs (default 2000)
+#   RUNS  runs per evaluator; the best wall time is reported (default 3)
+# The chain programs are dominated by parsing and lowering; the church program is dominated by
+# evaluation (7^8 applications). A failing evaluator is reported as "fail".
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+LS="$ROOT/src/lazyscript"
+CIR="$ROOT/src/lscoreir"
+for b in "$LS" "$CIR"; do
+  if [[ ! -x "$b" ]]; then echo "E: binary not found: $b" >&2; exit 1; fi
+done
+N=${1:-2000}
+RUNS=${2:-3}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+# apply: a chain of single-argument applications of small lambdas
+{
+  echo "("
+  echo "  ~a$N;"
+  echo "  ~id = \\ ~x -> ~x;"
+  echo "  ~wrap = \\ ~x -> Box ~x;"
+  echo "  ~a0 = Leaf 0;"
+  for ((i = 1; i <= N; i++)); do
+    if (( i % 2 )); then echo "  ~a$i = ~id ~a$((i - 1));"; else echo "  ~a$i = ~wrap ~a$((i - 1));"; fi
+  done
+  echo "  ~done = ()"
+  echo ")"
+} > "$WORK/apply.ls"
+
+# closure: curried application, so every step allocates and then calls a closure
+{
+  echo "("
+  echo "  ~a$N;"
+  echo "  ~k = \\ ~x -> \\ ~y -> ~x;"
+  echo "  ~pair = \\ ~x -> \\ ~y -> Pair ~x ~y;"
+  echo "  ~a0 = Leaf 0;"
+  for ((i = 1; i <= N; i++)); do
+    if (( i % 2 )); then echo "  ~a$i = (~k ~a$((i - 1))) $i;"; else echo "  ~a$i = (~pair $i) ~a$((i - 1));"; fi
+  done
+  echo "  ~done = ()"
+  echo ")"
+} > "$WORK/closure.ls"
+
+# church: Church numerals applied to the identity; small program, deep evaluation
+cat > "$WORK/church.ls" <<'EOF'
+(
+  ~r;
+  ~id = \ ~x -> ~x;
+  ~two = \ ~f -> \ ~x -> ~f (~f ~x);
+  ~seven = \ ~f -> \ ~x -> ~f (~f (~f (~f (~f (~f (~f ~x))))));
+  ~n = (~two (~two (~two ~seven)));
+  ~r = (~n ~id) (Leaf 0)
+)
+EOF
+
+best() { # best wall time in ms of RUNS runs of "$@"
+  local best_ms="" s e ms
+  for ((r = 0; r < RUNS; r++)); do
+    s=$(date +%s%N)
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+    e=$(date +%s%N)
+    ms=$(((e - s) / 1000000))
+    if [[ -z "$best_ms" || $ms -lt $best_ms ]]; then best_ms=$ms; fi
+  done
+  echo "$best_ms"
+}
+
+printf "%-10s %12s %12s %12s\n" program "thunk(ms)" "coreir(ms)" "vm(ms)"
+for prog in apply closure church; do
+  f="$WORK/$prog.ls"
+  tree_out="$("$CIR" --from-ls "$f" 2>&1)"
+  vm_out="$("$CIR" --vm --from-ls "$f" 2>&1)"
+  if [[ "$tree_out" != "$vm_out" ]]; then
+    echo "E: $prog: VM result differs from the tree-walking evaluator" >&2
+    exit 1
+  fi
+  printf "%-10s %12s %12s %12s\n" "$prog" "$(best "$LS" "$f")" "$(best "$CIR" --from-ls "$f")" \
+    "$(best "$CIR" --vm --from-ls "$f")"
+done
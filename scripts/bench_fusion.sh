@@ -0,0 +1,108 @@
+#!/usr/bin/env bash
+# Measure list fusion (lazyscriptc -O1/-O2) on a three-stage pipeline
+#   foldr count 0 (map inc (filter small (map double xs)))
+# over a list of 10^D integers, compiled by the C backend (lazyscriptc --emit-c) and the LLVM
+# backend (lazyscriptc --emit-llvm) without and with the optimizer.
+# Usage: scripts/bench_fusion.sh [D] [RUNS]
+#   D     the source list has 10^D elements (default 6)
+#   RUNS  runs per program; the best wall time is reported (default 3)
+# Environment:
+#   LSRT_LIB     runtime library to link (default src/.libs/liblazyscript_rt.a)
+#   LSRT_LDLIBS  extra link flags (default "-lgc -ldl -lm -lpthread")
+# The "source" row only counts the source list, which is built the same way at every level;
+# the pipeline's own cost is the difference between the two rows. Times exclude compilation.
+# A failing program is reported as "fail".
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+LSC="$ROOT/src/lazyscriptc"
+LSRT_LIB=${LSRT_LIB:-$ROOT/src/.libs/liblazyscript_rt.a}
+LSRT_LDLIBS=${LSRT_LDLIBS:--lgc -ldl -lm -lpthread}
+if [[ ! -x "$LSC" ]]; then echo "E: binary not found: $LSC" >&2; exit 1; fi
+if [[ ! -f "$LSRT_LIB" ]]; then echo "E: runtime library not found: $LSRT_LIB" >&2; exit 1; fi
+D=${1:-6}
+RUNS=${2:-3}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+# The source list [10^D - 1, ..., 1, 0]: Core IR lets are not recursive, so a Church numeral
+# applies a step to a CPS pair (counter, list) 10^D times
+ten() { # $1 under D applications of ~ten, which applies it 10^D times
+  local e="$1"
+  for ((i = 0; i < D; i++)); do e="(~ten $e)"; done
+  echo "$e"
+}
+source_list() {
+  echo "  ~ten = \\ ~f -> \\ ~x -> ~f (~f (~f (~f (~f (~f (~f (~f (~f (~f ~x)))))))));"
+  echo "  ~step = \\ ~p -> ~p (\\ ~i -> \\ ~xs -> \\ ~k -> ~k (~add ~i 1) (~i : ~xs));"
+  echo "  ~init = \\ ~k -> ~k 0 [];"
+  echo "  ~xs = $(ten "~step") ~init (\\ ~i -> \\ ~xs -> ~xs);"
+}
+LIMIT=$((10 ** D))
+
+{
+  echo "("
+  echo "  ~r;"
+  source_list
+  echo "  ~r = ~foldr (\\ ~x -> \\ ~n -> ~add ~n 1) 0 ~xs"
+  echo ")"
+} > "$WORK/source.ls"
+
+{
+  echo "("
+  echo "  ~r;"
+  source_list
+  echo "  ~r = ~foldr (\\ ~x -> \\ ~n -> ~add ~n 1) 0 (~map (\\ ~x -> ~add ~x 1)"
+  echo "         (~filter (\\ ~x -> ~lt ~x $LIMIT) (~map (\\ ~x -> ~add ~x ~x) ~xs)))"
+  echo ")"
+} > "$WORK/pipeline.ls"
+
+emit_c() { # compile $1.ls at level $2 to the executable $1$2.c.exe
+  "$LSC" $2 --emit-c "$1.ls" > "$1$2.c" &&
+    cc -std=c99 -O2 "$1$2.c" -o "$1$2.c.exe" "$LSRT_LIB" $LSRT_LDLIBS
+}
+
+native() { # compile $1.ls at level $2 to the executable $1$2.ll.exe
+  command -v clang > /dev/null || command -v llc > /dev/null || return 1
+  "$LSC" $2 --emit-llvm "$1.ls" > "$1$2.ll" || return 1
+  if command -v clang > /dev/null; then
+    clang -O2 -x ir "$1$2.ll" -o "$1$2.ll.exe" "$LSRT_LIB" $LSRT_LDLIBS
+  else
+    llc -O2 -relocation-model=pic -filetype=obj "$1$2.ll" -o "$1$2.o" &&
+      cc "$1$2.o" -o "$1$2.ll.exe" "$LSRT_LIB" $LSRT_LDLIBS
+  fi
+}
+
+best() { # best wall time in ms of RUNS runs of "$@"
+  local best_ms="" s e ms
+  for ((r = 0; r < RUNS; r++)); do
+    s=$(date +%s%N)
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+    e=$(date +%s%N)
+    ms=$(((e - s) / 1000000))
+    if [[ -z "$best_ms" || $ms -lt $best_ms ]]; then best_ms=$ms; fi
+  done
+  echo "$best_ms"
+}
+
+printf "%-10s %12s %12s %12s %12s\n" program "c -O0(ms)" "c -O2(ms)" "llvm -O0(ms)" "llvm -O2(ms)"
+for prog in source pipeline; do
+  f="$WORK/$prog"
+  cols=()
+  for backend in emit_c native; do
+    for level in -O0 -O2; do
+      flag=""
+      [[ $level == -O2 ]] && flag=-O2
+      ext=c
+      [[ $backend == native ]] && ext=ll
+      if "$backend" "$f" "$flag" 2>> "$f.err"; then
+        cols+=("$(best "$f$flag.$ext.exe")")
+      else
+        cols+=(fail)
+      fi
+    done
+  done
+  printf "%-10s %12s %12s %12s %12s\n" "$prog" "${cols[@]}"
+done
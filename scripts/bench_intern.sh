@@ -0,0 +1,85 @@
+#!/usr/bin/env bash
+# Measure string intern throughput (lsstr_new) from 1, 2, 4 and 8 threads.
+# Every thread interns M strings: mostly lookups of a shared vocabulary of 4096 names (the
+# common case: identifiers and constructor names), and every 16th string a new one of its own.
+# Usage: scripts/bench_intern.sh [M] [RUNS]
+#   M     interns per thread (default 1000000)
+#   RUNS  runs per thread count; the best is reported (default 3)
+# Environment:
+#   LSRT_LIB     runtime library to link (default src/.libs/liblazyscript_rt.a)
+#   LSRT_LDLIBS  extra link flags (default "-lgc -ldl -lm -lpthread")
+# Strings are allocated with the libc allocator (LAZYSCRIPT_USE_LIBC_ALLOC=1), so the numbers
+# are those of the table and its locks rather than of the collector.
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+LSRT_LIB=${LSRT_LIB:-$ROOT/src/.libs/liblazyscript_rt.a}
+LSRT_LDLIBS=${LSRT_LDLIBS:--lgc -ldl -lm -lpthread}
+if [[ ! -f "$LSRT_LIB" ]]; then echo "E: runtime library not found: $LSRT_LIB" >&2; exit 1; fi
+M=${1:-1000000}
+RUNS=${2:-3}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+cat > "$WORK/intern.c" <<'C'
+#include "common/str.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static long g_count;
+
+static void* run(void* arg) {
+  int  self = (int)(intptr_t)arg;
+  char buf[32];
+  for (long i = 0; i < g_count; i++) {
+    int n;
+    if (i % 16 == 15)
+      n = snprintf(buf, sizeof(buf), "t%d_%ld", self, i);
+    else
+      n = snprintf(buf, sizeof(buf), "sym%ld", (i * 7919 + self * 131) % 4096);
+    (void)lsstr_new(buf, n);
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  int nthreads = atoi(argv[1]);
+  g_count      = atol(argv[2]);
+  (void)lsstr_cstr("warm up");
+  pthread_t       tids[64];
+  struct timespec s, e;
+  clock_gettime(CLOCK_MONOTONIC, &s);
+  for (int i = 0; i < nthreads; i++)
+    pthread_create(&tids[i], NULL, run, (void*)(intptr_t)i);
+  for (int i = 0; i < nthreads; i++)
+    pthread_join(tids[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &e);
+  double sec = (e.tv_sec - s.tv_sec) + (e.tv_nsec - s.tv_nsec) / 1e9;
+  printf("%.2f\n", nthreads * g_count / sec / 1e6);
+  return 0;
+}
+C
+if ! cc -std=gnu11 -O2 -I"$ROOT/src" "$WORK/intern.c" -o "$WORK/intern" "$LSRT_LIB" $LSRT_LDLIBS; then
+  echo "E: cannot build the benchmark" >&2
+  exit 1
+fi
+
+best() { # best throughput in Mops/s of RUNS runs with $1 threads
+  local best_ops="" ops
+  for ((r = 0; r < RUNS; r++)); do
+    if ! ops=$(LAZYSCRIPT_USE_LIBC_ALLOC=1 "$WORK/intern" "$1" "$M" 2> /dev/null); then
+      echo fail
+      return
+    fi
+    if [[ -z "$best_ops" ]] || awk "BEGIN { exit !($ops > $best_ops) }"; then best_ops=$ops; fi
+  done
+  echo "$best_ops"
+}
+
+echo "$M interns per thread ($(getconf _NPROCESSORS_ONLN) processors online)"
+printf "%-8s %12s\n" threads "Mops/s"
+for t in 1 2 4 8; do
+  printf "%-8s %12s\n" "$t" "$(best "$t")"
+done
@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+# Measure `require` of a generated module of K bindings with the compiled module cache off, cold
+# (a fresh cache directory per run: parse and write the image) and warm (map the image), with a
+# script that requires nothing as the floor.
+# Usage: scripts/bench_modcache.sh [M] [K]
+#   M  runs per mode (default 50)
+#   K  bindings of the required module (default 5000)
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+M=${1:-50}
+K=${2:-5000}
+unset LAZYSCRIPT_MODULE_CACHE
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+{
+  echo "{"
+  for ((i = 0; i < K; i++)); do echo "  .f$i = \\~x -> (~~builtin \"core\") .add ~x $i;"; done
+  echo "  .last = 0"
+  echo "};"
+} > "$WORK/big.ls"
+echo "!{ !require \"$WORK/big.ls\"; !println \"ok\"; };" > "$WORK/req.ls"
+echo '!println "ok"' > "$WORK/none.ls"
+export LAZYSCRIPT_CACHE_DIR="$WORK/cache"
+
+per_run() { # ms per run of the command; "cold" empties the cache before each run
+  local s e cold=0
+  [[ "$1" == cold ]] && cold=1 && shift
+  s=$(date +%s%N)
+  for ((i = 0; i < M; i++)); do
+    ((cold)) && rm -rf "$LAZYSCRIPT_CACHE_DIR"
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+  done
+  e=$(date +%s%N)
+  awk "BEGIN { printf \"%.3f\", ($e - $s) / $M / 1e6 }"
+}
+
+if [[ "$("$BIN" "$WORK/req.ls")" != ok* ]]; then echo "E: require failed" >&2; exit 1; fi
+printf "%-22s %12s\n" mode "ms/run"
+printf "%-22s %12s\n" "no require" "$(per_run "$BIN" "$WORK/none.ls")"
+printf "%-22s %12s\n" "require, cache off" \
+  "$(LAZYSCRIPT_MODULE_CACHE=0 per_run "$BIN" "$WORK/req.ls")"
+printf "%-22s %12s\n" "require, cold cache" "$(per_run cold "$BIN" "$WORK/req.ls")"
+"$BIN" "$WORK/req.ls" > /dev/null
+printf "%-22s %12s\n" "require, warm cache" "$(per_run "$BIN" "$WORK/req.ls")"
+du -sh "$LAZYSCRIPT_CACHE_DIR" | awk '{ print "cache size: " $1 }'
@@ -0,0 +1,117 @@
+#!/usr/bin/env bash
+# Compare native code from the LLVM backend (lazyscriptc --emit-llvm) and the C backend
+# (lazyscriptc --emit-c) with the thunk evaluator (lazyscript), the tree-walking Core IR evaluator
+# (lscoreir) and the Core IR VM (lscoreir --vm).
+# Usage: scripts/bench_native.sh [N] [RUNS] [D]
+#   N     bindings in the generated chain programs (default 2000)
+#   RUNS  runs per evaluator; the best wall time is reported (default 3)
+#   D     depth of the doubling program, which makes 2^D integer additions (default 20)
+# Environment:
+#   LSRT_LIB     runtime library to link (default src/.libs/liblazyscript_rt.a)
+#   LSRT_LDLIBS  extra link flags (default "-lgc -ldl -lm -lpthread")
+# Native times exclude compilation. LLVM programs are linked with clang when available, otherwise
+# with llc and cc; C programs are compiled with cc -O2. A failing evaluator is reported as "fail".
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+LS="$ROOT/src/lazyscript"
+LSC="$ROOT/src/lazyscriptc"
+CIR="$ROOT/src/lscoreir"
+LSRT_LIB=${LSRT_LIB:-$ROOT/src/.libs/liblazyscript_rt.a}
+LSRT_LDLIBS=${LSRT_LDLIBS:--lgc -ldl -lm -lpthread}
+for b in "$LS" "$LSC" "$CIR"; do
+  if [[ ! -x "$b" ]]; then echo "E: binary not found: $b" >&2; exit 1; fi
+done
+if [[ ! -f "$LSRT_LIB" ]]; then echo "E: runtime library not found: $LSRT_LIB" >&2; exit 1; fi
+if ! command -v clang > /dev/null && ! command -v llc > /dev/null; then
+  echo "E: clang or llc is required" >&2
+  exit 1
+fi
+N=${1:-2000}
+RUNS=${2:-3}
+D=${3:-20}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+# apply: a chain of single-argument applications of small lambdas
+{
+  echo "("
+  echo "  ~a$N;"
+  echo "  ~id = \\ ~x -> ~x;"
+  echo "  ~wrap = \\ ~x -> Box ~x;"
+  echo "  ~a0 = Leaf 0;"
+  for ((i = 1; i <= N; i++)); do
+    if (( i % 2 )); then echo "  ~a$i = ~id ~a$((i - 1));"; else echo "  ~a$i = ~wrap ~a$((i - 1));"; fi
+  done
+  echo "  ~done = ()"
+  echo ")"
+} > "$WORK/apply.ls"
+
+# church: Church numerals applied to the identity; small program, deep evaluation
+cat > "$WORK/church.ls" <<'EOF'
+(
+  ~r;
+  ~id = \ ~x -> ~x;
+  ~two = \ ~f -> \ ~x -> ~f (~f ~x);
+  ~seven = \ ~f -> \ ~x -> ~f (~f (~f (~f (~f (~f (~f ~x))))));
+  ~n = (~two (~two (~two ~seven)));
+  ~r = (~n ~id) (Leaf 0)
+)
+EOF
+
+# double: ~d<i> applies ~d<i-1> twice, down to an addition; integer work through known calls.
+# Only the native backends implement unbound add, so only their columns are comparable.
+{
+  echo "("
+  echo "  ~r;"
+  echo "  ~d0 = \\ ~x -> ~add ~x 1;"
+  for ((i = 1; i <= D; i++)); do echo "  ~d$i = \\ ~x -> ~d$((i - 1)) (~d$((i - 1)) ~x);"; done
+  echo "  ~r = ~d$D 0"
+  echo ")"
+} > "$WORK/double.ls"
+
+native() { # compile $1.ls to the executable $1
+  "$LSC" --emit-llvm "$1.ls" > "$1.ll" || return 1
+  if command -v clang > /dev/null; then
+    clang -O2 -x ir "$1.ll" -o "$1" "$LSRT_LIB" $LSRT_LDLIBS
+  else
+    llc -O2 -relocation-model=pic -filetype=obj "$1.ll" -o "$1.o" &&
+      cc "$1.o" -o "$1" "$LSRT_LIB" $LSRT_LDLIBS
+  fi
+}
+
+emit_c() { # compile $1.ls to the executable $1.c.exe
+  "$LSC" --emit-c "$1.ls" > "$1.c" && cc -std=c99 -O2 "$1.c" -o "$1.c.exe" "$LSRT_LIB" $LSRT_LDLIBS
+}
+
+best() { # best wall time in ms of RUNS runs of "$@"
+  local best_ms="" s e ms
+  for ((r = 0; r < RUNS; r++)); do
+    s=$(date +%s%N)
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+    e=$(date +%s%N)
+    ms=$(((e - s) / 1000000))
+    if [[ -z "$best_ms" || $ms -lt $best_ms ]]; then best_ms=$ms; fi
+  done
+  echo "$best_ms"
+}
+
+printf "%-10s %12s %12s %12s %12s %12s\n" program "thunk(ms)" "coreir(ms)" "vm(ms)" "native(ms)" \
+  "c(ms)"
+for prog in apply church double; do
+  f="$WORK/$prog"
+  if native "$f" 2> "$f.err"; then
+    nat="$(best "$f")"
+  else
+    nat=fail
+  fi
+  if emit_c "$f" 2>> "$f.err"; then
+    cnat="$(best "$f.c.exe")"
+  else
+    cnat=fail
+  fi
+  printf "%-10s %12s %12s %12s %12s %12s\n" "$prog" "$(best "$LS" "$f.ls")" \
+    "$(best "$CIR" --from-ls "$f.ls")" "$(best "$CIR" --vm --from-ls "$f.ls")" "$nat" "$cnat"
+done
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Measure parallel evaluation: parMap fib over a list of N copies of F, evaluated with 1, 2, 4
+# and 8 threads (LAZYSCRIPT_THREADS).
+# Usage: scripts/bench_par.sh [F] [N] [RUNS]
+#   F     fib argument (default 22)
+#   N     list length (default 8)
+#   RUNS  runs per thread count; the best wall time is reported (default 3)
+# The speed-up is bounded by the number of processors. A failing run is reported as "fail".
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+F=${1:-22}
+N=${2:-8}
+RUNS=${3:-3}
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+xs="$F"
+for ((i = 1; i < N; i++)); do xs="$xs, $F"; done
+cat > "$WORK/parmap.ls" <<LS
+(
+  !{
+    !println (~~to_str (~~parMap ~fib [$xs]));
+  };
+  ~core = ~~builtin "core";
+  ~add = ~core .add;
+  ~sub = ~core .sub;
+  ~lt = ~core .lt;
+  ~fib = \\~n -> ~fibb ~n (~lt ~n 2);
+  ~fibb = \\~n -> (\\true -> ~n | \\false -> ~add (~fib (~sub ~n 1)) (~fib (~sub ~n 2)))
+)
+LS
+
+best() { # best wall time in ms of RUNS runs of "$@"
+  local best_ms="" s e ms
+  for ((r = 0; r < RUNS; r++)); do
+    s=$(date +%s%N)
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+    e=$(date +%s%N)
+    ms=$(((e - s) / 1000000))
+    if [[ -z "$best_ms" || $ms -lt $best_ms ]]; then best_ms=$ms; fi
+  done
+  echo "$best_ms"
+}
+
+echo "parMap fib $F over $N elements ($(getconf _NPROCESSORS_ONLN) processors online)"
+printf "%-8s %12s\n" threads "wall(ms)"
+for t in 1 2 4 8; do
+  printf "%-8s %12s\n" "$t" "$(LAZYSCRIPT_THREADS=$t best "$BIN" "$WORK/parmap.ls")"
+done
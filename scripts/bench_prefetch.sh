@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Measure a script that requires N generated modules of K bindings each, with the compiled module
+# cache off so that every module is parsed: prefetch off (parse on require, in program order)
+# against prefetch with 2/4/8 threads (parse ahead on the pool while earlier modules evaluate).
+# Usage: scripts/bench_prefetch.sh [M] [N] [K]
+#   M  runs per mode (default 10)
+#   N  required modules (default 8)
+#   K  bindings per module (default 2000)
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+M=${1:-10}
+N=${2:-8}
+K=${3:-2000}
+export LAZYSCRIPT_MODULE_CACHE=0
+unset LAZYSCRIPT_PREFETCH
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+for ((m = 0; m < N; m++)); do
+  {
+    echo "{"
+    for ((i = 0; i < K; i++)); do echo "  .f$i = \\~x -> (~~builtin \"core\") .add ~x $i;"; done
+    echo "  .last = $m"
+    echo "};"
+  } > "$WORK/m$m.ls"
+done
+{
+  echo "!{"
+  for ((m = 0; m < N; m++)); do echo "  !require \"$WORK/m$m.ls\";"; done
+  echo "  !println \"ok\";"
+  echo "};"
+} > "$WORK/req.ls"
+
+per_run() { # ms per run of the command
+  local s e
+  s=$(date +%s%N)
+  for ((i = 0; i < M; i++)); do
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+  done
+  e=$(date +%s%N)
+  awk "BEGIN { printf \"%.3f\", ($e - $s) / $M / 1e6 }"
+}
+
+if [[ "$("$BIN" "$WORK/req.ls")" != ok* ]]; then echo "E: require failed" >&2; exit 1; fi
+echo "processors: $(nproc), modules: $N x $K bindings"
+printf "%-22s %12s\n" mode "ms/run"
+printf "%-22s %12s\n" "prefetch off" "$(LAZYSCRIPT_PREFETCH=0 per_run "$BIN" "$WORK/req.ls")"
+for t in 2 4 8; do
+  printf "%-22s %12s\n" "prefetch, $t threads" "$(per_run "$BIN" --threads "$t" "$WORK/req.ls")"
+done
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Measure request latency of `lazyscript --serve` against one `lazyscript -e` process per request.
+# The server is driven over stdin/stdout with the framed protocol of src/runtime/serve.h; every
+# request waits for its response before the next one is sent.
+# Usage: scripts/bench_serve.sh [N] [M]
+#   N  requests to the server (default 2000)
+#   M  process spawns (default 200)
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+N=${1:-2000}
+M=${2:-200}
+now_us() { echo $(($(date +%s%N) / 1000)); }
+
+coproc SERVER { "$BIN" --serve 2> /dev/null; }
+s=$(now_us)
+for ((i = 0; i < N; i++)); do
+  req="(~~builtin \"core\") .add $i 1"
+  printf 'eval %d\n%s' "${#req}" "$req" >&"${SERVER[1]}"
+  if ! read -r verb len <&"${SERVER[0]}" || [[ "$verb" != ok ]]; then
+    echo "E: server request failed" >&2
+    exit 1
+  fi
+  read -r -N "$len" body <&"${SERVER[0]}"
+  if [[ "$body" != "$((i + 1))" ]]; then echo "E: unexpected result: $body" >&2; exit 1; fi
+done
+e=$(now_us)
+exec {SERVER[1]}>&-
+wait "$SERVER_PID"
+served=$(awk "BEGIN { printf \"%.3f\", ($e - $s) / $N / 1000 }")
+
+s=$(now_us)
+for ((i = 0; i < M; i++)); do
+  if ! "$BIN" -e "(~~builtin \"core\") .add $i 1" > /dev/null 2>&1; then
+    echo "E: lazyscript -e failed" >&2
+    exit 1
+  fi
+done
+e=$(now_us)
+spawned=$(awk "BEGIN { printf \"%.3f\", ($e - $s) / $M / 1000 }")
+
+printf "%-22s %12s\n" mode "ms/request"
+printf "%-22s %12s\n" "--serve ($N)" "$served"
+printf "%-22s %12s\n" "lazyscript -e ($M)" "$spawned"
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Measure startup of `lazyscript -e` one-liners: end-to-end latency per process and the
+# --startup-profile phases (averaged), with the built-in prelude and with the prelude plugin found
+# by probing (LAZYSCRIPT_PRELUDE_PATH), and /bin/true as the floor of starting a process.
+# Usage: scripts/bench_startup.sh [M]
+#   M  runs per mode (default 500)
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+PLUGINS="$ROOT/src/plugins/.libs"
+[[ -f "$PLUGINS/liblazyscript_prelude.so" ]] || PLUGINS="$ROOT/src/plugins"
+M=${1:-500}
+PROG='!println "ok"'
+unset LAZYSCRIPT_PRELUDE_SO LAZYSCRIPT_PRELUDE_PATH LAZYSCRIPT_INIT
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+per_run() { # ms per run of the command
+  local s e
+  s=$(date +%s%N)
+  for ((i = 0; i < M; i++)); do
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+  done
+  e=$(date +%s%N)
+  awk "BEGIN { printf \"%.3f\", ($e - $s) / $M / 1e6 }"
+}
+
+profile() { # average of each --startup-profile phase, one "phase ms" per line
+  for ((i = 0; i < M; i++)); do
+    "$@" --startup-profile -e "$PROG" 2>&1 > /dev/null
+  done | awk '$1 == "startup:" { sum[$2] += $3; if (!($2 in seen)) { seen[$2] = 1; order[n++] = $2 } }
+    END { for (i = 0; i < n; i++) printf "%s %.3f\n", order[i], sum[order[i]] / '"$M"' }'
+}
+
+if [[ "$("$BIN" -e "$PROG")" != ok* ]]; then echo "E: lazyscript -e failed" >&2; exit 1; fi
+if ! LAZYSCRIPT_PRELUDE_PATH="$PLUGINS" "$BIN" -e "$PROG" > /dev/null 2>&1; then
+  echo "E: prelude plugin not found in $PLUGINS" >&2
+  exit 1
+fi
+profile "$BIN" > "$WORK/builtin"
+LAZYSCRIPT_PRELUDE_PATH="$PLUGINS" profile "$BIN" > "$WORK/plugin"
+
+printf "%-22s %12s\n" mode "ms/run"
+printf "%-22s %12s\n" "/bin/true" "$(per_run /bin/true)"
+printf "%-22s %12s\n" "-e, built-in prelude" "$(per_run "$BIN" -e "$PROG")"
+printf "%-22s %12s\n" "-e, probed plugin" \
+  "$(LAZYSCRIPT_PRELUDE_PATH="$PLUGINS" per_run "$BIN" -e "$PROG")"
+echo
+printf "%-10s %12s %12s\n" phase "built-in ms" "plugin ms"
+paste -d ' ' "$WORK/builtin" "$WORK/plugin" | awk '{ printf "%-10s %12s %12s\n", $1, $2, $4 }'
@@ -0,0 +1,53 @@
+#!/usr/bin/env bash
+# Measure end-to-end latency of a trivial script: a fresh lazyscript process against a request to
+# a fork server (lazyscript --zygote, client lazyscript --connect), with the cost of starting a
+# process that does nothing (/bin/true) as the floor.
+# The second script requires a generated module of K bindings, which the fork server preloads.
+# Usage: scripts/bench_zygote.sh [M] [K]
+#   M  runs per mode (default 300)
+#   K  bindings of the required module (default 5000)
+set -uo pipefail
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BIN="$ROOT/src/lazyscript"
+if [[ ! -x "$BIN" ]]; then echo "E: binary not found: $BIN" >&2; exit 1; fi
+M=${1:-300}
+K=${2:-5000}
+WORK="$(mktemp -d)"
+SOCK="$WORK/zygote.sock"
+{
+  echo "{"
+  for ((i = 0; i < K; i++)); do echo "  .f$i = $i;"; done
+  echo "  .last = 0"
+  echo "};"
+} > "$WORK/big.ls"
+echo "!{ !require \"$WORK/big.ls\"; !println \"ok\"; };" > "$WORK/req.ls"
+"$BIN" --zygote="$SOCK" --preload "$WORK/big.ls" 2> "$WORK/zygote.err" &
+ZPID=$!
+trap 'kill "$ZPID" 2> /dev/null; rm -rf "$WORK"' EXIT
+echo '(~~builtin "core") .add 1 2' > "$WORK/add.ls"
+for ((i = 0; i < 50; i++)); do [[ -S "$SOCK" ]] && break; sleep 0.1; done
+if [[ ! -S "$SOCK" ]]; then echo "E: fork server did not start" >&2; cat "$WORK/zygote.err" >&2; exit 1; fi
+
+per_run() { # ms per run of the command
+  local s e
+  s=$(date +%s%N)
+  for ((i = 0; i < M; i++)); do
+    if ! "$@" > /dev/null 2>&1; then
+      echo fail
+      return
+    fi
+  done
+  e=$(date +%s%N)
+  awk "BEGIN { printf \"%.3f\", ($e - $s) / $M / 1e6 }"
+}
+
+if [[ "$("$BIN" --connect="$SOCK" "$WORK/add.ls")" != 3 ]]; then
+  echo "E: unexpected result from the fork server" >&2
+  exit 1
+fi
+printf "%-22s %12s\n" mode "ms/run"
+printf "%-22s %12s\n" "/bin/true" "$(per_run /bin/true)"
+printf "%-22s %12s\n" "lazyscript FILE" "$(per_run "$BIN" "$WORK/add.ls")"
+printf "%-22s %12s\n" "--connect FILE" "$(per_run "$BIN" --connect="$SOCK" "$WORK/add.ls")"
+printf "%-22s %12s\n" "lazyscript REQ" "$(per_run "$BIN" "$WORK/req.ls")"
+printf "%-22s %12s\n" "--connect REQ" "$(per_run "$BIN" --connect="$SOCK" "$WORK/req.ls")"
@@ -1,8 +1,10 @@
 // Builtin loader: (~prelude builtin) "name" -> namespace value
 #include "builtins/builtin_loader.h"
 #include "builtins/ns.h"
+#include "runtime/builtin.h"
 #include "runtime/error.h"
 #include "runtime/effects.h"
+#include "runtime/context.h"
 #include "common/io.h"
 #include "common/str.h"
 #include "common/hash.h"
@@ -36,8 +38,7 @@ typedef struct ls_builtin_module {
 
 typedef ls_builtin_module_t* (*ls_builtin_init_fn)(void);
 
-// Simple cache: name -> namespace thunk
-static lshash_t* g_builtin_cache = NULL;
+// Loaded modules are cached in the current context (lc_builtin_cache: name -> namespace thunk)
 
 static int       debug_enabled(void) {
         const char* d = getenv("LAZYSCRIPT_DEBUG");
@@ -166,6 +167,14 @@ static lsthunk_t* make_symbol_key(const char* name) {
   return lsthunk_new_symbol(lsstr_cstr(buf));
 }
 
+// The module ABI carries no attributes; the host's own arithmetic entries are known to force
+// both operands first, which lets lambdas built on them evaluate their arguments eagerly.
+static lsbuiltin_attr_t builtin_entry_attr(const ls_builtin_entry_t* e) {
+  if (e->fn == lsbuiltin_add || e->fn == lsbuiltin_sub || e->fn == lsbuiltin_lt)
+    return LSBATTR_STRICT;
+  return LSBATTR_PURE;
+}
+
 static lsthunk_t* build_namespace_from_module(const ls_builtin_module_t* mod) {
   if (!mod || !mod->entries || mod->entry_count < 0)
     return ls_make_err("builtin: invalid module");
@@ -194,7 +203,8 @@ static lsthunk_t* build_namespace_from_module(const ls_builtin_module_t* mod) {
         snprintf(label, (size_t)need + 1, "builtin:%s#%s", mname, e->name);
       }
     }
-    argv[2 * i + 1] = lsthunk_new_builtin(lsstr_cstr(label), e->arity, e->fn, e->data);
+    argv[2 * i + 1] = lsthunk_new_builtin_attr(lsstr_cstr(label), e->arity, e->fn, e->data,
+                                               builtin_entry_attr(e));
   }
   lsthunk_t* ns = lsbuiltin_nslit(pairs * 2, argv, NULL);
   // Free arg array; elements managed by thunks
@@ -219,10 +229,11 @@ lsthunk_t* lsbuiltin_prelude_builtin(lssize_t argc, lsthunk_t* const* args, void
     return ls_make_err("builtin: empty name");
 
   // Cache lookup
-  if (!g_builtin_cache)
-    g_builtin_cache = lshash_new(16);
+  ls_context_t* ctx = ls_context_current();
+  if (!ctx->lc_builtin_cache)
+    ctx->lc_builtin_cache = lshash_new(16);
   lshash_data_t cached;
-  if (lshash_get(g_builtin_cache, s, &cached)) {
+  if (lshash_get(ctx->lc_builtin_cache, s, &cached)) {
     if (debug_enabled())
       lsprintf(stderr, 0, "I: builtin: cache hit: name=%s\n", modname);
     return (lsthunk_t*)cached;
@@ -309,7 +320,7 @@ lsthunk_t* lsbuiltin_prelude_builtin(lssize_t argc, lsthunk_t* const* args, void
     return ns ? ns : ls_make_err("builtin: ns build");
   // Cache namespace by module name (copy key so hash owns it)
   const lsstr_t* keycopy = lsstr_new(lsstr_get_buf(s), lsstr_get_len(s));
-  lshash_put(g_builtin_cache, keycopy, ns, NULL);
+  lshash_put(ctx->lc_builtin_cache, keycopy, ns, NULL);
   if (debug_enabled())
     lsprintf(stderr, 0, "I: builtin: loaded: name=%s path=%s entries=%d\n", modname, chosen,
              mod->entry_count);
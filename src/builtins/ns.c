@@ -6,6 +6,7 @@
 #include "common/int.h"
 #include "runtime/unit.h"
 #include "runtime/effects.h"
+#include "runtime/context.h"
 #include "thunk/tenv.h"
 #include "runtime/error.h"
 #include "expr/expr.h"
@@ -99,10 +100,10 @@ typedef struct {
   int first;
 } _ns_dbg_ctx_t;
 static void _ns_dbg_cb(const lsstr_t* key, lshash_data_t value, void* data);
+// Named namespaces (name -> ns*) live in the current context (lc_namespaces)
 // Represent an ns value as a 1-ary builtin that dispatches on symbol: (~NS sym)
-static lshash_t* g_namespaces = NULL; // name -> ns* (named namespaces only)
-lsthunk_t*       lsbuiltin_ns_value(lssize_t argc, lsthunk_t* const* args, void* data) {
-        // data directly holds the namespace instance
+lsthunk_t* lsbuiltin_ns_value(lssize_t argc, lsthunk_t* const* args, void* data) {
+  // data directly holds the namespace instance
   lsns_t* ns = (lsns_t*)data;
   if (!ns)
     return NULL;
@@ -110,23 +111,33 @@ lsthunk_t*       lsbuiltin_ns_value(lssize_t argc, lsthunk_t* const* args, void*
 }
 
 // ----------------------------------------
-// Current namespace during nslit evaluation (stacked to allow nesting)
-static lsns_t* g_nslit_self = NULL;
+// Current namespace during nslit evaluation (stacked to allow nesting); kept in the current
+// context (lc_nslit_self)
+static lsns_t* ns_self(void) { return ls_context_current()->lc_nslit_self; }
+
+// Make ns the current namespace; returns the previous one for restoring
+static lsns_t* ns_set_self(lsns_t* ns) {
+  ls_context_t* ctx  = ls_context_current();
+  lsns_t*       prev = ctx->lc_nslit_self;
+  ctx->lc_nslit_self = ns;
+  return prev;
+}
 
 // (~prelude nsSelf) => returns the namespace value currently being built by nslit
 lsthunk_t* lsbuiltin_prelude_ns_self(lssize_t argc, lsthunk_t* const* args, void* data) {
   (void)argc;
   (void)args;
   (void)data;
-  if (!g_nslit_self || !g_nslit_self->map) {
+  lsns_t* self = ns_self();
+  if (!self || !self->map) {
     return ls_make_err("nsSelf: not in namespace literal");
   }
-  return lsthunk_new_builtin(lsstr_cstr("namespace"), 1, lsbuiltin_ns_value, g_nslit_self);
+  return lsthunk_new_builtin(lsstr_cstr("namespace"), 1, lsbuiltin_ns_value, self);
 }
 
 // ----------------------------------------
 // nslit member wrapper: keep original thunk, but when evaluated/applied,
-// temporarily set g_nslit_self so that (~prelude nsSelf) works even outside
+// temporarily set the current namespace so that (~prelude nsSelf) works even outside
 // of the literal construction, and so that intra-namespace references resolve.
 typedef struct ns_member_data {
   lsns_t*    ns;  // owning namespace
@@ -137,11 +148,10 @@ static lsthunk_t* lsbuiltin_ns_member_wrap(lssize_t argc, lsthunk_t* const* args
   ns_member_data_t* md = (ns_member_data_t*)data;
   if (!md || !md->ns || !md->val)
     return ls_make_err("namespace: member invalid");
-  lsns_t* prev_self = g_nslit_self;
-  g_nslit_self      = md->ns;
+  lsns_t* prev_self = ns_set_self(md->ns);
   // When applied, delegate application to original thunk; otherwise eval to WHNF
   lsthunk_t* ret = (argc == 0) ? lsthunk_eval0(md->val) : lsthunk_eval(md->val, argc, args);
-  g_nslit_self   = prev_self;
+  ns_set_self(prev_self);
   return ret;
 }
 // Key canonicalization
@@ -279,9 +289,10 @@ lsthunk_t* lsbuiltin_ns_members(lssize_t argc, lsthunk_t* const* args, void* dat
       return NULL;
     }
     const lsstr_t* nsname = lsthunk_get_constr(nsv);
-    if (g_namespaces) {
+    lshash_t* named = ls_context_current()->lc_namespaces;
+    if (named) {
       lshash_data_t nsp;
-      if (lshash_get(g_namespaces, nsname, &nsp))
+      if (lshash_get(named, nsname, &nsp))
         ns = (lsns_t*)nsp;
     }
   }
@@ -339,9 +350,10 @@ int lsns_foreach_member(lsthunk_t* ns_thunk, lsns_iter_cb cb, void* data) {
       return 0;
     }
     const lsstr_t* nsname = lsthunk_get_constr(ns_thunk);
-    if (g_namespaces) {
+    lshash_t* named = ls_context_current()->lc_namespaces;
+    if (named) {
       lshash_data_t nsp;
-      if (lshash_get(g_namespaces, nsname, &nsp))
+      if (lshash_get(named, nsname, &nsp))
         ns = (lsns_t*)nsp;
     }
   }
@@ -479,12 +491,11 @@ static lsthunk_t* lsbuiltin_ns_set(lssize_t argc, lsthunk_t* const* args, void*
 }
 
 // global registry name -> ns*
-static unsigned long  g_ns_counter = 0;
 static const lsstr_t* ns_make_key(const lsstr_t* base) {
   if (base)
     return base;
   char buf[32];
-  snprintf(buf, sizeof(buf), "__ns$%lu", ++g_ns_counter);
+  snprintf(buf, sizeof(buf), "__ns$%lu", ++ls_context_current()->lc_ns_counter);
   return lsstr_cstr(buf);
 }
 
@@ -531,8 +542,7 @@ lsthunk_t* lsbuiltin_nslit(lssize_t argc, lsthunk_t* const* args, void* data) {
   ns->map        = lshash_new(16);
   ns->is_mutable = 0; // immutable literal namespace
   // Enable (~prelude nsSelf) inside values while building
-  lsns_t* prev_self = g_nslit_self;
-  g_nslit_self      = ns;
+  lsns_t* prev_self = ns_set_self(ns);
   // First pass: resolve all keys and pre-register wrapped thunks for forward/self refs.
   // We do NOT evaluate values here; we keep the original thunk and wrap it so that
   // later evaluation happens with nsSelf bound.
@@ -542,12 +552,12 @@ lsthunk_t* lsbuiltin_nslit(lssize_t argc, lsthunk_t* const* args, void* data) {
     }
     lsthunk_t* symv = ls_eval_arg(args[i], "nslit: key");
     if (lsthunk_is_err(symv)) {
-      g_nslit_self = prev_self;
+      ns_set_self(prev_self);
       return symv;
     }
     const lsstr_t* symname = ns_encode_key_from_thunk(symv);
     if (!symname) {
-      g_nslit_self = prev_self;
+      ns_set_self(prev_self);
       return ls_make_err("nslit: symbol expected");
     }
     // Wrap original value thunk (unevaluated)
@@ -566,7 +576,7 @@ lsthunk_t* lsbuiltin_nslit(lssize_t argc, lsthunk_t* const* args, void* data) {
     (void)lshash_put(ns->map, symname, (const void*)wrapped, &oldv);
   }
   // No second pass needed; values will be evaluated lazily via wrappers.
-  g_nslit_self = prev_self;
+  ns_set_self(prev_self);
   if (nslog_enabled()) {
     lsprintf(stderr, 0, "DBG nslit end ns=%p map=%p\n", (void*)ns, (void*)ns->map);
   }
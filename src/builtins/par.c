@@ -0,0 +1,67 @@
+#include "runtime/par.h"
+#include "thunk/thunk.h"
+#include "common/malloc.h"
+#include "common/str.h"
+#include "runtime/error.h"
+
+// par a b: spark a for parallel evaluation and return b
+lsthunk_t* lsbuiltin_par(lssize_t argc, lsthunk_t* const* args, void* data) {
+  (void)argc;
+  (void)data;
+  ls_par_spark(args[0]);
+  return args[1];
+}
+
+// pseq a b: evaluate a to WHNF, then return b (unlike seq, pure and not an effect)
+lsthunk_t* lsbuiltin_pseq(lssize_t argc, lsthunk_t* const* args, void* data) {
+  (void)argc;
+  (void)data;
+  lsthunk_t* fst = ls_eval_arg(args[0], "pseq: first");
+  if (lsthunk_is_err(fst))
+    return fst;
+  return args[1];
+}
+
+// parMap f xs: map f xs with every element f x sparked. The spine of xs is forced.
+lsthunk_t* lsbuiltin_par_map(lssize_t argc, lsthunk_t* const* args, void* data) {
+  (void)argc;
+  (void)data;
+  const lsstr_t* cons  = lsstr_cstr(":");
+  const lsstr_t* nil   = lsstr_cstr("[]");
+  lsthunk_t**    elems = NULL;
+  lssize_t       n     = 0;
+  lssize_t       cap   = 0;
+  for (lsthunk_t* xs = args[1];;) {
+    lsthunk_t* v = ls_eval_arg(xs, "parMap: list");
+    if (lsthunk_is_err(v))
+      return v;
+    if (lsthunk_get_type(v) != LSTTYPE_ALGE)
+      return ls_make_err("parMap: not a list");
+    if (lsthunk_get_argc(v) == 0 && lsstrcmp(lsthunk_get_constr(v), nil) == 0)
+      break;
+    if (lsthunk_get_argc(v) != 2 || lsstrcmp(lsthunk_get_constr(v), cons) != 0)
+      return ls_make_err("parMap: not a list");
+    if (n == cap) {
+      cap   = cap ? cap * 2 : 16;
+      elems = lsrealloc(elems, cap * sizeof(lsthunk_t*));
+    }
+    elems[n++] = lsthunk_get_args(v)[0];
+    xs         = lsthunk_get_args(v)[1];
+  }
+  // Spark from the back: thieves take the oldest sparks first, so the caller, which consumes
+  // the list from the front, finds the elements nobody else has started
+  lsthunk_t* ret = lsthunk_alloc_alge(nil, 0);
+  for (lssize_t i = n; i > 0; i--) {
+    lsthunk_t* fx = lsthunk_alloc_appl(1);
+    lsthunk_set_appl_func(fx, args[0]);
+    lsthunk_set_appl_arg(fx, 0, elems[i - 1]);
+    ls_par_spark(fx);
+    lsthunk_t* c = lsthunk_alloc_alge(cons, 2);
+    lsthunk_set_alge_arg(c, 0, fx);
+    lsthunk_set_alge_arg(c, 1, ret);
+    ret = c;
+  }
+  if (elems != NULL)
+    lsfree(elems);
+  return ret;
+}
@@ -1,6 +1,8 @@
 #include "runtime/effects.h"
 #include "runtime/unit.h"
 #include "runtime/modules.h"
+#include "runtime/modcache.h"
+#include "runtime/prefetch.h"
 #include "thunk/thunk.h"
 #include "thunk/tenv.h"
 #include "common/str.h"
@@ -20,28 +22,28 @@ static int      debug_enabled(void) {
        return d && *d;
 }
 
-static const lsprog_t* ls_require_resolve(const char* path) {
-  const lsprog_t* prog = lsparse_file_nullable(path);
+// Parse the file a module name resolves to (*pfile), unless it was parsed ahead. When it cannot
+// be parsed (it may also have been moved or removed since the name was resolved), the later
+// candidates are tried in order, as lsparse_file_nullable did: the first one that parses is
+// stored in *pfile and remembered for the name.
+static const lsprog_t* ls_require_parse(const char* name, const lsmodule_file_t** pfile) {
+  const lsmodule_file_t* file = *pfile;
+  if (!file)
+    return NULL;
+  const lsprog_t* prog = ls_prefetch_take(file);
+  if (!prog)
+    prog = ls_modcache_parse_file(file->lmf_path);
   if (prog)
     return prog;
-  const char* spath = getenv("LAZYSCRIPT_PATH");
-  if (spath && spath[0]) {
-    char* buf = strdup(spath);
-    if (buf) {
-      for (char* tok = strtok(buf, ":"); tok != NULL; tok = strtok(NULL, ":")) {
-        size_t need = strlen(tok) + 1 + strlen(path) + 1;
-        char*  cand = (char*)malloc(need);
-        if (!cand)
-          break;
-        snprintf(cand, need, "%s/%s", tok, path);
-        prog = lsparse_file_nullable(cand);
-        if (prog) {
-          free(buf);
-          return prog;
-        }
-        free(cand);
-      }
-      free(buf);
+  const lsmodule_file_t* cand = NULL;
+  while ((cand = ls_modules_find(name, cand)) != NULL) {
+    if (strcmp(cand->lmf_path, file->lmf_path) == 0 && lsstrcmp(cand->lmf_id, file->lmf_id) == 0)
+      continue; // the file that does not parse
+    prog = ls_modcache_parse_file(cand->lmf_path);
+    if (prog) {
+      ls_modules_remember(name, cand);
+      *pfile = cand;
+      return prog;
     }
   }
   return NULL;
@@ -67,18 +69,21 @@ lsthunk_t* lsbuiltin_prelude_require(lssize_t argc, lsthunk_t* const* args, void
   FILE*  fp  = lsopen_memstream_gc(&buf, &n);
   lsstr_print_bare(fp, LSPREC_LOWEST, 0, lsthunk_get_str(pathv));
   fclose(fp);
-  const char* path = buf;
-  if (ls_modules_is_loaded(path))
+  const lsmodule_file_t* file = ls_modules_resolve(buf);
+  if (file && ls_modules_is_loaded(file))
     return ls_make_unit();
-  const lsprog_t* prog = ls_require_resolve(path);
+  const lsprog_t* prog = ls_require_parse(buf, &file);
   if (!prog)
     return ls_make_err("require: not found");
+  if (ls_modules_is_loaded(file))
+    return ls_make_unit(); // resolved again to a module loaded under another name
+  ls_prefetch_program(prog);
   if (ls_effects_get_strict())
     ls_effects_begin();
   (void)lsprog_eval(prog, tenv);
   if (ls_effects_get_strict())
     ls_effects_end();
-  ls_modules_mark_loaded(path);
+  ls_modules_mark_loaded(file);
   return ls_make_unit();
 }
 
@@ -107,8 +112,9 @@ lsthunk_t* lsbuiltin_prelude_include(lssize_t argc, lsthunk_t* const* args, void
   FILE*  fp  = lsopen_memstream_gc(&buf, &n);
   lsstr_print_bare(fp, LSPREC_LOWEST, 0, lsthunk_get_str(pathv));
   fclose(fp);
-  const char*     path = buf;
-  const lsprog_t* prog = ls_require_resolve(path);
+  const char*            path = buf;
+  const lsmodule_file_t* file = ls_modules_resolve(path);
+  const lsprog_t*        prog = ls_require_parse(path, &file);
   if (!prog) {
     return ls_make_err("include: not found");
   }
@@ -119,6 +125,7 @@ lsthunk_t* lsbuiltin_prelude_include(lssize_t argc, lsthunk_t* const* args, void
     lsprintf(stderr, 0, "%s\n", path);
   }
   // Do NOT enable effects here; pure modules will work, effectful ones will raise at call sites.
+  ls_prefetch_program(prog);
   lsthunk_t* ret = lsprog_eval(prog, child);
   if (debug_enabled()) {
     const char* rt =
@@ -35,4 +35,10 @@ void lsfree(void* ptr) {
     return;
   }
   GC_FREE(ptr);
+}
+
+void lsweak_link(void** link, const void* obj) {
+  if (use_libc_alloc())
+    return;
+  GC_GENERAL_REGISTER_DISAPPEARING_LINK(link, obj);
 }
\ No newline at end of file
@@ -5,4 +5,7 @@
 void* lsmalloc(size_t size);
 void* lsmalloc_atomic(size_t size);
 void* lsrealloc(void* ptr, size_t size);
-void  lsfree(void* ptr);
\ No newline at end of file
+void  lsfree(void* ptr);
+// Register *link as a weak reference to obj: the collector clears it once obj is unreachable.
+// No-op with the libc allocator, which never reclaims objects behind the program's back.
+void  lsweak_link(void** link, const void* obj);
\ No newline at end of file
@@ -4,11 +4,13 @@
 #include <assert.h>
 #include <gc.h>
 #include <limits.h>
+#include <pthread.h>
 #include <string.h>
 
 struct lsstr {
   const char* ls_buf;
   lssize_t    ls_len;
+  int         ls_tag; // dense tag of an interned string; 0 until requested
 };
 
 typedef struct lsstr_ht {
@@ -17,7 +19,30 @@ typedef struct lsstr_ht {
   lssize_t        lsth_cap;
 } lsstr_ht_t;
 
-static lsstr_ht_t g_str_ht = { NULL, 0, 0 };
+// Interned strings are spread over LSSTR_NSHARDS tables by hash, each under its own lock, so
+// threads interning different strings rarely wait for each other
+#define LSSTR_NSHARDS 64
+#define LSSTR_SHARD_BITS 6
+
+typedef struct lsstr_shard {
+  pthread_mutex_t lss_lock;
+  lsstr_ht_t      lss_ht;
+  // Strings finalized by an allocation made while this thread held the shard: an insert may be
+  // in progress, so they are deleted when the shard is released
+  const lsstr_t** lss_deferred;
+  lssize_t        lss_ndeferred;
+  lssize_t        lss_deferred_cap;
+} lsstr_shard_t;
+
+static lsstr_shard_t  g_str_shards[LSSTR_NSHARDS];
+static pthread_once_t g_str_once  = PTHREAD_ONCE_INIT;
+static int            g_str_ready = 0; // set once the shards are initialized
+static __thread char  g_str_held[LSSTR_NSHARDS]; // shards locked by the calling thread
+
+// Next tag handed out by lsstr_get_tag (tags start at 1; 0 means "no tag"). Tags are handed out
+// under their own lock to keep them dense.
+static pthread_mutex_t g_str_tag_lock = PTHREAD_MUTEX_INITIALIZER;
+static int             g_str_next_tag = 1;
 
 /**
  * Calculates the hash value of a key.
@@ -44,15 +69,16 @@ static const lsstr_t* lsstr_new_raw(const char* buf, lssize_t len) {
   lsstr_t* str = lsmalloc(sizeof(lsstr_t) + len + 1);
   str->ls_buf  = lsmalloc_atomic(len + 1);
   str->ls_len  = len;
+  str->ls_tag  = 0;
   memcpy((void*)str->ls_buf, buf, len);
   ((char*)str->ls_buf)[len] = '\0';
   return str;
 }
 
-static const lsstr_t** lsstr_ht_get_raw(lsstr_ht_t* str_ht, const char* buf, lssize_t len) {
+static const lsstr_t** lsstr_ht_get_raw_hash(lsstr_ht_t* str_ht, const char* buf, lssize_t len,
+                                             unsigned int hash) {
   assert(str_ht != NULL);
   assert(buf != NULL);
-  unsigned int    hash = lsstr_calc_hash_bare(buf, len);
   lssize_t        cap  = str_ht->lsth_cap;
   const lsstr_t** ents = str_ht->lsth_ents;
   lssize_t        i    = hash % cap;
@@ -68,6 +94,10 @@ static const lsstr_t** lsstr_ht_get_raw(lsstr_ht_t* str_ht, const char* buf, lss
   }
 }
 
+static const lsstr_t** lsstr_ht_get_raw(lsstr_ht_t* str_ht, const char* buf, lssize_t len) {
+  return lsstr_ht_get_raw_hash(str_ht, buf, len, lsstr_calc_hash_bare(buf, len));
+}
+
 static void lsstr_ht_resize(lsstr_ht_t* str_ht, lssize_t new_capacity) {
   assert(str_ht != NULL);
   assert(new_capacity >= str_ht->lsth_size);
@@ -136,18 +166,58 @@ static const lsstr_t* lsstr_ht_del_raw_resizable(lsstr_ht_t* str_hash, const lss
   return str;
 }
 
+// Shard of a hash: its top bits after a multiplicative mix (the table index uses the low bits)
+static int lsstr_shard_index(unsigned int hash) {
+  return (int)((hash * 2654435761u) >> (32 - LSSTR_SHARD_BITS));
+}
+
+static lsstr_shard_t* lsstr_shard_lock(int idx) {
+  lsstr_shard_t* shard = &g_str_shards[idx];
+  pthread_mutex_lock(&shard->lss_lock);
+  g_str_held[idx] = 1;
+  return shard;
+}
+
+static void lsstr_shard_unlock(int idx) {
+  lsstr_shard_t* shard = &g_str_shards[idx];
+  // Deleting may resize the table and defer more strings; the loop picks them up
+  while (shard->lss_ndeferred > 0) {
+    lssize_t       i       = --shard->lss_ndeferred;
+    const lsstr_t* str     = shard->lss_deferred[i];
+    shard->lss_deferred[i] = NULL;
+    if (*lsstr_ht_get_raw(&shard->lss_ht, str->ls_buf, str->ls_len) == str)
+      lsstr_ht_del_raw_resizable(&shard->lss_ht, str);
+  }
+  g_str_held[idx] = 0;
+  pthread_mutex_unlock(&shard->lss_lock);
+}
+
 static void lsstr_finalizer(void* ptr, void* data) {
   assert(ptr != NULL);
   (void)data;
-  const lsstr_t* str  = ptr;
-  const lsstr_t* str2 = lsstr_ht_del_raw_resizable(&g_str_ht, str);
+  const lsstr_t* str   = ptr;
+  int            idx   = lsstr_shard_index(lsstr_calc_hash(str));
+  lsstr_shard_t* shard = &g_str_shards[idx];
+  if (g_str_held[idx]) {
+    if (shard->lss_ndeferred == shard->lss_deferred_cap) {
+      shard->lss_deferred_cap = shard->lss_deferred_cap ? shard->lss_deferred_cap * 2 : 16;
+      shard->lss_deferred =
+          lsrealloc(shard->lss_deferred, sizeof(const lsstr_t*) * shard->lss_deferred_cap);
+    }
+    shard->lss_deferred[shard->lss_ndeferred++] = str;
+    return;
+  }
+  lsstr_shard_lock(idx);
+  const lsstr_t* str2 = lsstr_ht_del_raw_resizable(&shard->lss_ht, str);
+  lsstr_shard_unlock(idx);
   assert(str == str2);
 }
 
-static const lsstr_t** lsstr_ht_put_raw(lsstr_ht_t* str_ht, const char* buf, lssize_t len) {
+static const lsstr_t** lsstr_ht_put_raw(lsstr_ht_t* str_ht, const char* buf, lssize_t len,
+                                        unsigned int hash) {
   assert(str_ht != NULL);
   assert(buf != NULL);
-  const lsstr_t** pstr = lsstr_ht_get_raw(str_ht, buf, len);
+  const lsstr_t** pstr = lsstr_ht_get_raw_hash(str_ht, buf, len, hash);
   if (*pstr != NULL)
     return pstr;
   *pstr = lsstr_new_raw(buf, len);
@@ -157,7 +227,7 @@ static const lsstr_t** lsstr_ht_put_raw(lsstr_ht_t* str_ht, const char* buf, lss
 }
 
 static const lsstr_t* lsstr_ht_put_raw_resizable(lsstr_ht_t* str_ht, const char* buf,
-                                                 lssize_t len) {
+                                                 lssize_t len, unsigned int hash) {
   assert(str_ht != NULL);
   assert(buf != NULL);
   lssize_t cap = str_ht->lsth_cap;
@@ -165,24 +235,32 @@ static const lsstr_t* lsstr_ht_put_raw_resizable(lsstr_ht_t* str_ht, const char*
     cap *= 2;
   if (cap != str_ht->lsth_cap)
     lsstr_ht_resize(str_ht, cap);
-  return *lsstr_ht_put_raw(str_ht, buf, len);
+  return *lsstr_ht_put_raw(str_ht, buf, len, hash);
 }
 
-static void lsstr_ensure_init(void) {
-  if (g_str_ht.lsth_ents != NULL)
-    return;
-  // Allocate entries in GC-scanned memory so they keep interned strings alive.
-  g_str_ht.lsth_ents = lsmalloc(sizeof(const lsstr_t*) * 16);
-  g_str_ht.lsth_cap  = 16;
-  g_str_ht.lsth_size = 0;
-  for (lssize_t i = 0; i < g_str_ht.lsth_cap; i++)
-    g_str_ht.lsth_ents[i] = NULL;
+static void lsstr_init(void) {
+  for (int i = 0; i < LSSTR_NSHARDS; i++) {
+    lsstr_shard_t* shard = &g_str_shards[i];
+    pthread_mutex_init(&shard->lss_lock, NULL);
+    // Allocate entries in GC-scanned memory so they keep interned strings alive.
+    shard->lss_ht.lsth_ents = lsmalloc(sizeof(const lsstr_t*) * 16);
+    shard->lss_ht.lsth_cap  = 16;
+    shard->lss_ht.lsth_size = 0;
+    for (lssize_t j = 0; j < shard->lss_ht.lsth_cap; j++)
+      shard->lss_ht.lsth_ents[j] = NULL;
+  }
+  __atomic_store_n(&g_str_ready, 1, __ATOMIC_RELEASE);
 }
 
 const lsstr_t* lsstr_new(const char* buf, lssize_t len) {
   assert(buf != NULL);
-  lsstr_ensure_init();
-  const lsstr_t* str = lsstr_ht_put_raw_resizable(&g_str_ht, buf, len);
+  if (!__atomic_load_n(&g_str_ready, __ATOMIC_ACQUIRE))
+    pthread_once(&g_str_once, lsstr_init);
+  unsigned int   hash  = lsstr_calc_hash_bare(buf, len);
+  int            idx   = lsstr_shard_index(hash);
+  lsstr_shard_t* shard = lsstr_shard_lock(idx);
+  const lsstr_t* str   = lsstr_ht_put_raw_resizable(&shard->lss_ht, buf, len, hash);
+  lsstr_shard_unlock(idx);
   return str;
 }
 
@@ -195,6 +273,7 @@ const lsstr_t* lsstr_sub(const lsstr_t* str, lssize_t pos, lssize_t len) {
   lsstr_t* sub = lsmalloc(sizeof(lsstr_t));
   sub->ls_buf  = str->ls_buf + pos;
   sub->ls_len  = len;
+  sub->ls_tag  = 0;
   return sub;
 }
 
@@ -213,6 +292,23 @@ lssize_t lsstr_get_len(const lsstr_t* str) {
   return str->ls_len;
 }
 
+int lsstr_get_tag(const lsstr_t* str) {
+  assert(str != NULL);
+  int tag = __atomic_load_n(&str->ls_tag, __ATOMIC_ACQUIRE);
+  if (tag != 0)
+    return tag;
+  // Substrings are not interned; the tag lives on the interned instance
+  lsstr_t* istr = (lsstr_t*)lsstr_new(str->ls_buf, str->ls_len);
+  pthread_mutex_lock(&g_str_tag_lock);
+  tag = istr->ls_tag;
+  if (tag == 0) {
+    tag = g_str_next_tag++;
+    __atomic_store_n(&istr->ls_tag, tag, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&g_str_tag_lock);
+  return tag;
+}
+
 int lsstrcmp(const lsstr_t* str1, const lsstr_t* str2) {
   assert(str1 != NULL);
   assert(str2 != NULL);
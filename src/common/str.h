@@ -15,6 +15,18 @@ const char*    lsstr_get_buf(const lsstr_t* str);
 lssize_t       lsstr_get_len(const lsstr_t* str);
 int            lsstrcmp(const lsstr_t* str1, const lsstr_t* str2);
 
+/**
+ * Returns the dense integer tag of a string.
+ *
+ * Tags are assigned on first request, in request order starting at 1, so when only
+ * constructor names ask for one the tags stay small enough for switch tables. Equal
+ * strings always share a tag while any of them is alive.
+ *
+ * @param str The string.
+ * @return The tag (> 0).
+ */
+int lsstr_get_tag(const lsstr_t* str);
+
 /**
  * Calculates the hash value of a key.
  *
@@ -3,6 +3,18 @@
 #include "expr/ealge.h"
 #include "common/str.h"
 #include "common/io.h"
+#include "common/int.h"
+#include "common/loc.h"
+#include "common/malloc.h"
+#include <gc.h>
+#include <stdlib.h>
+#include <string.h>
+
+void lsrt_init(void) {
+  const char* use_libc = getenv("LAZYSCRIPT_USE_LIBC_ALLOC");
+  if (!(use_libc && use_libc[0] && use_libc[0] != '0'))
+    GC_init();
+}
 
 lsrt_value_t* lsrt_make_int(long long v) { return lsthunk_new_int(lsint_new((int)v)); }
 
@@ -30,7 +42,287 @@ lsrt_value_t* lsrt_unit(void) {
   return lsthunk_new_ealge(eunit, NULL);
 }
 
+lsrt_value_t* lsrt_make_symbol(const char* name) { return lsthunk_new_symbol(lsstr_cstr(name)); }
+
+typedef struct lsrt_closure lsrt_closure_t;
+struct lsrt_closure {
+  lsrt_fn_t             lrc_fn;   // unary entry (LLVM backend), or NULL
+  lsrt_fnn_t            lrc_fnn;  // n-ary entry (C backend), or NULL
+  const lsrt_closure_t* lrc_base; // partial application of lrc_base to lrc_env, or NULL
+  int                   lrc_arity;
+  int                   lrc_envc;
+  lsrt_value_t*         lrc_env[0];
+};
+
+// Call c with exactly lrc_arity arguments
+static lsrt_value_t* lsrt_closure_enter(const lsrt_closure_t* c, lsrt_value_t* const* args) {
+  if (c->lrc_base) {
+    lsrt_value_t* all[c->lrc_envc + c->lrc_arity];
+    memcpy(all, c->lrc_env, sizeof(lsrt_value_t*) * c->lrc_envc);
+    memcpy(all + c->lrc_envc, args, sizeof(lsrt_value_t*) * c->lrc_arity);
+    return lsrt_closure_enter(c->lrc_base, all);
+  }
+  return c->lrc_fnn ? c->lrc_fnn(c->lrc_env, args) : c->lrc_fn(c->lrc_env, args[0]);
+}
+
+static lsthunk_t* lsrt_closure_call(lssize_t argc, lsthunk_t* const* args, void* data) {
+  (void)argc;
+  return lsrt_closure_enter(data, args);
+}
+
+static lsrt_value_t* lsrt_closure_new(lsrt_fn_t fn, lsrt_fnn_t fnn, int arity, int envc,
+                                      lsrt_value_t* const* env) {
+  lsrt_closure_t* c = lsmalloc(sizeof(lsrt_closure_t) + envc * sizeof(lsrt_value_t*));
+  c->lrc_fn         = fn;
+  c->lrc_fnn        = fnn;
+  c->lrc_base       = NULL;
+  c->lrc_arity      = arity;
+  c->lrc_envc       = envc;
+  for (int i = 0; i < envc; i++)
+    c->lrc_env[i] = env[i];
+  static const lsstr_t* name = NULL;
+  if (name == NULL)
+    name = lsstr_cstr("<closure>");
+  return lsthunk_new_builtin(name, arity, lsrt_closure_call, c);
+}
+
+// Partial application of a compiled closure; stays a compiled closure so that the rest of the
+// arguments are entered directly rather than through the evaluator's partial application
+static lsrt_value_t* lsrt_closure_pap(const lsrt_closure_t* base, int argc,
+                                      lsrt_value_t* const* args) {
+  if (base->lrc_base) {
+    lsrt_value_t* all[base->lrc_envc + argc];
+    memcpy(all, base->lrc_env, sizeof(lsrt_value_t*) * base->lrc_envc);
+    memcpy(all + base->lrc_envc, args, sizeof(lsrt_value_t*) * argc);
+    return lsrt_closure_pap(base->lrc_base, base->lrc_envc + argc, all);
+  }
+  lsrt_value_t* pap = lsrt_closure_new(NULL, NULL, base->lrc_arity - argc, argc, args);
+  ((lsrt_closure_t*)lsthunk_get_builtin_data(pap))->lrc_base = base;
+  return pap;
+}
+
+lsrt_value_t* lsrt_make_closure(lsrt_fn_t fn, int envc, lsrt_value_t* const* env) {
+  return lsrt_closure_new(fn, NULL, 1, envc, env);
+}
+
+lsrt_value_t* lsrt_make_closure_n(lsrt_fnn_t fn, int arity, int envc, lsrt_value_t* const* env) {
+  return lsrt_closure_new(NULL, fn, arity, envc, env);
+}
+
+// Values are NULL after a fatal runtime error; keep those from reaching the evaluator
+static lsthunk_t* lsrt_whnf(lsrt_value_t* v) { return v ? lsthunk_eval0(v) : NULL; }
+
+static int lsrt_name_is(const lsstr_t* name, const char* cstr) {
+  return name && strcmp(lsstr_get_buf(name), cstr) == 0;
+}
+
+int lsrt_truthy(lsrt_value_t* v) {
+  v = lsrt_whnf(v);
+  if (v == NULL)
+    return 0;
+  switch (lsthunk_get_type(v)) {
+  case LSTTYPE_INT:
+    return lsint_get(lsthunk_get_int(v)) != 0;
+  case LSTTYPE_ALGE:
+    return !(lsrt_name_is(lsthunk_get_constr(v), "false") ||
+             (lsrt_name_is(lsthunk_get_constr(v), "()") && lsthunk_get_argc(v) == 0));
+  case LSTTYPE_SYMBOL:
+    return !lsrt_name_is(lsthunk_get_symbol(v), "false");
+  default:
+    return 1;
+  }
+}
+
+int lsrt_match_constr(lsrt_value_t* v, const char* name, int argc) {
+  v = lsrt_whnf(v);
+  return v && lsthunk_get_type(v) == LSTTYPE_ALGE && lsthunk_get_argc(v) == argc &&
+         lsrt_name_is(lsthunk_get_constr(v), name);
+}
+
+int lsrt_match_int(lsrt_value_t* v, long long k) {
+  v = lsrt_whnf(v);
+  return v && lsthunk_get_type(v) == LSTTYPE_INT && lsint_get(lsthunk_get_int(v)) == k;
+}
+
+int lsrt_match_str(lsrt_value_t* v, const char* bytes, unsigned long n) {
+  v = lsrt_whnf(v);
+  if (!v || lsthunk_get_type(v) != LSTTYPE_STR)
+    return 0;
+  const lsstr_t* s = lsthunk_get_str(v);
+  return (unsigned long)lsstr_get_len(s) == n && memcmp(lsstr_get_buf(s), bytes, n) == 0;
+}
+
+lsrt_value_t* lsrt_constr_arg(lsrt_value_t* v, int i) {
+  v = lsrt_whnf(v);
+  return v && i < lsthunk_get_argc(v) ? lsthunk_get_args(v)[i] : NULL;
+}
+
+// Bottom value raised by native code, carrying the offending value v
+static lsrt_value_t* lsrt_bottom(const char* msg, lsrt_value_t* v) {
+  return lsthunk_new_bottom(msg, lsloc("<native>", 1, 1, 1, 1), 1, &v);
+}
+
+lsrt_value_t* lsrt_match_fail(lsrt_value_t* v) { return lsrt_bottom("match: no case", v); }
+
+// Evaluate an operand of an integer builtin: 1 and its value in *out when it is an integer,
+// otherwise 0 and the result of the builtin in *err
+static int lsrt_int_operand(const char* msg, lsrt_value_t* v, int* out, lsrt_value_t** err) {
+  v = lsrt_whnf(v);
+  if (v && lsthunk_get_type(v) == LSTTYPE_INT) {
+    *out = lsint_get(lsthunk_get_int(v));
+    return 1;
+  }
+  if (v == NULL || lsthunk_is_bottom(v))
+    *err = v;
+  else
+    *err = lsrt_bottom(msg, v);
+  return 0;
+}
+
+lsrt_value_t* lsrt_add(lsrt_value_t* a, lsrt_value_t* b) {
+  int           x, y;
+  lsrt_value_t* err;
+  if (!lsrt_int_operand("add: invalid type", a, &x, &err) ||
+      !lsrt_int_operand("add: invalid type", b, &y, &err))
+    return err;
+  return lsrt_make_int((long long)x + y);
+}
+
+lsrt_value_t* lsrt_sub(lsrt_value_t* a, lsrt_value_t* b) {
+  int           x, y;
+  lsrt_value_t* err;
+  if (!lsrt_int_operand("sub: invalid type", a, &x, &err) ||
+      !lsrt_int_operand("sub: invalid type", b, &y, &err))
+    return err;
+  return lsrt_make_int((long long)x - y);
+}
+
+lsrt_value_t* lsrt_lt(lsrt_value_t* a, lsrt_value_t* b) {
+  int           x, y;
+  lsrt_value_t* err;
+  if (!lsrt_int_operand("lt: invalid type", a, &x, &err) ||
+      !lsrt_int_operand("lt: invalid type", b, &y, &err))
+    return err;
+  return lsrt_make_constr(x < y ? "true" : "false", 0, NULL);
+}
+
+// Evaluate the spine of the list xs: 1 with its elements in *elems and their count in *n, or 0
+// with the result of the builtin in *err
+static int lsrt_spine(const char* msg, lsrt_value_t* xs, lsrt_value_t*** elems, lssize_t* n,
+                      lsrt_value_t** err) {
+  lssize_t cap = 0;
+  *elems       = NULL;
+  *n           = 0;
+  for (;;) {
+    lsrt_value_t* v = lsrt_whnf(xs);
+    if (v && lsthunk_get_type(v) == LSTTYPE_ALGE) {
+      if (lsthunk_get_argc(v) == 0 && lsrt_name_is(lsthunk_get_constr(v), "[]"))
+        return 1;
+      if (lsthunk_get_argc(v) == 2 && lsrt_name_is(lsthunk_get_constr(v), ":")) {
+        if (*n == cap) {
+          cap    = cap ? cap * 2 : 16;
+          *elems = lsrealloc(*elems, sizeof(lsrt_value_t*) * cap);
+        }
+        (*elems)[(*n)++] = lsthunk_get_args(v)[0];
+        xs               = lsthunk_get_args(v)[1];
+        continue;
+      }
+    }
+    *err = v == NULL || lsthunk_is_bottom(v) ? v : lsrt_bottom(msg, v);
+    return 0;
+  }
+}
+
+static lsrt_value_t* lsrt_cons(const lsstr_t* cons, lsrt_value_t* x, lsrt_value_t* xs) {
+  lsthunk_t* c = lsthunk_alloc_alge(cons, 2);
+  lsthunk_set_alge_arg(c, 0, x);
+  lsthunk_set_alge_arg(c, 1, xs);
+  return c;
+}
+
+// Apply func for a list builtin: 1 with the value in *r, or 0 when *r is an error
+static int lsrt_step(lsrt_value_t* func, int argc, lsrt_value_t* const* args, lsrt_value_t** r) {
+  *r = lsrt_whnf(lsrt_apply(func, argc, args));
+  return *r && !lsthunk_is_bottom(*r);
+}
+
+lsrt_value_t* lsrt_map(lsrt_value_t* f, lsrt_value_t* xs) {
+  lsrt_value_t** elems;
+  lssize_t       n;
+  lsrt_value_t*  r;
+  if (!lsrt_spine("map: not a list", xs, &elems, &n, &r))
+    return r;
+  const lsstr_t* cons = lsstr_cstr(":");
+  lsrt_value_t*  acc  = lsrt_make_constr("[]", 0, NULL);
+  for (lssize_t i = n; i > 0; i--)
+    acc = lsrt_cons(cons, lsrt_apply(f, 1, &elems[i - 1]), acc);
+  return acc;
+}
+
+lsrt_value_t* lsrt_filter(lsrt_value_t* p, lsrt_value_t* xs) {
+  lsrt_value_t** elems;
+  lssize_t       n;
+  lsrt_value_t*  r;
+  if (!lsrt_spine("filter: not a list", xs, &elems, &n, &r))
+    return r;
+  const lsstr_t* cons = lsstr_cstr(":");
+  lsrt_value_t*  acc  = lsrt_make_constr("[]", 0, NULL);
+  for (lssize_t i = n; i > 0; i--) {
+    if (!lsrt_step(p, 1, &elems[i - 1], &r))
+      return r;
+    if (lsrt_truthy(r))
+      acc = lsrt_cons(cons, elems[i - 1], acc);
+  }
+  return acc;
+}
+
+lsrt_value_t* lsrt_foldr(lsrt_value_t* k, lsrt_value_t* z, lsrt_value_t* xs) {
+  lsrt_value_t** elems;
+  lssize_t       n;
+  lsrt_value_t*  acc;
+  if (!lsrt_spine("foldr: not a list", xs, &elems, &n, &acc))
+    return acc;
+  acc = z;
+  for (lssize_t i = n; i > 0; i--) {
+    lsrt_value_t* args[2] = { elems[i - 1], acc };
+    if (!lsrt_step(k, 2, args, &acc))
+      return acc;
+  }
+  return acc;
+}
+
+int lsrt_unbox_int(lsrt_value_t* v, long long* out) {
+  v = lsrt_whnf(v);
+  if (!v || lsthunk_get_type(v) != LSTTYPE_INT)
+    return 0;
+  *out = lsint_get(lsthunk_get_int(v));
+  return 1;
+}
+
+lsrt_value_t* lsrt_unbox_fail(lsrt_value_t* v) {
+  v = lsrt_whnf(v);
+  if (v == NULL || lsthunk_is_bottom(v))
+    return v;
+  return lsrt_bottom("invalid type: expected an integer", v);
+}
+
 lsrt_value_t* lsrt_apply(lsrt_value_t* func, int argc, lsrt_value_t* const* args) {
+  if (func == NULL)
+    return NULL;
+  // Saturated calls of compiled closures are entered directly
+  while (argc > 0 && lsthunk_get_type(func) == LSTTYPE_BUILTIN &&
+         lsthunk_get_builtin_func(func) == lsrt_closure_call) {
+    const lsrt_closure_t* c = lsthunk_get_builtin_data(func);
+    if (argc < c->lrc_arity)
+      return lsrt_closure_pap(c, argc, args);
+    func = lsrt_closure_enter(c, args);
+    if (func == NULL || (func = lsthunk_eval0(func)) == NULL || lsthunk_is_bottom(func))
+      return func;
+    args += c->lrc_arity;
+    argc -= c->lrc_arity;
+  }
+  if (argc == 0)
+    return lsthunk_eval0(func);
   return lsthunk_eval(func, argc, (lsthunk_t* const*)args);
 }
 
@@ -56,3 +348,17 @@ lsrt_value_t* lsrt_println(lsrt_value_t* v) {
   lsprintf(stdout, 0, "\n");
   return lsrt_unit();
 }
+
+int lsrt_print_result(lsrt_value_t* v) {
+  if (v == NULL || (v = lsthunk_eval0(v)) == NULL)
+    return 1;
+  if (lsthunk_is_bottom(v)) {
+    lsprintf(stderr, 0, "E: ");
+    lsthunk_print(stderr, LSPREC_LOWEST, 0, v);
+    lsprintf(stderr, 0, "\n");
+    return 1;
+  }
+  lsthunk_print(stdout, LSPREC_LOWEST, 0, v);
+  lsprintf(stdout, 0, "\n");
+  return 0;
+}
@@ -22,9 +22,58 @@ lsrt_value_t* lsrt_unit(void);
 lsrt_value_t* lsrt_apply(lsrt_value_t* func, int argc, lsrt_value_t* const* args);
 lsrt_value_t* lsrt_eval(lsrt_value_t* v);
 
+// Runtime initialization for native programs (GC setup). Call once before any other lsrt_*.
+void lsrt_init(void);
+
+// Unbound Core IR variables evaluate to symbols
+lsrt_value_t* lsrt_make_symbol(const char* name);
+
+// Closures of compiled lambdas: fn receives the captured values and the single argument.
+// env is copied, so the caller may pass a temporary array.
+typedef lsrt_value_t* (*lsrt_fn_t)(lsrt_value_t* const* env, lsrt_value_t* arg);
+lsrt_value_t* lsrt_make_closure(lsrt_fn_t fn, int envc, lsrt_value_t* const* env);
+// Closures of lambda chains (`\a -> \b -> e`) of the given arity: fn receives all arguments at
+// once; partial applications are handled by the runtime.
+typedef lsrt_value_t* (*lsrt_fnn_t)(lsrt_value_t* const* env, lsrt_value_t* const* args);
+lsrt_value_t* lsrt_make_closure_n(lsrt_fnn_t fn, int arity, int envc, lsrt_value_t* const* env);
+
+// Condition of `if`: 0 for the integer 0, false and unit; 1 otherwise
+int lsrt_truthy(lsrt_value_t* v);
+
+// Integer builtins: Core IR's unbound add, sub and lt (see lscir_optimize). Both operands are
+// evaluated; a non-integer operand gives a bottom value.
+lsrt_value_t* lsrt_add(lsrt_value_t* a, lsrt_value_t* b);
+lsrt_value_t* lsrt_sub(lsrt_value_t* a, lsrt_value_t* b);
+lsrt_value_t* lsrt_lt(lsrt_value_t* a, lsrt_value_t* b);
+
+// List builtins: Core IR's unbound map, filter and foldr (see lscir_optimize). They are strict:
+// the whole spine of xs is evaluated first, and every application of f, p or k is evaluated
+// before the next one (foldr runs from the last element to the first). A spine that is not a
+// list, or a bottom result of p or k, gives a bottom value.
+lsrt_value_t* lsrt_map(lsrt_value_t* f, lsrt_value_t* xs);
+lsrt_value_t* lsrt_filter(lsrt_value_t* p, lsrt_value_t* xs);
+lsrt_value_t* lsrt_foldr(lsrt_value_t* k, lsrt_value_t* z, lsrt_value_t* xs);
+
+// Unboxing for compiled workers taking raw integers: evaluates v and stores its value in *out,
+// returning 1; returns 0 when v is not an integer. lsrt_unbox_fail is the result of a call whose
+// argument v could not be unboxed (v itself when it is a bottom value).
+int           lsrt_unbox_int(lsrt_value_t* v, long long* out);
+lsrt_value_t* lsrt_unbox_fail(lsrt_value_t* v);
+
+// Pattern matching. The match_* helpers evaluate v to WHNF and return 1 on a match.
+int           lsrt_match_constr(lsrt_value_t* v, const char* name, int argc);
+int           lsrt_match_int(lsrt_value_t* v, long long k);
+int           lsrt_match_str(lsrt_value_t* v, const char* bytes, unsigned long n);
+lsrt_value_t* lsrt_constr_arg(lsrt_value_t* v, int i);
+// Result of a match without a matching case (a bottom value)
+lsrt_value_t* lsrt_match_fail(lsrt_value_t* v);
+
 // Debug/IO helpers (minimal)
 // Print value similarly to println (adds newline). Returns unit.
 lsrt_value_t* lsrt_println(lsrt_value_t* v);
+// Print the final value of a program like the lazyscript driver does. Returns the process exit
+// status (non-zero when v is an error).
+int lsrt_print_result(lsrt_value_t* v);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,973 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "coreir/cir_internal.h"
+#include "coreir/coreir.h"
+#include "common/io.h"
+#include "common/malloc.h"
+
+/*
+ * Core IR → portable C.
+ *
+ * The generated translation unit declares the lsrt_* C ABI (coreir/cir_callconv.h) itself, so
+ * it compiles with any C99 compiler and links against liblazyscript_rt.
+ *
+ * Lambdas are lambda-lifted: a chain `\a -> \b -> e` becomes one static function taking its
+ * captured variables and then its parameters as C parameters. A let-bound chain is a known
+ * function; applying it to at least as many arguments as it has parameters calls the C function
+ * directly, and a closure (lsrt_make_closure_n over an `_entry` wrapper) is only built when the
+ * binding is used as a value. Let-bound integer literals and the results of add/sub/lt on
+ * unboxed operands stay unboxed `long long` (or C truth value) locals for arithmetic, `if`
+ * conditions and integer patterns, and are boxed once on first use as a value.
+ *
+ * Worker/wrapper split: when a lifted function's body is certain to use a parameter as an
+ * integer operand before performing any effect, the body is compiled to a worker ls_fn_<id>_w
+ * taking that parameter as a raw `long long` (and returning one when its result is always an
+ * unboxed integer). ls_fn_<id> becomes a wrapper that unboxes and enters the worker; known calls
+ * whose arguments are already unboxed enter the worker directly. Errors are imprecise: a
+ * non-integer argument fails at the call rather than at its first use.
+ *
+ * Like lscir_eval, unbound variables are symbols and namespace literals are unit, except that
+ * two-argument applications of unbound add/sub/lt are the integer builtins and saturated
+ * applications of unbound map/filter/foldr the strict list builtins (as in lscir_optimize);
+ * unlike it, multi-argument applications are curried.
+ */
+
+typedef enum {
+  CG_VAL, // boxed local v<id>
+  CG_INT,  // unboxed long long v<id>, boxed on demand into b<id>
+  CG_BOOL, // unboxed C truth value v<id> of a comparison, boxed on demand into b<id>
+  CG_FN,   // known lambda chain; closure materialized on demand into v<id>
+} cg_kind_t;
+
+typedef enum {
+  CG_PRIM_NONE,
+  CG_PRIM_ADD,
+  CG_PRIM_SUB,
+  CG_PRIM_LT,
+  CG_PRIM_MAP,
+  CG_PRIM_FILTER,
+  CG_PRIM_FOLDR,
+} cg_prim_t;
+
+typedef struct cg_bind cg_bind_t;
+
+typedef struct cg_fn {
+  int                id; // ls_fn_<id>
+  int                arity;
+  cg_bind_t**        caps; // captured bindings, in parameter order
+  int                ncaps;
+  int                cap_caps;
+  const char**       params;
+  const char*        sig;     // C parameter list
+  const char*        body;    // C function body (of the worker when there is one)
+  int                entry;   // a closure refers to ls_fn_<id>_entry
+  unsigned long long unbox;   // parameters the worker takes unboxed (bit i: parameter i)
+  int                ret_int; // the worker returns an unboxed integer
+  const char*        wsig;    // worker C parameter list; NULL without a worker
+  int                boxed;   // a known call enters the wrapper ls_fn_<id>
+} cg_fn_t;
+
+struct cg_bind {
+  int       id;
+  int       owner; // function that declares the local
+  int       slot;  // CG_INT/CG_FN: the on-demand local is declared
+  cg_kind_t kind;
+  long long ival; // CG_INT
+  cg_fn_t*  fn;   // CG_FN
+};
+
+typedef struct cg_entry {
+  const char* name;
+  cg_bind_t*  bind;
+} cg_entry_t;
+
+typedef struct cg_mod {
+  cg_fn_t** fns; // lifted functions, innermost first
+  int       nfns;
+  int       cap_fns;
+  int       nids;    // binding and function ids
+  int       nframes; // C functions, for binding ownership
+} cg_mod_t;
+
+typedef struct cg_func {
+  cg_mod_t*       mod;
+  struct cg_func* parent;
+  cg_fn_t*        fn; // NULL for the program root
+  int             id; // frame number
+  FILE*           fp;
+  char*           buf;
+  size_t          len;
+  FILE*           decls; // locals created on demand, declared at the top of the function
+  char*           dbuf;
+  size_t          dlen;
+  int             ntmp;
+  int             indent;
+  cg_entry_t*     scope;
+  int             nscope;
+  int             cap_scope;
+} cg_func_t;
+
+#define CG_GROW(arr, n, cap, type)                                                                 \
+  do {                                                                                             \
+    if ((n) >= (cap)) {                                                                            \
+      (cap) = (cap) ? (cap) * 2 : 8;                                                               \
+      (arr) = lsrealloc((arr), sizeof(type) * (cap));                                              \
+    }                                                                                              \
+  } while (0)
+
+static const char* cg_fmt(const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  char* s = lsmalloc_atomic((size_t)n + 1);
+  va_start(ap, fmt);
+  vsnprintf(s, (size_t)n + 1, fmt, ap);
+  va_end(ap);
+  return s;
+}
+
+static void cg_line(cg_func_t* f, const char* fmt, ...) {
+  fprintf(f->fp, "%*s", 2 * f->indent, "");
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(f->fp, fmt, ap);
+  va_end(ap);
+  fputc('\n', f->fp);
+}
+
+// C string literal for n bytes; octal escapes are always three digits so they never absorb a
+// following digit
+static const char* cg_cstr(const char* bytes, size_t n) {
+  char*  buf = NULL;
+  size_t len = 0;
+  FILE*  fp  = lsopen_memstream_gc(&buf, &len);
+  fputc('"', fp);
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = (unsigned char)bytes[i];
+    if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\' || c == '?')
+      fprintf(fp, "\\%03o", c);
+    else
+      fputc(c, fp);
+  }
+  fputc('"', fp);
+  fclose(fp);
+  return buf;
+}
+
+static const char* cg_tmp(cg_func_t* f) { return cg_fmt("t%d", f->ntmp++); }
+
+static cg_bind_t* cg_bind_new(cg_func_t* f, cg_kind_t kind) {
+  cg_bind_t* b = lsmalloc(sizeof(cg_bind_t));
+  *b           = (cg_bind_t){ .id = f->mod->nids++, .owner = f->id, .kind = kind };
+  return b;
+}
+
+static void cg_scope_push(cg_func_t* f, const char* name, cg_bind_t* b) {
+  CG_GROW(f->scope, f->nscope, f->cap_scope, cg_entry_t);
+  f->scope[f->nscope].name = name;
+  f->scope[f->nscope].bind = b;
+  f->nscope++;
+}
+
+// Lexical lookup through the enclosing functions; NULL when unbound (a symbol)
+static cg_bind_t* cg_lookup(const cg_func_t* f, const char* name) {
+  for (; f; f = f->parent)
+    for (int i = f->nscope - 1; i >= 0; i--)
+      if (strcmp(f->scope[i].name, name) == 0)
+        return f->scope[i].bind;
+  return NULL;
+}
+
+static const char* cg_access(cg_func_t* f, cg_bind_t* b);
+
+// Capture b into f (a lifted function) and return the name of its capture parameter
+static const char* cg_capture(cg_func_t* f, cg_bind_t* b) {
+  cg_fn_t* fn = f->fn;
+  for (int i = 0; i < fn->ncaps; i++)
+    if (fn->caps[i] == b)
+      return cg_fmt("c%d", i);
+  CG_GROW(fn->caps, fn->ncaps, fn->cap_caps, cg_bind_t*);
+  fn->caps[fn->ncaps] = b;
+  return cg_fmt("c%d", fn->ncaps++);
+}
+
+// Comma-separated capture arguments of known function fn, as seen from f
+static const char* cg_cap_args(cg_func_t* f, const cg_fn_t* fn) {
+  const char* s = "";
+  for (int i = 0; i < fn->ncaps; i++)
+    s = cg_fmt("%s%s%s", s, i ? ", " : "", cg_access(f, fn->caps[i]));
+  return s;
+}
+
+static const char* cg_closure(cg_func_t* f, cg_fn_t* fn) {
+  const char* env = "0";
+  fn->entry       = 1;
+  if (fn->ncaps > 0) {
+    env = cg_tmp(f);
+    cg_line(f, "lsrt_value_t* %s[%d] = { %s };", env, fn->ncaps, cg_cap_args(f, fn));
+  }
+  return cg_fmt("lsrt_make_closure_n(ls_fn_%d_entry, %d, %d, %s)", fn->id, fn->arity, fn->ncaps,
+                env);
+}
+
+// C expression of the boxed value of b in f
+static const char* cg_access(cg_func_t* f, cg_bind_t* b) {
+  if (b->owner != f->id)
+    return cg_capture(f, b);
+  if (b->kind != CG_VAL && !b->slot) {
+    b->slot = 1;
+    fprintf(f->decls, "  lsrt_value_t* %s%d = 0;\n", b->kind == CG_FN ? "v" : "b", b->id);
+  }
+  switch (b->kind) {
+  case CG_INT:
+    cg_line(f, "if (!b%d)", b->id);
+    cg_line(f, "  b%d = lsrt_make_int(v%d);", b->id, b->id);
+    return cg_fmt("b%d", b->id);
+  case CG_BOOL:
+    cg_line(f, "if (!b%d)", b->id);
+    cg_line(f, "  b%d = lsrt_make_constr(v%d ? \"true\" : \"false\", 0, 0);", b->id, b->id);
+    return cg_fmt("b%d", b->id);
+  case CG_FN:
+    cg_line(f, "if (!v%d) {", b->id);
+    f->indent++;
+    cg_line(f, "v%d = %s;", b->id, cg_closure(f, b->fn));
+    f->indent--;
+    cg_line(f, "}");
+    return cg_fmt("v%d", b->id);
+  case CG_VAL:
+  default:
+    return cg_fmt("v%d", b->id);
+  }
+}
+
+static const char* cg_expr(cg_func_t* f, const lscir_expr_t* e);
+static cg_fn_t*    cg_func(cg_mod_t* m, cg_func_t* parent, const lscir_value_t* lam);
+
+static const char* cg_value(cg_func_t* f, const lscir_value_t* v) {
+  switch (v->kind) {
+  case LCIR_VAL_INT:
+    return cg_fmt("lsrt_make_int(%lldLL)", v->ival);
+  case LCIR_VAL_STR:
+    return cg_fmt("lsrt_make_str_n(%s, %zuUL)", cg_cstr(v->sval, strlen(v->sval)),
+                  strlen(v->sval));
+  case LCIR_VAL_VAR: {
+    cg_bind_t* b = cg_lookup(f, v->var);
+    if (b)
+      return cg_access(f, b);
+    // No implicit mapping to native functions. Treat as plain symbol.
+    return cg_fmt("lsrt_make_symbol(%s)", cg_cstr(v->var, strlen(v->var)));
+  }
+  case LCIR_VAL_CONSTR: {
+    int n = v->constr.argc;
+    if (n == 0 && strcmp(v->constr.name, "()") == 0)
+      return "lsrt_unit()";
+    const char* name = cg_cstr(v->constr.name, strlen(v->constr.name));
+    if (n == 0)
+      return cg_fmt("lsrt_make_constr(%s, 0, 0)", name);
+    const char* args = "";
+    for (int i = 0; i < n; i++)
+      args = cg_fmt("%s%s%s", args, i ? ", " : "", cg_value(f, v->constr.args[i]));
+    const char* a = cg_tmp(f);
+    cg_line(f, "lsrt_value_t* %s[%d] = { %s };", a, n, args);
+    return cg_fmt("lsrt_make_constr(%s, %d, %s)", name, n, a);
+  }
+  case LCIR_VAL_LAM:
+    return cg_closure(f, cg_func(f->mod, f, v));
+  case LCIR_VAL_NSLIT:
+    // Namespace literals are not compiled; like lscir_eval the result is unit
+    return "lsrt_unit()";
+  }
+  return "lsrt_unit()";
+}
+
+// Builtin applied by func to argc arguments: as in lscir_optimize, two-argument applications of
+// unbound add, sub, lt, map and filter, and three-argument applications of unbound foldr
+static cg_prim_t cg_prim(const cg_func_t* f, const lscir_value_t* func, int argc) {
+  static const struct {
+    const char* name;
+    int         argc;
+  } prims[] = {
+    [CG_PRIM_ADD] = { "add", 2 },       [CG_PRIM_SUB] = { "sub", 2 },
+    [CG_PRIM_LT] = { "lt", 2 },         [CG_PRIM_MAP] = { "map", 2 },
+    [CG_PRIM_FILTER] = { "filter", 2 }, [CG_PRIM_FOLDR] = { "foldr", 3 },
+  };
+  if (func->kind != LCIR_VAL_VAR || cg_lookup(f, func->var))
+    return CG_PRIM_NONE;
+  for (int i = CG_PRIM_ADD; i <= CG_PRIM_FOLDR; i++)
+    if (prims[i].argc == argc && strcmp(func->var, prims[i].name) == 0)
+      return (cg_prim_t)i;
+  return CG_PRIM_NONE;
+}
+
+// add, sub and lt work on integers; map, filter and foldr are the strict list builtins
+static int cg_int_prim(cg_prim_t prim) { return prim >= CG_PRIM_ADD && prim <= CG_PRIM_LT; }
+
+// C expression of v as an unboxed integer in f, or NULL when it is not one; generates no code
+static const char* cg_int_operand(const cg_func_t* f, const lscir_value_t* v) {
+  if (v->kind == LCIR_VAL_INT)
+    return cg_fmt("%lldLL", v->ival);
+  if (v->kind == LCIR_VAL_VAR) {
+    const cg_bind_t* b = cg_lookup(f, v->var);
+    if (b && b->kind == CG_INT && b->owner == f->id)
+      return cg_fmt("v%d", b->id);
+  }
+  return NULL;
+}
+
+static int cg_unboxed(const cg_fn_t* fn, int i) { return i < 64 && (fn->unbox >> i & 1); }
+
+// 1 when a known saturated call of fn can enter its worker: every parameter the worker takes
+// unboxed has an unboxed argument in f
+static int cg_worker_call(const cg_func_t* f, const cg_fn_t* fn,
+                          const lscir_value_t* const* args) {
+  if (!fn->wsig)
+    return 0;
+  for (int i = 0; i < fn->arity; i++)
+    if (cg_unboxed(fn, i) && !cg_int_operand(f, args[i]))
+      return 0;
+  return 1;
+}
+
+// Arguments of a known saturated call of fn: its captures, then the parameters (unboxed where
+// the worker takes them so when worker is set)
+static const char* cg_call_args(cg_func_t* f, const cg_fn_t* fn,
+                                const lscir_value_t* const* args, int worker) {
+  const char* s = cg_cap_args(f, fn);
+  for (int i = 0; i < fn->arity; i++) {
+    const char* a = worker && cg_unboxed(fn, i) ? cg_int_operand(f, args[i]) : cg_value(f, args[i]);
+    s             = cg_fmt("%s%s%s", s, (i || fn->ncaps) ? ", " : "", a);
+  }
+  return s;
+}
+
+// 1 when the application e yields an unboxed integer in f: add/sub of unboxed operands, or a
+// saturated worker call returning one; generates no code
+static int cg_int_app_ok(const cg_func_t* f, const lscir_expr_t* e) {
+  const lscir_value_t* const* as = e->app.args;
+  switch (cg_prim(f, e->app.func, e->app.argc)) {
+  case CG_PRIM_ADD:
+  case CG_PRIM_SUB:
+    return cg_int_operand(f, as[0]) && cg_int_operand(f, as[1]);
+  case CG_PRIM_LT:
+  case CG_PRIM_MAP:
+  case CG_PRIM_FILTER:
+  case CG_PRIM_FOLDR:
+    return 0;
+  case CG_PRIM_NONE:
+    break;
+  }
+  const cg_bind_t* b = e->app.func->kind == LCIR_VAL_VAR ? cg_lookup(f, e->app.func->var) : NULL;
+  return b && b->kind == CG_FN && b->fn->ret_int && e->app.argc == b->fn->arity &&
+         cg_worker_call(f, b->fn, as);
+}
+
+// C expression of the application e as an unboxed integer; cg_int_app_ok(f, e) holds. Results
+// wrap around like the builtins' C ints.
+static const char* cg_int_app(cg_func_t* f, const lscir_expr_t* e) {
+  const lscir_value_t* const* as = e->app.args;
+  switch (cg_prim(f, e->app.func, e->app.argc)) {
+  case CG_PRIM_ADD:
+    return cg_fmt("(int)(%s + %s)", cg_int_operand(f, as[0]), cg_int_operand(f, as[1]));
+  case CG_PRIM_SUB:
+    return cg_fmt("(int)(%s - %s)", cg_int_operand(f, as[0]), cg_int_operand(f, as[1]));
+  default:
+    break;
+  }
+  const cg_fn_t* fn = cg_lookup(f, e->app.func->var)->fn;
+  return cg_fmt("ls_fn_%d_w(%s)", fn->id, cg_call_args(f, fn, as, 1));
+}
+
+// C truth value of the application e when it is lt on unboxed operands in f, or NULL;
+// generates no code
+static const char* cg_bool_app(const cg_func_t* f, const lscir_expr_t* e) {
+  if (cg_prim(f, e->app.func, e->app.argc) != CG_PRIM_LT)
+    return NULL;
+  const char* a = cg_int_operand(f, e->app.args[0]);
+  const char* b = cg_int_operand(f, e->app.args[1]);
+  return a && b ? cg_fmt("%s < %s", a, b) : NULL;
+}
+
+static const char* cg_apply_rest(cg_func_t* f, const char* fn, int argc,
+                                 const lscir_value_t* const* args) {
+  if (argc == 0)
+    return fn;
+  const char* as = "";
+  for (int i = 0; i < argc; i++)
+    as = cg_fmt("%s%s%s", as, i ? ", " : "", cg_value(f, args[i]));
+  const char* a = cg_tmp(f);
+  cg_line(f, "lsrt_value_t* %s[%d] = { %s };", a, argc, as);
+  return cg_fmt("lsrt_apply(%s, %d, %s)", fn, argc, a);
+}
+
+static const char* cg_apply(cg_func_t* f, const lscir_value_t* func, int argc,
+                            const lscir_value_t* const* args) {
+  cg_prim_t prim = cg_prim(f, func, argc);
+  if (cg_int_prim(prim)) {
+    const char* a = cg_int_operand(f, args[0]);
+    const char* b = cg_int_operand(f, args[1]);
+    if (a && b && prim == CG_PRIM_LT)
+      return cg_fmt("lsrt_make_constr(%s < %s ? \"true\" : \"false\", 0, 0)", a, b);
+    if (a && b)
+      return cg_fmt("lsrt_make_int(%s %s %s)", a, prim == CG_PRIM_ADD ? "+" : "-", b);
+  }
+  if (prim != CG_PRIM_NONE) {
+    static const char* const rt[] = { NULL,       "lsrt_add",    "lsrt_sub",  "lsrt_lt",
+                                      "lsrt_map", "lsrt_filter", "lsrt_foldr" };
+    const char*              as   = "";
+    for (int i = 0; i < argc; i++)
+      as = cg_fmt("%s%s%s", as, i ? ", " : "", cg_value(f, args[i]));
+    return cg_fmt("%s(%s)", rt[prim], as);
+  }
+  cg_bind_t* b = func->kind == LCIR_VAL_VAR ? cg_lookup(f, func->var) : NULL;
+  if (b && b->kind == CG_FN && argc >= b->fn->arity) {
+    // Known saturated call: enter the lifted function (or its worker) directly
+    cg_fn_t*    fn     = b->fn;
+    int         worker = cg_worker_call(f, fn, args);
+    const char* as     = cg_call_args(f, fn, args, worker);
+    const char* r      = cg_tmp(f);
+    if (worker && fn->ret_int)
+      cg_line(f, "lsrt_value_t* %s = lsrt_make_int(ls_fn_%d_w(%s));", r, fn->id, as);
+    else
+      cg_line(f, "lsrt_value_t* %s = ls_fn_%d%s(%s);", r, fn->id, worker ? "_w" : "", as);
+    fn->boxed |= !worker;
+    return cg_apply_rest(f, r, argc - fn->arity, args + fn->arity);
+  }
+  const char* fv = cg_value(f, func);
+  const char* r  = cg_tmp(f);
+  cg_line(f, "lsrt_value_t* %s = %s;", r, fv);
+  return cg_apply_rest(f, r, argc, args);
+}
+
+// C condition for an `if` on v, unboxed when v is a known integer
+static const char* cg_cond(cg_func_t* f, const lscir_value_t* v) {
+  if (v->kind == LCIR_VAL_INT)
+    return v->ival != 0 ? "1" : "0";
+  if (v->kind == LCIR_VAL_VAR) {
+    cg_bind_t* b = cg_lookup(f, v->var);
+    if (b && b->kind == CG_INT && b->owner == f->id)
+      return cg_fmt("v%d != 0", b->id);
+    if (b && b->kind == CG_BOOL && b->owner == f->id)
+      return cg_fmt("v%d", b->id);
+  }
+  return cg_fmt("lsrt_truthy(%s)", cg_value(f, v));
+}
+
+// Open one `if` block per test of pat against the value s (scrutinee binding sb, or NULL);
+// returns the number of blocks opened. Pattern variables are bound in f's scope.
+static int cg_pat(cg_func_t* f, const lscir_pat_t* pat, const char* s, cg_bind_t* sb) {
+  if (!pat)
+    return 0;
+  int unboxed = sb && sb->kind == CG_INT && sb->owner == f->id;
+  switch (pat->kind) {
+  case LCIR_PAT_WILDCARD:
+    return 0;
+  case LCIR_PAT_VAR:
+    if (sb) {
+      cg_scope_push(f, pat->var, sb);
+    } else {
+      cg_bind_t* b = cg_bind_new(f, CG_VAL);
+      cg_line(f, "lsrt_value_t* v%d = %s;", b->id, s);
+      cg_scope_push(f, pat->var, b);
+    }
+    return 0;
+  case LCIR_PAT_INT:
+    if (unboxed)
+      cg_line(f, "if (v%d == %lldLL) {", sb->id, pat->ival);
+    else
+      cg_line(f, "if (lsrt_match_int(%s, %lldLL)) {", s, pat->ival);
+    f->indent++;
+    return 1;
+  case LCIR_PAT_STR:
+    cg_line(f, "if (%slsrt_match_str(%s, %s, %zuUL)) {", unboxed ? "0 && " : "", s,
+            cg_cstr(pat->sval, strlen(pat->sval)), strlen(pat->sval));
+    f->indent++;
+    return 1;
+  case LCIR_PAT_CONSTR: {
+    cg_line(f, "if (%slsrt_match_constr(%s, %s, %d)) {", unboxed ? "0 && " : "", s,
+            cg_cstr(pat->constr.name, strlen(pat->constr.name)), pat->constr.subc);
+    f->indent++;
+    int open = 1;
+    for (int i = 0; i < pat->constr.subc; i++) {
+      const char* a = cg_tmp(f);
+      cg_line(f, "lsrt_value_t* %s = lsrt_constr_arg(%s, %d);", a, s, i);
+      open += cg_pat(f, pat->constr.subpats[i], a, NULL);
+    }
+    return open;
+  }
+  }
+  return 0;
+}
+
+static const char* cg_expr_int(cg_func_t* f, const lscir_expr_t* e);
+static int         cg_ret_int(cg_func_t* f, const lscir_expr_t* e);
+
+// Generate the bound expression of a let and return its binding: aliases share the binding,
+// integer literals, integer results of unboxed operands and comparisons of them stay unboxed,
+// lambda chains become known functions. A let-bound let is generated as if floated out, so
+// the binding is that of its body.
+static cg_bind_t* cg_let(cg_func_t* f, const lscir_expr_t* bind) {
+  cg_bind_t*  b = NULL;
+  const char* c = NULL;
+  if (bind && bind->kind == LCIR_EXP_LET) {
+    cg_scope_push(f, bind->let1.var, cg_let(f, bind->let1.bind));
+    b = cg_let(f, bind->let1.body);
+    f->nscope--;
+  } else if (bind && bind->kind == LCIR_EXP_VAL && bind->v->kind == LCIR_VAL_VAR &&
+      (b = cg_lookup(f, bind->v->var)) != NULL) {
+    // Alias of another binding
+  } else if (bind && bind->kind == LCIR_EXP_VAL && bind->v->kind == LCIR_VAL_INT) {
+    b       = cg_bind_new(f, CG_INT);
+    b->ival = bind->v->ival;
+    cg_line(f, "const long long v%d = %lldLL;", b->id, b->ival);
+  } else if (bind && bind->kind == LCIR_EXP_VAL && bind->v->kind == LCIR_VAL_LAM) {
+    b     = cg_bind_new(f, CG_FN);
+    b->fn = cg_func(f->mod, f, bind->v);
+  } else if (cg_ret_int(f, bind)) {
+    const char* r = cg_expr_int(f, bind);
+    b             = cg_bind_new(f, CG_INT);
+    cg_line(f, "const long long v%d = %s;", b->id, r);
+  } else if (bind && bind->kind == LCIR_EXP_APP && (c = cg_bool_app(f, bind)) != NULL) {
+    b = cg_bind_new(f, CG_BOOL);
+    cg_line(f, "const int v%d = %s;", b->id, c);
+  } else {
+    const char* r = cg_expr(f, bind);
+    b             = cg_bind_new(f, CG_VAL);
+    cg_line(f, "lsrt_value_t* v%d = %s;", b->id, r);
+  }
+  return b;
+}
+
+// `if` as a statement assigning either branch to a fresh local (unboxed when is_int)
+static const char* cg_if(cg_func_t* f, const lscir_expr_t* e, int is_int) {
+  const char* r    = cg_tmp(f);
+  const char* cond = cg_cond(f, e->ife.cond);
+  cg_line(f, "%s %s;", is_int ? "long long" : "lsrt_value_t*", r);
+  cg_line(f, "if (%s) {", cond);
+  f->indent++;
+  const char* t = is_int ? cg_expr_int(f, e->ife.then_e) : cg_expr(f, e->ife.then_e);
+  cg_line(f, "%s = %s;", r, t);
+  f->indent--;
+  cg_line(f, "} else {");
+  f->indent++;
+  const char* el = is_int ? cg_expr_int(f, e->ife.else_e) : cg_expr(f, e->ife.else_e);
+  cg_line(f, "%s = %s;", r, el);
+  f->indent--;
+  cg_line(f, "}");
+  return r;
+}
+
+static const char* cg_expr(cg_func_t* f, const lscir_expr_t* e) {
+  if (!e)
+    return "lsrt_unit()";
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return cg_value(f, e->v);
+  case LCIR_EXP_LET: {
+    cg_scope_push(f, e->let1.var, cg_let(f, e->let1.bind));
+    const char* body = cg_expr(f, e->let1.body);
+    f->nscope--;
+    return body;
+  }
+  case LCIR_EXP_APP:
+    return cg_apply(f, e->app.func, e->app.argc, e->app.args);
+  case LCIR_EXP_EFFAPP:
+    // The token only orders effects; the call itself is an ordinary application
+    return cg_apply(f, e->effapp.func, e->effapp.argc, e->effapp.args);
+  case LCIR_EXP_TOKEN:
+    return "lsrt_unit()";
+  case LCIR_EXP_IF:
+    return cg_if(f, e, 0);
+  case LCIR_EXP_MATCH: {
+    const lscir_value_t* sv = e->match1.scrut;
+    cg_bind_t*           sb = sv->kind == LCIR_VAL_VAR ? cg_lookup(f, sv->var) : NULL;
+    const char*          s  = cg_tmp(f);
+    const char*          r  = cg_tmp(f);
+    if (sb && sb->kind == CG_INT && sb->owner == f->id)
+      cg_line(f, "lsrt_value_t* %s = 0;", s); // boxed only if a case needs the value
+    else
+      cg_line(f, "lsrt_value_t* %s = %s;", s, cg_value(f, sv));
+    if (!(sb && sb->kind == CG_INT && sb->owner == f->id))
+      sb = NULL;
+    cg_line(f, "lsrt_value_t* %s;", r);
+    cg_line(f, "do {");
+    f->indent++;
+    for (int i = 0; i < e->match1.casec; i++) {
+      const lscir_case_t* cs   = &e->match1.cases[i];
+      int                 save = f->nscope;
+      cg_line(f, "{");
+      f->indent++;
+      int         open = cg_pat(f, cs->pat, s, sb);
+      const char* body = cg_expr(f, cs->body);
+      cg_line(f, "%s = %s;", r, body);
+      cg_line(f, "break;");
+      for (int k = 0; k < open; k++) {
+        f->indent--;
+        cg_line(f, "}");
+      }
+      f->indent--;
+      cg_line(f, "}");
+      f->nscope = save;
+    }
+    if (sb)
+      cg_line(f, "%s = lsrt_match_fail(%s);", r, cg_access(f, sb));
+    else
+      cg_line(f, "%s = lsrt_match_fail(%s);", r, s);
+    f->indent--;
+    cg_line(f, "} while (0);");
+    return r;
+  }
+  }
+  return "lsrt_unit()";
+}
+
+// C expression of e as an unboxed integer; cg_ret_int(f, e) holds
+static const char* cg_expr_int(cg_func_t* f, const lscir_expr_t* e) {
+  switch (e->kind) {
+  case LCIR_EXP_LET: {
+    cg_scope_push(f, e->let1.var, cg_let(f, e->let1.bind));
+    const char* body = cg_expr_int(f, e->let1.body);
+    f->nscope--;
+    return body;
+  }
+  case LCIR_EXP_APP:
+    return cg_int_app(f, e);
+  case LCIR_EXP_IF:
+    return cg_if(f, e, 1);
+  default:
+    return cg_int_operand(f, e->v);
+  }
+}
+
+/*
+ * Worker/wrapper analysis. Both walks run over a body before it is generated and push the
+ * variables its lets and patterns bind onto f's scope, so lookups see the same shadowing as
+ * code generation; a binding the analysis does not model is cg_opaque.
+ */
+
+static cg_bind_t cg_opaque = { .kind = CG_VAL, .owner = -1 };
+
+static cg_bind_t* cg_let_shape(cg_func_t* f, const lscir_expr_t* bind, cg_bind_t* tmp);
+
+static int cg_effectful(const lscir_expr_t* e) {
+  if (!e)
+    return 0;
+  switch (e->kind) {
+  case LCIR_EXP_EFFAPP:
+  case LCIR_EXP_TOKEN:
+    return 1;
+  case LCIR_EXP_LET:
+    return cg_effectful(e->let1.bind) || cg_effectful(e->let1.body);
+  case LCIR_EXP_IF:
+    return cg_effectful(e->ife.then_e) || cg_effectful(e->ife.else_e);
+  case LCIR_EXP_MATCH:
+    for (int i = 0; i < e->match1.casec; i++)
+      if (cg_effectful(e->match1.cases[i].body))
+        return 1;
+    return 0;
+  default:
+    return 0;
+  }
+}
+
+static void cg_pat_hide(cg_func_t* f, const lscir_pat_t* pat) {
+  if (pat && pat->kind == LCIR_PAT_VAR)
+    cg_scope_push(f, pat->var, &cg_opaque);
+  else if (pat && pat->kind == LCIR_PAT_CONSTR)
+    for (int i = 0; i < pat->constr.subc; i++)
+      cg_pat_hide(f, pat->constr.subpats[i]);
+}
+
+static int cg_is_param(const cg_func_t* f, const lscir_value_t* v, const cg_bind_t* p) {
+  return v->kind == LCIR_VAL_VAR && cg_lookup(f, v->var) == p;
+}
+
+// 1 when evaluating e is certain to use parameter p as an integer operand (of add/sub/lt or of a
+// parameter a known worker takes unboxed) before performing any effect. A match without a
+// matching case is a bottom value, so only the cases count.
+static int cg_strict(cg_func_t* f, const lscir_expr_t* e, const cg_bind_t* p) {
+  if (!e)
+    return 0;
+  switch (e->kind) {
+  case LCIR_EXP_LET: {
+    if (cg_strict(f, e->let1.bind, p))
+      return 1;
+    if (cg_effectful(e->let1.bind))
+      return 0;
+    // Aliases (let x = y, as beta reduction leaves them) keep referring to p
+    cg_bind_t tmp;
+    cg_scope_push(f, e->let1.var, cg_let_shape(f, e->let1.bind, &tmp));
+    int r = cg_strict(f, e->let1.body, p);
+    f->nscope--;
+    return r;
+  }
+  case LCIR_EXP_APP: {
+    const lscir_value_t* const* as = e->app.args;
+    if (cg_int_prim(cg_prim(f, e->app.func, e->app.argc)))
+      return cg_is_param(f, as[0], p) || cg_is_param(f, as[1], p);
+    const cg_bind_t* b = e->app.func->kind == LCIR_VAL_VAR ? cg_lookup(f, e->app.func->var) : NULL;
+    if (!b || b->kind != CG_FN || e->app.argc < b->fn->arity)
+      return 0;
+    for (int i = 0; i < b->fn->arity; i++)
+      if (cg_unboxed(b->fn, i) && cg_is_param(f, as[i], p))
+        return 1;
+    return 0;
+  }
+  case LCIR_EXP_IF:
+    return cg_strict(f, e->ife.then_e, p) && cg_strict(f, e->ife.else_e, p);
+  case LCIR_EXP_MATCH: {
+    if (e->match1.casec == 0)
+      return 0;
+    for (int i = 0; i < e->match1.casec; i++) {
+      int save = f->nscope;
+      cg_pat_hide(f, e->match1.cases[i].pat);
+      int r     = cg_strict(f, e->match1.cases[i].body, p);
+      f->nscope = save;
+      if (!r)
+        return 0;
+    }
+    return 1;
+  }
+  default:
+    return 0;
+  }
+}
+
+// The binding cg_let would create for bind, without generating code: the aliased binding, tmp
+// as an unboxed stand-in, or cg_opaque (also for lambda chains, whose summaries are not known
+// yet). Let-bound lets are looked through as in cg_let.
+static cg_bind_t* cg_let_shape(cg_func_t* f, const lscir_expr_t* bind, cg_bind_t* tmp) {
+  cg_bind_t* b = NULL;
+  *tmp         = (cg_bind_t){ .owner = f->id };
+  if (bind && bind->kind == LCIR_EXP_LET) {
+    cg_bind_t* inner = lsmalloc(sizeof(cg_bind_t));
+    cg_scope_push(f, bind->let1.var, cg_let_shape(f, bind->let1.bind, inner));
+    b = cg_let_shape(f, bind->let1.body, tmp);
+    f->nscope--;
+    return b;
+  }
+  if (bind && bind->kind == LCIR_EXP_VAL && bind->v->kind == LCIR_VAL_VAR &&
+      (b = cg_lookup(f, bind->v->var)) != NULL)
+    return b;
+  if (cg_ret_int(f, bind)) {
+    tmp->kind = CG_INT;
+    return tmp;
+  }
+  if (bind && bind->kind == LCIR_EXP_APP && cg_bool_app(f, bind)) {
+    tmp->kind = CG_BOOL;
+    return tmp;
+  }
+  return &cg_opaque;
+}
+
+// 1 when e always yields an unboxed integer in f
+static int cg_ret_int(cg_func_t* f, const lscir_expr_t* e) {
+  if (!e)
+    return 0;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return cg_int_operand(f, e->v) != NULL;
+  case LCIR_EXP_LET: {
+    cg_bind_t tmp;
+    cg_scope_push(f, e->let1.var, cg_let_shape(f, e->let1.bind, &tmp));
+    int r = cg_ret_int(f, e->let1.body);
+    f->nscope--;
+    return r;
+  }
+  case LCIR_EXP_APP:
+    return cg_int_app_ok(f, e);
+  case LCIR_EXP_IF:
+    return cg_ret_int(f, e->ife.then_e) && cg_ret_int(f, e->ife.else_e);
+  default:
+    return 0;
+  }
+}
+
+// Finish a function: its on-demand declarations followed by its statements and return (of an
+// unboxed integer when ret_int is set)
+static const char* cg_func_body(cg_func_t* f, const lscir_expr_t* body, int ret_int) {
+  cg_line(f, "return %s;", ret_int ? cg_expr_int(f, body) : cg_expr(f, body));
+  fclose(f->fp);
+  fclose(f->decls);
+  return cg_fmt("%.*s%.*s", (int)f->dlen, f->dbuf ? f->dbuf : "", (int)f->len, f->buf);
+}
+
+// Lift the lambda chain starting at lam into a function ls_fn_<id> plus its closure entry
+static cg_fn_t* cg_func(cg_mod_t* m, cg_func_t* parent, const lscir_value_t* lam) {
+  cg_fn_t* fn = lsmalloc(sizeof(cg_fn_t));
+  int      id = m->nids++;
+  *fn         = (cg_fn_t){ .id = id };
+  int      n  = 0;
+  for (const lscir_value_t* l = lam; l && l->kind == LCIR_VAL_LAM;
+       l = (l->lam.body && l->lam.body->kind == LCIR_EXP_VAL) ? l->lam.body->v : NULL)
+    n++;
+  fn->arity  = n;
+  fn->params = lsmalloc(sizeof(const char*) * n);
+
+  cg_func_t f = { .mod = m, .parent = parent, .fn = fn, .id = m->nframes++, .indent = 1 };
+  f.fp        = lsopen_memstream_gc(&f.buf, &f.len);
+  f.decls     = lsopen_memstream_gc(&f.dbuf, &f.dlen);
+  const lscir_expr_t* body = NULL;
+  cg_bind_t*          ps[n];
+  for (int i = 0; i < n; i++) {
+    cg_bind_t* b  = lsmalloc(sizeof(cg_bind_t));
+    *b            = (cg_bind_t){ .id = m->nids++, .owner = f.id, .kind = CG_VAL };
+    ps[i]         = b;
+    fn->params[i] = cg_fmt("v%d", b->id);
+    cg_scope_push(&f, lam->lam.param, b);
+    body = lam->lam.body;
+    if (i + 1 < n)
+      lam = body->v;
+  }
+  for (int i = 0; i < n && i < 64; i++) {
+    if (cg_strict(&f, body, ps[i])) {
+      fn->unbox |= 1ULL << i;
+      ps[i]->kind = CG_INT;
+    }
+  }
+  fn->ret_int = cg_ret_int(&f, body);
+  fn->body    = cg_func_body(&f, body, fn->ret_int);
+
+  const char* sig  = "";
+  const char* wsig = "";
+  for (int i = 0; i < fn->ncaps; i++)
+    sig = cg_fmt("%slsrt_value_t* c%d, ", sig, i);
+  wsig = sig;
+  for (int i = 0; i < n; i++) {
+    const char* sep   = i + 1 < n ? ", " : "";
+    const char* wtype = cg_unboxed(fn, i) ? "long long" : "lsrt_value_t*";
+    sig               = cg_fmt("%slsrt_value_t* %s%s", sig, fn->params[i], sep);
+    wsig              = cg_fmt("%s%s %s%s", wsig, wtype, fn->params[i], sep);
+  }
+  fn->sig  = sig;
+  fn->wsig = fn->unbox || fn->ret_int ? wsig : NULL;
+  CG_GROW(m->fns, m->nfns, m->cap_fns, cg_fn_t*);
+  m->fns[m->nfns++] = fn;
+  return fn;
+}
+
+static const char* cg_worker_ret(const cg_fn_t* fn) {
+  return fn->ret_int ? "long long" : "lsrt_value_t*";
+}
+
+// Without a worker, ls_fn_<id> is the function itself; with one, it is the wrapper and only
+// emitted when something calls it
+static int cg_has_wrapper(const cg_fn_t* fn) { return !fn->wsig || fn->boxed || fn->entry; }
+
+// The wrapper of a worker: unbox the parameters the worker takes unboxed, then enter it
+static void cg_wrapper(FILE* out, const cg_fn_t* fn) {
+  const char* call = "";
+  for (int i = 0; i < fn->ncaps; i++)
+    call = cg_fmt("%sc%d, ", call, i);
+  fprintf(out, "static lsrt_value_t* ls_fn_%d(%s) {\n", fn->id, fn->sig);
+  for (int i = 0; i < fn->arity; i++) {
+    const char* p = fn->params[i];
+    if (cg_unboxed(fn, i)) {
+      fprintf(out, "  long long u%d;\n", i);
+      fprintf(out, "  if (!lsrt_unbox_int(%s, &u%d))\n    return lsrt_unbox_fail(%s);\n", p, i, p);
+      call = cg_fmt("%su%d", call, i);
+    } else {
+      call = cg_fmt("%s%s", call, p);
+    }
+    if (i + 1 < fn->arity)
+      call = cg_fmt("%s, ", call);
+  }
+  if (fn->ret_int)
+    fprintf(out, "  return lsrt_make_int(ls_fn_%d_w(%s));\n}\n\n", fn->id, call);
+  else
+    fprintf(out, "  return ls_fn_%d_w(%s);\n}\n\n", fn->id, call);
+}
+
+static void cg_entry(FILE* out, const cg_fn_t* fn) {
+  const char* call = "";
+  for (int i = 0; i < fn->ncaps; i++)
+    call = cg_fmt("%senv[%d], ", call, i);
+  for (int i = 0; i < fn->arity; i++)
+    call = cg_fmt("%sargs[%d]%s", call, i, i + 1 < fn->arity ? ", " : "");
+  fprintf(out,
+          "static lsrt_value_t* ls_fn_%d_entry(lsrt_value_t* const* env, lsrt_value_t* const* "
+          "args) {\n",
+          fn->id);
+  if (fn->ncaps == 0)
+    fprintf(out, "  (void)env;\n");
+  fprintf(out, "  return ls_fn_%d(%s);\n}\n\n", fn->id, call);
+}
+
+static const char* const cg_decls =
+    "typedef struct lsthunk lsrt_value_t;\n"
+    "typedef lsrt_value_t* (*lsrt_fnn_t)(lsrt_value_t* const* env, lsrt_value_t* const* args);\n"
+    "void          lsrt_init(void);\n"
+    "lsrt_value_t* lsrt_make_int(long long v);\n"
+    "lsrt_value_t* lsrt_make_str_n(const char* bytes, unsigned long n);\n"
+    "lsrt_value_t* lsrt_make_symbol(const char* name);\n"
+    "lsrt_value_t* lsrt_make_constr(const char* name, int argc, lsrt_value_t* const* args);\n"
+    "lsrt_value_t* lsrt_make_closure_n(lsrt_fnn_t fn, int arity, int envc,\n"
+    "                                  lsrt_value_t* const* env);\n"
+    "lsrt_value_t* lsrt_unit(void);\n"
+    "lsrt_value_t* lsrt_apply(lsrt_value_t* func, int argc, lsrt_value_t* const* args);\n"
+    "lsrt_value_t* lsrt_add(lsrt_value_t* a, lsrt_value_t* b);\n"
+    "lsrt_value_t* lsrt_sub(lsrt_value_t* a, lsrt_value_t* b);\n"
+    "lsrt_value_t* lsrt_lt(lsrt_value_t* a, lsrt_value_t* b);\n"
+    "lsrt_value_t* lsrt_map(lsrt_value_t* f, lsrt_value_t* xs);\n"
+    "lsrt_value_t* lsrt_filter(lsrt_value_t* p, lsrt_value_t* xs);\n"
+    "lsrt_value_t* lsrt_foldr(lsrt_value_t* k, lsrt_value_t* z, lsrt_value_t* xs);\n"
+    "int           lsrt_unbox_int(lsrt_value_t* v, long long* out);\n"
+    "lsrt_value_t* lsrt_unbox_fail(lsrt_value_t* v);\n"
+    "int           lsrt_truthy(lsrt_value_t* v);\n"
+    "int           lsrt_match_constr(lsrt_value_t* v, const char* name, int argc);\n"
+    "int           lsrt_match_int(lsrt_value_t* v, long long k);\n"
+    "int           lsrt_match_str(lsrt_value_t* v, const char* bytes, unsigned long n);\n"
+    "lsrt_value_t* lsrt_constr_arg(lsrt_value_t* v, int i);\n"
+    "lsrt_value_t* lsrt_match_fail(lsrt_value_t* v);\n"
+    "int           lsrt_print_result(lsrt_value_t* v);\n";
+
+int lscir_emit_c(FILE* out, const lscir_prog_t* cir) {
+  if (!cir || !cir->root) {
+    fprintf(stderr, "E: emit-c: program could not be lowered to Core IR\n");
+    return 1;
+  }
+  cg_mod_t    m    = { 0 };
+  cg_func_t   root = { .mod = &m, .id = m.nframes++, .indent = 1 };
+  root.fp          = lsopen_memstream_gc(&root.buf, &root.len);
+  root.decls       = lsopen_memstream_gc(&root.dbuf, &root.dlen);
+  const char* body = cg_func_body(&root, cir->root, 0);
+
+  fprintf(out, "/* Generated by lazyscriptc --emit-c; link with liblazyscript_rt. */\n\n%s\n",
+          cg_decls);
+  for (int i = 0; i < m.nfns; i++) {
+    const cg_fn_t* fn = m.fns[i];
+    if (fn->wsig)
+      fprintf(out, "static %s ls_fn_%d_w(%s);\n", cg_worker_ret(fn), fn->id, fn->wsig);
+    if (cg_has_wrapper(fn))
+      fprintf(out, "static lsrt_value_t* ls_fn_%d(%s);\n", fn->id, fn->sig);
+    if (fn->entry)
+      fprintf(out,
+              "static lsrt_value_t* ls_fn_%d_entry(lsrt_value_t* const* env, "
+              "lsrt_value_t* const* args);\n",
+              fn->id);
+  }
+  if (m.nfns > 0)
+    fprintf(out, "\n");
+  for (int i = 0; i < m.nfns; i++) {
+    const cg_fn_t* fn = m.fns[i];
+    if (fn->wsig) {
+      fprintf(out, "static %s ls_fn_%d_w(%s) {\n%s}\n\n", cg_worker_ret(fn), fn->id, fn->wsig,
+              fn->body);
+      if (cg_has_wrapper(fn))
+        cg_wrapper(out, fn);
+    } else {
+      fprintf(out, "static lsrt_value_t* ls_fn_%d(%s) {\n%s}\n\n", fn->id, fn->sig, fn->body);
+    }
+    if (fn->entry)
+      cg_entry(out, fn);
+  }
+  fprintf(out, "static lsrt_value_t* ls_root(void) {\n%s", body);
+  fprintf(out, "}\n\n"
+               "int main(void) {\n"
+               "  lsrt_init();\n"
+               "  return lsrt_print_result(ls_root());\n"
+               "}\n");
+  return 0;
+}
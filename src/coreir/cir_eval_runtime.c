@@ -3,119 +3,191 @@
 #include <stdio.h>
 
 #include "coreir/cir_internal.h"
+#include "coreir/cir_value.h"
 #include "coreir/coreir.h"
 #include "common/malloc.h"
 
-// Runtime value kinds
-typedef enum {
-  RV_INT,
-  RV_STR,
-  RV_UNIT,
-  RV_TOKEN,
-  RV_LAM,
-  RV_SYMBOL,
-  RV_NATFUN,
-  RV_CONSTR,
-  RV_BOTTOM
-} rv_kind_t;
+typedef struct rx_expr rx_expr_t;
 
-typedef struct rv rv_t;
+// Core IR value with its variables resolved to frame slots (see resolve_expr)
+struct rx_value {
+  const lscir_value_t* src;
+  union {
+    struct { // LCIR_VAL_VAR: depth < 0 when the variable is not bound by the program
+      int depth;
+      int slot;
+    } var;
+    struct { // LCIR_VAL_LAM: slots of the frame the body runs in
+      int              nslots;
+      const rx_expr_t* body;
+    } lam;
+    const rx_value_t* const* args; // LCIR_VAL_CONSTR args, LCIR_VAL_NSLIT vals
+  };
+};
 
-typedef struct env_bind {
-  const char*      name;
-  const rv_t*      val;
-  struct env_bind* next;
-} env_bind_t;
+// Core IR expression with its variables resolved to frame slots
+struct rx_expr {
+  const lscir_expr_t*      src;
+  int                      slot;  // LCIR_EXP_LET: slot of the bound variable
+  const rx_value_t*        v;     // VAL value, APP/EFFAPP func, IF cond, MATCH scrut
+  const rx_value_t* const* args;  // APP/EFFAPP args
+  const rx_expr_t*         e1;    // LET bind, IF then
+  const rx_expr_t*         e2;    // LET body, IF else
+  const rx_expr_t* const*  cases; // MATCH case bodies
+};
+
+// One flat frame per lambda application (and one for the program root). The parameter and
+// every let bound in the lambda body outside nested lambdas own a slot of that frame.
+struct frame {
+  struct frame* up;
+  const rv_t*   slots[0];
+};
 
 typedef struct eval_ctx {
-  env_bind_t* env;
-  int         has_token;
+  frame_t* frame;
+  int      has_token;
 } eval_ctx_t;
 
-struct rv {
-  rv_kind_t kind;
-  union {
-    long long   ival;
-    const char* sval;
-    struct {
-      const char*         param;
-      const lscir_expr_t* body;
-      env_bind_t*         env;
-    } lam;
-    const char* sym;
-    struct {
-      const char*        name;
-      int                arity;
-      int                capc;
-      const rv_t* const* caps;
-    } nf;
-    struct {
-      const char*        name;
-      int                argc;
-      const rv_t* const* args;
-    } con;
-    struct { // internal bottom representation for runtime evaluator
-      const char*        message;
-      int                argc;
-      const rv_t* const* args;
-    } bot;
-  };
-};
+// --- Slot resolution -------------------------------------------------------
 
-static env_bind_t* env_push(env_bind_t* env, const char* name, const rv_t* v) {
-  env_bind_t* b = lsmalloc(sizeof(env_bind_t));
-  b->name       = name;
-  b->val        = v;
-  b->next       = env;
-  return b;
-}
-static const rv_t* env_lookup(env_bind_t* env, const char* name) {
-  for (env_bind_t* p = env; p; p = p->next)
-    if (strcmp(p->name, name) == 0)
-      return p->val;
-  return NULL;
-}
+typedef struct rs_scope {
+  const char* name;
+  int         level;
+  int         slot;
+} rs_scope_t;
 
-static const rv_t* rv_int(long long x) {
-  rv_t* v = lsmalloc(sizeof(rv_t));
-  v->kind = RV_INT;
-  v->ival = x;
-  return v;
-}
-static const rv_t* rv_str(const char* s) {
-  rv_t* v = lsmalloc(sizeof(rv_t));
-  v->kind = RV_STR;
-  v->sval = s;
-  return v;
+typedef struct resolver {
+  rs_scope_t* scope;
+  int         count;
+  int         cap;
+  int         level;  // frame nesting of the code being resolved
+  int         nslots; // slots allocated so far in the current frame
+} resolver_t;
+
+static void rs_push(resolver_t* rs, const char* name, int slot) {
+  if (rs->count == rs->cap) {
+    rs->cap   = rs->cap ? rs->cap * 2 : 16;
+    rs->scope = lsrealloc(rs->scope, sizeof(rs_scope_t) * rs->cap);
+  }
+  rs->scope[rs->count++] = (rs_scope_t){ .name = name, .level = rs->level, .slot = slot };
 }
-static const rv_t* rv_unit(void) {
-  static rv_t u = { .kind = RV_UNIT };
-  return &u;
+
+static const rx_expr_t*  resolve_expr(resolver_t* rs, const lscir_expr_t* e);
+static const rx_value_t* resolve_value(resolver_t* rs, const lscir_value_t* v);
+
+static const rx_value_t* const* resolve_values(resolver_t* rs, int n,
+                                               const lscir_value_t* const* vs) {
+  if (n <= 0)
+    return NULL;
+  const rx_value_t** xs = lsmalloc(sizeof(rx_value_t*) * n);
+  for (int i = 0; i < n; i++)
+    xs[i] = resolve_value(rs, vs[i]);
+  return xs;
 }
-static const rv_t* rv_tok(void) {
-  static rv_t t = { .kind = RV_TOKEN };
-  return &t;
+
+static const rx_value_t* resolve_value(resolver_t* rs, const lscir_value_t* v) {
+  rx_value_t* x = lsmalloc(sizeof(rx_value_t));
+  x->src        = v;
+  switch (v->kind) {
+  case LCIR_VAL_VAR:
+    x->var.depth = -1;
+    x->var.slot  = -1;
+    for (int i = rs->count - 1; i >= 0; i--) {
+      if (strcmp(rs->scope[i].name, v->var) == 0) {
+        x->var.depth = rs->level - rs->scope[i].level;
+        x->var.slot  = rs->scope[i].slot;
+        break;
+      }
+    }
+    break;
+  case LCIR_VAL_CONSTR:
+    x->args = resolve_values(rs, v->constr.argc, v->constr.args);
+    break;
+  case LCIR_VAL_NSLIT:
+    x->args = resolve_values(rs, v->nslit.count, v->nslit.vals);
+    break;
+  case LCIR_VAL_LAM: {
+    // The body runs in a fresh frame whose slot 0 is the parameter
+    int saved_count  = rs->count;
+    int saved_nslots = rs->nslots;
+    rs->level++;
+    rs->nslots = 1;
+    rs_push(rs, v->lam.param, 0);
+    x->lam.body   = resolve_expr(rs, v->lam.body);
+    x->lam.nslots = rs->nslots;
+    rs->level--;
+    rs->count  = saved_count;
+    rs->nslots = saved_nslots;
+    break;
+  }
+  case LCIR_VAL_INT:
+  case LCIR_VAL_STR:
+    break;
+  }
+  return x;
 }
-static const rv_t* rv_sym(const char* s) {
-  rv_t* v = lsmalloc(sizeof(rv_t));
-  v->kind = RV_SYMBOL;
-  v->sym  = s;
-  return v;
+
+static const rx_expr_t* resolve_expr(resolver_t* rs, const lscir_expr_t* e) {
+  if (!e)
+    return NULL;
+  rx_expr_t* x = lsmalloc(sizeof(rx_expr_t));
+  *x           = (rx_expr_t){ .src = e, .slot = -1 };
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    x->v = resolve_value(rs, e->v);
+    break;
+  case LCIR_EXP_LET: {
+    // Non-recursive: the bound expression does not see the variable
+    x->e1   = resolve_expr(rs, e->let1.bind);
+    x->slot = rs->nslots++;
+    rs_push(rs, e->let1.var, x->slot);
+    x->e2 = resolve_expr(rs, e->let1.body);
+    rs->count--;
+    break;
+  }
+  case LCIR_EXP_APP:
+    x->v    = resolve_value(rs, e->app.func);
+    x->args = resolve_values(rs, e->app.argc, e->app.args);
+    break;
+  case LCIR_EXP_IF:
+    x->v  = resolve_value(rs, e->ife.cond);
+    x->e1 = resolve_expr(rs, e->ife.then_e);
+    x->e2 = resolve_expr(rs, e->ife.else_e);
+    break;
+  case LCIR_EXP_EFFAPP:
+    x->v    = resolve_value(rs, e->effapp.func);
+    x->args = resolve_values(rs, e->effapp.argc, e->effapp.args);
+    break;
+  case LCIR_EXP_TOKEN:
+    break;
+  case LCIR_EXP_MATCH: {
+    // Case patterns do not bind in the runtime path (see eval_expr), so bodies share the scope
+    x->v = resolve_value(rs, e->match1.scrut);
+    if (e->match1.casec > 0) {
+      const rx_expr_t** cs = lsmalloc(sizeof(rx_expr_t*) * e->match1.casec);
+      for (int i = 0; i < e->match1.casec; i++)
+        cs[i] = resolve_expr(rs, e->match1.cases[i].body);
+      x->cases = cs;
+    }
+    break;
+  }
+  }
+  return x;
 }
-static const rv_t* rv_bottom(const char* msg, int argc, const rv_t* const* args) {
-  rv_t* v        = lsmalloc(sizeof(rv_t));
-  v->kind        = RV_BOTTOM;
-  v->bot.message = msg;
-  v->bot.argc    = argc;
-  v->bot.args    = args;
-  return v;
+
+static frame_t* frame_new(frame_t* up, int nslots) {
+  frame_t* f = lsmalloc(sizeof(frame_t) + sizeof(rv_t*) * nslots);
+  f->up      = up;
+  for (int i = 0; i < nslots; i++)
+    f->slots[i] = NULL;
+  return f;
 }
-static const rv_t* rv_lam(const char* p, const lscir_expr_t* b, env_bind_t* env) {
-  rv_t* v      = lsmalloc(sizeof(rv_t));
-  v->kind      = RV_LAM;
-  v->lam.param = p;
-  v->lam.body  = b;
-  v->lam.env   = env;
+
+static const rv_t* rv_lam(const rx_value_t* fn, frame_t* env) {
+  rv_t* v    = lsmalloc(sizeof(rv_t));
+  v->kind    = RV_LAM;
+  v->lam.fn  = fn;
+  v->lam.env = env;
   return v;
 }
 static const rv_t* rv_natfun(const char* name, int arity, int capc, const rv_t* const* caps) {
@@ -127,17 +199,9 @@ static const rv_t* rv_natfun(const char* name, int arity, int capc, const rv_t*
   v->nf.caps  = caps;
   return v;
 }
-static const rv_t* rv_constr(const char* name, int argc, const rv_t* const* args) {
-  rv_t* v     = lsmalloc(sizeof(rv_t));
-  v->kind     = RV_CONSTR;
-  v->con.name = name;
-  v->con.argc = argc;
-  v->con.args = args;
-  return v;
-}
 
-static const rv_t* eval_value(FILE* outfp, const lscir_value_t* v, eval_ctx_t* ctx);
-static const rv_t* eval_expr(FILE* outfp, const lscir_expr_t* e, eval_ctx_t* ctx);
+static const rv_t* eval_value(FILE* outfp, const rx_value_t* x, eval_ctx_t* ctx);
+static const rv_t* eval_expr(FILE* outfp, const rx_expr_t* x, eval_ctx_t* ctx);
 static const rv_t* apply(FILE* outfp, const rv_t* f, int argc, const rv_t* const* args,
                          eval_ctx_t* ctx);
 
@@ -150,15 +214,22 @@ static const rv_t* apply(FILE* outfp, const rv_t* f, int argc, const rv_t* const
 //            NOT be implicitly resolved to native functions. They remain plain symbols and will not
 //            be callable here. Follow-up: Introduce explicit import table in CIR and wire
 //            evaluator/typechecker to it.
-static const rv_t* eval_value(FILE* outfp, const lscir_value_t* v, eval_ctx_t* ctx) {
+static const rv_t* eval_value(FILE* outfp, const rx_value_t* x, eval_ctx_t* ctx) {
   (void)outfp;
+  const lscir_value_t* v = x->src;
   switch (v->kind) {
   case LCIR_VAL_INT:
     return rv_int(v->ival);
   case LCIR_VAL_STR:
     return rv_str(v->sval);
   case LCIR_VAL_VAR: {
-    const rv_t* found = env_lookup(ctx ? ctx->env : NULL, v->var);
+    const rv_t* found = NULL;
+    if (x->var.depth >= 0 && ctx) {
+      frame_t* f = ctx->frame;
+      for (int d = x->var.depth; d > 0 && f; d--)
+        f = f->up;
+      found = f ? f->slots[x->var.slot] : NULL;
+    }
     if (found)
       return found;
     // No implicit mapping to native functions. Treat as plain symbol.
@@ -172,15 +243,15 @@ static const rv_t* eval_value(FILE* outfp, const lscir_value_t* v, eval_ctx_t* c
     if (n > 0) {
       xs = lsmalloc(sizeof(rv_t*) * n);
       for (int i = 0; i < n; i++)
-        xs[i] = eval_value(outfp, v->constr.args[i], ctx);
+        xs[i] = eval_value(outfp, x->args[i], ctx);
     }
     return rv_constr(v->constr.name, n, xs);
   }
   case LCIR_VAL_LAM:
-    return rv_lam(v->lam.param, v->lam.body, ctx ? ctx->env : NULL);
+    return rv_lam(x, ctx ? ctx->frame : NULL);
   case LCIR_VAL_NSLIT: {
     for (int i = 0; i < v->nslit.count; i++) {
-      (void)eval_value(outfp, v->nslit.vals[i], ctx);
+      (void)eval_value(outfp, x->args[i], ctx);
     }
     return rv_unit();
   }
@@ -188,180 +259,6 @@ static const rv_t* eval_value(FILE* outfp, const lscir_value_t* v, eval_ctx_t* c
   return rv_unit();
 }
 
-static int truthy(const rv_t* v) {
-  if (!v)
-    return 0;
-  switch (v->kind) {
-  case RV_INT:
-    return v->ival != 0;
-  case RV_SYMBOL:
-    return (strcmp(v->sym, "true") == 0) ? 1 : (strcmp(v->sym, "false") == 0 ? 0 : 1);
-  case RV_UNIT:
-    return 0;
-  default:
-    return 1;
-  }
-}
-
-static void print_value_inline(FILE* outfp, const rv_t* v) {
-  if (!v) {
-    fprintf(outfp, "<v>");
-    return;
-  }
-  switch (v->kind) {
-  case RV_UNIT:
-    fprintf(outfp, "()");
-    return;
-  case RV_INT:
-    fprintf(outfp, "%lld", v->ival);
-    return;
-  case RV_STR:
-    fprintf(outfp, "%s", v->sval);
-    return;
-  case RV_SYMBOL:
-    fprintf(outfp, "%s", v->sym);
-    return;
-  case RV_CONSTR: {
-    if (v->con.argc == 0) {
-      fprintf(outfp, "%s", v->con.name ? v->con.name : "<con>");
-      return;
-    }
-    fprintf(outfp, "(%s", v->con.name ? v->con.name : "<con>");
-    for (int j = 0; j < v->con.argc; j++) {
-      fprintf(outfp, " ");
-      print_value_inline(outfp, v->con.args[j]);
-    }
-    fprintf(outfp, ")");
-    return;
-  }
-  case RV_BOTTOM: {
-    fprintf(outfp, "<bottom msg=\"%s\"", v->bot.message ? v->bot.message : "");
-    if (v->bot.argc > 0 && v->bot.args) {
-      fprintf(outfp, " args=[");
-      for (int i = 0; i < v->bot.argc; i++) {
-        if (i)
-          fprintf(outfp, ", ");
-        print_value_inline(outfp, v->bot.args[i]);
-      }
-      fprintf(outfp, "]");
-    }
-    fprintf(outfp, ">");
-    return;
-  }
-  default:
-    fprintf(outfp, "<v>");
-    return;
-  }
-}
-
-static void print_value(FILE* outfp, const rv_t* v) {
-  switch (v->kind) {
-  case RV_UNIT:
-    fprintf(outfp, "()\n");
-    return;
-  case RV_INT:
-    fprintf(outfp, "%lld\n", v->ival);
-    return;
-  case RV_STR:
-    fprintf(outfp, "%s\n", v->sval);
-    return;
-  case RV_SYMBOL:
-    fprintf(outfp, "%s\n", v->sym);
-    return;
-  case RV_LAM:
-    fprintf(outfp, "<lam>\n");
-    return;
-  case RV_TOKEN:
-    fprintf(outfp, "<token>\n");
-    return;
-  case RV_NATFUN:
-    fprintf(outfp, "<fun %s/%d:%d>\n", v->nf.name, v->nf.arity, v->nf.capc);
-    return;
-  case RV_CONSTR: {
-    if ((strcmp(v->con.name, "[]") == 0 && v->con.argc == 0) ||
-        (strcmp(v->con.name, "Nil") == 0 && v->con.argc == 0)) {
-      fprintf(outfp, "[]\n");
-      return;
-    }
-    if ((strcmp(v->con.name, ":") == 0 || strcmp(v->con.name, "Cons") == 0) && v->con.argc == 2) {
-      const rv_t*  cur = v;
-      int          cap = 8, cnt = 0;
-      const rv_t** elems = lsmalloc(sizeof(rv_t*) * cap);
-      while (cur && cur->kind == RV_CONSTR &&
-             (strcmp(cur->con.name, ":") == 0 || strcmp(cur->con.name, "Cons") == 0) &&
-             cur->con.argc == 2) {
-        if (cnt >= cap) {
-          cap *= 2;
-          const rv_t** tmp = lsmalloc(sizeof(rv_t*) * cap);
-          for (int i = 0; i < cnt; i++)
-            tmp[i] = elems[i];
-          elems = tmp;
-        }
-        elems[cnt++] = cur->con.args[0];
-        cur          = cur->con.args[1];
-      }
-      int is_nil = (cur && cur->kind == RV_CONSTR &&
-                    ((strcmp(cur->con.name, "[]") == 0 && cur->con.argc == 0) ||
-                     (strcmp(cur->con.name, "Nil") == 0 && cur->con.argc == 0)));
-      if (is_nil) {
-        fprintf(outfp, "[");
-        for (int i = 0; i < cnt; i++) {
-          if (i)
-            fprintf(outfp, ", ");
-          const rv_t* e = elems[i];
-          switch (e->kind) {
-          case RV_INT:
-            fprintf(outfp, "%lld", e->ival);
-            break;
-          case RV_STR:
-            fprintf(outfp, "%s", e->sval);
-            break;
-          case RV_SYMBOL:
-            fprintf(outfp, "%s", e->sym);
-            break;
-          case RV_UNIT:
-            fprintf(outfp, "()");
-            break;
-          default:
-            fprintf(outfp, "<v>");
-          }
-        }
-        fprintf(outfp, "]\n");
-        return;
-      }
-    }
-    fprintf(outfp, "(%s", v->con.name);
-    for (int i = 0; i < v->con.argc; i++) {
-      fprintf(outfp, " ");
-      const rv_t* e = v->con.args[i];
-      switch (e->kind) {
-      case RV_INT:
-        fprintf(outfp, "%lld", e->ival);
-        break;
-      case RV_STR:
-        fprintf(outfp, "%s", e->sval);
-        break;
-      case RV_SYMBOL:
-        fprintf(outfp, "%s", e->sym);
-        break;
-      case RV_UNIT:
-        fprintf(outfp, "()");
-        break;
-      default:
-        fprintf(outfp, "<v>");
-        break;
-      }
-    }
-    fprintf(outfp, ")\n");
-    return;
-  case RV_BOTTOM:
-    print_value_inline(outfp, v);
-    fprintf(outfp, "\n");
-    return;
-  }
-  }
-}
-
 static const rv_t* apply_natfun(FILE* outfp, const rv_t* nf, int argc, const rv_t* const* args,
                                 eval_ctx_t* ctx) {
   (void)ctx;
@@ -400,9 +297,10 @@ static const rv_t* apply(FILE* outfp, const rv_t* f, int argc, const rv_t* const
   case RV_LAM: {
     if (argc != 1)
       return rv_unit();
-    env_bind_t* env2 = env_push(f->lam.env, f->lam.param, args[0]);
-    eval_ctx_t  sub  = { .env = env2, .has_token = ctx->has_token };
-    return eval_expr(outfp, f->lam.body, &sub);
+    frame_t* frame  = frame_new(f->lam.env, f->lam.fn->lam.nslots);
+    frame->slots[0] = args[0];
+    eval_ctx_t sub  = { .frame = frame, .has_token = ctx->has_token };
+    return eval_expr(outfp, f->lam.fn->lam.body, &sub);
   }
   case RV_NATFUN:
     return apply_natfun(outfp, f, argc, args, ctx);
@@ -411,66 +309,66 @@ static const rv_t* apply(FILE* outfp, const rv_t* f, int argc, const rv_t* const
   }
 }
 
-static const rv_t* eval_expr(FILE* outfp, const lscir_expr_t* e, eval_ctx_t* ctx) {
-  if (!e)
+static const rv_t* eval_expr(FILE* outfp, const rx_expr_t* x, eval_ctx_t* ctx) {
+  if (!x)
     return rv_unit();
+  const lscir_expr_t* e = x->src;
   switch (e->kind) {
   case LCIR_EXP_VAL:
-    return eval_value(outfp, e->v, ctx);
+    return eval_value(outfp, x->v, ctx);
   case LCIR_EXP_LET: {
-    const rv_t* v    = eval_expr(outfp, e->let1.bind, ctx);
-    env_bind_t* env2 = env_push(ctx->env, e->let1.var, v);
-    eval_ctx_t  sub  = { .env       = env2,
-                         .has_token = ctx->has_token ||
-                                      (e->let1.bind && e->let1.bind->kind == LCIR_EXP_TOKEN) };
-    return eval_expr(outfp, e->let1.body, &sub);
+    int has_token = ctx->has_token || (e->let1.bind && e->let1.bind->kind == LCIR_EXP_TOKEN);
+    ctx->frame->slots[x->slot] = eval_expr(outfp, x->e1, ctx);
+    eval_ctx_t sub             = { .frame = ctx->frame, .has_token = has_token };
+    return eval_expr(outfp, x->e2, &sub);
   }
   case LCIR_EXP_APP: {
-    const rv_t*  f  = eval_value(outfp, e->app.func, ctx);
+    const rv_t*  f  = eval_value(outfp, x->v, ctx);
     const rv_t** xs = NULL;
     if (e->app.argc > 0) {
       xs = lsmalloc(sizeof(rv_t*) * e->app.argc);
       for (int i = 0; i < e->app.argc; i++)
-        xs[i] = eval_value(outfp, e->app.args[i], ctx);
+        xs[i] = eval_value(outfp, x->args[i], ctx);
     }
     return apply(outfp, f, e->app.argc, xs, ctx);
   }
   case LCIR_EXP_IF: {
-    const rv_t* cv = eval_value(outfp, e->ife.cond, ctx);
-    if (truthy(cv))
-      return eval_expr(outfp, e->ife.then_e, ctx);
-    return eval_expr(outfp, e->ife.else_e, ctx);
+    const rv_t* cv = eval_value(outfp, x->v, ctx);
+    if (rv_truthy(cv))
+      return eval_expr(outfp, x->e1, ctx);
+    return eval_expr(outfp, x->e2, ctx);
   }
   case LCIR_EXP_EFFAPP: {
-    const rv_t*  f  = eval_value(outfp, e->effapp.func, ctx);
+    const rv_t*  f  = eval_value(outfp, x->v, ctx);
     const rv_t** xs = NULL;
     if (e->effapp.argc > 0) {
       xs = lsmalloc(sizeof(rv_t*) * e->effapp.argc);
       for (int i = 0; i < e->effapp.argc; i++)
-        xs[i] = eval_value(outfp, e->effapp.args[i], ctx);
+        xs[i] = eval_value(outfp, x->args[i], ctx);
     }
-    // TODO: Effects must be mediated via explicit effectful builtins from an import table.
-    //       No implicit symbol-based effects here.
-    return rv_unit();
+    // The token only orders effects: the function is applied like any other. Effects of unknown
+    // (symbol) functions still yield unit; they need effectful builtins from an import table.
+    return apply(outfp, f, e->effapp.argc, xs, ctx);
   }
   case LCIR_EXP_TOKEN:
     return rv_tok();
   case LCIR_EXP_MATCH: {
-    const rv_t* sv = eval_value(outfp, e->match1.scrut, ctx);
+    const rv_t* sv = eval_value(outfp, x->v, ctx);
     for (int i = 0; i < e->match1.casec; i++) {
       const lscir_case_t* c = &e->match1.cases[i];
       // Reuse clean matcher logic: only handle trivial equality/constructors via rv_t structure
       // For runtime path, we don’t have thunk infra here; pattern eval lives in clean evaluator
       // only. So we limit to wildcard and variables; others require lowering.
       if (!c->pat || c->pat->kind == LCIR_PAT_WILDCARD || c->pat->kind == LCIR_PAT_VAR) {
-        eval_ctx_t sub = { .env = ctx->env, .has_token = ctx->has_token };
+        eval_ctx_t sub = { .frame = ctx->frame, .has_token = ctx->has_token };
         // Bind var is ignored in runtime path until full env wiring exists.
-        return eval_expr(outfp, c->body, &sub);
+        return eval_expr(outfp, x->cases[i], &sub);
       }
     }
     // No match -> emit a Bottom-style diagnostic and return an internal bottom carrying scrutinee
     fprintf(stderr, "E: <bottom msg=\"match: no case\" at <unknown>:1.1: >\n");
-    const rv_t* rels[1] = { sv };
+    const rv_t** rels = lsmalloc(sizeof(rv_t*));
+    rels[0]           = sv;
     return rv_bottom("match: no case", 1, rels);
   }
   }
@@ -482,8 +380,10 @@ int lscir_eval(FILE* outfp, const lscir_prog_t* cir) {
     fprintf(outfp, "()\n");
     return 0;
   }
-  eval_ctx_t  ctx = { .env = NULL, .has_token = 0 };
-  const rv_t* v   = eval_expr(outfp, cir->root, &ctx);
-  print_value(outfp, v);
+  resolver_t       rs   = { 0 };
+  const rx_expr_t* root = resolve_expr(&rs, cir->root);
+  eval_ctx_t       ctx  = { .frame = frame_new(NULL, rs.nslots), .has_token = 0 };
+  const rv_t*      v    = eval_expr(outfp, root, &ctx);
+  rv_print(outfp, v);
   return 0;
 }
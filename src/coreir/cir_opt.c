@@ -0,0 +1,990 @@
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "coreir/cir_internal.h"
+#include "coreir/coreir.h"
+#include "common/malloc.h"
+
+/*
+ * Core IR optimizer.
+ *
+ * lscir_optimize runs a pipeline of rewrite passes over the lowered program until a round
+ * changes nothing (or the round limit of the level is reached). Every pass is one rule applied
+ * bottom-up by a shared walk that tracks the variables in scope, so rules can look at what a
+ * variable is bound to and how often a let body used its variable.
+ *
+ *   inline  (-O2) call heads naming a small let-bound lambda get the lambda itself
+ *   beta    (-O1) (lam x e) v1 v2 ... becomes let x = v1 in e, applied to the rest;
+ *                 let x = e in x becomes e
+ *   fold    (-O1) add/sub/lt on int literals, if on an int literal or on true/false
+ *   case    (-O1) match on a known constructor or literal selects the case statically
+ *   dce     (-O1) lets whose variable is unused and whose binding is pure are dropped
+ *   fuse    (-O1) map/filter/foldr over map/filter/a list-building foldr become one foldr,
+ *                 when every function involved is pure (fusion interleaves their calls)
+ *
+ * Lets are sequential and non-recursive. A rewrite that moves a value to another place only
+ * happens when none of the value's free variables is rebound in between. Applications, effect
+ * applications and tokens are never dropped, so the effect token discipline is preserved.
+ * add/sub/lt are folded only while unbound by the program; they denote the builtins then.
+ */
+
+typedef struct opt_scope {
+  const char*         name;
+  const lscir_expr_t* bind; // let binding, or NULL for lambda parameters and pattern variables
+  int                 uses; // occurrences seen by the current walk
+} opt_scope_t;
+
+typedef struct opt {
+  opt_scope_t* scope;
+  int          count;
+  int          cap;
+  int          changed; // rewrites made by the current round
+} opt_t;
+
+// A rule rewrites one node whose children have already been walked. For LET nodes the bound
+// variable is still the top scope entry, so its use count in the body is known.
+typedef const lscir_expr_t* (*opt_rule_t)(opt_t* o, const lscir_expr_t* e);
+
+typedef struct opt_pass {
+  const char* name;
+  int         level; // lowest -O level that runs the pass
+  opt_rule_t  rule;
+} opt_pass_t;
+
+// Largest lambda (in Core IR nodes) that -O2 inlines at a call site
+#define OPT_INLINE_SIZE 24
+
+// --- Scope -------------------------------------------------------------------
+
+static void opt_push(opt_t* o, const char* name, const lscir_expr_t* bind) {
+  if (o->count == o->cap) {
+    o->cap   = o->cap ? o->cap * 2 : 16;
+    o->scope = lsrealloc(o->scope, sizeof(opt_scope_t) * o->cap);
+  }
+  o->scope[o->count++] = (opt_scope_t){ .name = name, .bind = bind, .uses = 0 };
+}
+
+// Index of the innermost entry for name, or -1 when the program does not bind it
+static int opt_lookup(const opt_t* o, const char* name) {
+  for (int i = o->count - 1; i >= 0; i--)
+    if (strcmp(o->scope[i].name, name) == 0)
+      return i;
+  return -1;
+}
+
+// Value a variable is let-bound to, or NULL
+static const lscir_value_t* opt_known(const opt_t* o, const lscir_value_t* v, int* at) {
+  if (v->kind != LCIR_VAL_VAR)
+    return v;
+  int i = opt_lookup(o, v->var);
+  if (i < 0 || !o->scope[i].bind || o->scope[i].bind->kind != LCIR_EXP_VAL)
+    return NULL;
+  if (at)
+    *at = i;
+  return o->scope[i].bind->v;
+}
+
+static const char* opt_gensym(void) {
+  static int s_gsym = 0;
+  char       buf[32];
+  int        n = snprintf(buf, sizeof(buf), "o$%d", ++s_gsym);
+  char*      s = lsmalloc((size_t)n + 1);
+  memcpy(s, buf, (size_t)n + 1);
+  return s;
+}
+
+// --- Free variables ------------------------------------------------------------
+
+// Names bound while looking for free variables
+typedef struct opt_bound {
+  const char** names;
+  int          count;
+  int          cap;
+} opt_bound_t;
+
+static void opt_bound_push(opt_bound_t* b, const char* name) {
+  if (b->count == b->cap) {
+    b->cap   = b->cap ? b->cap * 2 : 8;
+    b->names = lsrealloc(b->names, sizeof(const char*) * b->cap);
+  }
+  b->names[b->count++] = name;
+}
+
+static int opt_bound_has(const opt_bound_t* b, const char* name) {
+  for (int i = b->count - 1; i >= 0; i--)
+    if (strcmp(b->names[i], name) == 0)
+      return 1;
+  return 0;
+}
+
+static void opt_pat_bind(opt_bound_t* b, const lscir_pat_t* p) {
+  if (!p)
+    return;
+  if (p->kind == LCIR_PAT_VAR)
+    opt_bound_push(b, p->var);
+  else if (p->kind == LCIR_PAT_CONSTR)
+    for (int i = 0; i < p->constr.subc; i++)
+      opt_pat_bind(b, p->constr.subpats[i]);
+}
+
+// Calls the predicate on every free variable until it returns non-zero
+typedef int (*opt_fv_fn_t)(const char* name, const void* data);
+
+static int opt_fv_expr(const lscir_expr_t* e, opt_bound_t* b, opt_fv_fn_t fn, const void* data);
+
+static int opt_fv_value(const lscir_value_t* v, opt_bound_t* b, opt_fv_fn_t fn, const void* data) {
+  switch (v->kind) {
+  case LCIR_VAL_VAR:
+    return !opt_bound_has(b, v->var) && fn(v->var, data);
+  case LCIR_VAL_CONSTR:
+    for (int i = 0; i < v->constr.argc; i++)
+      if (opt_fv_value(v->constr.args[i], b, fn, data))
+        return 1;
+    return 0;
+  case LCIR_VAL_NSLIT:
+    for (int i = 0; i < v->nslit.count; i++)
+      if (opt_fv_value(v->nslit.vals[i], b, fn, data))
+        return 1;
+    return 0;
+  case LCIR_VAL_LAM: {
+    int saved = b->count;
+    opt_bound_push(b, v->lam.param);
+    int r    = opt_fv_expr(v->lam.body, b, fn, data);
+    b->count = saved;
+    return r;
+  }
+  default:
+    return 0;
+  }
+}
+
+static int opt_fv_values(int n, const lscir_value_t* const* vs, opt_bound_t* b, opt_fv_fn_t fn,
+                         const void* data) {
+  for (int i = 0; i < n; i++)
+    if (opt_fv_value(vs[i], b, fn, data))
+      return 1;
+  return 0;
+}
+
+static int opt_fv_expr(const lscir_expr_t* e, opt_bound_t* b, opt_fv_fn_t fn, const void* data) {
+  if (!e)
+    return 0;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return opt_fv_value(e->v, b, fn, data);
+  case LCIR_EXP_LET: {
+    if (opt_fv_expr(e->let1.bind, b, fn, data))
+      return 1;
+    int saved = b->count;
+    opt_bound_push(b, e->let1.var);
+    int r    = opt_fv_expr(e->let1.body, b, fn, data);
+    b->count = saved;
+    return r;
+  }
+  case LCIR_EXP_APP:
+    return opt_fv_value(e->app.func, b, fn, data) ||
+           opt_fv_values(e->app.argc, e->app.args, b, fn, data);
+  case LCIR_EXP_IF:
+    return opt_fv_value(e->ife.cond, b, fn, data) || opt_fv_expr(e->ife.then_e, b, fn, data) ||
+           opt_fv_expr(e->ife.else_e, b, fn, data);
+  case LCIR_EXP_EFFAPP:
+    return opt_fv_value(e->effapp.func, b, fn, data) ||
+           (e->effapp.token && opt_fv_value(e->effapp.token, b, fn, data)) ||
+           opt_fv_values(e->effapp.argc, e->effapp.args, b, fn, data);
+  case LCIR_EXP_TOKEN:
+    return 0;
+  case LCIR_EXP_MATCH:
+    if (opt_fv_value(e->match1.scrut, b, fn, data))
+      return 1;
+    for (int i = 0; i < e->match1.casec; i++) {
+      int saved = b->count;
+      opt_pat_bind(b, e->match1.cases[i].pat);
+      int r    = opt_fv_expr(e->match1.cases[i].body, b, fn, data);
+      b->count = saved;
+      if (r)
+        return 1;
+    }
+    return 0;
+  }
+  return 0;
+}
+
+typedef struct opt_shadow {
+  const opt_t* o;
+  int          from; // first scope entry that was not visible where the value was written
+} opt_shadow_t;
+
+static int opt_is_shadowed(const char* name, const void* data) {
+  const opt_shadow_t* s = data;
+  for (int i = s->from; i < s->o->count; i++)
+    if (strcmp(s->o->scope[i].name, name) == 0)
+      return 1;
+  return 0;
+}
+
+// Whether v, written where only scope entries below `from` were visible, still means the same
+// at the current point of the walk
+static int opt_movable(const opt_t* o, const lscir_value_t* v, int from) {
+  opt_shadow_t s = { .o = o, .from = from };
+  opt_bound_t  b = { 0 };
+  return !opt_fv_value(v, &b, opt_is_shadowed, &s);
+}
+
+static int opt_is_name(const char* name, const void* data) { return strcmp(name, data) == 0; }
+
+static int opt_value_mentions(const lscir_value_t* v, const char* name) {
+  opt_bound_t b = { 0 };
+  return opt_fv_value(v, &b, opt_is_name, name);
+}
+
+static int opt_expr_mentions(const lscir_expr_t* e, const char* name) {
+  opt_bound_t b = { 0 };
+  return opt_fv_expr(e, &b, opt_is_name, name);
+}
+
+// --- Walk --------------------------------------------------------------------
+
+static const lscir_expr_t*  opt_expr(opt_t* o, const lscir_expr_t* e, opt_rule_t rule);
+static const lscir_value_t* opt_value(opt_t* o, const lscir_value_t* v, opt_rule_t rule);
+
+static const lscir_value_t* const* opt_values(opt_t* o, int n, const lscir_value_t* const* vs,
+                                              opt_rule_t rule) {
+  const lscir_value_t** xs = NULL;
+  for (int i = 0; i < n; i++) {
+    const lscir_value_t* x = opt_value(o, vs[i], rule);
+    if (x != vs[i] && !xs) {
+      xs = lsmalloc(sizeof(lscir_value_t*) * n);
+      memcpy(xs, vs, sizeof(lscir_value_t*) * n);
+    }
+    if (xs)
+      xs[i] = x;
+  }
+  return xs ? xs : vs;
+}
+
+static const lscir_value_t* opt_value(opt_t* o, const lscir_value_t* v, opt_rule_t rule) {
+  switch (v->kind) {
+  case LCIR_VAL_VAR: {
+    int i = opt_lookup(o, v->var);
+    if (i >= 0)
+      o->scope[i].uses++;
+    return v;
+  }
+  case LCIR_VAL_CONSTR: {
+    const lscir_value_t* const* args = opt_values(o, v->constr.argc, v->constr.args, rule);
+    if (args == v->constr.args)
+      return v;
+    lscir_value_t* x = lsmalloc(sizeof(lscir_value_t));
+    *x               = *v;
+    x->constr.args   = args;
+    return x;
+  }
+  case LCIR_VAL_NSLIT: {
+    const lscir_value_t* const* vals = opt_values(o, v->nslit.count, v->nslit.vals, rule);
+    if (vals == v->nslit.vals)
+      return v;
+    lscir_value_t* x = lsmalloc(sizeof(lscir_value_t));
+    *x               = *v;
+    x->nslit.vals    = vals;
+    return x;
+  }
+  case LCIR_VAL_LAM: {
+    opt_push(o, v->lam.param, NULL);
+    const lscir_expr_t* body = opt_expr(o, v->lam.body, rule);
+    o->count--;
+    if (body == v->lam.body)
+      return v;
+    lscir_value_t* x = lsmalloc(sizeof(lscir_value_t));
+    *x               = *v;
+    x->lam.body      = body;
+    return x;
+  }
+  default:
+    return v;
+  }
+}
+
+static void opt_push_pat(opt_t* o, const lscir_pat_t* p) {
+  if (!p)
+    return;
+  if (p->kind == LCIR_PAT_VAR)
+    opt_push(o, p->var, NULL);
+  else if (p->kind == LCIR_PAT_CONSTR)
+    for (int i = 0; i < p->constr.subc; i++)
+      opt_push_pat(o, p->constr.subpats[i]);
+}
+
+static const lscir_expr_t* opt_expr(opt_t* o, const lscir_expr_t* e, opt_rule_t rule) {
+  if (!e)
+    return NULL;
+  lscir_expr_t x = *e;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    x.v = opt_value(o, e->v, rule);
+    break;
+  case LCIR_EXP_LET: {
+    x.let1.bind = opt_expr(o, e->let1.bind, rule);
+    opt_push(o, e->let1.var, x.let1.bind);
+    x.let1.body = opt_expr(o, e->let1.body, rule);
+    break;
+  }
+  case LCIR_EXP_APP:
+    x.app.func = opt_value(o, e->app.func, rule);
+    x.app.args = opt_values(o, e->app.argc, e->app.args, rule);
+    break;
+  case LCIR_EXP_IF:
+    x.ife.cond   = opt_value(o, e->ife.cond, rule);
+    x.ife.then_e = opt_expr(o, e->ife.then_e, rule);
+    x.ife.else_e = opt_expr(o, e->ife.else_e, rule);
+    break;
+  case LCIR_EXP_EFFAPP:
+    x.effapp.func  = opt_value(o, e->effapp.func, rule);
+    x.effapp.token = e->effapp.token ? opt_value(o, e->effapp.token, rule) : NULL;
+    x.effapp.args  = opt_values(o, e->effapp.argc, e->effapp.args, rule);
+    break;
+  case LCIR_EXP_TOKEN:
+    break;
+  case LCIR_EXP_MATCH: {
+    x.match1.scrut         = opt_value(o, e->match1.scrut, rule);
+    lscir_case_t* cases    = NULL;
+    for (int i = 0; i < e->match1.casec; i++) {
+      int saved = o->count;
+      opt_push_pat(o, e->match1.cases[i].pat);
+      const lscir_expr_t* body = opt_expr(o, e->match1.cases[i].body, rule);
+      o->count                 = saved;
+      if (body != e->match1.cases[i].body && !cases) {
+        cases = lsmalloc(sizeof(lscir_case_t) * e->match1.casec);
+        memcpy(cases, e->match1.cases, sizeof(lscir_case_t) * e->match1.casec);
+      }
+      if (cases)
+        cases[i].body = body;
+    }
+    if (cases)
+      x.match1.cases = cases;
+    break;
+  }
+  }
+  const lscir_expr_t* r = e;
+  if (memcmp(&x, e, sizeof(x)) != 0) {
+    lscir_expr_t* n = lsmalloc(sizeof(lscir_expr_t));
+    *n              = x;
+    r               = n;
+  }
+  r = rule(o, r);
+  if (e->kind == LCIR_EXP_LET)
+    o->count--;
+  return r;
+}
+
+// --- Constructors --------------------------------------------------------------
+
+static const lscir_expr_t* opt_mk_val(const lscir_value_t* v) {
+  lscir_expr_t* e = lsmalloc(sizeof(lscir_expr_t));
+  *e              = (lscir_expr_t){ .kind = LCIR_EXP_VAL, .v = v };
+  return e;
+}
+
+static const lscir_expr_t* opt_mk_let(const char* var, const lscir_expr_t* bind,
+                                      const lscir_expr_t* body) {
+  lscir_expr_t* e = lsmalloc(sizeof(lscir_expr_t));
+  *e = (lscir_expr_t){ .kind = LCIR_EXP_LET, .let1 = { .var = var, .bind = bind, .body = body } };
+  return e;
+}
+
+static const lscir_expr_t* opt_mk_app(const lscir_value_t* f, int argc,
+                                      const lscir_value_t* const* args) {
+  lscir_expr_t* e = lsmalloc(sizeof(lscir_expr_t));
+  *e = (lscir_expr_t){ .kind = LCIR_EXP_APP, .app = { .func = f, .args = args, .argc = argc } };
+  return e;
+}
+
+static const lscir_value_t* opt_mk_int(long long ival) {
+  lscir_value_t* v = lsmalloc(sizeof(lscir_value_t));
+  *v               = (lscir_value_t){ .kind = LCIR_VAL_INT, .ival = ival };
+  return v;
+}
+
+static const lscir_value_t* opt_mk_constr0(const char* name) {
+  lscir_value_t* v = lsmalloc(sizeof(lscir_value_t));
+  *v = (lscir_value_t){ .kind = LCIR_VAL_CONSTR, .constr = { .name = name, .argc = 0 } };
+  return v;
+}
+
+static const lscir_value_t* opt_mk_var(const char* name) {
+  lscir_value_t* v = lsmalloc(sizeof(lscir_value_t));
+  *v               = (lscir_value_t){ .kind = LCIR_VAL_VAR, .var = name };
+  return v;
+}
+
+static const lscir_value_t* opt_mk_lam(const char* param, const lscir_expr_t* body) {
+  lscir_value_t* v = lsmalloc(sizeof(lscir_value_t));
+  *v = (lscir_value_t){ .kind = LCIR_VAL_LAM, .lam = { .param = param, .body = body } };
+  return v;
+}
+
+static const lscir_value_t* opt_mk_cons(const lscir_value_t* x, const lscir_value_t* xs) {
+  const lscir_value_t** args = lsmalloc(sizeof(lscir_value_t*) * 2);
+  args[0]                    = x;
+  args[1]                    = xs;
+  lscir_value_t* v           = lsmalloc(sizeof(lscir_value_t));
+  *v = (lscir_value_t){ .kind = LCIR_VAL_CONSTR, .constr = { .name = ":", .argc = 2 } };
+  v->constr.args = args;
+  return v;
+}
+
+static const lscir_expr_t* opt_mk_if(const lscir_value_t* cond, const lscir_expr_t* then_e,
+                                     const lscir_expr_t* else_e) {
+  lscir_expr_t* e = lsmalloc(sizeof(lscir_expr_t));
+  *e              = (lscir_expr_t){ .kind = LCIR_EXP_IF,
+                                    .ife  = { .cond = cond, .then_e = then_e, .else_e = else_e } };
+  return e;
+}
+
+// --- Rules ---------------------------------------------------------------------
+
+static int opt_size_expr(const lscir_expr_t* e);
+
+static int opt_size_value(const lscir_value_t* v) {
+  int n = 1;
+  switch (v->kind) {
+  case LCIR_VAL_CONSTR:
+    for (int i = 0; i < v->constr.argc; i++)
+      n += opt_size_value(v->constr.args[i]);
+    return n;
+  case LCIR_VAL_NSLIT:
+    for (int i = 0; i < v->nslit.count; i++)
+      n += opt_size_value(v->nslit.vals[i]);
+    return n;
+  case LCIR_VAL_LAM:
+    return n + opt_size_expr(v->lam.body);
+  default:
+    return n;
+  }
+}
+
+static int opt_size_expr(const lscir_expr_t* e) {
+  if (!e)
+    return 0;
+  int n = 1;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return n + opt_size_value(e->v);
+  case LCIR_EXP_LET:
+    return n + opt_size_expr(e->let1.bind) + opt_size_expr(e->let1.body);
+  case LCIR_EXP_APP:
+    n += opt_size_value(e->app.func);
+    for (int i = 0; i < e->app.argc; i++)
+      n += opt_size_value(e->app.args[i]);
+    return n;
+  case LCIR_EXP_IF:
+    return n + opt_size_value(e->ife.cond) + opt_size_expr(e->ife.then_e) +
+           opt_size_expr(e->ife.else_e);
+  case LCIR_EXP_MATCH:
+    n += opt_size_value(e->match1.scrut);
+    for (int i = 0; i < e->match1.casec; i++)
+      n += 1 + opt_size_expr(e->match1.cases[i].body);
+    return n;
+  case LCIR_EXP_EFFAPP:
+    return n + 1 + e->effapp.argc;
+  default:
+    return n;
+  }
+}
+
+static const lscir_expr_t* opt_rule_inline(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind != LCIR_EXP_APP || e->app.func->kind != LCIR_VAL_VAR)
+    return e;
+  int                  at  = -1;
+  const lscir_value_t* lam = opt_known(o, e->app.func, &at);
+  if (!lam || lam->kind != LCIR_VAL_LAM || opt_size_value(lam) > OPT_INLINE_SIZE)
+    return e;
+  // The lambda was written where the scope ended just below its own let
+  if (!opt_movable(o, lam, at))
+    return e;
+  o->changed++;
+  return opt_mk_app(lam, e->app.argc, e->app.args);
+}
+
+static const lscir_expr_t* opt_rule_beta(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind == LCIR_EXP_LET) {
+    const lscir_expr_t* body = e->let1.body;
+    if (body && body->kind == LCIR_EXP_VAL && body->v->kind == LCIR_VAL_VAR &&
+        strcmp(body->v->var, e->let1.var) == 0) {
+      o->changed++;
+      return e->let1.bind;
+    }
+    return e;
+  }
+  if (e->kind != LCIR_EXP_APP || e->app.func->kind != LCIR_VAL_LAM || e->app.argc < 1)
+    return e;
+  const lscir_value_t* lam   = e->app.func;
+  const char*          param = lam->lam.param;
+  // The remaining arguments are evaluated inside the new let, so they must not see param
+  for (int i = 1; i < e->app.argc; i++)
+    if (opt_value_mentions(e->app.args[i], param))
+      return e;
+  o->changed++;
+  const lscir_expr_t* body = lam->lam.body;
+  if (e->app.argc > 1) {
+    const char* t = opt_gensym();
+    body = opt_mk_let(t, body, opt_mk_app(opt_mk_var(t), e->app.argc - 1, e->app.args + 1));
+  }
+  return opt_mk_let(param, opt_mk_val(e->app.args[0]), body);
+}
+
+// Integer literal value of v (directly or through a let), if any
+static int opt_int_of(const opt_t* o, const lscir_value_t* v, long long* out) {
+  const lscir_value_t* k = opt_known(o, v, NULL);
+  if (!k || k->kind != LCIR_VAL_INT)
+    return 0;
+  *out = k->ival;
+  return 1;
+}
+
+// Truth of a known if condition, as lsrt_truthy decides it: 1, 0, or -1 when unknown
+static int opt_truth_of(const opt_t* o, const lscir_value_t* v) {
+  const lscir_value_t* k = opt_known(o, v, NULL);
+  if (!k)
+    return -1;
+  if (k->kind == LCIR_VAL_INT)
+    return k->ival != 0;
+  if (k->kind == LCIR_VAL_CONSTR && k->constr.argc == 0) {
+    if (strcmp(k->constr.name, "true") == 0)
+      return 1;
+    if (strcmp(k->constr.name, "false") == 0)
+      return 0;
+  }
+  return -1;
+}
+
+static const lscir_expr_t* opt_rule_fold(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind == LCIR_EXP_IF) {
+    int c = opt_truth_of(o, e->ife.cond);
+    if (c < 0)
+      return e;
+    o->changed++;
+    return c ? e->ife.then_e : e->ife.else_e;
+  }
+  if (e->kind != LCIR_EXP_APP || e->app.func->kind != LCIR_VAL_VAR || e->app.argc != 2)
+    return e;
+  const char* f = e->app.func->var;
+  long long   a, b;
+  if (opt_lookup(o, f) >= 0 || !opt_int_of(o, e->app.args[0], &a) ||
+      !opt_int_of(o, e->app.args[1], &b))
+    return e;
+  // The builtins work on C ints; leave anything that could overflow to run time
+  if (a < INT_MIN || a > INT_MAX || b < INT_MIN || b > INT_MAX)
+    return e;
+  const lscir_value_t* r = NULL;
+  if (strcmp(f, "add") == 0 && a + b >= INT_MIN && a + b <= INT_MAX)
+    r = opt_mk_int(a + b);
+  else if (strcmp(f, "sub") == 0 && a - b >= INT_MIN && a - b <= INT_MAX)
+    r = opt_mk_int(a - b);
+  else if (strcmp(f, "lt") == 0)
+    r = opt_mk_constr0(a < b ? "true" : "false");
+  if (!r)
+    return e;
+  o->changed++;
+  return opt_mk_val(r);
+}
+
+// Pattern variables bound by a static match
+typedef struct opt_binds {
+  const char**          names;
+  const lscir_value_t** vals;
+  int                   count;
+  int                   cap;
+} opt_binds_t;
+
+static void opt_binds_add(opt_binds_t* bs, const char* name, const lscir_value_t* v) {
+  if (bs->count == bs->cap) {
+    bs->cap   = bs->cap ? bs->cap * 2 : 4;
+    bs->names = lsrealloc(bs->names, sizeof(const char*) * bs->cap);
+    bs->vals  = lsrealloc(bs->vals, sizeof(lscir_value_t*) * bs->cap);
+  }
+  bs->names[bs->count]  = name;
+  bs->vals[bs->count++] = v;
+}
+
+// 1 when p matches v, 0 when it cannot, -1 when that is only known at run time
+static int opt_pat_match(const lscir_pat_t* p, const lscir_value_t* v, opt_binds_t* bs) {
+  if (!p || p->kind == LCIR_PAT_WILDCARD)
+    return 1;
+  if (p->kind == LCIR_PAT_VAR) {
+    opt_binds_add(bs, p->var, v);
+    return 1;
+  }
+  switch (v->kind) {
+  case LCIR_VAL_INT:
+    return p->kind == LCIR_PAT_INT ? p->ival == v->ival : 0;
+  case LCIR_VAL_STR:
+    return p->kind == LCIR_PAT_STR ? strcmp(p->sval, v->sval) == 0 : 0;
+  case LCIR_VAL_CONSTR:
+    if (p->kind != LCIR_PAT_CONSTR)
+      return 0;
+    if (strcmp(p->constr.name, v->constr.name) != 0 || p->constr.subc != v->constr.argc)
+      return 0;
+    for (int i = 0; i < p->constr.subc; i++) {
+      int r = opt_pat_match(p->constr.subpats[i], v->constr.args[i], bs);
+      if (r != 1)
+        return r;
+    }
+    return 1;
+  case LCIR_VAL_LAM:
+  case LCIR_VAL_NSLIT:
+    return 0;
+  default:
+    return -1;
+  }
+}
+
+static const lscir_expr_t* opt_rule_case(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind != LCIR_EXP_MATCH)
+    return e;
+  int                  at = o->count;
+  const lscir_value_t* v  = opt_known(o, e->match1.scrut, &at);
+  if (!v || v->kind == LCIR_VAL_VAR)
+    return e;
+  for (int i = 0; i < e->match1.casec; i++) {
+    opt_binds_t bs = { 0 };
+    int         r  = opt_pat_match(e->match1.cases[i].pat, v, &bs);
+    if (r < 0)
+      return e;
+    if (r == 0)
+      continue;
+    // Pattern variables become lets; a later one must not capture an earlier one's value
+    for (int j = 0; j < bs.count; j++) {
+      if (!opt_movable(o, bs.vals[j], at))
+        return e;
+      for (int k = 0; k < j; k++)
+        if (opt_value_mentions(bs.vals[j], bs.names[k]))
+          return e;
+    }
+    const lscir_expr_t* body = e->match1.cases[i].body;
+    for (int j = bs.count - 1; j >= 0; j--)
+      body = opt_mk_let(bs.names[j], opt_mk_val(bs.vals[j]), body);
+    o->changed++;
+    return body;
+  }
+  // No case matches: keep the run-time "match: no case" failure
+  return e;
+}
+
+// Expressions whose evaluation has no effect beyond its value
+static int opt_pure(const lscir_expr_t* e) {
+  if (!e)
+    return 1;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return 1;
+  case LCIR_EXP_LET:
+    return opt_pure(e->let1.bind) && opt_pure(e->let1.body);
+  case LCIR_EXP_IF:
+    return opt_pure(e->ife.then_e) && opt_pure(e->ife.else_e);
+  case LCIR_EXP_MATCH:
+    for (int i = 0; i < e->match1.casec; i++)
+      if (!opt_pure(e->match1.cases[i].body))
+        return 0;
+    return 1;
+  default:
+    // Applications may perform effects; tokens and effect applications carry them
+    return 0;
+  }
+}
+
+// add/sub/lt, which denote the builtins while unbound by the program (see opt_rule_fold)
+static int opt_prim_name(const char* f) {
+  return strcmp(f, "add") == 0 || strcmp(f, "sub") == 0 || strcmp(f, "lt") == 0;
+}
+
+// The binding of name by the last of the lets top is under, or NULL
+static const lscir_expr_t* opt_let_bind(const lscir_expr_t* top, const char* name) {
+  const lscir_expr_t* bind = NULL;
+  for (const lscir_expr_t* e = top; e && e->kind == LCIR_EXP_LET; e = e->let1.body)
+    if (strcmp(e->let1.var, name) == 0)
+      bind = e->let1.bind;
+  return bind;
+}
+
+// The function v as bound by the lets of top or else by the scope: NULL unless it is a lambda
+static const lscir_value_t* opt_let_fn(const opt_t* o, const lscir_expr_t* top,
+                                       const lscir_value_t* v) {
+  if (v->kind == LCIR_VAL_VAR) {
+    const lscir_expr_t* bind = opt_let_bind(top, v->var);
+    v = !bind                        ? opt_known(o, v, NULL)
+        : bind->kind == LCIR_EXP_VAL ? bind->v
+                                     : NULL;
+  }
+  return v && v->kind == LCIR_VAL_LAM ? v : NULL;
+}
+
+static int opt_pure_lam(const opt_t* o, const lscir_expr_t* top, opt_bound_t* b,
+                        const lscir_value_t* lam, int depth);
+
+// Like opt_pure, but applications of add/sub/lt and of pure functions bound by the lets of top
+// or by the scope count as pure too. Variables bound in between (b) are unknown functions.
+static int opt_pure_calls(const opt_t* o, const lscir_expr_t* top, opt_bound_t* b,
+                          const lscir_expr_t* e, int depth) {
+  if (!e)
+    return 1;
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    // A lambda value may be applied by the caller of the function it is returned from
+    return e->v->kind != LCIR_VAL_LAM || opt_pure_lam(o, top, b, e->v, depth);
+  case LCIR_EXP_LET: {
+    if (!opt_pure_calls(o, top, b, e->let1.bind, depth))
+      return 0;
+    opt_bound_push(b, e->let1.var);
+    int r = opt_pure_calls(o, top, b, e->let1.body, depth);
+    b->count--;
+    return r;
+  }
+  case LCIR_EXP_IF:
+    return opt_pure_calls(o, top, b, e->ife.then_e, depth) &&
+           opt_pure_calls(o, top, b, e->ife.else_e, depth);
+  case LCIR_EXP_APP: {
+    const lscir_value_t* f = e->app.func;
+    if (f->kind == LCIR_VAL_LAM)
+      return opt_pure_lam(o, top, b, f, depth);
+    if (f->kind != LCIR_VAL_VAR || opt_bound_has(b, f->var))
+      return 0;
+    if (opt_prim_name(f->var) && !opt_let_bind(top, f->var) && opt_lookup(o, f->var) < 0)
+      return 1;
+    // Lets are not recursive, but a let may refer to an earlier binding of its own name
+    const lscir_value_t* lam = depth < 8 ? opt_let_fn(o, top, f) : NULL;
+    opt_bound_t          nb  = { 0 };
+    return lam && opt_pure_lam(o, top, &nb, lam, depth + 1);
+  }
+  default:
+    return 0;
+  }
+}
+
+static int opt_pure_lam(const opt_t* o, const lscir_expr_t* top, opt_bound_t* b,
+                        const lscir_value_t* lam, int depth) {
+  opt_bound_push(b, lam->lam.param);
+  int r = opt_pure_calls(o, top, b, lam->lam.body, depth);
+  b->count--;
+  return r;
+}
+
+// Whether applying the function v, as bound by the lets of top or by the scope, has no effect
+static int opt_pure_fn(const opt_t* o, const lscir_expr_t* top, const lscir_value_t* v) {
+  const lscir_value_t* lam = opt_let_fn(o, top, v);
+  opt_bound_t          b   = { 0 };
+  return lam && opt_pure_lam(o, top, &b, lam, 0);
+}
+
+static const lscir_expr_t* opt_rule_dce(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind != LCIR_EXP_LET || o->scope[o->count - 1].uses > 0 || !opt_pure(e->let1.bind))
+    return e;
+  o->changed++;
+  return e->let1.body;
+}
+
+// --- Fusion --------------------------------------------------------------------
+
+typedef enum { OPT_LIST_NONE, OPT_LIST_MAP, OPT_LIST_FILTER, OPT_LIST_FOLDR } opt_list_t;
+
+// List combinator applied by the application e: unbound map and filter with two arguments,
+// unbound foldr with three
+static opt_list_t opt_list_op(const opt_t* o, const lscir_expr_t* e) {
+  if (e->kind != LCIR_EXP_APP || e->app.func->kind != LCIR_VAL_VAR)
+    return OPT_LIST_NONE;
+  const char* f = e->app.func->var;
+  if (opt_lookup(o, f) >= 0)
+    return OPT_LIST_NONE;
+  if (e->app.argc == 2 && strcmp(f, "map") == 0)
+    return OPT_LIST_MAP;
+  if (e->app.argc == 2 && strcmp(f, "filter") == 0)
+    return OPT_LIST_FILTER;
+  if (e->app.argc == 3 && strcmp(f, "foldr") == 0)
+    return OPT_LIST_FOLDR;
+  return OPT_LIST_NONE;
+}
+
+// The consumer of a fused pipeline: map f, filter p or foldr k z, with fn the variable its
+// function is bound to
+typedef struct opt_consumer {
+  opt_list_t           op;
+  const lscir_value_t* fn;
+} opt_consumer_t;
+
+// What the consumer does with an element x the producer conses onto acc
+static const lscir_expr_t* opt_fuse_elem(const opt_consumer_t* c, const lscir_value_t* x,
+                                         const lscir_value_t* acc) {
+  const lscir_value_t* xa[2] = { x, acc };
+  const lscir_value_t** args = lsmalloc(sizeof(xa));
+  memcpy(args, xa, sizeof(xa));
+  if (c->op == OPT_LIST_FOLDR)
+    return opt_mk_app(c->fn, 2, args);
+  const char* t = opt_gensym();
+  if (c->op == OPT_LIST_MAP)
+    return opt_mk_let(t, opt_mk_app(c->fn, 1, args), opt_mk_val(opt_mk_cons(opt_mk_var(t), acc)));
+  return opt_mk_let(t, opt_mk_app(c->fn, 1, args),
+                    opt_mk_if(opt_mk_var(t), opt_mk_val(opt_mk_cons(x, acc)), opt_mk_val(acc)));
+}
+
+// Body of a foldr step that builds a list on acc, with every (: x acc) it returns replaced by
+// what the consumer does with x; NULL when the body uses acc in any other way
+static const lscir_expr_t* opt_fuse_tail(const lscir_expr_t* e, const char* acc,
+                                         const opt_consumer_t* c) {
+  switch (e->kind) {
+  case LCIR_EXP_VAL: {
+    const lscir_value_t* v = e->v;
+    if (v->kind == LCIR_VAL_VAR && strcmp(v->var, acc) == 0)
+      return e;
+    if (v->kind != LCIR_VAL_CONSTR || v->constr.argc != 2 || strcmp(v->constr.name, ":") != 0)
+      return NULL;
+    const lscir_value_t* tl = v->constr.args[1];
+    if (tl->kind != LCIR_VAL_VAR || strcmp(tl->var, acc) != 0 ||
+        opt_value_mentions(v->constr.args[0], acc))
+      return NULL;
+    return opt_fuse_elem(c, v->constr.args[0], tl);
+  }
+  case LCIR_EXP_LET: {
+    if (strcmp(e->let1.var, acc) == 0 || opt_expr_mentions(e->let1.bind, acc))
+      return NULL;
+    const lscir_expr_t* body = opt_fuse_tail(e->let1.body, acc, c);
+    return body ? opt_mk_let(e->let1.var, e->let1.bind, body) : NULL;
+  }
+  case LCIR_EXP_IF: {
+    if (opt_value_mentions(e->ife.cond, acc))
+      return NULL;
+    const lscir_expr_t* then_e = opt_fuse_tail(e->ife.then_e, acc, c);
+    const lscir_expr_t* else_e = then_e ? opt_fuse_tail(e->ife.else_e, acc, c) : NULL;
+    return else_e ? opt_mk_if(e->ife.cond, then_e, else_e) : NULL;
+  }
+  default:
+    return NULL;
+  }
+}
+
+// The producer p (map g xs, filter q xs or a list-building foldr s [] xs, possibly under the
+// lets of top) rewritten to foldr over xs with the consumer applied to every element it yields,
+// or NULL
+static const lscir_expr_t* opt_fuse_into(const opt_t* o, const lscir_expr_t* top,
+                                         const lscir_expr_t* p, const opt_consumer_t* c,
+                                         const lscir_value_t* z) {
+  if (p->kind == LCIR_EXP_LET) {
+    const char* v = p->let1.var;
+    if (strcmp(v, "map") == 0 || strcmp(v, "filter") == 0 || strcmp(v, "foldr") == 0)
+      return NULL;
+    const lscir_expr_t* body = opt_fuse_into(o, top, p->let1.body, c, z);
+    return body ? opt_mk_let(v, p->let1.bind, body) : NULL;
+  }
+  opt_list_t op = opt_list_op(o, p);
+  if (op == OPT_LIST_NONE)
+    return NULL;
+  // The producer's function runs interleaved with the consumer's once fused
+  if (!opt_pure_fn(o, top, p->app.args[0]))
+    return NULL;
+  const lscir_value_t* const* args = p->app.args;
+  const char*                 x    = NULL;
+  const char*                 acc  = NULL;
+  const lscir_expr_t*         body = NULL;
+  if (op == OPT_LIST_MAP || op == OPT_LIST_FILTER) {
+    // \x -> \acc -> let t = g x in <t onto acc>, or let t = q x in if t then <x onto acc> else acc
+    x                        = opt_gensym();
+    acc                      = opt_gensym();
+    const char*           t  = opt_gensym();
+    const lscir_value_t** xv = lsmalloc(sizeof(lscir_value_t*));
+    xv[0]                    = opt_mk_var(x);
+    if (op == OPT_LIST_MAP)
+      body = opt_fuse_elem(c, opt_mk_var(t), opt_mk_var(acc));
+    else
+      body = opt_mk_if(opt_mk_var(t), opt_fuse_elem(c, xv[0], opt_mk_var(acc)),
+                       opt_mk_val(opt_mk_var(acc)));
+    body = opt_mk_let(t, opt_mk_app(args[0], 1, xv), body);
+  } else if (op == OPT_LIST_FOLDR) {
+    const lscir_value_t* s   = args[0];
+    const lscir_value_t* nil = args[1];
+    if (nil->kind != LCIR_VAL_CONSTR || nil->constr.argc != 0 ||
+        strcmp(nil->constr.name, "[]") != 0)
+      return NULL;
+    if (s->kind != LCIR_VAL_LAM || s->lam.body->kind != LCIR_EXP_VAL ||
+        s->lam.body->v->kind != LCIR_VAL_LAM)
+      return NULL;
+    x    = s->lam.param;
+    acc  = s->lam.body->v->lam.param;
+    body = opt_fuse_tail(s->lam.body->v->lam.body, acc, c);
+    if (!body)
+      return NULL;
+  } else {
+    return NULL;
+  }
+  const lscir_value_t** fargs = lsmalloc(sizeof(lscir_value_t*) * 3);
+  fargs[0]                    = opt_mk_lam(x, opt_mk_val(opt_mk_lam(acc, body)));
+  fargs[1]                    = z;
+  fargs[2]                    = args[op == OPT_LIST_FOLDR ? 2 : 1];
+  return opt_mk_app(opt_mk_var("foldr"), 3, fargs);
+}
+
+// Variable to bind v to before it is moved into a fused step, or NULL when v is a literal
+static const char* opt_fuse_var(const lscir_value_t* v) {
+  if (v->kind == LCIR_VAL_INT || v->kind == LCIR_VAL_STR ||
+      (v->kind == LCIR_VAL_CONSTR && v->constr.argc == 0))
+    return NULL;
+  return opt_gensym();
+}
+
+static const lscir_expr_t* opt_rule_fuse(opt_t* o, const lscir_expr_t* e) {
+  if (e->kind != LCIR_EXP_LET || o->scope[o->count - 1].uses != 1 || !e->let1.body)
+    return e;
+  const lscir_expr_t* body = e->let1.body;
+  opt_list_t          op   = opt_list_op(o, body);
+  if (op == OPT_LIST_NONE)
+    return e;
+  const lscir_value_t* const* args = body->app.args;
+  const lscir_value_t*        last = args[body->app.argc - 1];
+  if (last->kind != LCIR_VAL_VAR || strcmp(last->var, e->let1.var) != 0 ||
+      !opt_pure_fn(o, NULL, args[0]))
+    return e;
+  // The consumer's function and seed move into the producer's steps, under its binders: bind
+  // them to fresh variables outside instead
+  const char*          fv = opt_fuse_var(args[0]);
+  const char*          zv = op == OPT_LIST_FOLDR ? opt_fuse_var(args[1]) : NULL;
+  opt_consumer_t       c  = { .op = op, .fn = fv ? opt_mk_var(fv) : args[0] };
+  const lscir_value_t* z  = op != OPT_LIST_FOLDR ? opt_mk_constr0("[]")
+                            : zv                 ? opt_mk_var(zv)
+                                                 : args[1];
+  const lscir_expr_t*  r  = opt_fuse_into(o, e->let1.bind, e->let1.bind, &c, z);
+  if (!r)
+    return e;
+  if (zv)
+    r = opt_mk_let(zv, opt_mk_val(args[1]), r);
+  if (fv)
+    r = opt_mk_let(fv, opt_mk_val(args[0]), r);
+  o->changed++;
+  return r;
+}
+
+static const opt_pass_t opt_passes[] = {
+  { "fuse", 1, opt_rule_fuse }, { "inline", 2, opt_rule_inline }, { "beta", 1, opt_rule_beta },
+  { "fold", 1, opt_rule_fold }, { "case", 1, opt_rule_case },     { "dce", 1, opt_rule_dce },
+};
+
+const lscir_prog_t* lscir_optimize(const lscir_prog_t* cir, int level) {
+  if (!cir || !cir->root || level <= 0)
+    return cir;
+  int                 rounds = level >= 2 ? 8 : 2;
+  const lscir_expr_t* root   = cir->root;
+  opt_t               o      = { 0 };
+  for (int r = 0; r < rounds; r++) {
+    int changed = 0;
+    for (size_t i = 0; i < sizeof(opt_passes) / sizeof(opt_passes[0]); i++) {
+      if (opt_passes[i].level > level)
+        continue;
+      o.count   = 0;
+      o.changed = 0;
+      root      = opt_expr(&o, root, opt_passes[i].rule);
+      changed += o.changed;
+    }
+    if (changed == 0)
+      break;
+  }
+  lscir_prog_t* out = lsmalloc(sizeof(lscir_prog_t));
+  *out              = (lscir_prog_t){ .ast = cir->ast, .root = root };
+  return out;
+}
@@ -0,0 +1,221 @@
+#include <string.h>
+
+#include "coreir/cir_value.h"
+#include "common/malloc.h"
+
+const rv_t* rv_int(long long x) {
+  rv_t* v = lsmalloc(sizeof(rv_t));
+  v->kind = RV_INT;
+  v->ival = x;
+  return v;
+}
+const rv_t* rv_str(const char* s) {
+  rv_t* v = lsmalloc(sizeof(rv_t));
+  v->kind = RV_STR;
+  v->sval = s;
+  return v;
+}
+const rv_t* rv_unit(void) {
+  static rv_t u = { .kind = RV_UNIT };
+  return &u;
+}
+const rv_t* rv_tok(void) {
+  static rv_t t = { .kind = RV_TOKEN };
+  return &t;
+}
+const rv_t* rv_sym(const char* s) {
+  rv_t* v = lsmalloc(sizeof(rv_t));
+  v->kind = RV_SYMBOL;
+  v->sym  = s;
+  return v;
+}
+const rv_t* rv_bottom(const char* msg, int argc, const rv_t* const* args) {
+  rv_t* v        = lsmalloc(sizeof(rv_t));
+  v->kind        = RV_BOTTOM;
+  v->bot.message = msg;
+  v->bot.argc    = argc;
+  v->bot.args    = args;
+  return v;
+}
+const rv_t* rv_constr(const char* name, int argc, const rv_t* const* args) {
+  rv_t* v     = lsmalloc(sizeof(rv_t));
+  v->kind     = RV_CONSTR;
+  v->con.name = name;
+  v->con.argc = argc;
+  v->con.args = args;
+  return v;
+}
+
+int rv_truthy(const rv_t* v) {
+  if (!v)
+    return 0;
+  switch (v->kind) {
+  case RV_INT:
+    return v->ival != 0;
+  case RV_SYMBOL:
+    return (strcmp(v->sym, "true") == 0) ? 1 : (strcmp(v->sym, "false") == 0 ? 0 : 1);
+  case RV_UNIT:
+    return 0;
+  default:
+    return 1;
+  }
+}
+
+static void print_value_inline(FILE* outfp, const rv_t* v) {
+  if (!v) {
+    fprintf(outfp, "<v>");
+    return;
+  }
+  switch (v->kind) {
+  case RV_UNIT:
+    fprintf(outfp, "()");
+    return;
+  case RV_INT:
+    fprintf(outfp, "%lld", v->ival);
+    return;
+  case RV_STR:
+    fprintf(outfp, "%s", v->sval);
+    return;
+  case RV_SYMBOL:
+    fprintf(outfp, "%s", v->sym);
+    return;
+  case RV_CONSTR: {
+    if (v->con.argc == 0) {
+      fprintf(outfp, "%s", v->con.name ? v->con.name : "<con>");
+      return;
+    }
+    fprintf(outfp, "(%s", v->con.name ? v->con.name : "<con>");
+    for (int j = 0; j < v->con.argc; j++) {
+      fprintf(outfp, " ");
+      print_value_inline(outfp, v->con.args[j]);
+    }
+    fprintf(outfp, ")");
+    return;
+  }
+  case RV_BOTTOM: {
+    fprintf(outfp, "<bottom msg=\"%s\"", v->bot.message ? v->bot.message : "");
+    if (v->bot.argc > 0 && v->bot.args) {
+      fprintf(outfp, " args=[");
+      for (int i = 0; i < v->bot.argc; i++) {
+        if (i)
+          fprintf(outfp, ", ");
+        print_value_inline(outfp, v->bot.args[i]);
+      }
+      fprintf(outfp, "]");
+    }
+    fprintf(outfp, ">");
+    return;
+  }
+  default:
+    fprintf(outfp, "<v>");
+    return;
+  }
+}
+
+void rv_print(FILE* outfp, const rv_t* v) {
+  switch (v->kind) {
+  case RV_UNIT:
+    fprintf(outfp, "()\n");
+    return;
+  case RV_INT:
+    fprintf(outfp, "%lld\n", v->ival);
+    return;
+  case RV_STR:
+    fprintf(outfp, "%s\n", v->sval);
+    return;
+  case RV_SYMBOL:
+    fprintf(outfp, "%s\n", v->sym);
+    return;
+  case RV_LAM:
+    fprintf(outfp, "<lam>\n");
+    return;
+  case RV_TOKEN:
+    fprintf(outfp, "<token>\n");
+    return;
+  case RV_NATFUN:
+    fprintf(outfp, "<fun %s/%d:%d>\n", v->nf.name, v->nf.arity, v->nf.capc);
+    return;
+  case RV_CONSTR: {
+    if ((strcmp(v->con.name, "[]") == 0 && v->con.argc == 0) ||
+        (strcmp(v->con.name, "Nil") == 0 && v->con.argc == 0)) {
+      fprintf(outfp, "[]\n");
+      return;
+    }
+    if ((strcmp(v->con.name, ":") == 0 || strcmp(v->con.name, "Cons") == 0) && v->con.argc == 2) {
+      const rv_t*  cur = v;
+      int          cap = 8, cnt = 0;
+      const rv_t** elems = lsmalloc(sizeof(rv_t*) * cap);
+      while (cur && cur->kind == RV_CONSTR &&
+             (strcmp(cur->con.name, ":") == 0 || strcmp(cur->con.name, "Cons") == 0) &&
+             cur->con.argc == 2) {
+        if (cnt >= cap) {
+          cap *= 2;
+          const rv_t** tmp = lsmalloc(sizeof(rv_t*) * cap);
+          for (int i = 0; i < cnt; i++)
+            tmp[i] = elems[i];
+          elems = tmp;
+        }
+        elems[cnt++] = cur->con.args[0];
+        cur          = cur->con.args[1];
+      }
+      int is_nil = (cur && cur->kind == RV_CONSTR &&
+                    ((strcmp(cur->con.name, "[]") == 0 && cur->con.argc == 0) ||
+                     (strcmp(cur->con.name, "Nil") == 0 && cur->con.argc == 0)));
+      if (is_nil) {
+        fprintf(outfp, "[");
+        for (int i = 0; i < cnt; i++) {
+          if (i)
+            fprintf(outfp, ", ");
+          const rv_t* e = elems[i];
+          switch (e->kind) {
+          case RV_INT:
+            fprintf(outfp, "%lld", e->ival);
+            break;
+          case RV_STR:
+            fprintf(outfp, "%s", e->sval);
+            break;
+          case RV_SYMBOL:
+            fprintf(outfp, "%s", e->sym);
+            break;
+          case RV_UNIT:
+            fprintf(outfp, "()");
+            break;
+          default:
+            fprintf(outfp, "<v>");
+          }
+        }
+        fprintf(outfp, "]\n");
+        return;
+      }
+    }
+    fprintf(outfp, "(%s", v->con.name);
+    for (int i = 0; i < v->con.argc; i++) {
+      fprintf(outfp, " ");
+      const rv_t* e = v->con.args[i];
+      switch (e->kind) {
+      case RV_INT:
+        fprintf(outfp, "%lld", e->ival);
+        break;
+      case RV_STR:
+        fprintf(outfp, "%s", e->sval);
+        break;
+      case RV_SYMBOL:
+        fprintf(outfp, "%s", e->sym);
+        break;
+      case RV_UNIT:
+        fprintf(outfp, "()");
+        break;
+      default:
+        fprintf(outfp, "<v>");
+        break;
+      }
+    }
+    fprintf(outfp, ")\n");
+    return;
+  case RV_BOTTOM:
+    print_value_inline(outfp, v);
+    fprintf(outfp, "\n");
+    return;
+  }
+  }
+}
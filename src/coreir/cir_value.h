@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdio.h>
+
+// Runtime values of the Core IR evaluators, shared by the tree-walking evaluator
+// (cir_eval_runtime.c) and the bytecode VM (cir_vm.c).
+
+typedef enum {
+  RV_INT,
+  RV_STR,
+  RV_UNIT,
+  RV_TOKEN,
+  RV_LAM,
+  RV_SYMBOL,
+  RV_NATFUN,
+  RV_CONSTR,
+  RV_BOTTOM
+} rv_kind_t;
+
+typedef struct rv       rv_t;
+typedef struct rx_value rx_value_t; // tree-walking evaluator: resolved lambda
+typedef struct frame    frame_t;    // tree-walking evaluator: variable frame
+typedef struct vm_func  vm_func_t;  // VM: compiled lambda body
+typedef struct vm_frame vm_frame_t; // VM: register file captured by closures
+
+struct rv {
+  rv_kind_t kind;
+  union {
+    long long   ival;
+    const char* sval;
+    struct {
+      const rx_value_t* fn;
+      frame_t*          env;
+    } lam;
+    struct { // RV_LAM built by the VM
+      const vm_func_t* fn;
+      vm_frame_t*      env;
+    } clo;
+    const char* sym;
+    struct {
+      const char*        name;
+      int                arity;
+      int                capc;
+      const rv_t* const* caps;
+    } nf;
+    struct {
+      const char*        name;
+      int                argc;
+      const rv_t* const* args;
+    } con;
+    struct { // internal bottom representation for runtime evaluator
+      const char*        message;
+      int                argc;
+      const rv_t* const* args;
+    } bot;
+  };
+};
+
+const rv_t* rv_int(long long x);
+const rv_t* rv_str(const char* s);
+const rv_t* rv_unit(void);
+const rv_t* rv_tok(void);
+const rv_t* rv_sym(const char* s);
+const rv_t* rv_bottom(const char* msg, int argc, const rv_t* const* args);
+const rv_t* rv_constr(const char* name, int argc, const rv_t* const* args);
+
+/** Truthiness used by `if`: non-zero ints, symbols other than false, anything but unit */
+int rv_truthy(const rv_t* v);
+
+/** Print a final program value in the form expected by the Core IR tests */
+void rv_print(FILE* outfp, const rv_t* v);
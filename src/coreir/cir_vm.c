@@ -0,0 +1,452 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "coreir/cir_internal.h"
+#include "coreir/cir_value.h"
+#include "coreir/coreir.h"
+#include "common/malloc.h"
+
+/*
+ * Register bytecode VM for Core IR.
+ *
+ * Each lambda body (and the program root) compiles to one vm_func_t. Its parameter, its lets
+ * and the temporaries of ANF operands live in numbered registers of a flat frame. Variables of
+ * enclosing lambdas are reached through the closure's captured frame chain (VM_UPVAL), so no
+ * name lookup is left at run time. Literals are materialized once into the constant pool.
+ *
+ * Evaluation matches lscir_eval (cir_eval_runtime.c) value for value: lambdas take exactly one
+ * argument, unknown variables are symbols and only wildcard or variable match cases are taken.
+ * Effect applications are calls in both (and in the C backend); the token only orders them.
+ */
+
+// Instruction stream: an opcode word followed by its operands.
+typedef enum {
+  VM_CONST,   // dst k             r[dst] = consts[k]
+  VM_MOVE,    // dst src           r[dst] = r[src]
+  VM_UPVAL,   // dst depth slot    r[dst] = register slot of the frame depth closures out
+  VM_CONSTR,  // dst k argc r...   r[dst] = names[k] applied to the argument registers
+  VM_CLOSURE, // dst f             r[dst] = closure of funcs[f] over the current frame
+  VM_CALL,    // dst f argc r...   r[dst] = r[f] applied to the argument registers
+  VM_JMPF,    // cond target       jump when r[cond] is not truthy
+  VM_JMP,     // target
+  VM_NOMATCH, // dst scrut         r[dst] = "match: no case" bottom (reported on stderr)
+  VM_RET,     // src
+  VM_NOPS
+} vm_op_t;
+
+struct vm_func {
+  const int32_t* code;
+  int            nregs;
+  int            captured; // the body creates closures, so its frame must outlive the call
+};
+
+struct vm_frame {
+  vm_frame_t* up;
+  const rv_t* regs[0];
+};
+
+typedef struct vm_prog {
+  const rv_t**      consts;
+  int               nconsts;
+  const char**      names;
+  int               nnames;
+  const vm_func_t** funcs;
+  int               nfuncs;
+} vm_prog_t;
+
+// --- Compiler ----------------------------------------------------------------
+
+typedef struct vm_scope {
+  const char* name;
+  int         level;
+  int         reg;
+} vm_scope_t;
+
+typedef struct vm_comp {
+  vm_prog_t*  prog;
+  int         cap_consts;
+  int         cap_names;
+  int         cap_funcs;
+  vm_scope_t* scope;
+  int         nscope;
+  int         cap_scope;
+} vm_comp_t;
+
+typedef struct vm_fcomp {
+  vm_comp_t* comp;
+  int32_t*   code;
+  int        ncode;
+  int        cap_code;
+  int        nregs; // registers are never reused: closures may read any variable register
+  int        level;
+  int        captured;
+} vm_fcomp_t;
+
+#define VM_GROW(ptr, n, cap, type)                                                                 \
+  do {                                                                                             \
+    if ((n) == (cap)) {                                                                            \
+      (cap) = (cap) ? (cap) * 2 : 16;                                                              \
+      (ptr) = (type*)lsrealloc((void*)(ptr), sizeof(type) * (cap));                                \
+    }                                                                                              \
+  } while (0)
+
+static void vm_emit(vm_fcomp_t* fc, int32_t w) {
+  VM_GROW(fc->code, fc->ncode, fc->cap_code, int32_t);
+  fc->code[fc->ncode++] = w;
+}
+
+static int vm_reg(vm_fcomp_t* fc) { return fc->nregs++; }
+
+static int vm_const(vm_comp_t* c, const rv_t* v) {
+  vm_prog_t* p = c->prog;
+  VM_GROW(p->consts, p->nconsts, c->cap_consts, const rv_t*);
+  p->consts[p->nconsts] = v;
+  return p->nconsts++;
+}
+
+static int vm_name(vm_comp_t* c, const char* name) {
+  vm_prog_t* p = c->prog;
+  for (int i = 0; i < p->nnames; i++)
+    if (p->names[i] == name || strcmp(p->names[i], name) == 0)
+      return i;
+  VM_GROW(p->names, p->nnames, c->cap_names, const char*);
+  p->names[p->nnames] = name;
+  return p->nnames++;
+}
+
+static void vm_scope_push(vm_comp_t* c, const char* name, int level, int reg) {
+  VM_GROW(c->scope, c->nscope, c->cap_scope, vm_scope_t);
+  c->scope[c->nscope++] = (vm_scope_t){ .name = name, .level = level, .reg = reg };
+}
+
+static void vm_compile_expr(vm_fcomp_t* fc, const lscir_expr_t* e, int dst);
+static int  vm_compile_func(vm_comp_t* c, const char* param, const lscir_expr_t* body, int level);
+
+static void vm_compile_value_into(vm_fcomp_t* fc, const lscir_value_t* v, int dst);
+
+// Register holding v: a variable of the current frame is used in place.
+static int vm_compile_value(vm_fcomp_t* fc, const lscir_value_t* v) {
+  if (v->kind == LCIR_VAL_VAR) {
+    vm_comp_t* c = fc->comp;
+    for (int i = c->nscope - 1; i >= 0; i--) {
+      if (strcmp(c->scope[i].name, v->var) == 0) {
+        if (c->scope[i].level == fc->level)
+          return c->scope[i].reg;
+        break;
+      }
+    }
+  }
+  int r = vm_reg(fc);
+  vm_compile_value_into(fc, v, r);
+  return r;
+}
+
+static void vm_compile_value_into(vm_fcomp_t* fc, const lscir_value_t* v, int dst) {
+  vm_comp_t* c = fc->comp;
+  switch (v->kind) {
+  case LCIR_VAL_INT:
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_int(v->ival)));
+    return;
+  case LCIR_VAL_STR:
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_str(v->sval)));
+    return;
+  case LCIR_VAL_VAR: {
+    for (int i = c->nscope - 1; i >= 0; i--) {
+      if (strcmp(c->scope[i].name, v->var) != 0)
+        continue;
+      if (c->scope[i].level == fc->level) {
+        vm_emit(fc, VM_MOVE);
+        vm_emit(fc, dst);
+        vm_emit(fc, c->scope[i].reg);
+      } else {
+        vm_emit(fc, VM_UPVAL);
+        vm_emit(fc, dst);
+        vm_emit(fc, fc->level - c->scope[i].level);
+        vm_emit(fc, c->scope[i].reg);
+      }
+      return;
+    }
+    // No implicit mapping to native functions. Treat as plain symbol.
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_sym(v->var)));
+    return;
+  }
+  case LCIR_VAL_CONSTR: {
+    int n = v->constr.argc;
+    if (n == 0) {
+      const rv_t* k =
+          strcmp(v->constr.name, "()") == 0 ? rv_unit() : rv_constr(v->constr.name, 0, NULL);
+      vm_emit(fc, VM_CONST);
+      vm_emit(fc, dst);
+      vm_emit(fc, vm_const(c, k));
+      return;
+    }
+    int* regs = lsmalloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++)
+      regs[i] = vm_compile_value(fc, v->constr.args[i]);
+    vm_emit(fc, VM_CONSTR);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_name(c, v->constr.name));
+    vm_emit(fc, n);
+    for (int i = 0; i < n; i++)
+      vm_emit(fc, regs[i]);
+    return;
+  }
+  case LCIR_VAL_LAM: {
+    int f        = vm_compile_func(c, v->lam.param, v->lam.body, fc->level + 1);
+    fc->captured = 1;
+    vm_emit(fc, VM_CLOSURE);
+    vm_emit(fc, dst);
+    vm_emit(fc, f);
+    return;
+  }
+  case LCIR_VAL_NSLIT:
+    // Namespace literal values have no observable evaluation here; the result is unit
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_unit()));
+    return;
+  }
+}
+
+static void vm_compile_call(vm_fcomp_t* fc, const lscir_value_t* func, int argc,
+                            const lscir_value_t* const* args, int dst) {
+  int  f    = vm_compile_value(fc, func);
+  int* regs = argc > 0 ? lsmalloc(sizeof(int) * argc) : NULL;
+  for (int i = 0; i < argc; i++)
+    regs[i] = vm_compile_value(fc, args[i]);
+  vm_emit(fc, VM_CALL);
+  vm_emit(fc, dst);
+  vm_emit(fc, f);
+  vm_emit(fc, argc);
+  for (int i = 0; i < argc; i++)
+    vm_emit(fc, regs[i]);
+}
+
+static void vm_compile_expr(vm_fcomp_t* fc, const lscir_expr_t* e, int dst) {
+  vm_comp_t* c = fc->comp;
+  if (!e) {
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_unit()));
+    return;
+  }
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    vm_compile_value_into(fc, e->v, dst);
+    return;
+  case LCIR_EXP_LET: {
+    int r = vm_reg(fc);
+    vm_compile_expr(fc, e->let1.bind, r);
+    vm_scope_push(c, e->let1.var, fc->level, r);
+    vm_compile_expr(fc, e->let1.body, dst);
+    c->nscope--;
+    return;
+  }
+  case LCIR_EXP_APP:
+    vm_compile_call(fc, e->app.func, e->app.argc, e->app.args, dst);
+    return;
+  case LCIR_EXP_IF: {
+    int cond = vm_compile_value(fc, e->ife.cond);
+    vm_emit(fc, VM_JMPF);
+    vm_emit(fc, cond);
+    int else_at = fc->ncode;
+    vm_emit(fc, 0);
+    vm_compile_expr(fc, e->ife.then_e, dst);
+    vm_emit(fc, VM_JMP);
+    int end_at = fc->ncode;
+    vm_emit(fc, 0);
+    fc->code[else_at] = fc->ncode;
+    vm_compile_expr(fc, e->ife.else_e, dst);
+    fc->code[end_at] = fc->ncode;
+    return;
+  }
+  case LCIR_EXP_EFFAPP:
+    // The token only orders effects, and instructions run in order: an ordinary call
+    vm_compile_call(fc, e->effapp.func, e->effapp.argc, e->effapp.args, dst);
+    return;
+  case LCIR_EXP_TOKEN:
+    vm_emit(fc, VM_CONST);
+    vm_emit(fc, dst);
+    vm_emit(fc, vm_const(c, rv_tok()));
+    return;
+  case LCIR_EXP_MATCH: {
+    // Only wildcard/variable cases are taken (without binding), so the case is known statically
+    for (int i = 0; i < e->match1.casec; i++) {
+      const lscir_case_t* cs = &e->match1.cases[i];
+      if (!cs->pat || cs->pat->kind == LCIR_PAT_WILDCARD || cs->pat->kind == LCIR_PAT_VAR) {
+        vm_compile_expr(fc, cs->body, dst);
+        return;
+      }
+    }
+    int scrut = vm_compile_value(fc, e->match1.scrut);
+    vm_emit(fc, VM_NOMATCH);
+    vm_emit(fc, dst);
+    vm_emit(fc, scrut);
+    return;
+  }
+  }
+}
+
+static int vm_compile_func(vm_comp_t* c, const char* param, const lscir_expr_t* body, int level) {
+  vm_fcomp_t fc   = { .comp = c, .level = level };
+  int        save = c->nscope;
+  if (param)
+    vm_scope_push(c, param, level, vm_reg(&fc)); // register 0
+  int ret = vm_reg(&fc);
+  vm_compile_expr(&fc, body, ret);
+  vm_emit(&fc, VM_RET);
+  vm_emit(&fc, ret);
+  c->nscope = save;
+
+  vm_func_t* fn = lsmalloc(sizeof(vm_func_t));
+  fn->code      = fc.code;
+  fn->nregs     = fc.nregs;
+  fn->captured  = fc.captured;
+  vm_prog_t* p  = c->prog;
+  VM_GROW(p->funcs, p->nfuncs, c->cap_funcs, const vm_func_t*);
+  p->funcs[p->nfuncs] = fn;
+  return p->nfuncs++;
+}
+
+// --- Interpreter ---------------------------------------------------------------
+
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#else
+#define VM_COMPUTED_GOTO 0
+#endif
+
+// Frames of bodies that create no closures are never referenced after the call returns
+#define VM_STACK_REGS 64
+
+static const rv_t* vm_run(const vm_prog_t* prog, const vm_func_t* fn, vm_frame_t* env,
+                          const rv_t* arg) {
+  const rv_t*  stack_regs[VM_STACK_REGS];
+  vm_frame_t*  frame = NULL;
+  const rv_t** R     = stack_regs;
+  if (fn->captured || fn->nregs > VM_STACK_REGS) {
+    frame     = lsmalloc(sizeof(vm_frame_t) + sizeof(rv_t*) * fn->nregs);
+    frame->up = env;
+    R         = frame->regs;
+  }
+  for (int i = 0; i < fn->nregs; i++)
+    R[i] = NULL;
+  if (arg)
+    R[0] = arg;
+  const int32_t* pc = fn->code;
+
+#if VM_COMPUTED_GOTO
+  static const void* const labels[VM_NOPS] = {
+    [VM_CONST]   = &&op_const,   [VM_MOVE]    = &&op_move,    [VM_UPVAL]   = &&op_upval,
+    [VM_CONSTR]  = &&op_constr,  [VM_CLOSURE] = &&op_closure, [VM_CALL]    = &&op_call,
+    [VM_JMPF]    = &&op_jmpf,    [VM_JMP]     = &&op_jmp,     [VM_NOMATCH] = &&op_nomatch,
+    [VM_RET]     = &&op_ret,
+  };
+#define VM_CASE(op) op_##op:
+#define VM_NEXT goto* labels[*pc++]
+  VM_NEXT;
+#else
+#define VM_CASE(op) case VM_##op:
+#define VM_NEXT continue
+  for (;;) {
+    switch ((vm_op_t)*pc++) {
+#endif
+
+  VM_CASE(const) {
+    R[pc[0]] = prog->consts[pc[1]];
+    pc += 2;
+    VM_NEXT;
+  }
+  VM_CASE(move) {
+    R[pc[0]] = R[pc[1]];
+    pc += 2;
+    VM_NEXT;
+  }
+  VM_CASE(upval) {
+    vm_frame_t* f = env;
+    for (int d = pc[1]; d > 1 && f; d--)
+      f = f->up;
+    const rv_t* v = f ? f->regs[pc[2]] : NULL;
+    R[pc[0]]      = v ? v : rv_unit();
+    pc += 3;
+    VM_NEXT;
+  }
+  VM_CASE(constr) {
+    int          n  = pc[2];
+    const rv_t** xs = lsmalloc(sizeof(rv_t*) * n);
+    for (int i = 0; i < n; i++)
+      xs[i] = R[pc[3 + i]];
+    R[pc[0]] = rv_constr(prog->names[pc[1]], n, xs);
+    pc += 3 + n;
+    VM_NEXT;
+  }
+  VM_CASE(closure) {
+    rv_t* v    = lsmalloc(sizeof(rv_t));
+    v->kind    = RV_LAM;
+    v->clo.fn  = prog->funcs[pc[1]];
+    v->clo.env = frame;
+    R[pc[0]]   = v;
+    pc += 2;
+    VM_NEXT;
+  }
+  VM_CASE(call) {
+    const rv_t* f = R[pc[1]];
+    int         n = pc[2];
+    // Lambdas take exactly one argument; anything else evaluates to unit (as in lscir_eval)
+    if (f && f->kind == RV_LAM && n == 1)
+      R[pc[0]] = vm_run(prog, f->clo.fn, f->clo.env, R[pc[3]]);
+    else
+      R[pc[0]] = rv_unit();
+    pc += 3 + n;
+    VM_NEXT;
+  }
+  VM_CASE(jmpf) {
+    pc = rv_truthy(R[pc[0]]) ? pc + 2 : fn->code + pc[1];
+    VM_NEXT;
+  }
+  VM_CASE(jmp) {
+    pc = fn->code + pc[0];
+    VM_NEXT;
+  }
+  VM_CASE(nomatch) {
+    fprintf(stderr, "E: <bottom msg=\"match: no case\" at <unknown>:1.1: >\n");
+    const rv_t** rels = lsmalloc(sizeof(rv_t*));
+    rels[0]           = R[pc[1]];
+    R[pc[0]]          = rv_bottom("match: no case", 1, rels);
+    pc += 2;
+    VM_NEXT;
+  }
+  VM_CASE(ret) {
+    const rv_t* v = R[pc[0]];
+    return v ? v : rv_unit();
+  }
+
+#if !VM_COMPUTED_GOTO
+    default:
+      return rv_unit();
+    }
+  }
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+int lscir_eval_vm(FILE* outfp, const lscir_prog_t* cir) {
+  if (!cir || !cir->root) {
+    fprintf(outfp, "()\n");
+    return 0;
+  }
+  vm_prog_t prog = { 0 };
+  vm_comp_t comp = { .prog = &prog };
+  int       root = vm_compile_func(&comp, NULL, cir->root, 0);
+  rv_print(outfp, vm_run(&prog, prog.funcs[root], NULL, NULL));
+  return 0;
+}
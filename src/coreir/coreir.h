@@ -137,6 +137,23 @@ int lscir_validate_effects(FILE* errfp, const lscir_prog_t* cir);
  */
 int lscir_eval(FILE* outfp, const lscir_prog_t* cir);
 
+/* Evaluate a Core IR program like lscir_eval, but by compiling it to register bytecode and
+ * running it on the Core IR VM. Returns 0 on success.
+ */
+int lscir_eval_vm(FILE* outfp, const lscir_prog_t* cir);
+
+/* Optimize a Core IR program: level 1 runs beta-reduction, constant folding of add/sub/lt,
+ * case-of-known-constructor and dead-let removal; level 2 also inlines small let-bound lambdas
+ * and iterates longer. Level 0 returns cir unchanged. The input is not modified.
+ */
+const lscir_prog_t* lscir_optimize(const lscir_prog_t* cir, int level);
+
+/* Translate a Core IR program to a C99 translation unit whose main prints the program's result.
+ * The code calls the lsrt_* runtime ABI (cir_callconv.h) and links against liblazyscript_rt.
+ * Returns 0 on success, non-zero when the program has no lowered Core IR root.
+ */
+int lscir_emit_c(FILE* outfp, const lscir_prog_t* cir);
+
 /* Minimal typecheck for Core IR: prints a one-line result to outfp.
  * Returns 0 on success, non-zero on type error.
  */
@@ -6,20 +6,18 @@
 #include "thunk/thunk.h"
 #include <string.h>
 
-#include "parser/lexer.h"
 #include <assert.h>
 #include <gc.h>
 #include <getopt.h>
 #include <stdarg.h>
 #include <stdlib.h>
-#include <dlfcn.h>
+#include <time.h>
 #include "coreir/coreir.h"
 #include "common/hash.h"
 #include "common/malloc.h"
 #include "common/ref.h"
 #include "common/loc.h"
 #include <unistd.h>
-#include <limits.h>
 #include "runtime/effects.h"
 #include "runtime/unit.h"
 #include "runtime/error.h"
@@ -27,6 +25,11 @@
 #include "builtins/ns.h"
 #include "runtime/builtin.h"
 #include "runtime/trace.h"
+#include "runtime/par.h"
+#include "runtime/prefetch.h"
+#include "runtime/prelude.h"
+#include "runtime/serve.h"
+#include "runtime/zygote.h"
 
 static int         g_debug             = 0;
 static int         g_run_main          = 1; // default: on (files). -e path will disable temporarily
@@ -37,57 +40,52 @@ static const char* g_trace_dump_path =
 // Global registry for namespaces moved to builtins/ns.c
 
 // effects helpers moved to runtime/effects.{h,c}
-static const char* g_sugar_ns       = NULL; // NULL => default (prelude)
-static const char* g_init_file      = NULL; // Optional init script (from --init or env)
-static lshash_t*   g_require_loaded = NULL; // cache of loaded module paths
-const lsprog_t*    lsparse_stream(const char* filename, FILE* in_str) {
-     assert(in_str != NULL);
-     yyscan_t yyscanner;
-     yylex_init(&yyscanner);
-     lsscan_t* lsscan = lsscan_new(filename);
-     yyset_in(in_str, yyscanner);
-     yyset_extra(lsscan, yyscanner);
-     // Apply sugar namespace if configured
-     if (g_sugar_ns == NULL)
-    g_sugar_ns = getenv("LAZYSCRIPT_SUGAR_NS");
-  if (g_sugar_ns && g_sugar_ns[0])
-    lsscan_set_sugar_ns(lsscan, g_sugar_ns);
-  int             ret  = yyparse(yyscanner);
-     const lsprog_t* prog = ret == 0 ? lsscan_get_prog(lsscan) : NULL;
-     yylex_destroy(yyscanner);
-     return prog;
-}
+static const char* g_init_file = NULL; // Optional init script (from --init or env)
+// Forward declaration (defined below in Prelude helpers)
+// moved to runtime/unit.h as inline
 
-const lsprog_t* lsparse_file(const char* filename) {
-  FILE* stream = fopen(filename, "r");
-  if (!stream) {
-    perror(filename);
-    exit(1);
-  }
-  const lsprog_t* prog = lsparse_stream(filename, stream);
-  fclose(stream);
-  return prog;
+// --startup-profile: wall time of the startup phases, reported on stderr at exit
+typedef enum lsstartup_phase {
+  LSSTARTUP_GC,      // collector setup
+  LSSTARTUP_PRELUDE, // prelude registration (plugin probing and dlopen only when asked for)
+  LSSTARTUP_INIT,    // init script
+  LSSTARTUP_PARSE,   // scanner and parser setup, parsing
+  LSSTARTUP_EVAL,    // evaluation and printing
+  LSSTARTUP_NPHASES,
+} lsstartup_phase_t;
+
+static const char* const g_startup_names[LSSTARTUP_NPHASES] = { "gc", "prelude", "init", "parse",
+                                                                "eval" };
+static double            g_startup_ms[LSSTARTUP_NPHASES];
+static struct timespec   g_startup_t0; // entry of main
+
+static struct timespec   ls_startup_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts;
 }
 
-const lsprog_t* lsparse_string(const char* filename, const char* str) {
-  FILE*           stream = fmemopen((void*)str, strlen(str), "r");
-  const lsprog_t* prog   = lsparse_stream(filename, stream);
-  fclose(stream);
-  return prog;
+static double ls_startup_ms_since(struct timespec t) {
+  struct timespec now = ls_startup_now();
+  return (now.tv_sec - t.tv_sec) * 1e3 + (now.tv_nsec - t.tv_nsec) / 1e6;
 }
 
-// Nullable file parser: returns NULL if file open fails
-const lsprog_t* lsparse_file_nullable(const char* filename) {
-  FILE* stream = fopen(filename, "r");
-  if (!stream)
-    return NULL;
-  const lsprog_t* prog = lsparse_stream(filename, stream);
-  fclose(stream);
-  return prog;
+// Charge the time since t to a phase
+static void ls_startup_mark(lsstartup_phase_t phase, struct timespec t) {
+  g_startup_ms[phase] += ls_startup_ms_since(t);
 }
 
-// Forward declaration (defined below in Prelude helpers)
-// moved to runtime/unit.h as inline
+static void ls_startup_report(void) {
+  double total  = ls_startup_ms_since(g_startup_t0);
+  fflush(stdout); // the program's output comes first
+  double phases = 0;
+  for (int i = 0; i < LSSTARTUP_NPHASES; i++) {
+    lsprintf(stderr, 0, "startup: %-8s %8.3f ms\n", g_startup_names[i], g_startup_ms[i]);
+    phases += g_startup_ms[i];
+  }
+  lsprintf(stderr, 0, "startup: %-8s %8.3f ms\n", "other", total - phases);
+  lsprintf(stderr, 0, "startup: %-8s %8.3f ms (from main)\n", "total", total);
+}
 
 // Try to run entry function (~g_entry_name) if configured; returns 1 if invoked.
 static int ls_maybe_run_entry(lstenv_t* tenv) {
@@ -119,17 +117,110 @@ static void ls_maybe_eval_init(lstenv_t* tenv) {
       g_init_file = from_env;
   }
   if (g_init_file && g_init_file[0]) {
+    struct timespec t0    = ls_startup_now();
     const lsprog_t* iprog = lsparse_file(g_init_file);
     if (iprog) {
       // Effects in init are allowed if strict-effects is enabled (wrap with begin/end)
       if (ls_effects_get_strict())
         ls_effects_begin();
+      ls_prefetch_program(iprog);
       lsthunk_t* ret = lsprog_eval(iprog, tenv);
       if (ls_effects_get_strict())
         ls_effects_end();
       (void)ret; // ignore value, init is for side effects / definitions
     }
+    ls_startup_mark(LSSTARTUP_INIT, t0);
+  }
+}
+
+// A new environment holding the prelude; exits when the prelude cannot be loaded
+static lstenv_t* ls_new_prelude_env(const char* prelude_so) {
+  struct timespec t0   = ls_startup_now();
+  lstenv_t*       tenv = lstenv_new(NULL);
+  if (!ls_prelude_load(tenv, prelude_so, g_debug)) {
+    lsprintf(stderr, 0,
+             "E: prelude: plugin not found or failed to load; check --prelude-so, "
+             "LAZYSCRIPT_PRELUDE_SO and LAZYSCRIPT_PRELUDE_PATH\n");
+    exit(1);
+  }
+  ls_startup_mark(LSSTARTUP_PRELUDE, t0);
+  return tenv;
+}
+
+// Evaluate the program of a FILE and print its value, unless it ran an entry function
+static void ls_eval_print(const lsprog_t* prog, lstenv_t* tenv) {
+  struct timespec t0 = ls_startup_now();
+  if (g_trace_dump_path && g_trace_dump_path[0])
+    lstrace_begin_dump(g_trace_dump_path);
+  ls_prefetch_program(prog);
+  lsthunk_t* ret = lsprog_eval(prog, tenv);
+  if (ret != NULL && !ls_maybe_run_entry(tenv)) {
+    if (lsthunk_is_err(ret)) {
+      lsprintf(stderr, 0, "E: ");
+      lsthunk_print(stderr, LSPREC_LOWEST, 0, ret);
+      if (g_lstrace_table && g_trace_stack_depth > 0)
+        lstrace_print_stack(stderr, g_trace_stack_depth);
+      lsprintf(stderr, 0, "\n");
+    } else {
+      lsthunk_print(stdout, LSPREC_LOWEST, 0, ret);
+      lsprintf(stdout, 0, "\n");
+    }
+  }
+  if (g_trace_dump_path && g_trace_dump_path[0])
+    lstrace_end_dump();
+  ls_startup_mark(LSSTARTUP_EVAL, t0);
+}
+
+// Require a module into the fork server's environment, as `!require` in the init script would
+static void ls_preload(lstenv_t* tenv, const char* module) {
+  if (strpbrk(module, "\"\\\n") != NULL) {
+    lsprintf(stderr, 0, "W: preload: unsupported module path: %s\n", module);
+    return;
+  }
+  size_t len = strlen(module) + 32;
+  char*  src = malloc(len);
+  snprintf(src, len, "!{ !require \"%s\"; }", module);
+  const lsprog_t* prog = lsparse_string("<preload>", src);
+  free(src);
+  if (prog == NULL)
+    return;
+  if (ls_effects_get_strict())
+    ls_effects_begin();
+  lsthunk_t* ret = lsprog_eval(prog, tenv);
+  if (ret != NULL)
+    ret = lsthunk_eval0(ret);
+  if (ls_effects_get_strict())
+    ls_effects_end();
+  if (ret == NULL || lsthunk_is_err(ret))
+    lsprintf(stderr, 0, "W: preload: cannot load %s\n", module);
+}
+
+// Fork server child: run the FILE arguments (and -e programs) of a request like the
+// executable would, on top of the warmed environment
+static int ls_zygote_run(int argc, char** argv, void* data) {
+  lstenv_t* base = data;
+  // The child is on its own: sparks and prefetch may start threads here
+  ls_par_hold_threads(0);
+  for (int i = 0; i < argc; i++) {
+    int             saved_run_main = g_run_main;
+    const lsprog_t* prog;
+    if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      prog       = lsparse_string("<eval>", argv[++i]);
+      g_run_main = 0; // as with -e: print the value
+    } else {
+      const char* filename = strcmp(argv[i], "-") == 0 ? "/dev/stdin" : argv[i];
+      // As lsparse_file: a file that cannot be opened ends the run
+      if (access(filename, R_OK) != 0) {
+        perror(filename);
+        return 1;
+      }
+      prog = lsparse_file_nullable(filename);
+    }
+    if (prog != NULL)
+      ls_eval_print(prog, lstenv_new(base));
+    g_run_main = saved_run_main;
   }
+  return 0;
 }
 
 // builtin prototypes are provided via runtime/builtin.h
@@ -150,160 +241,6 @@ lsthunk_t* lsbuiltin_lt(lssize_t argc, lsthunk_t* const* args, void* data);
 
 // Prelude is provided via plugin: see src/plugins/prelude_plugin.c
 
-typedef int (*ls_prelude_register_fn)(lstenv_t*);
-
-static void get_exe_dir(char* out, size_t outsz) {
-  if (!out || outsz == 0)
-    return;
-  ssize_t n = readlink("/proc/self/exe", out, outsz - 1);
-  if (n <= 0) {
-    out[0] = '\0';
-    return;
-  }
-  out[n] = '\0';
-  for (ssize_t i = n - 1; i >= 0; --i) {
-    if (out[i] == '/') {
-      out[i] = '\0';
-      break;
-    }
-  }
-}
-
-static int file_exists(const char* path) { return access(path, R_OK) == 0; }
-
-// safe join helper to avoid -Wformat-truncation on snprintf
-static int join2(char* out, size_t outsz, const char* a, const char* b) {
-  if (!out || outsz == 0)
-    return 0;
-  size_t al = a ? strnlen(a, outsz) : 0;
-  size_t bl = b ? strlen(b) : 0;
-  if (al + bl >= outsz) {
-    out[0] = '\0';
-    return 0;
-  }
-  if (a && al)
-    memcpy(out, a, al);
-  if (b && bl)
-    memcpy(out + al, b, bl);
-  out[al + bl] = '\0';
-  return 1;
-}
-
-static const char* ls_find_prelude_so(char* buf, size_t bufsz) {
-  if (!buf || bufsz == 0)
-    return NULL;
-  buf[0] = '\0';
-
-  const char* envp = getenv("LAZYSCRIPT_PRELUDE_PATH");
-  if (envp && envp[0]) {
-    const char* p = envp;
-    while (p && *p) {
-      const char* colon = strchr(p, ':');
-      size_t      len   = colon ? (size_t)(colon - p) : strlen(p);
-      char        dir[PATH_MAX];
-      if (len >= sizeof(dir))
-        len = sizeof(dir) - 1;
-      memcpy(dir, p, len);
-      dir[len] = '\0';
-      if (!join2(buf, bufsz, dir, "/liblazyscript_prelude.so")) {
-        buf[0] = '\0';
-      }
-      if (file_exists(buf))
-        return buf;
-      p = colon ? colon + 1 : NULL;
-    }
-  }
-  char exedir[PATH_MAX];
-  exedir[0] = '\0';
-  get_exe_dir(exedir, sizeof(exedir));
-  if (exedir[0]) {
-    if (!join2(buf, bufsz, exedir, "/plugins/liblazyscript_prelude.so")) {
-      buf[0] = '\0';
-    }
-    if (file_exists(buf))
-      return buf;
-    // When running from build tree, plugin resides in .libs/
-    if (!join2(buf, bufsz, exedir, "/plugins/.libs/liblazyscript_prelude.so")) {
-      buf[0] = '\0';
-    }
-    if (file_exists(buf))
-      return buf;
-    // Also try parent dir (exedir is usually src/.libs, plugin is in src/plugins/.libs)
-    char parent[PATH_MAX];
-    memcpy(parent, exedir, sizeof(parent));
-    parent[sizeof(parent) - 1] = '\0';
-    for (ssize_t i = (ssize_t)strlen(parent) - 1; i >= 0; --i) {
-      if (parent[i] == '/') {
-        parent[i] = '\0';
-        break;
-      }
-    }
-    if (!join2(buf, bufsz, parent, "/plugins/.libs/liblazyscript_prelude.so")) {
-      buf[0] = '\0';
-    }
-    if (file_exists(buf))
-      return buf;
-  }
-  snprintf(buf, bufsz, "/usr/local/lib/lazyscript/liblazyscript_prelude.so");
-  if (file_exists(buf))
-    return buf;
-  snprintf(buf, bufsz, "/usr/lib/lazyscript/liblazyscript_prelude.so");
-  if (file_exists(buf))
-    return buf;
-  buf[0] = '\0';
-  return NULL;
-}
-
-static int ls_try_load_prelude_plugin(lstenv_t* tenv, const char* path) {
-  const char* chosen = path;
-  const char* source = NULL; // for logging
-  if (chosen == NULL)
-    chosen = getenv("LAZYSCRIPT_PRELUDE_SO");
-  if (chosen && chosen[0])
-    source = "CLI/ENV";
-  char found[PATH_MAX];
-  if ((chosen == NULL || chosen[0] == '\0')) {
-    // Try to find via LAZYSCRIPT_PRELUDE_PATH / standard locations
-    if (ls_find_prelude_so(found, sizeof(found))) {
-      chosen = found;
-      source = "AUTO";
-    }
-  }
-  if (chosen == NULL || chosen[0] == '\0') {
-    if (g_debug)
-      lsprintf(stderr, 0, "I: prelude: plugin not found (auto-discovery)\n");
-    return 0;
-  }
-  void* handle = dlopen(chosen, RTLD_NOW | RTLD_LOCAL);
-  if (!handle) {
-    const char* err = dlerror();
-    lsprintf(stderr, 0, "W: prelude: dlopen failed: path=%s err=%s\n", chosen,
-             err ? err : "(null)");
-    return 0;
-  }
-  dlerror();
-  ls_prelude_register_fn reg = (ls_prelude_register_fn)dlsym(handle, "ls_prelude_register");
-  const char*            err = dlerror();
-  if (err != NULL || reg == NULL) {
-    lsprintf(stderr, 0, "W: prelude: dlsym(ls_prelude_register) failed: %s\n",
-             err ? err : "(null)");
-    dlclose(handle);
-    return 0;
-  }
-  int rc = reg(tenv);
-  if (rc != 0) {
-    lsprintf(stderr, 0, "W: prelude: plugin returned error: %d\n", rc);
-    // keep handle but report error; fall back
-    return 0;
-  }
-  if (g_debug) {
-    lsprintf(stderr, 0, "I: prelude: plugin loaded: path=%s source=%s\n", chosen,
-             source ? source : "(n/a)");
-  }
-  // Keep handle open for the lifetime of process
-  return 1;
-}
-
 // --- Prelude as value setup ---
 // local 0-arity getter: returns captured thunk value
 static lsthunk_t* lsbuiltin_getter0_local(lssize_t argc, lsthunk_t* const* args, void* data) {
@@ -334,10 +271,22 @@ int        main(int argc, char** argv) {
   // scanner/parser (yylex_init may allocate and trigger GC lazy init otherwise).
   // If libc allocator is requested, skip GC_init to avoid unnecessary GC setup
   // and potential environment-specific issues.
+  // A fork server client only forwards its arguments: no collector, no prelude
+  if (argc > 1 && strncmp(argv[1], "--connect=", 10) == 0)
+    return ls_zygote_connect(argv[1] + 10, argc - 2, argv + 2);
+  g_startup_t0             = ls_startup_now();
   const char* _ls_use_libc = getenv("LAZYSCRIPT_USE_LIBC_ALLOC");
   if (!(_ls_use_libc && _ls_use_libc[0] && _ls_use_libc[0] != '0')) {
            GC_init();
   }
+  ls_startup_mark(LSSTARTUP_GC, g_startup_t0);
+  const char* _ls_hash_cons = getenv("LAZYSCRIPT_HASH_CONS");
+  int         hash_cons     = _ls_hash_cons && _ls_hash_cons[0] && _ls_hash_cons[0] != '0';
+  if (hash_cons)
+    lsthunk_set_hashcons(1);
+  const char* _ls_threads = getenv("LAZYSCRIPT_THREADS");
+  if (_ls_threads && _ls_threads[0])
+    ls_par_set_threads(atoi(_ls_threads));
   const char*   prelude_so       = NULL;
   int           dump_coreir      = 0;
   int           eval_coreir      = 0;
@@ -345,6 +294,12 @@ int        main(int argc, char** argv) {
   int           kind_warn        = 1;    // default warn
   int           kind_error       = 0;    // default no error
   const char*   trace_map_path   = NULL; // optional sourcemap for runtime tracing
+  int           serve            = 0;
+  const char*   serve_socket     = NULL; // --serve=<socket>; NULL: stdin
+  int           serve_workers    = 0;
+  const char*   zygote_socket    = NULL;
+  const char*   preloads[32];
+  int           npreloads        = 0;
   struct option longopts[]       = {
                  { "eval", required_argument, NULL, 'e' },
                  { "prelude-so", required_argument, NULL, 'p' },
@@ -361,6 +316,13 @@ int        main(int argc, char** argv) {
                  { "trace-map", required_argument, NULL, 2000 },
                  { "trace-stack-depth", required_argument, NULL, 2001 },
                  { "trace-dump", required_argument, NULL, 2002 },
+                 { "hash-cons", no_argument, NULL, 2003 },
+                 { "threads", required_argument, NULL, 2004 },
+                 { "serve", optional_argument, NULL, 2005 },
+                 { "serve-workers", required_argument, NULL, 2006 },
+                 { "zygote", required_argument, NULL, 2007 },
+                 { "preload", required_argument, NULL, 2008 },
+                 { "startup-profile", no_argument, NULL, 2009 },
                  { "debug", no_argument, NULL, 'd' },
                  { "help", no_argument, NULL, 'h' },
                  { "version", no_argument, NULL, 'v' },
@@ -373,7 +335,9 @@ int        main(int argc, char** argv) {
              static int eval_count = 0;
              char       name[32];
              snprintf(name, sizeof(name), "<eval:#%d>", ++eval_count);
+             struct timespec t0   = ls_startup_now();
              const lsprog_t* prog = lsparse_string(name, optarg);
+             ls_startup_mark(LSSTARTUP_PARSE, t0);
              if (prog != NULL) {
                if (dump_coreir) {
                  const lscir_prog_t* cir = lscir_lower_prog(prog);
@@ -423,13 +387,7 @@ int        main(int argc, char** argv) {
                    exit(1);
           }
         }
-               lstenv_t* tenv = lstenv_new(NULL);
-               if (!ls_try_load_prelude_plugin(tenv, prelude_so)) {
-                 lsprintf(stderr, 0,
-                          "E: prelude: plugin not found or failed to load; set --prelude-so or install "
-                                 "liblazyscript_prelude.so\n");
-                 exit(1);
-        }
+               lstenv_t* tenv = ls_new_prelude_env(prelude_so);
                // Plugin registers prelude dispatchers; no host-side MUX
                int saved_run_main = g_run_main;
                g_run_main         = 0; // -e は従来通り：最終値を出力
@@ -438,6 +396,8 @@ int        main(int argc, char** argv) {
           lstrace_begin_dump(g_trace_dump_path);
         if (g_debug)
           lsprintf(stderr, 0, "DBG: eval(-e) begin\n");
+        t0 = ls_startup_now();
+        ls_prefetch_program(prog);
         lsthunk_t* ret = lsprog_eval(prog, tenv);
                if (g_debug)
           lsprintf(stderr, 0, "DBG: eval(-e) end ret=%p\n", (void*)ret);
@@ -499,6 +459,7 @@ int        main(int argc, char** argv) {
                g_run_main = saved_run_main;
                if (g_trace_dump_path && g_trace_dump_path[0])
           lstrace_end_dump();
+               ls_startup_mark(LSSTARTUP_EVAL, t0);
       }
              break;
     }
@@ -506,7 +467,7 @@ int        main(int argc, char** argv) {
       prelude_so = optarg;
       break;
            case 'n':
-      g_sugar_ns = optarg;
+      lsparse_set_sugar_ns(optarg);
       break;
            case 's':
       ls_effects_set_strict(1);
@@ -545,6 +506,32 @@ int        main(int argc, char** argv) {
       break;
            case 2002: // --trace-dump <file>
       g_trace_dump_path = optarg;
+      break;
+           case 2003: // --hash-cons
+      hash_cons = 1;
+      lsthunk_set_hashcons(1);
+      break;
+           case 2004: // --threads <n>
+      ls_par_set_threads(atoi(optarg));
+      break;
+           case 2005: // --serve[=<socket>]
+      serve        = 1;
+      serve_socket = optarg;
+      break;
+           case 2006: // --serve-workers <n>
+      serve_workers = atoi(optarg);
+      break;
+           case 2007: // --zygote=<socket>
+      zygote_socket = optarg;
+      break;
+           case 2008: // --preload <module>
+      if (npreloads < (int)(sizeof(preloads) / sizeof(preloads[0])))
+        preloads[npreloads++] = optarg;
+      else
+        lsprintf(stderr, 0, "W: preload: too many modules, ignoring %s\n", optarg);
+      break;
+           case 2009: // --startup-profile
+      atexit(ls_startup_report);
       break;
            case 'd':
       g_debug = 1;
@@ -576,19 +563,34 @@ int        main(int argc, char** argv) {
       printf("      --trace-map <file>   load sourcemap JSONL for runtime trace printing (exp)\n");
       printf("      --trace-stack-depth <n>  print up to N frames on error (default: 1)\n");
       printf("      --trace-dump <file>  write JSONL sourcemap while evaluating (exp)\n");
+      printf("      --hash-cons     share structurally equal evaluated values (exp)\n");
+      printf("      --threads <n>   threads evaluating par/parMap sparks and parsing required "
+             "modules (default: processors)\n");
+      printf("      --serve[=<socket>]  answer framed eval/call requests on stdin or a Unix "
+             "socket\n");
+      printf("      --serve-workers <n>  concurrent socket connections (default: processors)\n");
+      printf("      --zygote=<socket>  fork server: load the prelude once, fork per request\n");
+      printf("      --preload <module>  require a module before the fork server forks\n");
+      printf("      --connect=<socket> [FILE|-e <program>]...  run in a fork server (first "
+             "option)\n");
+      printf("      --startup-profile  report the time of each startup phase on stderr at exit\n");
       printf("  -h, --help      display this help and exit\n");
       printf("  -v, --version   output version information and exit\n");
-      printf("\nDefault prelude: plugin-only (CLI -p / LAZYSCRIPT_PRELUDE_SO / auto-discover).\n");
+      printf("\nDefault prelude: built in (plugin: CLI -p / LAZYSCRIPT_PRELUDE_SO / "
+             "LAZYSCRIPT_PRELUDE_PATH).\n");
       printf("\nEnvironment:\n  LAZYSCRIPT_PRELUDE_SO  path to prelude plugin .so (used if -p not "
              "set)\n");
-      printf("  LAZYSCRIPT_PRELUDE_PATH search paths (:) to find liblazyscript_prelude.so when SO "
-             "not set\n");
+      printf("  LAZYSCRIPT_PRELUDE_PATH search paths (:) to find liblazyscript_prelude.so "
+             "instead of the built-in prelude\n");
       printf("  LAZYSCRIPT_SUGAR_NS     namespace used for ~~sym sugar (if -n not set)\n");
       printf("  LAZYSCRIPT_INIT         path to init LazyScript (used if --init not set)\n");
       printf("  LAZYSCRIPT_TRACE_MAP    path to sourcemap JSONL (used if --trace-map not set)\n");
       printf(
           "  LAZYSCRIPT_TRACE_STACK_DEPTH  depth to print (used if --trace-stack-depth not set)\n");
       printf("  LAZYSCRIPT_TRACE_DUMP   path to write JSONL (used if --trace-dump not set)\n");
+      printf("  LAZYSCRIPT_HASH_CONS    set to 1 to enable --hash-cons\n");
+      printf("  LAZYSCRIPT_THREADS      number of threads (used if --threads not set)\n");
+      printf("  LAZYSCRIPT_PREFETCH     set to 0 to parse required modules only when loaded\n");
       exit(0);
     case 'v':
       printf("%s %s\n", PACKAGE_NAME, PACKAGE_VERSION);
@@ -623,11 +625,32 @@ int        main(int argc, char** argv) {
     if (env_dump && env_dump[0])
       g_trace_dump_path = env_dump;
   }
+  if (serve) {
+    if (g_init_file == NULL || g_init_file[0] == '\0')
+      g_init_file = getenv("LAZYSCRIPT_INIT");
+    ls_serve_opts_t sopts = {
+      .lso_socket  = serve_socket,
+      .lso_workers = serve_workers,
+      .lso_runtime = { prelude_so, g_init_file, ls_effects_get_strict(), hash_cons },
+    };
+    return ls_serve(&sopts);
+  }
+  if (zygote_socket != NULL) {
+    // fork() copies only the calling thread: no pool may start before the server forks
+    ls_par_hold_threads(1);
+    lstenv_t* tenv = ls_new_prelude_env(prelude_so);
+    ls_maybe_eval_init(tenv);
+    for (int i = 0; i < npreloads; i++)
+      ls_preload(tenv, preloads[i]);
+    return ls_zygote_serve(zygote_socket, ls_zygote_run, tenv);
+  }
   for (int i = optind; i < argc; i++) {
     const char* filename = argv[i];
     if (strcmp(filename, "-") == 0)
       filename = "/dev/stdin";
+    struct timespec t0   = ls_startup_now();
     const lsprog_t* prog = lsparse_file(filename);
+    ls_startup_mark(LSSTARTUP_PARSE, t0);
     if (prog != NULL) {
       if (dump_coreir) {
         const lscir_prog_t* cir = lscir_lower_prog(prog);
@@ -680,33 +703,11 @@ int        main(int argc, char** argv) {
           exit(1);
         }
       }
-      lstenv_t* tenv = lstenv_new(NULL);
-      if (!ls_try_load_prelude_plugin(tenv, prelude_so)) {
-        lsprintf(stderr, 0,
-                 "E: prelude: plugin not found or failed to load; set --prelude-so or install "
-                 "liblazyscript_prelude.so\n");
-        exit(1);
-      }
+      lstenv_t* tenv = ls_new_prelude_env(prelude_so);
       // Plugin registers prelude dispatchers; no host-side MUX
       // Evaluate init script (if any) into the same environment
       ls_maybe_eval_init(tenv);
-      if (g_trace_dump_path && g_trace_dump_path[0])
-        lstrace_begin_dump(g_trace_dump_path);
-      lsthunk_t* ret = lsprog_eval(prog, tenv);
-      if (ret != NULL && !ls_maybe_run_entry(tenv)) {
-        if (lsthunk_is_err(ret)) {
-          lsprintf(stderr, 0, "E: ");
-          lsthunk_print(stderr, LSPREC_LOWEST, 0, ret);
-          if (g_lstrace_table && g_trace_stack_depth > 0)
-            lstrace_print_stack(stderr, g_trace_stack_depth);
-          lsprintf(stderr, 0, "\n");
-        } else {
-          lsthunk_print(stdout, LSPREC_LOWEST, 0, ret);
-          lsprintf(stdout, 0, "\n");
-        }
-      }
-      if (g_trace_dump_path && g_trace_dump_path[0])
-        lstrace_end_dump();
+      ls_eval_print(prog, tenv);
     }
   }
   // Cleanup
@@ -12,3 +12,13 @@
 
 /* パーサAPI: lazyscript_format から利用 */
 extern const lsprog_t* lsparse_stream(const char* filename, FILE* in_str);
+
+// Parser entry points (runtime/parse.c); lsparse_file exits when the file cannot be opened
+const lsprog_t* lsparse_file(const char* filename);
+const lsprog_t* lsparse_file_nullable(const char* filename);
+const lsprog_t* lsparse_string(const char* filename, const char* str);
+
+// Set the namespace of ~~sym sugar (NULL: LAZYSCRIPT_SUGAR_NS, else prelude)
+void lsparse_set_sugar_ns(const char* ns);
+// The namespace of ~~sym sugar in effect
+const char* lsparse_get_sugar_ns(void);
@@ -1,6 +1,7 @@
 #pragma once
 
-// Minimal interface for emitting textual LLVM IR from Core IR (MVP)
+// Emitting textual LLVM IR from Core IR. The module calls the lsrt_* C ABI
+// (coreir/cir_callconv.h) and links against liblazyscript_rt.
 
 #include "coreir/coreir.h"
 
@@ -8,7 +9,8 @@
 extern "C" {
 #endif
 
-// Emit textual LLVM IR for a given Core IR program (subset). Returns 0 on success.
+// Emit textual LLVM IR for a Core IR program, with a main that prints its result.
+// Returns 0 on success, non-zero when the program has no lowered Core IR root.
 int lsllvm_emit_text(FILE* out, const lscir_prog_t* cir);
 
 #ifdef __cplusplus
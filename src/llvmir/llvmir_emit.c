@@ -1,17 +1,509 @@
 #include "llvmir/llvmir.h"
 #include "coreir/coreir.h"
 #include "coreir/cir_internal.h"
+#include "common/io.h"
+#include "common/malloc.h"
 #include <stdio.h>
+#include <string.h>
+
+/*
+ * Core IR → textual LLVM IR.
+ *
+ * Every value is an opaque `i8*` handled by the lsrt_* C ABI (coreir/cir_callconv.h), so the
+ * module links against the runtime library and needs no knowledge of the thunk layout. Each
+ * lambda is lifted to `i8* @ls_fn_N(i8** env, i8* arg)`; its free variables are copied into the
+ * closure environment when the lambda value is created. Lets are SSA values, `if` and `match`
+ * become branches joined by a phi, and unbound variables are symbols, as in lscir_eval, except
+ * that two-argument applications of unbound add/sub/lt call the runtime's integer builtins and
+ * saturated applications of unbound map/filter/foldr its list builtins.
+ *
+ * The module is written for LLVM's typed-pointer syntax (`i8*`), which newer releases still
+ * accept as `ptr`.
+ */
+
+typedef struct ll_mod {
+  FILE*  strs; // string constants
+  char*  strs_buf;
+  size_t strs_len;
+  FILE*  funcs; // completed function definitions
+  char*  funcs_buf;
+  size_t funcs_len;
+  int    nstrs;
+  int    nfuncs;
+} ll_mod_t;
+
+typedef struct ll_bind {
+  const char* name;
+  int         tmp;
+} ll_bind_t;
+
+typedef struct ll_func {
+  ll_mod_t*       mod;
+  struct ll_func* parent;
+  FILE*           fp;
+  char*           buf;
+  size_t          len;
+  int             id;
+  int             ntmp;
+  int             nlabel;
+  int             block; // label of the current basic block
+  ll_bind_t*      scope;
+  int             nscope;
+  int             cap_scope;
+  const char**    caps; // free variables, in environment order
+  int             ncaps;
+  int             cap_caps;
+} ll_func_t;
+
+typedef struct ll_phi {
+  int* tmps;
+  int* blocks;
+  int  n;
+  int  cap;
+} ll_phi_t;
+
+#define LL_GROW(arr, n, cap, type)                                                                 \
+  do {                                                                                             \
+    if ((n) >= (cap)) {                                                                            \
+      (cap) = (cap) ? (cap) * 2 : 8;                                                               \
+      (arr) = lsrealloc((arr), sizeof(type) * (cap));                                              \
+    }                                                                                              \
+  } while (0)
+
+static int ll_tmp(ll_func_t* f) { return f->ntmp++; }
+
+static int ll_label(ll_func_t* f) { return ++f->nlabel; }
+
+static void ll_begin_block(ll_func_t* f, int label) {
+  fprintf(f->fp, "L%d:\n", label);
+  f->block = label;
+}
+
+static void ll_phi_add(ll_phi_t* phi, int tmp, int block) {
+  if (phi->n >= phi->cap) {
+    phi->cap    = phi->cap ? phi->cap * 2 : 4;
+    phi->tmps   = lsrealloc(phi->tmps, sizeof(int) * phi->cap);
+    phi->blocks = lsrealloc(phi->blocks, sizeof(int) * phi->cap);
+  }
+  phi->tmps[phi->n]   = tmp;
+  phi->blocks[phi->n] = block;
+  phi->n++;
+}
+
+static int ll_phi_emit(ll_func_t* f, const ll_phi_t* phi) {
+  int r = ll_tmp(f);
+  fprintf(f->fp, "  %%t%d = phi i8* ", r);
+  for (int i = 0; i < phi->n; i++)
+    fprintf(f->fp, "%s[ %%t%d, %%L%d ]", i ? ", " : "", phi->tmps[i], phi->blocks[i]);
+  fprintf(f->fp, "\n");
+  return r;
+}
+
+// Emit a private byte-string constant and return its index; the bytes are NUL-terminated so
+// that names can also be passed as C strings.
+static int ll_str_const(ll_mod_t* m, const char* bytes, size_t n) {
+  int id = m->nstrs++;
+  fprintf(m->strs, "@.str.%d = private unnamed_addr constant [%zu x i8] c\"", id, n + 1);
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = (unsigned char)bytes[i];
+    if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\')
+      fprintf(m->strs, "\\%02X", c);
+    else
+      fputc(c, m->strs);
+  }
+  fprintf(m->strs, "\\00\"\n");
+  return id;
+}
+
+// Operand text for a pointer to the first byte of string constant id of n bytes
+static void ll_str_ptr(FILE* fp, int id, size_t n) {
+  fprintf(fp, "i8* getelementptr inbounds ([%zu x i8], [%zu x i8]* @.str.%d, i64 0, i64 0)", n + 1,
+          n + 1, id);
+}
+
+static void ll_scope_push(ll_func_t* f, const char* name, int tmp) {
+  LL_GROW(f->scope, f->nscope, f->cap_scope, ll_bind_t);
+  f->scope[f->nscope].name = name;
+  f->scope[f->nscope].tmp  = tmp;
+  f->nscope++;
+}
+
+static int ll_bound_in(const ll_func_t* f, const char* name) {
+  for (; f; f = f->parent) {
+    for (int i = f->nscope - 1; i >= 0; i--)
+      if (strcmp(f->scope[i].name, name) == 0)
+        return 1;
+    for (int i = 0; i < f->ncaps; i++)
+      if (strcmp(f->caps[i], name) == 0)
+        return 1;
+  }
+  return 0;
+}
+
+// Look a variable up; returns its SSA temp, or -1 when it is unbound (a symbol)
+static int ll_lookup(ll_func_t* f, const char* name) {
+  for (int i = f->nscope - 1; i >= 0; i--)
+    if (strcmp(f->scope[i].name, name) == 0)
+      return f->scope[i].tmp;
+  int k = -1;
+  for (int i = 0; i < f->ncaps; i++)
+    if (strcmp(f->caps[i], name) == 0)
+      k = i;
+  if (k < 0) {
+    if (!ll_bound_in(f->parent, name))
+      return -1;
+    LL_GROW(f->caps, f->ncaps, f->cap_caps, const char*);
+    k          = f->ncaps++;
+    f->caps[k] = name;
+  }
+  int p = ll_tmp(f);
+  int r = ll_tmp(f);
+  fprintf(f->fp, "  %%t%d = getelementptr inbounds i8*, i8** %%env, i64 %d\n", p, k);
+  fprintf(f->fp, "  %%t%d = load i8*, i8** %%t%d\n", r, p);
+  return r;
+}
+
+// Store operand temps into a fresh stack array; returns its temp, or -1 for an empty array
+static int ll_array(ll_func_t* f, const int* tmps, int n) {
+  if (n == 0)
+    return -1;
+  int a = ll_tmp(f);
+  fprintf(f->fp, "  %%t%d = alloca i8*, i32 %d\n", a, n);
+  for (int i = 0; i < n; i++) {
+    int p = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = getelementptr inbounds i8*, i8** %%t%d, i64 %d\n", p, a, i);
+    fprintf(f->fp, "  store i8* %%t%d, i8** %%t%d\n", tmps[i], p);
+  }
+  return a;
+}
+
+static void ll_array_arg(FILE* fp, int a) {
+  if (a < 0)
+    fprintf(fp, "i8** null");
+  else
+    fprintf(fp, "i8** %%t%d", a);
+}
+
+static int ll_func(ll_mod_t* m, ll_func_t* parent, const char* param, const lscir_expr_t* body,
+                   ll_func_t* out);
+static int ll_expr(ll_func_t* f, const lscir_expr_t* e);
+
+static int ll_call0(ll_func_t* f, const char* fn) {
+  int r = ll_tmp(f);
+  fprintf(f->fp, "  %%t%d = call i8* @%s()\n", r, fn);
+  return r;
+}
+
+static int ll_value(ll_func_t* f, const lscir_value_t* v) {
+  switch (v->kind) {
+  case LCIR_VAL_INT: {
+    int r = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_make_int(i64 %lld)\n", r, v->ival);
+    return r;
+  }
+  case LCIR_VAL_STR: {
+    size_t n  = strlen(v->sval);
+    int    id = ll_str_const(f->mod, v->sval, n);
+    int    r  = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_make_str_n(", r);
+    ll_str_ptr(f->fp, id, n);
+    fprintf(f->fp, ", i64 %zu)\n", n);
+    return r;
+  }
+  case LCIR_VAL_VAR: {
+    int r = ll_lookup(f, v->var);
+    if (r >= 0)
+      return r;
+    // No implicit mapping to native functions. Treat as plain symbol.
+    size_t n  = strlen(v->var);
+    int    id = ll_str_const(f->mod, v->var, n);
+    r         = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_make_symbol(", r);
+    ll_str_ptr(f->fp, id, n);
+    fprintf(f->fp, ")\n");
+    return r;
+  }
+  case LCIR_VAL_CONSTR: {
+    int n = v->constr.argc;
+    if (n == 0 && strcmp(v->constr.name, "()") == 0)
+      return ll_call0(f, "lsrt_unit");
+    int* args = n > 0 ? lsmalloc(sizeof(int) * n) : NULL;
+    for (int i = 0; i < n; i++)
+      args[i] = ll_value(f, v->constr.args[i]);
+    int    a   = ll_array(f, args, n);
+    size_t len = strlen(v->constr.name);
+    int    id  = ll_str_const(f->mod, v->constr.name, len);
+    int    r   = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_make_constr(", r);
+    ll_str_ptr(f->fp, id, len);
+    fprintf(f->fp, ", i32 %d, ", n);
+    ll_array_arg(f->fp, a);
+    fprintf(f->fp, ")\n");
+    return r;
+  }
+  case LCIR_VAL_LAM: {
+    ll_func_t inner;
+    int       id   = ll_func(f->mod, f, v->lam.param, v->lam.body, &inner);
+    int*      caps = inner.ncaps > 0 ? lsmalloc(sizeof(int) * inner.ncaps) : NULL;
+    for (int i = 0; i < inner.ncaps; i++)
+      caps[i] = ll_lookup(f, inner.caps[i]);
+    int a = ll_array(f, caps, inner.ncaps);
+    int r = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_make_closure(i8* (i8**, i8*)* @ls_fn_%d, i32 %d, ", r,
+            id, inner.ncaps);
+    ll_array_arg(f->fp, a);
+    fprintf(f->fp, ")\n");
+    return r;
+  }
+  case LCIR_VAL_NSLIT:
+    // Namespace literals are not compiled; like lscir_eval the result is unit
+    return ll_call0(f, "lsrt_unit");
+  }
+  return ll_call0(f, "lsrt_unit");
+}
+
+// Runtime entry of a builtin (integer or list) applied to argc arguments, or NULL
+static const char* ll_prim(const ll_func_t* f, const lscir_value_t* func, int argc) {
+  static const struct {
+    const char* name;
+    int         argc;
+    const char* entry;
+  } prims[] = {
+    { "add", 2, "lsrt_add" }, { "sub", 2, "lsrt_sub" },       { "lt", 2, "lsrt_lt" },
+    { "map", 2, "lsrt_map" }, { "filter", 2, "lsrt_filter" }, { "foldr", 3, "lsrt_foldr" },
+  };
+  if (func->kind != LCIR_VAL_VAR || ll_bound_in(f, func->var))
+    return NULL;
+  for (size_t i = 0; i < sizeof(prims) / sizeof(prims[0]); i++)
+    if (prims[i].argc == argc && strcmp(func->var, prims[i].name) == 0)
+      return prims[i].entry;
+  return NULL;
+}
+
+static int ll_apply(ll_func_t* f, const lscir_value_t* func, int argc,
+                    const lscir_value_t* const* args) {
+  const char* prim = ll_prim(f, func, argc);
+  if (prim) {
+    int as[3];
+    for (int i = 0; i < argc; i++)
+      as[i] = ll_value(f, args[i]);
+    int r = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @%s(", r, prim);
+    for (int i = 0; i < argc; i++)
+      fprintf(f->fp, "%si8* %%t%d", i ? ", " : "", as[i]);
+    fprintf(f->fp, ")\n");
+    return r;
+  }
+  int  fn = ll_value(f, func);
+  int* as = argc > 0 ? lsmalloc(sizeof(int) * argc) : NULL;
+  for (int i = 0; i < argc; i++)
+    as[i] = ll_value(f, args[i]);
+  int a = ll_array(f, as, argc);
+  int r = ll_tmp(f);
+  fprintf(f->fp, "  %%t%d = call i8* @lsrt_apply(i8* %%t%d, i32 %d, ", r, fn, argc);
+  ll_array_arg(f->fp, a);
+  fprintf(f->fp, ")\n");
+  return r;
+}
+
+// Branch on an i32 test result: continue in a fresh block when it is non-zero, else go to fail
+static void ll_branch_test(ll_func_t* f, int test, int fail) {
+  int c  = ll_tmp(f);
+  int ok = ll_label(f);
+  fprintf(f->fp, "  %%t%d = icmp ne i32 %%t%d, 0\n", c, test);
+  fprintf(f->fp, "  br i1 %%t%d, label %%L%d, label %%L%d\n", c, ok, fail);
+  ll_begin_block(f, ok);
+}
+
+// Test value temp v against pat, binding pattern variables; jumps to label fail on mismatch
+static void ll_pat(ll_func_t* f, const lscir_pat_t* pat, int v, int fail) {
+  if (!pat)
+    return;
+  switch (pat->kind) {
+  case LCIR_PAT_WILDCARD:
+    return;
+  case LCIR_PAT_VAR:
+    ll_scope_push(f, pat->var, v);
+    return;
+  case LCIR_PAT_INT: {
+    int t = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i32 @lsrt_match_int(i8* %%t%d, i64 %lld)\n", t, v, pat->ival);
+    ll_branch_test(f, t, fail);
+    return;
+  }
+  case LCIR_PAT_STR: {
+    size_t n  = strlen(pat->sval);
+    int    id = ll_str_const(f->mod, pat->sval, n);
+    int    t  = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i32 @lsrt_match_str(i8* %%t%d, ", t, v);
+    ll_str_ptr(f->fp, id, n);
+    fprintf(f->fp, ", i64 %zu)\n", n);
+    ll_branch_test(f, t, fail);
+    return;
+  }
+  case LCIR_PAT_CONSTR: {
+    size_t n  = strlen(pat->constr.name);
+    int    id = ll_str_const(f->mod, pat->constr.name, n);
+    int    t  = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i32 @lsrt_match_constr(i8* %%t%d, ", t, v);
+    ll_str_ptr(f->fp, id, n);
+    fprintf(f->fp, ", i32 %d)\n", pat->constr.subc);
+    ll_branch_test(f, t, fail);
+    for (int i = 0; i < pat->constr.subc; i++) {
+      int a = ll_tmp(f);
+      fprintf(f->fp, "  %%t%d = call i8* @lsrt_constr_arg(i8* %%t%d, i32 %d)\n", a, v, i);
+      ll_pat(f, pat->constr.subpats[i], a, fail);
+    }
+    return;
+  }
+  }
+}
+
+static int ll_expr(ll_func_t* f, const lscir_expr_t* e) {
+  if (!e)
+    return ll_call0(f, "lsrt_unit");
+  switch (e->kind) {
+  case LCIR_EXP_VAL:
+    return ll_value(f, e->v);
+  case LCIR_EXP_LET: {
+    int r = ll_expr(f, e->let1.bind);
+    ll_scope_push(f, e->let1.var, r);
+    int body = ll_expr(f, e->let1.body);
+    f->nscope--;
+    return body;
+  }
+  case LCIR_EXP_APP:
+    return ll_apply(f, e->app.func, e->app.argc, e->app.args);
+  case LCIR_EXP_EFFAPP:
+    // The token only orders effects; the call itself is an ordinary application
+    return ll_apply(f, e->effapp.func, e->effapp.argc, e->effapp.args);
+  case LCIR_EXP_TOKEN:
+    return ll_call0(f, "lsrt_unit");
+  case LCIR_EXP_IF: {
+    int      cond = ll_value(f, e->ife.cond);
+    int      t    = ll_tmp(f);
+    int      c    = ll_tmp(f);
+    int      lt   = ll_label(f);
+    int      le   = ll_label(f);
+    int      join = ll_label(f);
+    ll_phi_t phi  = { 0 };
+    fprintf(f->fp, "  %%t%d = call i32 @lsrt_truthy(i8* %%t%d)\n", t, cond);
+    fprintf(f->fp, "  %%t%d = icmp ne i32 %%t%d, 0\n", c, t);
+    fprintf(f->fp, "  br i1 %%t%d, label %%L%d, label %%L%d\n", c, lt, le);
+    ll_begin_block(f, lt);
+    ll_phi_add(&phi, ll_expr(f, e->ife.then_e), f->block);
+    fprintf(f->fp, "  br label %%L%d\n", join);
+    ll_begin_block(f, le);
+    ll_phi_add(&phi, ll_expr(f, e->ife.else_e), f->block);
+    fprintf(f->fp, "  br label %%L%d\n", join);
+    ll_begin_block(f, join);
+    return ll_phi_emit(f, &phi);
+  }
+  case LCIR_EXP_MATCH: {
+    int      scrut = ll_value(f, e->match1.scrut);
+    int      join  = ll_label(f);
+    ll_phi_t phi   = { 0 };
+    for (int i = 0; i < e->match1.casec; i++) {
+      const lscir_case_t* cs   = &e->match1.cases[i];
+      int                 fail = ll_label(f);
+      int                 save = f->nscope;
+      ll_pat(f, cs->pat, scrut, fail);
+      ll_phi_add(&phi, ll_expr(f, cs->body), f->block);
+      fprintf(f->fp, "  br label %%L%d\n", join);
+      f->nscope = save;
+      ll_begin_block(f, fail);
+    }
+    int r = ll_tmp(f);
+    fprintf(f->fp, "  %%t%d = call i8* @lsrt_match_fail(i8* %%t%d)\n", r, scrut);
+    ll_phi_add(&phi, r, f->block);
+    fprintf(f->fp, "  br label %%L%d\n", join);
+    ll_begin_block(f, join);
+    return ll_phi_emit(f, &phi);
+  }
+  }
+  return ll_call0(f, "lsrt_unit");
+}
+
+// Compile one function (a lambda, or the program root when param is NULL) and append its
+// definition to the module. The caller reads the captured variables from *out.
+static int ll_func(ll_mod_t* m, ll_func_t* parent, const char* param, const lscir_expr_t* body,
+                   ll_func_t* out) {
+  memset(out, 0, sizeof(*out));
+  out->mod    = m;
+  out->parent = parent;
+  out->id     = m->nfuncs++;
+  out->fp     = lsopen_memstream_gc(&out->buf, &out->len);
+  fprintf(out->fp, "L0:\n");
+  if (param) {
+    int a = ll_tmp(out);
+    // Name the parameter through a no-op cast so scope entries are uniformly %tN
+    fprintf(out->fp, "  %%t%d = bitcast i8* %%arg to i8*\n", a);
+    ll_scope_push(out, param, a);
+  }
+  int r = ll_expr(out, body);
+  fprintf(out->fp, "  ret i8* %%t%d\n", r);
+  fclose(out->fp);
+  fprintf(m->funcs, "define internal i8* @ls_fn_%d(i8** %%env, i8* %%arg) {\n", out->id);
+  fwrite(out->buf, 1, out->len, m->funcs);
+  fprintf(m->funcs, "}\n\n");
+  return out->id;
+}
+
+static const char* const ll_decls[] = {
+  "declare void @lsrt_init()",
+  "declare i8* @lsrt_make_int(i64)",
+  "declare i8* @lsrt_make_str_n(i8*, i64)",
+  "declare i8* @lsrt_make_symbol(i8*)",
+  "declare i8* @lsrt_make_constr(i8*, i32, i8**)",
+  "declare i8* @lsrt_make_closure(i8* (i8**, i8*)*, i32, i8**)",
+  "declare i8* @lsrt_unit()",
+  "declare i8* @lsrt_apply(i8*, i32, i8**)",
+  "declare i8* @lsrt_add(i8*, i8*)",
+  "declare i8* @lsrt_sub(i8*, i8*)",
+  "declare i8* @lsrt_lt(i8*, i8*)",
+  "declare i8* @lsrt_map(i8*, i8*)",
+  "declare i8* @lsrt_filter(i8*, i8*)",
+  "declare i8* @lsrt_foldr(i8*, i8*, i8*)",
+  "declare i32 @lsrt_truthy(i8*)",
+  "declare i32 @lsrt_match_constr(i8*, i8*, i32)",
+  "declare i32 @lsrt_match_int(i8*, i64)",
+  "declare i32 @lsrt_match_str(i8*, i8*, i64)",
+  "declare i8* @lsrt_constr_arg(i8*, i32)",
+  "declare i8* @lsrt_match_fail(i8*)",
+  "declare i32 @lsrt_print_result(i8*)",
+};
 
-// Very small placeholder: emit an LLVM IR module with a main that returns 0
-// Later this will lower Core IR expressions to functions and calls.
 int lsllvm_emit_text(FILE* out, const lscir_prog_t* cir) {
-  (void)cir;
-  fprintf(out, "; ModuleID = 'lazyscript_mvp'\n"
-               "source_filename = \"lazyscript_mvp\"\n\n"
-               "define i32 @main() {\n"
-               "entry:\n"
-               "  ret i32 0\n"
-               "}\n");
+  if (!cir || !cir->root) {
+    fprintf(stderr, "E: llvmir: program could not be lowered to Core IR\n");
+    return 1;
+  }
+  ll_mod_t m = { 0 };
+  m.strs     = lsopen_memstream_gc(&m.strs_buf, &m.strs_len);
+  m.funcs    = lsopen_memstream_gc(&m.funcs_buf, &m.funcs_len);
+  ll_func_t root;
+  int       id = ll_func(&m, NULL, NULL, cir->root, &root);
+  fclose(m.strs);
+  fclose(m.funcs);
+
+  fprintf(out, "; ModuleID = 'lazyscript'\n"
+               "source_filename = \"lazyscript\"\n\n");
+  for (size_t i = 0; i < sizeof(ll_decls) / sizeof(ll_decls[0]); i++)
+    fprintf(out, "%s\n", ll_decls[i]);
+  fprintf(out, "\n");
+  if (m.strs_len > 0) {
+    fwrite(m.strs_buf, 1, m.strs_len, out);
+    fprintf(out, "\n");
+  }
+  fwrite(m.funcs_buf, 1, m.funcs_len, out);
+  fprintf(out,
+          "define i32 @main() {\n"
+          "L0:\n"
+          "  call void @lsrt_init()\n"
+          "  %%t0 = call i8* @ls_fn_%d(i8** null, i8* null)\n"
+          "  %%t1 = call i32 @lsrt_print_result(i8* %%t0)\n"
+          "  ret i32 %%t1\n"
+          "}\n",
+          id);
   return 0;
 }
@@ -0,0 +1,312 @@
+// liblazyscript: the embedding API of lsapi.h
+#include "lsapi.h"
+#include "lazyscript.h"
+#include "common/int.h"
+#include "common/io.h"
+#include "common/malloc.h"
+#include "common/str.h"
+#include "runtime/context.h"
+#include "runtime/effects.h"
+#include "runtime/error.h"
+#include "runtime/prefetch.h"
+#include "runtime/prelude.h"
+#include "thunk/tenv.h"
+#include "thunk/thunk.h"
+#include <gc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ls_program {
+  const lsprog_t* lp_prog;
+};
+
+// Objects the host holds. The collector does not scan the host's memory, so they are kept
+// here, in collected memory reachable from g_lsapi_runtimes.
+typedef struct lsapi_held {
+  const void** lah_ents;
+  lssize_t     lah_count;
+  lssize_t     lah_cap;
+} lsapi_held_t;
+
+struct ls_runtime {
+  ls_runtime_t* lr_prev;  // live runtimes (g_lsapi_runtimes)
+  ls_runtime_t* lr_next;
+  ls_context_t* lr_ctx;   // interpreter state, installed while the runtime is called
+  lstenv_t*     lr_env;   // prelude and init script bindings, the parent of every run
+  lsapi_held_t  lr_held;  // programs and values held by the host
+  lsapi_held_t  lr_names; // constructor names returned to the host
+};
+
+static pthread_once_t  g_lsapi_once     = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_lsapi_lock     = PTHREAD_MUTEX_INITIALIZER; // guards g_lsapi_runtimes
+static ls_runtime_t*   g_lsapi_runtimes = NULL;
+
+static void lsapi_init(void) {
+  // As in the lazyscript executable, the collector is not set up for the libc allocator
+  const char* use_libc = getenv("LAZYSCRIPT_USE_LIBC_ALLOC");
+  if (!(use_libc && use_libc[0] && use_libc[0] != '0')) {
+    GC_init();
+    GC_allow_register_threads();
+  }
+}
+
+static void lsapi_hold_in(lsapi_held_t* held, const void* obj) {
+  if (held->lah_count == held->lah_cap) {
+    held->lah_cap  = held->lah_cap ? held->lah_cap * 2 : 16;
+    held->lah_ents = lsrealloc(held->lah_ents, held->lah_cap * sizeof(const void*));
+  }
+  held->lah_ents[held->lah_count++] = obj;
+}
+
+static void lsapi_hold(ls_runtime_t* rt, const void* obj) { lsapi_hold_in(&rt->lr_held, obj); }
+
+static void lsapi_unhold(ls_runtime_t* rt, const void* obj) {
+  lsapi_held_t* held = &rt->lr_held;
+  // Hosts mostly release what they got last
+  for (lssize_t i = held->lah_count; i > 0; i--) {
+    if (held->lah_ents[i - 1] == obj) {
+      held->lah_ents[i - 1]             = held->lah_ents[held->lah_count - 1];
+      held->lah_ents[--held->lah_count] = NULL;
+      return;
+    }
+  }
+}
+
+// Install the runtime's context on the calling thread; returns the context to restore
+static ls_context_t* lsapi_enter(ls_runtime_t* rt) { return ls_context_set_current(rt->lr_ctx); }
+
+static void          lsapi_leave(ls_context_t* prev) { ls_context_set_current(prev); }
+
+ls_runtime_t*        ls_runtime_new(const ls_runtime_opts_t* opts) {
+  static const ls_runtime_opts_t defaults = { NULL, NULL, 0, 0 };
+  if (opts == NULL)
+    opts = &defaults;
+  pthread_once(&g_lsapi_once, lsapi_init);
+  ls_runtime_t* rt = lsmalloc(sizeof(ls_runtime_t));
+  memset(rt, 0, sizeof(ls_runtime_t));
+  rt->lr_ctx         = ls_context_new();
+  ls_context_t* prev = lsapi_enter(rt);
+  ls_effects_set_strict(opts->lro_strict_effects);
+  lsthunk_set_hashcons(opts->lro_hash_cons);
+  rt->lr_env = lstenv_new(NULL);
+  int ok     = ls_prelude_load(rt->lr_env, opts->lro_prelude_so, 0);
+  if (!ok)
+    lsprintf(stderr, 0, "E: prelude: plugin not found or failed to load\n");
+  if (ok && opts->lro_init_file != NULL) {
+    const lsprog_t* iprog = lsparse_file_nullable(opts->lro_init_file);
+    if (iprog == NULL) {
+      lsprintf(stderr, 0, "E: init: cannot load %s\n", opts->lro_init_file);
+      ok = 0;
+    } else {
+      if (ls_effects_get_strict())
+        ls_effects_begin();
+      ls_prefetch_program(iprog);
+      (void)lsprog_eval(iprog, rt->lr_env);
+      if (ls_effects_get_strict())
+        ls_effects_end();
+    }
+  }
+  lsapi_leave(prev);
+  if (!ok) {
+    lsfree(rt->lr_ctx);
+    lsfree(rt);
+    return NULL;
+  }
+  pthread_mutex_lock(&g_lsapi_lock);
+  rt->lr_next = g_lsapi_runtimes;
+  if (g_lsapi_runtimes != NULL)
+    g_lsapi_runtimes->lr_prev = rt;
+  g_lsapi_runtimes = rt;
+  pthread_mutex_unlock(&g_lsapi_lock);
+  return rt;
+}
+
+void ls_runtime_free(ls_runtime_t* rt) {
+  if (rt == NULL)
+    return;
+  pthread_mutex_lock(&g_lsapi_lock);
+  if (rt->lr_prev != NULL)
+    rt->lr_prev->lr_next = rt->lr_next;
+  else
+    g_lsapi_runtimes = rt->lr_next;
+  if (rt->lr_next != NULL)
+    rt->lr_next->lr_prev = rt->lr_prev;
+  pthread_mutex_unlock(&g_lsapi_lock);
+  if (rt->lr_held.lah_ents != NULL)
+    lsfree(rt->lr_held.lah_ents);
+  if (rt->lr_names.lah_ents != NULL)
+    lsfree(rt->lr_names.lah_ents);
+  lsfree(rt->lr_ctx);
+  lsfree(rt);
+}
+
+static ls_program_t* lsapi_program(ls_runtime_t* rt, const lsprog_t* prog) {
+  if (prog == NULL)
+    return NULL;
+  ls_program_t* p = lsmalloc(sizeof(ls_program_t));
+  p->lp_prog      = prog;
+  lsapi_hold(rt, p);
+  return p;
+}
+
+// A copy of a file name for the locations of a program, which outlive the caller's string
+static const char* lsapi_name(const char* name) {
+  size_t len  = strlen(name);
+  char*  copy = lsmalloc_atomic(len + 1);
+  memcpy(copy, name, len + 1);
+  return copy;
+}
+
+ls_program_t* ls_program_compile(ls_runtime_t* rt, const char* name, const char* source) {
+  if (source[0] == '\0') {
+    // The grammar has no empty program
+    lsprintf(stderr, 0, "E: %s: empty program\n", name);
+    return NULL;
+  }
+  return lsapi_program(rt, lsparse_string(lsapi_name(name), source));
+}
+
+ls_program_t* ls_program_compile_file(ls_runtime_t* rt, const char* path) {
+  return lsapi_program(rt, lsparse_file_nullable(lsapi_name(path)));
+}
+
+void ls_program_free(ls_runtime_t* rt, ls_program_t* prog) {
+  if (prog != NULL)
+    lsapi_unhold(rt, prog);
+}
+
+ls_value_t* ls_program_run(ls_runtime_t* rt, const ls_program_t* prog, int argc,
+                           ls_value_t* const* args) {
+  ls_context_t* prev = lsapi_enter(rt);
+  // Each run gets its own bindings; the prelude is shared
+  lstenv_t*     tenv = lstenv_new(rt->lr_env);
+  ls_prefetch_program(prog->lp_prog);
+  lsthunk_t* ret = lsprog_eval(prog->lp_prog, tenv);
+  if (ret != NULL)
+    ret = lsthunk_eval0(ret);
+  if (ret != NULL && argc > 0 && !lsthunk_is_err(ret)) {
+    ret = lsthunk_eval(ret, argc, args);
+    if (ret != NULL)
+      ret = lsthunk_eval0(ret);
+  }
+  lsapi_leave(prev);
+  if (ret != NULL)
+    lsapi_hold(rt, ret);
+  return ret;
+}
+
+ls_value_t* ls_value_new_int(ls_runtime_t* rt, int n) {
+  ls_context_t* prev = lsapi_enter(rt);
+  lsthunk_t*    v    = lsthunk_new_int(lsint_new(n));
+  lsapi_leave(prev);
+  lsapi_hold(rt, v);
+  return v;
+}
+
+ls_value_t* ls_value_new_str(ls_runtime_t* rt, const char* str) {
+  ls_context_t* prev = lsapi_enter(rt);
+  lsthunk_t*    v    = lsthunk_new_str(lsstr_cstr(str));
+  lsapi_leave(prev);
+  lsapi_hold(rt, v);
+  return v;
+}
+
+void ls_value_release(ls_runtime_t* rt, ls_value_t* v) {
+  if (v != NULL)
+    lsapi_unhold(rt, v);
+}
+
+// Evaluate v to WHNF under the runtime's context
+static lsthunk_t* lsapi_whnf(ls_runtime_t* rt, ls_value_t* v) {
+  ls_context_t* prev = lsapi_enter(rt);
+  lsthunk_t*    whnf = lsthunk_eval0(v);
+  lsapi_leave(prev);
+  return whnf;
+}
+
+ls_value_kind_t ls_value_kind(ls_runtime_t* rt, ls_value_t* v) {
+  lsthunk_t* whnf = lsapi_whnf(rt, v);
+  if (whnf == NULL || lsthunk_is_err(whnf))
+    return LS_VALUE_ERROR;
+  switch (lsthunk_get_type(whnf)) {
+  case LSTTYPE_INT:
+    return LS_VALUE_INT;
+  case LSTTYPE_STR:
+    return LS_VALUE_STR;
+  case LSTTYPE_SYMBOL:
+    return LS_VALUE_SYMBOL;
+  case LSTTYPE_ALGE:
+    return LS_VALUE_CONSTR;
+  case LSTTYPE_LAMBDA:
+  case LSTTYPE_BUILTIN:
+  case LSTTYPE_CHOICE:
+    return LS_VALUE_FUNCTION;
+  default:
+    return LS_VALUE_ERROR;
+  }
+}
+
+int ls_value_get_int(ls_runtime_t* rt, ls_value_t* v, int* out) {
+  if (ls_value_kind(rt, v) != LS_VALUE_INT)
+    return -1;
+  *out = lsint_get(lsthunk_get_int(lsapi_whnf(rt, v)));
+  return 0;
+}
+
+char* ls_value_get_str(ls_runtime_t* rt, ls_value_t* v) {
+  ls_value_kind_t kind = ls_value_kind(rt, v);
+  if (kind != LS_VALUE_STR && kind != LS_VALUE_SYMBOL)
+    return NULL;
+  lsthunk_t*     whnf = lsapi_whnf(rt, v);
+  const lsstr_t* str  = kind == LS_VALUE_STR ? lsthunk_get_str(whnf) : lsthunk_get_symbol(whnf);
+  lssize_t       len  = lsstr_get_len(str);
+  char*          buf  = malloc(len + 1);
+  if (buf == NULL)
+    return NULL;
+  memcpy(buf, lsstr_get_buf(str), len);
+  buf[len] = '\0';
+  return buf;
+}
+
+const char* ls_value_get_constr(ls_runtime_t* rt, ls_value_t* v) {
+  if (ls_value_kind(rt, v) != LS_VALUE_CONSTR)
+    return NULL;
+  const lsstr_t* constr = lsthunk_get_constr(lsapi_whnf(rt, v));
+  // The interned copy is NUL-terminated. Interned strings are collected once unreachable, so it
+  // is held by the runtime; there is one per name, held once.
+  const lsstr_t* name  = lsstr_new(lsstr_get_buf(constr), lsstr_get_len(constr));
+  lsapi_held_t*  names = &rt->lr_names;
+  lssize_t       i     = 0;
+  while (i < names->lah_count && names->lah_ents[i] != name)
+    i++;
+  if (i == names->lah_count)
+    lsapi_hold_in(names, name);
+  return lsstr_get_buf(name);
+}
+
+int ls_value_get_argc(ls_runtime_t* rt, ls_value_t* v) {
+  if (ls_value_kind(rt, v) != LS_VALUE_CONSTR)
+    return 0;
+  return (int)lsthunk_get_argc(lsapi_whnf(rt, v));
+}
+
+ls_value_t* ls_value_get_arg(ls_runtime_t* rt, ls_value_t* v, int i) {
+  if (i < 0 || i >= ls_value_get_argc(rt, v))
+    return NULL;
+  return lsthunk_get_args(lsapi_whnf(rt, v))[i];
+}
+
+char* ls_value_to_string(ls_runtime_t* rt, ls_value_t* v) {
+  char*  buf = NULL;
+  size_t len = 0;
+  FILE*  fp  = open_memstream(&buf, &len);
+  if (fp == NULL)
+    return NULL;
+  ls_context_t* prev = lsapi_enter(rt);
+  lsthunk_print(fp, LSPREC_LOWEST, 0, v);
+  lsapi_leave(prev);
+  fclose(fp);
+  return buf;
+}
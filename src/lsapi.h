@@ -0,0 +1,185 @@
+#pragma once
+
+// liblazyscript: embed the LazyScript interpreter in a host program.
+//
+// A runtime loads the prelude (and an init script) once; programs are parsed once into
+// handles and evaluated any number of times, each run in a fresh environment on top of the
+// prelude. Every runtime owns its interpreter state, so different runtimes may be used from
+// different threads at the same time; one runtime must not be used by two threads at once.
+//
+// Values are collected by the runtime's allocator. Values returned by ls_program_run and the
+// ls_value_new_* constructors are held by their runtime until ls_value_release (or
+// ls_runtime_free); values reached through them (constructor arguments) stay valid while the
+// value they were reached from is held. Strings handed to the host are malloc()ed copies.
+//
+// A runtime resolves each module name given to require or include once, relative to the working
+// directory of that first use.
+//
+// With the Boehm collector, threads other than the one that created the first runtime must be
+// registered with it (GC_register_my_thread) before calling in; LAZYSCRIPT_USE_LIBC_ALLOC=1
+// lifts this.
+//
+// The prelude is linked into the library. `~~builtin` modules are searched next to the
+// executable, which is the host here: outside the lazyscript install tree, point
+// LAZYSCRIPT_BUILTIN_PATH at them.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LSAPI_VERSION 1
+
+typedef struct ls_runtime ls_runtime_t;
+typedef struct ls_program ls_program_t;
+typedef struct lsthunk    ls_value_t;
+
+typedef struct ls_runtime_opts {
+  const char* lro_prelude_so;     // prelude plugin (NULL: LAZYSCRIPT_PRELUDE_SO/built in)
+  const char* lro_init_file;      // init script evaluated into the prelude (NULL: none)
+  int         lro_strict_effects; // enforce the effect discipline (--strict-effects)
+  int         lro_hash_cons;      // share structurally equal values (--hash-cons)
+} ls_runtime_opts_t;
+
+typedef enum ls_value_kind {
+  LS_VALUE_INT,
+  LS_VALUE_STR,
+  LS_VALUE_SYMBOL,
+  LS_VALUE_CONSTR,   // constructor application, including lists (":" and "[]") and tuples
+  LS_VALUE_FUNCTION, // lambda, builtin or lambda choice
+  LS_VALUE_ERROR,    // bottom
+} ls_value_kind_t;
+
+/**
+ * Create a runtime
+ * The prelude plugin is loaded and the init script evaluated here, once.
+ * @param opts Options (NULL: defaults)
+ * @return The runtime, or NULL when the prelude cannot be loaded (reported on stderr)
+ */
+ls_runtime_t* ls_runtime_new(const ls_runtime_opts_t* opts);
+
+/**
+ * Release a runtime with its programs and held values
+ * @param rt The runtime
+ */
+void ls_runtime_free(ls_runtime_t* rt);
+
+/**
+ * Parse a program
+ * @param rt The runtime
+ * @param name The name used in diagnostics (e.g. a file name); copied
+ * @param source The source text
+ * @return The program, or NULL on a syntax error or an empty source (reported on stderr)
+ */
+ls_program_t* ls_program_compile(ls_runtime_t* rt, const char* name, const char* source);
+
+/**
+ * Parse a program from a file
+ * @param rt The runtime
+ * @param path The file
+ * @return The program, or NULL when the file cannot be read or on a syntax error
+ */
+ls_program_t* ls_program_compile_file(ls_runtime_t* rt, const char* path);
+
+/**
+ * Release a program
+ * @param rt The runtime
+ * @param prog The program
+ */
+void ls_program_free(ls_runtime_t* rt, ls_program_t* prog);
+
+/**
+ * Evaluate a program, applying its value to arguments when there are any
+ * @param rt The runtime
+ * @param prog The program
+ * @param argc The number of arguments
+ * @param args The arguments (values of rt)
+ * @return The value in weak head normal form (held; see ls_value_release), or NULL on a fatal
+ *         evaluation error. Errors raised by the program are LS_VALUE_ERROR values.
+ */
+ls_value_t* ls_program_run(ls_runtime_t* rt, const ls_program_t* prog, int argc,
+                           ls_value_t* const* args);
+
+/**
+ * Make an integer value (held)
+ * @param rt The runtime
+ * @param n The integer
+ * @return The value
+ */
+ls_value_t* ls_value_new_int(ls_runtime_t* rt, int n);
+
+/**
+ * Make a string value (held)
+ * @param rt The runtime
+ * @param str The string (copied)
+ * @return The value
+ */
+ls_value_t* ls_value_new_str(ls_runtime_t* rt, const char* str);
+
+/**
+ * Let the runtime collect a held value
+ * @param rt The runtime
+ * @param v The value
+ */
+void ls_value_release(ls_runtime_t* rt, ls_value_t* v);
+
+/**
+ * Get the kind of a value, evaluating it to weak head normal form first
+ * @param rt The runtime
+ * @param v The value
+ * @return The kind
+ */
+ls_value_kind_t ls_value_kind(ls_runtime_t* rt, ls_value_t* v);
+
+/**
+ * Get the integer of an LS_VALUE_INT value
+ * @param rt The runtime
+ * @param v The value
+ * @param out Where to store the integer
+ * @return 0, or -1 when v is not an integer
+ */
+int ls_value_get_int(ls_runtime_t* rt, ls_value_t* v, int* out);
+
+/**
+ * Get the contents of an LS_VALUE_STR value (or the name of an LS_VALUE_SYMBOL)
+ * @param rt The runtime
+ * @param v The value
+ * @return A malloc()ed copy, or NULL when v is not a string or symbol
+ */
+char* ls_value_get_str(ls_runtime_t* rt, ls_value_t* v);
+
+/**
+ * Get the constructor name of an LS_VALUE_CONSTR value
+ * @param rt The runtime
+ * @param v The value
+ * @return The name (owned by the runtime, valid until ls_runtime_free), or NULL for other kinds
+ */
+const char* ls_value_get_constr(ls_runtime_t* rt, ls_value_t* v);
+
+/**
+ * Get the number of arguments of an LS_VALUE_CONSTR value
+ * @param rt The runtime
+ * @param v The value
+ * @return The number of arguments (0 for other kinds)
+ */
+int ls_value_get_argc(ls_runtime_t* rt, ls_value_t* v);
+
+/**
+ * Get an argument of an LS_VALUE_CONSTR value
+ * @param rt The runtime
+ * @param v The value
+ * @param i The index (< ls_value_get_argc)
+ * @return The argument, not evaluated
+ */
+ls_value_t* ls_value_get_arg(ls_runtime_t* rt, ls_value_t* v, int i);
+
+/**
+ * Print a value as the lazyscript executable prints results, evaluating it fully
+ * @param rt The runtime
+ * @param v The value
+ * @return A malloc()ed string
+ */
+char* ls_value_to_string(ls_runtime_t* rt, ls_value_t* v);
+
+#ifdef __cplusplus
+}
+#endif
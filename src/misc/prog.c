@@ -18,6 +18,8 @@ struct lsscan {
   int              ls_tight_since_last; // no whitespace since last token
 };
 
+static __thread int g_scan_quiet = 0; // syntax errors are not reported on this thread
+
 const lsprog_t* lsprog_new(const lsexpr_t* expr, const lsarray_t* comments) {
   lsprog_t* prog    = lsmalloc(sizeof(lsprog_t));
   prog->lp_expr     = expr;
@@ -42,6 +44,8 @@ const lsarray_t* lsprog_get_comments(const lsprog_t* prog) { return prog->lp_com
 
 void             yyerror(lsloc_t* loc, lsscan_t* scanner, const char* s) {
               (void)scanner;
+              if (g_scan_quiet)
+                return;
               lsloc_print(stderr, *loc);
               lsprintf(stderr, 0, "%s\n", s);
 }
@@ -63,6 +67,8 @@ void        lsscan_set_prog(lsscan_t* scanner, const lsprog_t* prog) { scanner->
 
 const char* lsscan_get_filename(const lsscan_t* scanner) { return scanner->ls_filename; }
 
+void        lsscan_set_quiet(int quiet) { g_scan_quiet = quiet; }
+
 void        lsscan_set_sugar_ns(lsscan_t* scanner, const char* ns) {
          scanner->ls_sugar_ns = (ns && ns[0]) ? ns : "prelude";
 }
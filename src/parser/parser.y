@@ -42,7 +42,7 @@ do                                                        \
     }                                                     \
   else                                                    \
     {                                                     \
-      (Cur).filename     = YYRHSLOC(Rhs, 1).filename;     \
+      (Cur).filename     = YYRHSLOC(Rhs, 0).filename;     \
       (Cur).first_line   = (Cur).last_line   =            \
         YYRHSLOC(Rhs, 0).last_line;                       \
       (Cur).first_column = (Cur).last_column =            \
@@ -28,6 +28,9 @@ static void pl_import_cb(const lsstr_t* sym, lsthunk_t* value, void* data);
 // Core runtime builtins forwarded under prelude
 extern lsthunk_t* lsbuiltin_print(lssize_t argc, lsthunk_t* const* args, void* data);
 extern lsthunk_t* lsbuiltin_seq(lssize_t argc, lsthunk_t* const* args, void* data);
+extern lsthunk_t* lsbuiltin_par(lssize_t argc, lsthunk_t* const* args, void* data);
+extern lsthunk_t* lsbuiltin_pseq(lssize_t argc, lsthunk_t* const* args, void* data);
+extern lsthunk_t* lsbuiltin_par_map(lssize_t argc, lsthunk_t* const* args, void* data);
 extern lsthunk_t* lsbuiltin_add(lssize_t argc, lsthunk_t* const* args, void* data);
 extern lsthunk_t* lsbuiltin_to_string(lssize_t argc, lsthunk_t* const* args, void* data);
 extern lsthunk_t* lsbuiltin_prelude_require(lssize_t, lsthunk_t* const*, void*);
@@ -382,6 +385,17 @@ static lsthunk_t* pl_withImport(lssize_t argc, lsthunk_t* const* args, void* dat
 // pluginHello removed
 // nsdef stub removed
 
+// What pl_dispatch maps a name to, for the strictness analysis: its strict builtins (keep in
+// step with pl_dispatch)
+static int pl_dispatch_lookup(const lsstr_t* name, lssize_t* parity, lsbuiltin_attr_t* pattr) {
+  if (lsstrcmp(name, lsstr_cstr("add")) == 0) {
+    *parity = 2;
+    *pattr  = LSBATTR_STRICT;
+    return 1;
+  }
+  return 0;
+}
+
 // main 1-arg dispatcher for prelude: maps names to builtins
 static lsthunk_t* pl_dispatch(lssize_t argc, lsthunk_t* const* args, void* data) {
   lstenv_t* tenv = (lstenv_t*)data;
@@ -403,7 +417,7 @@ static lsthunk_t* pl_dispatch(lssize_t argc, lsthunk_t* const* args, void* data)
 
   if (lsstrcmp(name, lsstr_cstr("add")) == 0)
     return lsthunk_new_builtin_attr(lsstr_cstr("prelude.add"), 2, lsbuiltin_add, NULL,
-                                    LSBATTR_PURE);
+                                    LSBATTR_STRICT);
   if (lsstrcmp(name, lsstr_cstr("seq")) == 0)
     return lsthunk_new_builtin_attr(lsstr_cstr("prelude.seq"), 2, lsbuiltin_seq, NULL,
                                     LSBATTR_EFFECT);
@@ -449,6 +463,15 @@ static lsthunk_t* pl_dispatch(lssize_t argc, lsthunk_t* const* args, void* data)
     return lsthunk_new_builtin_attr(lsstr_cstr("prelude.trace"), 2, pl_trace, NULL, LSBATTR_EFFECT);
   if (lsstrcmp(name, lsstr_cstr("force")) == 0)
     return lsthunk_new_builtin_attr(lsstr_cstr("prelude.force"), 1, pl_force, NULL, LSBATTR_PURE);
+  if (lsstrcmp(name, lsstr_cstr("par")) == 0)
+    return lsthunk_new_builtin_attr(lsstr_cstr("prelude.par"), 2, lsbuiltin_par, NULL,
+                                    LSBATTR_PURE);
+  if (lsstrcmp(name, lsstr_cstr("pseq")) == 0)
+    return lsthunk_new_builtin_attr(lsstr_cstr("prelude.pseq"), 2, lsbuiltin_pseq, NULL,
+                                    LSBATTR_PURE);
+  if (lsstrcmp(name, lsstr_cstr("parMap")) == 0)
+    return lsthunk_new_builtin_attr(lsstr_cstr("prelude.parMap"), 2, lsbuiltin_par_map, NULL,
+                                    LSBATTR_PURE);
   if (lsstrcmp(name, lsstr_cstr("traceForce")) == 0)
     return lsthunk_new_builtin_attr(lsstr_cstr("prelude.traceForce"), 2, pl_trace_force, NULL,
                                     LSBATTR_EFFECT);
@@ -492,8 +515,9 @@ static lsthunk_t* pl_dispatch(lssize_t argc, lsthunk_t* const* args, void* data)
 int ls_prelude_register(lstenv_t* tenv) {
   if (!tenv)
     return -1;
-  lstenv_put_builtin(tenv, lsstr_cstr("prelude"), 1, pl_dispatch, tenv);
+  lstenv_put_dispatcher(tenv, lsstr_cstr("prelude"), pl_dispatch, tenv, pl_dispatch_lookup);
   // Stable alias kept as builtin even after prelude is rebound to a value
-  lstenv_put_builtin(tenv, lsstr_cstr("prelude$builtin"), 1, pl_dispatch, tenv);
+  lstenv_put_dispatcher(tenv, lsstr_cstr("prelude$builtin"), pl_dispatch, tenv,
+                        pl_dispatch_lookup);
   return 0;
 }
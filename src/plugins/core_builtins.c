@@ -12,6 +12,9 @@ lsthunk_t* lsbuiltin_dump(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_to_string(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_print(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_seq(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_par(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_pseq(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_par_map(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_add(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_sub(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_lt(lssize_t argc, lsthunk_t* const* args, void* data);
@@ -32,6 +35,23 @@ static lsthunk_t* cb_eq(lssize_t argc, lsthunk_t* const* args, void* data) {
     const char* v = getenv("LAZYSCRIPT_ENABLE_TRACE");
     do_log        = (v && v[0] && v[0] != '0');
   }
+  lsttype_t ta = lsthunk_get_type(a);
+  if (lsthunk_is_hashconsed(a) && lsthunk_is_hashconsed(b) &&
+      (ta == LSTTYPE_INT || ta == LSTTYPE_SYMBOL ||
+       (ta == LSTTYPE_ALGE && lsthunk_get_argc(a) == 0))) {
+    // Canonical values of the kinds compared below: equality is node identity. Other kinds
+    // (strings, constructors with arguments) compare as below with or without hash-consing.
+    int eq = a == b;
+    if (do_log) {
+      lsprintf(stderr, 0, "[core.eq:hashcons] ");
+      lsthunk_dprint(stderr, LSPREC_LOWEST, 0, a);
+      lsprintf(stderr, 0, " == ");
+      lsthunk_dprint(stderr, LSPREC_LOWEST, 0, b);
+      lsprintf(stderr, 0, " -> %s\n", eq ? "true" : "false");
+    }
+    return lsthunk_new_ealge(lsealge_new(eq ? lsstr_cstr("true") : lsstr_cstr("false"), 0, NULL),
+                             NULL);
+  }
   if (lsthunk_get_type(a) == LSTTYPE_INT && lsthunk_get_type(b) == LSTTYPE_INT) {
     int eq = lsint_eq(lsthunk_get_int(a), lsthunk_get_int(b));
     if (do_log) {
@@ -60,9 +80,7 @@ static lsthunk_t* cb_eq(lssize_t argc, lsthunk_t* const* args, void* data) {
   }
   if (lsthunk_get_type(a) == LSTTYPE_ALGE && lsthunk_get_argc(a) == 0 &&
       lsthunk_get_type(b) == LSTTYPE_ALGE && lsthunk_get_argc(b) == 0) {
-    const lsstr_t* ca = lsthunk_get_constr(a);
-    const lsstr_t* cb = lsthunk_get_constr(b);
-    int            eq = (lsstrcmp(ca, cb) == 0);
+    int eq = lsthunk_get_constr_tag(a) == lsthunk_get_constr_tag(b);
     if (do_log) {
       lsprintf(stderr, 0, "[core.eq:alge0] ");
       lsthunk_dprint(stderr, LSPREC_LOWEST, 0, a);
@@ -162,6 +180,9 @@ static const ls_builtin_entry_t CORE_ENTRIES[] = {
   { "return", 1, cb_return, NULL },
   { "seq", 2, lsbuiltin_seq, (void*)0 },
   { "seqc", 2, lsbuiltin_seq, (void*)1 },
+  { "par", 2, lsbuiltin_par, NULL },
+  { "pseq", 2, lsbuiltin_pseq, NULL },
+  { "parMap", 2, lsbuiltin_par_map, NULL },
   { "add", 2, lsbuiltin_add, NULL },
   { "sub", 2, lsbuiltin_sub, NULL },
   { "lt", 2, lsbuiltin_lt, NULL },
@@ -13,9 +13,15 @@ lsthunk_t* lsbuiltin_print(lssize_t argc, lsthunk_t* const* args, void* data);
 // sequencing
 lsthunk_t* lsbuiltin_seq(lssize_t argc, lsthunk_t* const* args, void* data);
 
+// parallel evaluation
+lsthunk_t* lsbuiltin_par(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_pseq(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_par_map(lssize_t argc, lsthunk_t* const* args, void* data);
+
 // arithmetic
 lsthunk_t* lsbuiltin_add(lssize_t argc, lsthunk_t* const* args, void* data);
 lsthunk_t* lsbuiltin_sub(lssize_t argc, lsthunk_t* const* args, void* data);
+lsthunk_t* lsbuiltin_lt(lssize_t argc, lsthunk_t* const* args, void* data);
 
 // namespaces
 lsthunk_t* lsbuiltin_nsnew(lssize_t argc, lsthunk_t* const* args, void* data);
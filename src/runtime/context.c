@@ -0,0 +1,22 @@
+#include "runtime/context.h"
+#include "common/malloc.h"
+#include <string.h>
+
+static ls_context_t           g_context_default;
+static __thread ls_context_t* g_context_current = NULL;
+
+ls_context_t* ls_context_new(void) {
+  ls_context_t* ctx = lsmalloc(sizeof(ls_context_t));
+  memset(ctx, 0, sizeof(ls_context_t));
+  return ctx;
+}
+
+ls_context_t* ls_context_current(void) {
+  return g_context_current != NULL ? g_context_current : &g_context_default;
+}
+
+ls_context_t* ls_context_set_current(ls_context_t* ctx) {
+  ls_context_t* prev = ls_context_current();
+  g_context_current  = ctx;
+  return prev;
+}
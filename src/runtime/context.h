@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common/hash.h"
+
+// Interpreter context: the mutable state of one interpreter. Each thread evaluates under a
+// current context (the process default until another is installed), so independent
+// interpreters can run on different threads of one process. State shared between threads stays
+// process-wide behind locks: interned strings, the spark pool and the node trace ids of a loaded
+// trace map (the map itself is read-only once loaded).
+typedef struct ls_context {
+  int           lc_trace_next_id;  // next creation-order trace id of a node
+  int           lc_hashcons;       // share structurally equal values (--hash-cons)
+  void*         lc_hashcons_table; // canonical values of this context (thunk.c; weak links)
+  int           lc_effects_strict; // guard side effects (--strict-effects)
+  lshash_t*     lc_loaded;         // modules loaded by require (file identity -> 1)
+  lshash_t*     lc_resolved;       // names resolved by require (name -> file)
+  const char*   lc_resolved_spath; // LAZYSCRIPT_PATH lc_resolved was filled under
+  lshash_t*     lc_prefetched;     // modules parsed ahead of require (file identity -> entry)
+  lshash_t*     lc_namespaces;     // named namespaces (name -> ns)
+  void*         lc_nslit_self;     // namespace whose literal or member is being evaluated
+  unsigned long lc_ns_counter;     // suffix of generated namespace names
+  lshash_t*     lc_builtin_cache;  // modules loaded by (~builtin "name") (name -> ns value)
+} ls_context_t;
+
+/**
+ * Create a context with fresh state and default settings
+ * @return The context
+ */
+ls_context_t* ls_context_new(void);
+
+/**
+ * Get the context of the calling thread
+ * @return The installed context, or the process default
+ */
+ls_context_t* ls_context_current(void);
+
+/**
+ * Install a context on the calling thread
+ * Values built under one context must not be evaluated under another.
+ * @param ctx The context (NULL: the process default)
+ * @return The previously installed context
+ */
+ls_context_t* ls_context_set_current(ls_context_t* ctx);
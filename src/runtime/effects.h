@@ -7,3 +7,5 @@ int  ls_effects_get_strict(void);
 void ls_effects_begin(void);
 void ls_effects_end(void);
 int  ls_effects_allowed(void);
+// Leave every effect scope of the calling thread (after an evaluation was abandoned)
+void ls_effects_reset(void);
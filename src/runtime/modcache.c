@@ -0,0 +1,716 @@
+#include "runtime/modcache.h"
+#include "lazyscript.h"
+#include "common/hash.h"
+#include "common/io.h"
+#include "common/loc.h"
+#include "common/malloc.h"
+#include "common/ref.h"
+#include "expr/expr.h"
+#include "misc/bind.h"
+#include "pat/palge.h"
+#include "pat/pas.h"
+#include "pat/pat.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Image layout (native byte order, 32-bit words):
+//   lsmodcache_hdr_t
+//   strings  lmh_nstrs x (length, bytes padded to a word)
+//   tree     lmh_nwords words: the program expression in prefix order, strings by index
+#define LSMODCACHE_MAGIC 0x494d534cu // "LSMI"
+// Bump when the syntax tree or its encoding changes
+#define LSMODCACHE_FORMAT 1u
+
+typedef struct lsmodcache_hdr {
+  uint32_t lmh_magic;
+  uint32_t lmh_format;
+  uint64_t lmh_key;      // content key of the source
+  uint64_t lmh_src_size; // bytes of the source
+  uint32_t lmh_nstrs;
+  uint32_t lmh_nwords;
+} lsmodcache_hdr_t;
+
+// Index entry: the image of a source file while its identity, mtime and size are unchanged
+typedef struct lsmodcache_idx {
+  uint32_t lmi_magic;
+  uint32_t lmi_format;
+  uint64_t lmi_dev;
+  uint64_t lmi_ino;
+  uint64_t lmi_size;
+  int64_t  lmi_mtime_sec;
+  int64_t  lmi_mtime_nsec;
+  uint64_t lmi_key;
+} lsmodcache_idx_t;
+
+// File name of a location
+typedef enum lsmodcache_locfile {
+  LSMODCACHE_LOC_NONE,    // NULL
+  LSMODCACHE_LOC_UNKNOWN, // "<unknown>" of nodes built without a location
+  LSMODCACHE_LOC_FILE,    // the module file
+} lsmodcache_locfile_t;
+
+// -------------------------------
+// Encoding
+// -------------------------------
+
+typedef struct lsmodcache_enc {
+  uint32_t*       lme_words;
+  size_t          lme_len;
+  size_t          lme_cap;
+  lshash_t*       lme_strs; // string -> index + 1
+  const lsstr_t** lme_strv;
+  uint32_t        lme_nstrs;
+  uint32_t        lme_strcap;
+  const char*     lme_file;
+  int             lme_err; // the tree cannot be encoded
+} lsmodcache_enc_t;
+
+static void lsmodcache_put(lsmodcache_enc_t* e, uint32_t w) {
+  if (e->lme_len == e->lme_cap) {
+    size_t    cap = e->lme_cap ? e->lme_cap * 2 : 1024;
+    uint32_t* ws  = realloc(e->lme_words, cap * sizeof(uint32_t));
+    if (ws == NULL) {
+      e->lme_err = 1;
+      return;
+    }
+    e->lme_words = ws;
+    e->lme_cap   = cap;
+  }
+  e->lme_words[e->lme_len++] = w;
+}
+
+static void lsmodcache_put_str(lsmodcache_enc_t* e, const lsstr_t* s) {
+  lshash_data_t idx;
+  if (!lshash_get(e->lme_strs, s, &idx)) {
+    if (e->lme_nstrs == e->lme_strcap) {
+      uint32_t        cap = e->lme_strcap ? e->lme_strcap * 2 : 64;
+      const lsstr_t** sv  = realloc(e->lme_strv, cap * sizeof(const lsstr_t*));
+      if (sv == NULL) {
+        e->lme_err = 1;
+        return;
+      }
+      e->lme_strv   = sv;
+      e->lme_strcap = cap;
+    }
+    e->lme_strv[e->lme_nstrs++] = s;
+    idx                         = (lshash_data_t)(uintptr_t)e->lme_nstrs;
+    lshash_data_t old;
+    (void)lshash_put(e->lme_strs, s, idx, &old);
+  }
+  lsmodcache_put(e, (uint32_t)(uintptr_t)idx - 1);
+}
+
+static void lsmodcache_put_loc(lsmodcache_enc_t* e, lsloc_t loc) {
+  if (loc.filename == NULL)
+    lsmodcache_put(e, LSMODCACHE_LOC_NONE);
+  else if (strcmp(loc.filename, "<unknown>") == 0)
+    lsmodcache_put(e, LSMODCACHE_LOC_UNKNOWN);
+  else if (loc.filename == e->lme_file || strcmp(loc.filename, e->lme_file) == 0)
+    lsmodcache_put(e, LSMODCACHE_LOC_FILE);
+  else
+    e->lme_err = 1;
+  lsmodcache_put(e, (uint32_t)loc.first_line);
+  lsmodcache_put(e, (uint32_t)loc.first_column);
+  lsmodcache_put(e, (uint32_t)loc.last_line);
+  lsmodcache_put(e, (uint32_t)loc.last_column);
+}
+
+static void lsmodcache_put_ref(lsmodcache_enc_t* e, const lsref_t* ref) {
+  lsmodcache_put_str(e, lsref_get_name(ref));
+  lsmodcache_put_loc(e, lsref_get_loc(ref));
+}
+
+static void lsmodcache_put_pat(lsmodcache_enc_t* e, const lspat_t* pat) {
+  lsptype_t type = lspat_get_type(pat);
+  lsmodcache_put(e, (uint32_t)type);
+  switch (type) {
+  case LSPTYPE_ALGE: {
+    const lspalge_t* palge = lspat_get_alge(pat);
+    lssize_t         argc  = lspalge_get_argc(palge);
+    lsmodcache_put_str(e, lspalge_get_constr(palge));
+    lsmodcache_put(e, (uint32_t)argc);
+    for (lssize_t i = 0; i < argc; i++)
+      lsmodcache_put_pat(e, lspalge_get_arg(palge, i));
+    break;
+  }
+  case LSPTYPE_AS:
+    lsmodcache_put_ref(e, lspas_get_ref(lspat_get_as(pat)));
+    lsmodcache_put_pat(e, lspas_get_pat(lspat_get_as(pat)));
+    break;
+  case LSPTYPE_INT:
+    lsmodcache_put(e, (uint32_t)lsint_get(lspat_get_int(pat)));
+    break;
+  case LSPTYPE_STR:
+    lsmodcache_put_str(e, lspat_get_str(pat));
+    break;
+  case LSPTYPE_REF:
+    lsmodcache_put_ref(e, lspat_get_ref(pat));
+    break;
+  case LSPTYPE_WILDCARD:
+    break;
+  case LSPTYPE_OR:
+    lsmodcache_put_pat(e, lspat_get_or_left(pat));
+    lsmodcache_put_pat(e, lspat_get_or_right(pat));
+    break;
+  case LSPTYPE_CARET:
+    lsmodcache_put_pat(e, lspat_get_caret_inner(pat));
+    break;
+  default:
+    e->lme_err = 1;
+  }
+}
+
+static void lsmodcache_put_expr(lsmodcache_enc_t* e, const lsexpr_t* expr) {
+  lsetype_t type = lsexpr_get_type(expr);
+  lsmodcache_put(e, (uint32_t)type);
+  lsmodcache_put_loc(e, lsexpr_get_loc(expr));
+  switch (type) {
+  case LSETYPE_ALGE: {
+    const lsealge_t* ealge = lsexpr_get_alge(expr);
+    lssize_t         argc  = lsealge_get_argc(ealge);
+    lsmodcache_put_str(e, lsealge_get_constr(ealge));
+    lsmodcache_put(e, (uint32_t)argc);
+    for (lssize_t i = 0; i < argc; i++)
+      lsmodcache_put_expr(e, lsealge_get_arg(ealge, i));
+    break;
+  }
+  case LSETYPE_APPL: {
+    const lseappl_t*       eappl = lsexpr_get_appl(expr);
+    lssize_t               argc  = lseappl_get_argc(eappl);
+    const lsexpr_t* const* args  = lseappl_get_args(eappl);
+    lsmodcache_put_expr(e, lseappl_get_func(eappl));
+    lsmodcache_put(e, (uint32_t)argc);
+    for (lssize_t i = 0; i < argc; i++)
+      lsmodcache_put_expr(e, args[i]);
+    break;
+  }
+  case LSETYPE_LAMBDA:
+    lsmodcache_put_pat(e, lselambda_get_param(lsexpr_get_lambda(expr)));
+    lsmodcache_put_expr(e, lselambda_get_body(lsexpr_get_lambda(expr)));
+    break;
+  case LSETYPE_REF:
+    lsmodcache_put_ref(e, lsexpr_get_ref(expr));
+    break;
+  case LSETYPE_INT:
+    lsmodcache_put(e, (uint32_t)lsint_get(lsexpr_get_int(expr)));
+    break;
+  case LSETYPE_STR:
+    lsmodcache_put_str(e, lsexpr_get_str(expr));
+    break;
+  case LSETYPE_CLOSURE: {
+    const lseclosure_t*    closure = lsexpr_get_closure(expr);
+    lssize_t               bindc   = lseclosure_get_bindc(closure);
+    const lsbind_t* const* binds   = lseclosure_get_binds(closure);
+    lsmodcache_put_expr(e, lseclosure_get_expr(closure));
+    lsmodcache_put(e, (uint32_t)bindc);
+    for (lssize_t i = 0; i < bindc; i++) {
+      lsmodcache_put_pat(e, lsbind_get_lhs(binds[i]));
+      lsmodcache_put_expr(e, lsbind_get_rhs(binds[i]));
+    }
+    break;
+  }
+  case LSETYPE_CHOICE: {
+    const lsechoice_t* choice = lsexpr_get_choice(expr);
+    lsmodcache_put(e, (uint32_t)lsechoice_get_kind(choice));
+    lsmodcache_put_expr(e, lsechoice_get_left(choice));
+    lsmodcache_put_expr(e, lsechoice_get_right(choice));
+    break;
+  }
+  case LSETYPE_NSLIT: {
+    const lsenslit_t* ns    = lsexpr_get_nslit(expr);
+    lssize_t          count = lsenslit_get_count(ns);
+    lsmodcache_put(e, (uint32_t)count);
+    for (lssize_t i = 0; i < count; i++) {
+      lsmodcache_put_str(e, lsenslit_get_name(ns, i));
+      lsmodcache_put_expr(e, lsenslit_get_expr(ns, i));
+    }
+    break;
+  }
+  case LSETYPE_SYMBOL:
+    lsmodcache_put_str(e, lsexpr_get_symbol(expr));
+    break;
+  case LSETYPE_RAISE:
+    lsmodcache_put_expr(e, lsexpr_get_raise_arg(expr));
+    break;
+  default:
+    e->lme_err = 1;
+  }
+}
+
+// -------------------------------
+// Decoding
+// -------------------------------
+
+typedef struct lsmodcache_dec {
+  const uint32_t* lmd_words;
+  size_t          lmd_len;
+  size_t          lmd_pos;
+  const lsstr_t** lmd_strv;
+  uint32_t        lmd_nstrs;
+  const char*     lmd_file;
+  int             lmd_err; // the image is malformed
+} lsmodcache_dec_t;
+
+static uint32_t lsmodcache_get(lsmodcache_dec_t* d) {
+  if (d->lmd_pos >= d->lmd_len) {
+    d->lmd_err = 1;
+    return 0;
+  }
+  return d->lmd_words[d->lmd_pos++];
+}
+
+// A count of items taking at least one word each
+static lssize_t lsmodcache_get_count(lsmodcache_dec_t* d) {
+  uint32_t n = lsmodcache_get(d);
+  if (n > d->lmd_len - d->lmd_pos) {
+    d->lmd_err = 1;
+    return 0;
+  }
+  return (lssize_t)n;
+}
+
+static const lsstr_t* lsmodcache_get_str(lsmodcache_dec_t* d) {
+  uint32_t i = lsmodcache_get(d);
+  if (i >= d->lmd_nstrs) {
+    d->lmd_err = 1;
+    return lsstr_cstr("");
+  }
+  return d->lmd_strv[i];
+}
+
+static lsloc_t lsmodcache_get_loc(lsmodcache_dec_t* d) {
+  uint32_t    kind = lsmodcache_get(d);
+  const char* file = kind == LSMODCACHE_LOC_FILE      ? d->lmd_file
+                     : kind == LSMODCACHE_LOC_UNKNOWN ? "<unknown>"
+                                                      : NULL;
+  lsloc_t     loc;
+  loc.filename     = file;
+  loc.first_line   = (int)lsmodcache_get(d);
+  loc.first_column = (int)lsmodcache_get(d);
+  loc.last_line    = (int)lsmodcache_get(d);
+  loc.last_column  = (int)lsmodcache_get(d);
+  if (kind > LSMODCACHE_LOC_FILE)
+    d->lmd_err = 1;
+  return loc; // not lsloc(): it asserts on the positions a damaged image may hold
+}
+
+static const lsref_t* lsmodcache_get_ref(lsmodcache_dec_t* d) {
+  const lsstr_t* name = lsmodcache_get_str(d);
+  return lsref_new(name, lsmodcache_get_loc(d));
+}
+
+static const lspat_t* lsmodcache_get_pat(lsmodcache_dec_t* d) {
+  uint32_t type = lsmodcache_get(d);
+  if (d->lmd_err)
+    return NULL;
+  switch (type) {
+  case LSPTYPE_ALGE: {
+    const lsstr_t*  constr = lsmodcache_get_str(d);
+    lssize_t        argc   = lsmodcache_get_count(d);
+    const lspat_t** args   = argc > 0 ? lsmalloc(argc * sizeof(lspat_t*)) : NULL;
+    for (lssize_t i = 0; i < argc && !d->lmd_err; i++)
+      args[i] = lsmodcache_get_pat(d);
+    return d->lmd_err ? NULL : lspat_new_alge(lspalge_new(constr, argc, args));
+  }
+  case LSPTYPE_AS: {
+    const lsref_t* ref = lsmodcache_get_ref(d);
+    const lspat_t* pat = lsmodcache_get_pat(d);
+    return d->lmd_err ? NULL : lspat_new_as(lspas_new(ref, pat));
+  }
+  case LSPTYPE_INT:
+    return lspat_new_int(lsint_new((int)lsmodcache_get(d)));
+  case LSPTYPE_STR:
+    return lspat_new_str(lsmodcache_get_str(d));
+  case LSPTYPE_REF:
+    return lspat_new_ref(lsmodcache_get_ref(d));
+  case LSPTYPE_WILDCARD:
+    return lspat_new_wild();
+  case LSPTYPE_OR: {
+    const lspat_t* left  = lsmodcache_get_pat(d);
+    const lspat_t* right = lsmodcache_get_pat(d);
+    return d->lmd_err ? NULL : lspat_new_or(left, right);
+  }
+  case LSPTYPE_CARET: {
+    const lspat_t* inner = lsmodcache_get_pat(d);
+    return d->lmd_err ? NULL : lspat_new_caret(inner);
+  }
+  default:
+    d->lmd_err = 1;
+    return NULL;
+  }
+}
+
+static const lsexpr_t* lsmodcache_get_expr(lsmodcache_dec_t* d) {
+  uint32_t type = lsmodcache_get(d);
+  lsloc_t  loc  = lsmodcache_get_loc(d);
+  if (d->lmd_err)
+    return NULL;
+  const lsexpr_t* expr = NULL;
+  switch (type) {
+  case LSETYPE_ALGE: {
+    const lsstr_t*   constr = lsmodcache_get_str(d);
+    lssize_t         argc   = lsmodcache_get_count(d);
+    const lsexpr_t** args   = argc > 0 ? lsmalloc(argc * sizeof(lsexpr_t*)) : NULL;
+    for (lssize_t i = 0; i < argc && !d->lmd_err; i++)
+      args[i] = lsmodcache_get_expr(d);
+    if (!d->lmd_err)
+      expr = lsexpr_new_alge(lsealge_new(constr, argc, args));
+    break;
+  }
+  case LSETYPE_APPL: {
+    const lsexpr_t*  func = lsmodcache_get_expr(d);
+    lssize_t         argc = lsmodcache_get_count(d);
+    const lsexpr_t** args = argc > 0 ? lsmalloc(argc * sizeof(lsexpr_t*)) : NULL;
+    for (lssize_t i = 0; i < argc && !d->lmd_err; i++)
+      args[i] = lsmodcache_get_expr(d);
+    if (!d->lmd_err)
+      expr = lsexpr_new_appl(lseappl_new(func, argc, args));
+    break;
+  }
+  case LSETYPE_LAMBDA: {
+    const lspat_t*  param = lsmodcache_get_pat(d);
+    const lsexpr_t* body  = d->lmd_err ? NULL : lsmodcache_get_expr(d);
+    if (!d->lmd_err)
+      expr = lsexpr_new_lambda(lselambda_new(param, body));
+    break;
+  }
+  case LSETYPE_REF:
+    expr = lsexpr_new_ref(lsmodcache_get_ref(d));
+    break;
+  case LSETYPE_INT:
+    expr = lsexpr_new_int(lsint_new((int)lsmodcache_get(d)));
+    break;
+  case LSETYPE_STR:
+    expr = lsexpr_new_str(lsmodcache_get_str(d));
+    break;
+  case LSETYPE_CLOSURE: {
+    const lsexpr_t*  body  = lsmodcache_get_expr(d);
+    lssize_t         bindc = lsmodcache_get_count(d);
+    const lsbind_t** binds = bindc > 0 ? lsmalloc(bindc * sizeof(lsbind_t*)) : NULL;
+    for (lssize_t i = 0; i < bindc && !d->lmd_err; i++) {
+      const lspat_t*  lhs = lsmodcache_get_pat(d);
+      const lsexpr_t* rhs = d->lmd_err ? NULL : lsmodcache_get_expr(d);
+      if (!d->lmd_err)
+        binds[i] = lsbind_new(lhs, rhs);
+    }
+    if (!d->lmd_err)
+      expr = lsexpr_new_closure(lseclosure_new(body, bindc, binds));
+    break;
+  }
+  case LSETYPE_CHOICE: {
+    uint32_t        kind  = lsmodcache_get(d);
+    const lsexpr_t* left  = lsmodcache_get_expr(d);
+    const lsexpr_t* right = d->lmd_err ? NULL : lsmodcache_get_expr(d);
+    if (kind < LSECHOICE_LAMBDA || kind > LSECHOICE_CATCH)
+      d->lmd_err = 1;
+    if (!d->lmd_err)
+      expr = lsexpr_new_choice(lsechoice_new_kind(left, right, (lsechoice_kind_t)kind));
+    break;
+  }
+  case LSETYPE_NSLIT: {
+    lssize_t         count = lsmodcache_get_count(d);
+    const lsstr_t**  names = count > 0 ? lsmalloc(count * sizeof(lsstr_t*)) : NULL;
+    const lsexpr_t** exprs = count > 0 ? lsmalloc(count * sizeof(lsexpr_t*)) : NULL;
+    for (lssize_t i = 0; i < count && !d->lmd_err; i++) {
+      names[i] = lsmodcache_get_str(d);
+      exprs[i] = lsmodcache_get_expr(d);
+    }
+    if (!d->lmd_err)
+      expr = lsexpr_new_nslit(lsenslit_new(count, names, exprs));
+    break;
+  }
+  case LSETYPE_SYMBOL:
+    expr = lsexpr_new_symbol(lsmodcache_get_str(d));
+    break;
+  case LSETYPE_RAISE: {
+    const lsexpr_t* arg = lsmodcache_get_expr(d);
+    if (!d->lmd_err)
+      expr = lsexpr_new_raise(arg);
+    break;
+  }
+  default:
+    d->lmd_err = 1;
+  }
+  return d->lmd_err ? NULL : lsexpr_with_loc(expr, loc);
+}
+
+// The program of an image, or NULL when it is malformed or was built from other source
+static const lsprog_t* lsmodcache_decode(const void* img, size_t size, uint64_t key,
+                                         uint64_t src_size, const char* file) {
+  const lsmodcache_hdr_t* hdr = img;
+  if (size < sizeof(*hdr) || hdr->lmh_magic != LSMODCACHE_MAGIC ||
+      hdr->lmh_format != LSMODCACHE_FORMAT || hdr->lmh_key != key ||
+      hdr->lmh_src_size != src_size)
+    return NULL;
+  const uint32_t* w   = (const uint32_t*)(hdr + 1);
+  size_t          len = (size - sizeof(*hdr)) / sizeof(uint32_t);
+  size_t          pos = 0;
+  if (hdr->lmh_nstrs > len)
+    return NULL;
+  const lsstr_t** strv = lsmalloc((hdr->lmh_nstrs + 1) * sizeof(lsstr_t*));
+  for (uint32_t i = 0; i < hdr->lmh_nstrs; i++) {
+    if (pos >= len)
+      return NULL;
+    uint32_t slen   = w[pos++];
+    size_t   swords = ((size_t)slen + 3) / 4;
+    if (swords > len - pos)
+      return NULL;
+    strv[i] = lsstr_new((const char*)&w[pos], slen);
+    pos += swords;
+  }
+  if (hdr->lmh_nwords != len - pos)
+    return NULL;
+  lsmodcache_dec_t d    = { w + pos, hdr->lmh_nwords, 0, strv, hdr->lmh_nstrs, file, 0 };
+  const lsexpr_t*  expr = lsmodcache_get_expr(&d);
+  if (d.lmd_err || d.lmd_pos != d.lmd_len)
+    return NULL;
+  return lsprog_new(expr, NULL);
+}
+
+// -------------------------------
+// Cache files
+// -------------------------------
+
+static pthread_once_t g_modcache_once = PTHREAD_ONCE_INIT;
+static char           g_modcache_dir[PATH_MAX]; // empty: no cache
+
+// Room for a cache file name: the directory, a 64-bit key in hex and an extension
+#define LSMODCACHE_PATH_MAX (PATH_MAX + 32)
+
+static void           lsmodcache_init(void) {
+  const char* on = getenv("LAZYSCRIPT_MODULE_CACHE");
+  if (on != NULL && strcmp(on, "0") == 0)
+    return;
+  const char* dir  = getenv("LAZYSCRIPT_CACHE_DIR");
+  const char* xdg  = getenv("XDG_CACHE_HOME");
+  const char* home = getenv("HOME");
+  int         n    = -1;
+  if (dir != NULL && dir[0] != '\0')
+    n = snprintf(g_modcache_dir, sizeof(g_modcache_dir), "%s", dir);
+  else if (xdg != NULL && xdg[0] == '/')
+    n = snprintf(g_modcache_dir, sizeof(g_modcache_dir), "%s/lazyscript", xdg);
+  else if (home != NULL && home[0] == '/')
+    n = snprintf(g_modcache_dir, sizeof(g_modcache_dir), "%s/.cache/lazyscript", home);
+  if (n < 0 || (size_t)n >= sizeof(g_modcache_dir))
+    g_modcache_dir[0] = '\0';
+}
+
+// 64-bit FNV-1a
+static uint64_t lsmodcache_hash(uint64_t h, const void* buf, size_t len) {
+  const unsigned char* p = buf;
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+// Hash of what besides the source decides the tree: the runtime and the sugar namespace
+static uint64_t lsmodcache_seed(void) {
+  static const char version[] = PACKAGE_NAME " " PACKAGE_VERSION " lsmi";
+  uint32_t          format    = LSMODCACHE_FORMAT;
+  const char*       ns        = lsparse_get_sugar_ns();
+  uint64_t          h         = lsmodcache_hash(0xcbf29ce484222325ull, version, sizeof(version));
+  h                           = lsmodcache_hash(h, &format, sizeof(format));
+  return lsmodcache_hash(h, ns, strlen(ns) + 1);
+}
+
+// Create the cache directory and its parents
+static int lsmodcache_mkdirs(void) {
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s", g_modcache_dir);
+  for (char* p = path + 1; *p != '\0'; p++) {
+    if (*p != '/')
+      continue;
+    *p = '\0';
+    if (mkdir(path, 0755) != 0 && errno != EEXIST)
+      return -1;
+    *p = '/';
+  }
+  return mkdir(path, 0755) != 0 && errno != EEXIST ? -1 : 0;
+}
+
+// Write a cache file atomically: readers see the old file or the whole new one
+static void lsmodcache_write(const char* path, const void* a, size_t alen, const void* b,
+                             size_t blen) {
+  char tmp[LSMODCACHE_PATH_MAX + 8];
+  snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+  int fd = mkstemp(tmp);
+  if (fd < 0 && errno == ENOENT && lsmodcache_mkdirs() == 0) {
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+    fd = mkstemp(tmp);
+  }
+  if (fd < 0)
+    return;
+  FILE* fp = fdopen(fd, "wb");
+  if (fp == NULL) {
+    close(fd);
+    unlink(tmp);
+    return;
+  }
+  int ok = fwrite(a, 1, alen, fp) == alen && (blen == 0 || fwrite(b, 1, blen, fp) == blen);
+  ok     = fclose(fp) == 0 && ok;
+  if (!ok || rename(tmp, path) != 0)
+    unlink(tmp);
+}
+
+// Store the image of a program parsed from source with the given key
+static void lsmodcache_store(const char* path, const lsprog_t* prog, const char* file,
+                             uint64_t key, uint64_t src_size) {
+  lsmodcache_enc_t e = { 0 };
+  e.lme_strs         = lshash_new(64);
+  e.lme_file         = file;
+  lsmodcache_put_expr(&e, lsprog_get_expr(prog));
+  lsmodcache_enc_t s = { 0 }; // the string section
+  for (uint32_t i = 0; i < e.lme_nstrs && !e.lme_err && !s.lme_err; i++) {
+    lssize_t    len = lsstr_get_len(e.lme_strv[i]);
+    const char* buf = lsstr_get_buf(e.lme_strv[i]);
+    lsmodcache_put(&s, (uint32_t)len);
+    for (lssize_t j = 0; j < len; j += 4) {
+      uint32_t w = 0;
+      memcpy(&w, buf + j, len - j < 4 ? (size_t)(len - j) : 4);
+      lsmodcache_put(&s, w);
+    }
+  }
+  if (!e.lme_err && !s.lme_err) {
+    size_t            size = sizeof(lsmodcache_hdr_t) + s.lme_len * sizeof(uint32_t);
+    lsmodcache_hdr_t* hdr  = malloc(size);
+    if (hdr != NULL) {
+      *hdr = (lsmodcache_hdr_t){ LSMODCACHE_MAGIC, LSMODCACHE_FORMAT, key, src_size,
+                                 e.lme_nstrs,      (uint32_t)e.lme_len };
+      if (s.lme_len > 0)
+        memcpy(hdr + 1, s.lme_words, s.lme_len * sizeof(uint32_t));
+      lsmodcache_write(path, hdr, size, e.lme_words, e.lme_len * sizeof(uint32_t));
+      free(hdr);
+    }
+  }
+  free(e.lme_words);
+  free(e.lme_strv);
+  free(s.lme_words);
+}
+
+// Map an image and decode it
+static const lsprog_t* lsmodcache_load(const char* path, uint64_t key, uint64_t src_size,
+                                       const char* file) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  void*       img = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+    img = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (img == MAP_FAILED)
+    return NULL;
+  const lsprog_t* prog = lsmodcache_decode(img, st.st_size, key, src_size, file);
+  munmap(img, st.st_size);
+  return prog;
+}
+
+// The whole source, malloc()ed
+static char* lsmodcache_read(const char* path, size_t* len) {
+  FILE* fp = fopen(path, "rb");
+  if (fp == NULL)
+    return NULL;
+  char*  buf = NULL;
+  size_t cap = 0, n = 0, got;
+  do {
+    if (n == cap) {
+      cap       = cap ? cap * 2 : 8192;
+      char* nbf = realloc(buf, cap);
+      if (nbf == NULL) {
+        free(buf);
+        fclose(fp);
+        return NULL;
+      }
+      buf = nbf;
+    }
+    got = fread(buf + n, 1, cap - n, fp);
+    n += got;
+  } while (got > 0);
+  int err = ferror(fp);
+  fclose(fp);
+  if (err) {
+    free(buf);
+    return NULL;
+  }
+  *len = n;
+  return buf;
+}
+
+static const lsprog_t* lsmodcache_parse_buf(const char* path, const char* buf, size_t len) {
+  FILE* fp = len > 0 ? fmemopen((void*)buf, len, "r") : NULL;
+  if (fp == NULL)
+    return lsparse_file_nullable(path);
+  const lsprog_t* prog = lsparse_stream(path, fp);
+  fclose(fp);
+  return prog;
+}
+
+const lsprog_t* ls_modcache_parse_file(const char* path) {
+  struct stat st;
+  if (stat(path, &st) != 0 || S_ISDIR(st.st_mode))
+    return NULL; // as lsparse_file_nullable, without opening the file just to probe it
+  pthread_once(&g_modcache_once, lsmodcache_init);
+  if (g_modcache_dir[0] == '\0' || !S_ISREG(st.st_mode))
+    return lsparse_file_nullable(path);
+
+  // Fast check: the index entry of the file names the image while the file is unchanged
+  uint64_t seed = lsmodcache_seed();
+  char     real[PATH_MAX], idxpath[LSMODCACHE_PATH_MAX], imgpath[LSMODCACHE_PATH_MAX];
+  if (realpath(path, real) == NULL)
+    return lsparse_file_nullable(path);
+  uint64_t pkey = lsmodcache_hash(seed, real, strlen(real));
+  snprintf(idxpath, sizeof(idxpath), "%s/%016llx.idx", g_modcache_dir, (unsigned long long)pkey);
+  lsmodcache_idx_t cur = { 0 };
+  cur.lmi_magic         = LSMODCACHE_MAGIC;
+  cur.lmi_format        = LSMODCACHE_FORMAT;
+  cur.lmi_dev           = (uint64_t)st.st_dev;
+  cur.lmi_ino           = (uint64_t)st.st_ino;
+  cur.lmi_size          = (uint64_t)st.st_size;
+  cur.lmi_mtime_sec     = (int64_t)st.st_mtim.tv_sec;
+  cur.lmi_mtime_nsec    = (int64_t)st.st_mtim.tv_nsec;
+  lsmodcache_idx_t idx;
+  int              fd = open(idxpath, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    ssize_t n = read(fd, &idx, sizeof(idx));
+    close(fd);
+    if (n == sizeof(idx) && memcmp(&idx, &cur, offsetof(lsmodcache_idx_t, lmi_key)) == 0) {
+      snprintf(imgpath, sizeof(imgpath), "%s/%016llx.lsmi", g_modcache_dir,
+               (unsigned long long)idx.lmi_key);
+      const lsprog_t* prog = lsmodcache_load(imgpath, idx.lmi_key, cur.lmi_size, path);
+      if (prog != NULL)
+        return prog;
+    }
+  }
+
+  // Read and hash the source: an image of the same content may exist under another name
+  size_t len;
+  char*  src = lsmodcache_read(path, &len);
+  if (src == NULL)
+    return lsparse_file_nullable(path);
+  cur.lmi_key  = lsmodcache_hash(seed, src, len);
+  cur.lmi_size = len;
+  snprintf(imgpath, sizeof(imgpath), "%s/%016llx.lsmi", g_modcache_dir,
+           (unsigned long long)cur.lmi_key);
+  const lsprog_t* prog = lsmodcache_load(imgpath, cur.lmi_key, len, path);
+  if (prog == NULL) {
+    prog = lsmodcache_parse_buf(path, src, len);
+    if (prog != NULL)
+      lsmodcache_store(imgpath, prog, path, cur.lmi_key, len);
+  }
+  free(src);
+  if (prog != NULL && len == (size_t)st.st_size)
+    lsmodcache_write(idxpath, &cur, sizeof(cur), NULL, 0);
+  return prog;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "misc/prog.h"
+
+// Compiled module cache: modules loaded by require are parsed once and kept as images of their
+// syntax tree under a cache directory, so later loads map the image instead of parsing.
+//
+// Images are content-addressed: the name of an image is a hash of the runtime version, the ~~sym
+// sugar namespace and the source. A per-file index entry remembers the device, inode, mtime and
+// size of the source an image was built from; while they are unchanged the source is not read.
+//
+// The directory is LAZYSCRIPT_CACHE_DIR, else $XDG_CACHE_HOME/lazyscript, else
+// ~/.cache/lazyscript. LAZYSCRIPT_MODULE_CACHE=0 turns the cache off. The cache is best effort:
+// when it cannot be read or written, modules are parsed as before.
+
+/**
+ * Parse a module file, through the compiled module cache
+ * Locations in the program refer to path, as with lsparse_file_nullable.
+ * @param path The file
+ * @return The program, or NULL when the file cannot be opened or does not parse
+ */
+const lsprog_t* ls_modcache_parse_file(const char* path);
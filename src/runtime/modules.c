@@ -1,22 +1,123 @@
 #include "runtime/modules.h"
 #include "common/hash.h"
+#include "common/malloc.h"
 #include "common/str.h"
+#include "runtime/context.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
-static lshash_t* g_loaded = NULL; // key: lsstr_t*
+// Loaded modules live in the current context (lc_loaded, key: file identity), as do resolved
+// names (lc_resolved, key: name). Resolutions hold for one search path and working directory:
+// the table is dropped when LAZYSCRIPT_PATH differs from the one it was filled under, or on
+// ls_modules_chdir.
 
-int              ls_modules_is_loaded(const char* path_cstr) {
-               if (!g_loaded)
+static const lsmodule_file_t* ls_modules_file_new(const char* path, const struct stat* st) {
+  char id[64];
+  int  len              = snprintf(id, sizeof(id), "%llx:%llx", (unsigned long long)st->st_dev,
+                                   (unsigned long long)st->st_ino);
+  lsmodule_file_t* file = lsmalloc(sizeof(lsmodule_file_t));
+  file->lmf_path        = path;
+  file->lmf_id          = lsstr_new(id, len);
+  return file;
+}
+
+static const char* ls_modules_search_path(void) {
+  const char* spath = getenv("LAZYSCRIPT_PATH");
+  return spath != NULL && spath[0] != '\0' ? spath : NULL;
+}
+
+// The first existing candidate for a name after the candidate after (NULL: from the first), in
+// the order lsparse_file_nullable probed them
+static const lsmodule_file_t* ls_modules_probe(const char* name, const char* spath,
+                                               const lsmodule_file_t* after) {
+  struct stat st;
+  int         past = after == NULL;
+  if (!past)
+    past = strcmp(name, after->lmf_path) == 0;
+  else if (stat(name, &st) == 0 && !S_ISDIR(st.st_mode)) {
+    size_t len  = strlen(name);
+    char*  path = lsmalloc_atomic(len + 1);
+    memcpy(path, name, len + 1);
+    return ls_modules_file_new(path, &st);
+  }
+  if (spath == NULL)
+    return NULL;
+  for (const char* tok = spath; *tok != '\0';) {
+    size_t toklen = strcspn(tok, ":");
+    if (toklen > 0) {
+      size_t need = toklen + 1 + strlen(name) + 1;
+      char*  cand = lsmalloc_atomic(need);
+      snprintf(cand, need, "%.*s/%s", (int)toklen, tok, name);
+      if (!past)
+        past = strcmp(cand, after->lmf_path) == 0;
+      else if (stat(cand, &st) == 0 && !S_ISDIR(st.st_mode))
+        return ls_modules_file_new(cand, &st);
+    }
+    tok += toklen;
+    if (*tok == ':')
+      tok++;
+  }
+  return NULL;
+}
+
+const lsmodule_file_t* ls_modules_find(const char* name, const lsmodule_file_t* after) {
+  return ls_modules_probe(name, ls_modules_search_path(), after);
+}
+
+// The names resolved in the context under the search path spath; a new table when create is set
+static lshash_t* ls_modules_resolved(ls_context_t* ctx, const char* spath, int create) {
+  const char* prev = ctx->lc_resolved_spath;
+  if (ctx->lc_resolved != NULL &&
+      (prev == NULL ? spath == NULL : spath != NULL && strcmp(prev, spath) == 0))
+    return ctx->lc_resolved;
+  if (!create)
+    return NULL;
+  char* copy = NULL;
+  if (spath != NULL) {
+    size_t len = strlen(spath);
+    copy       = lsmalloc_atomic(len + 1);
+    memcpy(copy, spath, len + 1);
+  }
+  ctx->lc_resolved       = lshash_new(16);
+  ctx->lc_resolved_spath = copy;
+  return ctx->lc_resolved;
+}
+
+const lsmodule_file_t* ls_modules_resolve(const char* name) {
+  const char*   spath    = ls_modules_search_path();
+  ls_context_t* ctx      = ls_context_current();
+  lshash_t*     resolved = ls_modules_resolved(ctx, spath, 0);
+  lshash_data_t v;
+  if (resolved != NULL && lshash_get(resolved, lsstr_cstr(name), &v))
+    return v;
+  const lsmodule_file_t* file = ls_modules_probe(name, spath, NULL);
+  if (file != NULL) // not cached otherwise: the file may appear later
+    ls_modules_remember(name, file);
+  return file;
+}
+
+void ls_modules_remember(const char* name, const lsmodule_file_t* file) {
+  lshash_t*     resolved = ls_modules_resolved(ls_context_current(), ls_modules_search_path(), 1);
+  lshash_data_t oldv;
+  (void)lshash_put(resolved, lsstr_cstr(name), file, &oldv);
+}
+
+void ls_modules_chdir(void) { ls_context_current()->lc_resolved = NULL; }
+
+int ls_modules_is_loaded(const lsmodule_file_t* file) {
+  lshash_t* loaded = ls_context_current()->lc_loaded;
+  if (!loaded)
     return 0;
-  const lsstr_t* k = lsstr_cstr(path_cstr);
-               lshash_data_t  v;
-               return lshash_get(g_loaded, k, &v);
+  lshash_data_t v;
+  return lshash_get(loaded, file->lmf_id, &v);
 }
 
-void ls_modules_mark_loaded(const char* path_cstr) {
-  if (!g_loaded)
-    g_loaded = lshash_new(16);
-  const lsstr_t* k = lsstr_cstr(path_cstr);
-  lshash_data_t  oldv;
-  (void)lshash_put(g_loaded, k, (const void*)1, &oldv);
+void ls_modules_mark_loaded(const lsmodule_file_t* file) {
+  ls_context_t* ctx = ls_context_current();
+  if (!ctx->lc_loaded)
+    ctx->lc_loaded = lshash_new(16);
+  lshash_data_t oldv;
+  (void)lshash_put(ctx->lc_loaded, file->lmf_id, (const void*)1, &oldv);
 }
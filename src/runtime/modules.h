@@ -2,6 +2,46 @@
 
 #include "common/str.h"
 
-// Simple module load cache used by prelude.require
-int  ls_modules_is_loaded(const char* path_cstr);
-void ls_modules_mark_loaded(const char* path_cstr);
+// Module files loaded by prelude.require. A name is resolved once per search path to the file
+// it denotes, and loaded files are identified by device and inode, so different spellings of
+// one file (lib/List.ls, ./lib/List.ls, a LAZYSCRIPT_PATH-relative name) load it once.
+
+// A module file found by ls_modules_resolve
+typedef struct lsmodule_file {
+  const char*    lmf_path; // the file as found: the name, or a search path entry and the name
+  const lsstr_t* lmf_id;   // identity of the file (device and inode)
+} lsmodule_file_t;
+
+/**
+ * Resolve a module name to a file
+ * The name is tried as given, then under each LAZYSCRIPT_PATH entry. Results are cached in the
+ * current context for the search path and working directory.
+ * @param name The name given to require
+ * @return The file, or NULL when no candidate exists
+ */
+const lsmodule_file_t* ls_modules_resolve(const char* name);
+
+/**
+ * Record the file a module name resolves to in the current context
+ * For a resolved file that cannot be parsed: the name stands for a later candidate instead.
+ * @param name The name given to require
+ * @param file The file
+ */
+void ls_modules_remember(const char* name, const lsmodule_file_t* file);
+
+/**
+ * Drop the resolutions of the current context after the working directory has changed
+ */
+void ls_modules_chdir(void);
+
+/**
+ * Resolve a module name to a file, without the cache of the current context
+ * Safe on any thread.
+ * @param name The name given to require
+ * @param after A candidate to resume after (NULL: from the first)
+ * @return The first existing candidate (after the given one), or NULL when there is none
+ */
+const lsmodule_file_t* ls_modules_find(const char* name, const lsmodule_file_t* after);
+
+int                    ls_modules_is_loaded(const lsmodule_file_t* file);
+void                   ls_modules_mark_loaded(const lsmodule_file_t* file);
@@ -0,0 +1,162 @@
+// Worker threads must be known to the collector: gc.h then redirects pthread_create
+#define GC_THREADS
+#include "runtime/par.h"
+#include "common/malloc.h"
+#include "runtime/context.h"
+#include "runtime/trace.h"
+#include "thunk/tpat.h"
+#include <assert.h>
+#include <gc.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// A spark is evaluated under the context of the thread that sparked it
+typedef struct lspar_spark {
+  lsthunk_t*    lps_thunk;
+  ls_context_t* lps_ctx;
+} lspar_spark_t;
+
+typedef struct lspar_deque {
+  pthread_mutex_t lpd_lock;
+  lspar_spark_t*  lpd_items;  // ring buffer in collected memory, so sparks stay alive
+  lssize_t        lpd_cap;    // power of two
+  lssize_t        lpd_top;    // next spark to steal
+  lssize_t        lpd_bottom; // next free slot
+} lspar_deque_t;
+
+static int             g_par_threads  = 0; // requested size; 0 = number of online processors
+static int             g_par_nthreads = 1; // running size (set once by lspar_start)
+static pthread_once_t  g_par_once     = PTHREAD_ONCE_INIT;
+static lspar_deque_t   g_par_deques[LSPAR_MAX_THREADS];
+static __thread int    g_par_self     = 0; // deque of the calling thread (0: main thread)
+static int             g_par_held     = 0; // threads may not start (ls_par_hold_threads)
+
+// Idle workers sleep until a spark is pushed
+static pthread_mutex_t g_par_idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_par_idle_cond = PTHREAD_COND_INITIALIZER;
+static int             g_par_pending   = 0; // sparks in all deques
+static int             g_par_sleeping  = 0; // workers waiting on g_par_idle_cond
+
+void ls_par_set_threads(int n) {
+  if (n < 0)
+    n = 0;
+  g_par_threads = n > LSPAR_MAX_THREADS ? LSPAR_MAX_THREADS : n;
+}
+
+int ls_par_get_threads(void) {
+  if (g_par_threads > 0)
+    return g_par_threads;
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 1)
+    return 1;
+  return n > LSPAR_MAX_THREADS ? LSPAR_MAX_THREADS : (int)n;
+}
+
+void ls_par_hold_threads(int hold) { __atomic_store_n(&g_par_held, hold != 0, __ATOMIC_SEQ_CST); }
+
+int  ls_par_threads_held(void) { return __atomic_load_n(&g_par_held, __ATOMIC_SEQ_CST); }
+
+static void lspar_push(lspar_deque_t* dq, lspar_spark_t spark) {
+  pthread_mutex_lock(&dq->lpd_lock);
+  if (dq->lpd_bottom - dq->lpd_top == dq->lpd_cap) {
+    lssize_t       ncap   = dq->lpd_cap ? dq->lpd_cap * 2 : 256;
+    lspar_spark_t* nitems = lsmalloc(ncap * sizeof(lspar_spark_t));
+    for (lssize_t i = dq->lpd_top; i < dq->lpd_bottom; i++)
+      nitems[i & (ncap - 1)] = dq->lpd_items[i & (dq->lpd_cap - 1)];
+    if (dq->lpd_items != NULL)
+      lsfree(dq->lpd_items);
+    dq->lpd_items = nitems;
+    dq->lpd_cap   = ncap;
+  }
+  dq->lpd_items[dq->lpd_bottom++ & (dq->lpd_cap - 1)] = spark;
+  pthread_mutex_unlock(&dq->lpd_lock);
+}
+
+// Take the newest spark (owner) or the oldest one (thief); a NULL thunk when the deque is empty
+static lspar_spark_t lspar_take(lspar_deque_t* dq, int steal) {
+  lspar_spark_t spark = { NULL, NULL };
+  pthread_mutex_lock(&dq->lpd_lock);
+  if (dq->lpd_top < dq->lpd_bottom) {
+    lssize_t       i    = steal ? dq->lpd_top++ : --dq->lpd_bottom;
+    lspar_spark_t* slot = &dq->lpd_items[i & (dq->lpd_cap - 1)];
+    spark               = *slot;
+    *slot               = (lspar_spark_t){ NULL, NULL };
+  }
+  pthread_mutex_unlock(&dq->lpd_lock);
+  if (spark.lps_thunk != NULL)
+    __atomic_fetch_sub(&g_par_pending, 1, __ATOMIC_SEQ_CST);
+  return spark;
+}
+
+// Next spark for worker self: its own newest, else the oldest of another thread
+static lspar_spark_t lspar_next(int self) {
+  lspar_spark_t spark = lspar_take(&g_par_deques[self], 0);
+  for (int i = 1; spark.lps_thunk == NULL && i < g_par_nthreads; i++)
+    spark = lspar_take(&g_par_deques[(self + i) % g_par_nthreads], 1);
+  return spark;
+}
+
+static void lspar_wait(void) {
+  pthread_mutex_lock(&g_par_idle_lock);
+  __atomic_fetch_add(&g_par_sleeping, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&g_par_pending, __ATOMIC_SEQ_CST) == 0)
+    pthread_cond_wait(&g_par_idle_cond, &g_par_idle_lock);
+  __atomic_fetch_sub(&g_par_sleeping, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&g_par_idle_lock);
+}
+
+static void* lspar_worker(void* arg) {
+  int self   = (int)(intptr_t)arg;
+  g_par_self = self;
+  lstpat_use_private_binds();
+  for (;;) {
+    lspar_spark_t spark = lspar_next(self);
+    if (spark.lps_thunk != NULL) {
+      ls_context_set_current(spark.lps_ctx);
+      lsthunk_eval_spark(spark.lps_thunk);
+    } else {
+      lspar_wait();
+    }
+  }
+  return NULL;
+}
+
+static void lspar_start(void) {
+  int n = ls_par_get_threads();
+  if (n <= 1)
+    return;
+  for (int i = 0; i < n; i++)
+    pthread_mutex_init(&g_par_deques[i].lpd_lock, NULL);
+  // Claims must be in place before a second thread can see a thunk
+  lsthunk_set_parallel(1);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int started = 1;
+  for (int i = 1; i < n; i++) {
+    pthread_t tid;
+    if (pthread_create(&tid, &attr, lspar_worker, (void*)(intptr_t)started) != 0)
+      break;
+    started++;
+  }
+  pthread_attr_destroy(&attr);
+  __atomic_store_n(&g_par_nthreads, started, __ATOMIC_SEQ_CST);
+}
+
+void ls_par_spark(lsthunk_t* thunk) {
+  assert(thunk != NULL);
+  // Shared trace ids are not thread-safe; a traced run stays sequential
+  if (lstrace_ids_enabled() || ls_par_threads_held())
+    return;
+  pthread_once(&g_par_once, lspar_start);
+  if (g_par_nthreads <= 1)
+    return;
+  __atomic_fetch_add(&g_par_pending, 1, __ATOMIC_SEQ_CST);
+  lspar_push(&g_par_deques[g_par_self], (lspar_spark_t){ thunk, ls_context_current() });
+  if (__atomic_load_n(&g_par_sleeping, __ATOMIC_SEQ_CST) > 0) {
+    pthread_mutex_lock(&g_par_idle_lock);
+    pthread_cond_signal(&g_par_idle_cond);
+    pthread_mutex_unlock(&g_par_idle_lock);
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "thunk/thunk.h"
+
+// Parallel evaluation: a pool of worker threads that evaluate sparked thunks to WHNF.
+// Each thread owns a deque; a thread pushes and pops its own sparks at the bottom and idle
+// workers steal from the top of the others. The pool starts with the first spark.
+
+// Upper bound on the pool size (the main thread included)
+#define LSPAR_MAX_THREADS 64
+
+/**
+ * Set the number of threads that evaluate (the main thread included)
+ * 0 selects the number of online processors and 1 turns sparks into no-ops. Only effective
+ * before the pool starts.
+ * @param n The number of threads (clamped to LSPAR_MAX_THREADS)
+ */
+void ls_par_set_threads(int n);
+
+/**
+ * Get the number of threads that evaluate
+ * @return The configured number, or the number of online processors when not set
+ */
+int ls_par_get_threads(void);
+
+/**
+ * Keep threads from starting, or let them start again
+ * While held, sparks are dropped and modules are not prefetched, so the process stays
+ * single-threaded; the fork server holds threads until it has forked. Threads already running
+ * are not stopped.
+ * @param hold Non-zero to hold threads
+ */
+void ls_par_hold_threads(int hold);
+
+/**
+ * Check whether threads are held
+ * @return Non-zero while ls_par_hold_threads holds them
+ */
+int ls_par_threads_held(void);
+
+/**
+ * Offer a thunk for evaluation by an idle worker
+ * A spark is a hint: whichever thread needs the thunk first evaluates it, and a spark whose
+ * thunk is evaluated (or being evaluated) by then is dropped. Sparks are ignored with a single
+ * thread, while threads are held and while a trace map is loaded.
+ * @param thunk The thunk
+ */
+void ls_par_spark(lsthunk_t* thunk);
@@ -0,0 +1,58 @@
+// Parser entry points shared by the lazyscript executable and liblazyscript
+#include "lazyscript.h"
+#include "parser/parser.h"
+#include "parser/lexer.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* g_sugar_ns = NULL; // NULL => LAZYSCRIPT_SUGAR_NS, else default (prelude)
+
+void lsparse_set_sugar_ns(const char* ns) { g_sugar_ns = ns; }
+
+const char* lsparse_get_sugar_ns(void) {
+  const char* sugar_ns = g_sugar_ns != NULL ? g_sugar_ns : getenv("LAZYSCRIPT_SUGAR_NS");
+  return sugar_ns && sugar_ns[0] ? sugar_ns : "prelude";
+}
+
+const lsprog_t* lsparse_stream(const char* filename, FILE* in_str) {
+  assert(in_str != NULL);
+  yyscan_t yyscanner;
+  yylex_init(&yyscanner);
+  lsscan_t* lsscan = lsscan_new(filename);
+  yyset_in(in_str, yyscanner);
+  yyset_extra(lsscan, yyscanner);
+  lsscan_set_sugar_ns(lsscan, lsparse_get_sugar_ns());
+  int             ret  = yyparse(yyscanner);
+  const lsprog_t* prog = ret == 0 ? lsscan_get_prog(lsscan) : NULL;
+  yylex_destroy(yyscanner);
+  return prog;
+}
+
+const lsprog_t* lsparse_file(const char* filename) {
+  FILE* stream = fopen(filename, "r");
+  if (!stream) {
+    perror(filename);
+    exit(1);
+  }
+  const lsprog_t* prog = lsparse_stream(filename, stream);
+  fclose(stream);
+  return prog;
+}
+
+const lsprog_t* lsparse_string(const char* filename, const char* str) {
+  FILE*           stream = fmemopen((void*)str, strlen(str), "r");
+  const lsprog_t* prog   = lsparse_stream(filename, stream);
+  fclose(stream);
+  return prog;
+}
+
+// Nullable file parser: returns NULL if file open fails
+const lsprog_t* lsparse_file_nullable(const char* filename) {
+  FILE* stream = fopen(filename, "r");
+  if (!stream)
+    return NULL;
+  const lsprog_t* prog = lsparse_stream(filename, stream);
+  fclose(stream);
+  return prog;
+}
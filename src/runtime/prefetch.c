@@ -0,0 +1,302 @@
+// Worker threads must be known to the collector: gc.h then redirects pthread_create
+#define GC_THREADS
+#include "runtime/prefetch.h"
+#include "lazyscript.h"
+#include "common/hash.h"
+#include "common/malloc.h"
+#include "common/ref.h"
+#include "expr/ealge.h"
+#include "expr/eappl.h"
+#include "expr/echoice.h"
+#include "expr/eclosure.h"
+#include "expr/elambda.h"
+#include "expr/enslit.h"
+#include "expr/expr.h"
+#include "misc/bind.h"
+#include "runtime/context.h"
+#include "runtime/modcache.h"
+#include "runtime/par.h"
+#include <gc.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum lsprefetch_state {
+  LSPREFETCH_QUEUED,  // waiting for a worker
+  LSPREFETCH_RUNNING, // being parsed by a worker
+  LSPREFETCH_DONE,    // parsed (lpe_prog is NULL when the parse failed)
+  LSPREFETCH_TAKEN,   // handed to require, or left to it
+} lsprefetch_state_t;
+
+// A module parsed ahead; entries live in the table of their context (lc_prefetched)
+typedef struct lsprefetch_entry {
+  const lsmodule_file_t*   lpe_file;
+  ls_context_t*            lpe_ctx; // context the modules it requires are prefetched for
+  lsprefetch_state_t       lpe_state;
+  const lsprog_t*          lpe_prog;
+  struct lsprefetch_entry* lpe_next; // queue link
+} lsprefetch_entry_t;
+
+// The lock guards the queue, the entry states and the lc_prefetched tables
+static pthread_mutex_t     g_prefetch_lock    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      g_prefetch_work    = PTHREAD_COND_INITIALIZER; // the queue grew
+static pthread_cond_t      g_prefetch_done    = PTHREAD_COND_INITIALIZER; // a parse finished
+static lsprefetch_entry_t* g_prefetch_head    = NULL;
+static lsprefetch_entry_t* g_prefetch_tail    = NULL;
+static pthread_once_t      g_prefetch_once    = PTHREAD_ONCE_INIT;
+static int                 g_prefetch_workers = 0; // running workers (0: prefetch is off)
+
+// Names of the modules a program requires, in program order
+typedef struct lsprefetch_names {
+  const char** lpn_names; // strings of the program
+  lssize_t     lpn_count;
+  lssize_t     lpn_cap;
+} lsprefetch_names_t;
+
+static void lsprefetch_add_name(lsprefetch_names_t* names, const char* name) {
+  if (names->lpn_count == names->lpn_cap) {
+    lssize_t     cap = names->lpn_cap ? names->lpn_cap * 2 : 8;
+    const char** nv  = realloc(names->lpn_names, cap * sizeof(const char*));
+    if (nv == NULL)
+      return;
+    names->lpn_names = nv;
+    names->lpn_cap   = cap;
+  }
+  names->lpn_names[names->lpn_count++] = name;
+}
+
+// require or include as the sugar builds it: ~~require, (~prelude .require), ~require
+static int lsprefetch_is_loader(const lsexpr_t* expr) {
+  const lsstr_t* name = NULL;
+  switch (lsexpr_get_type(expr)) {
+  case LSETYPE_SYMBOL:
+    name = lsexpr_get_symbol(expr);
+    break;
+  case LSETYPE_ALGE:
+    if (lsealge_get_argc(lsexpr_get_alge(expr)) == 0)
+      name = lsealge_get_constr(lsexpr_get_alge(expr));
+    break;
+  case LSETYPE_REF:
+    name = lsref_get_name(lsexpr_get_ref(expr));
+    break;
+  default:
+    break;
+  }
+  if (name == NULL)
+    return 0;
+  const char* s = lsstr_get_buf(name);
+  if (*s == '.')
+    s++;
+  return strcmp(s, "require") == 0 || strcmp(s, "include") == 0;
+}
+
+// Collect the string literals that loaders are applied to
+static void lsprefetch_scan(const lsexpr_t* expr, lsprefetch_names_t* names) {
+  switch (lsexpr_get_type(expr)) {
+  case LSETYPE_ALGE: {
+    const lsealge_t* ealge = lsexpr_get_alge(expr);
+    for (lssize_t i = 0; i < lsealge_get_argc(ealge); i++)
+      lsprefetch_scan(lsealge_get_arg(ealge, i), names);
+    break;
+  }
+  case LSETYPE_APPL: {
+    const lseappl_t*       eappl = lsexpr_get_appl(expr);
+    const lsexpr_t*        func  = lseappl_get_func(eappl);
+    const lsexpr_t* const* args  = lseappl_get_args(eappl);
+    lsprefetch_scan(func, names);
+    // ((~prelude .env) .require) "m.ls" and ~prelude .require "m.ls" alike
+    const lsexpr_t* prev = func;
+    if (lsexpr_get_type(func) == LSETYPE_APPL) {
+      const lseappl_t* inner = lsexpr_get_appl(func);
+      if (lseappl_get_argc(inner) > 0)
+        prev = lseappl_get_args(inner)[lseappl_get_argc(inner) - 1];
+    }
+    for (lssize_t i = 0; i < lseappl_get_argc(eappl); i++) {
+      if (lsexpr_get_type(args[i]) == LSETYPE_STR && lsprefetch_is_loader(prev))
+        lsprefetch_add_name(names, lsstr_get_buf(lsexpr_get_str(args[i])));
+      lsprefetch_scan(args[i], names);
+      prev = args[i];
+    }
+    break;
+  }
+  case LSETYPE_LAMBDA:
+    lsprefetch_scan(lselambda_get_body(lsexpr_get_lambda(expr)), names);
+    break;
+  case LSETYPE_CLOSURE: {
+    const lseclosure_t*    closure = lsexpr_get_closure(expr);
+    const lsbind_t* const* binds   = lseclosure_get_binds(closure);
+    lsprefetch_scan(lseclosure_get_expr(closure), names);
+    for (lssize_t i = 0; i < lseclosure_get_bindc(closure); i++)
+      lsprefetch_scan(lsbind_get_rhs(binds[i]), names);
+    break;
+  }
+  case LSETYPE_CHOICE:
+    lsprefetch_scan(lsechoice_get_left(lsexpr_get_choice(expr)), names);
+    lsprefetch_scan(lsechoice_get_right(lsexpr_get_choice(expr)), names);
+    break;
+  case LSETYPE_NSLIT: {
+    const lsenslit_t* ns = lsexpr_get_nslit(expr);
+    for (lssize_t i = 0; i < lsenslit_get_count(ns); i++)
+      lsprefetch_scan(lsenslit_get_expr(ns, i), names);
+    break;
+  }
+  case LSETYPE_RAISE:
+    lsprefetch_scan(lsexpr_get_raise_arg(expr), names);
+    break;
+  default:
+    break;
+  }
+}
+
+// Queue a file unless the context has prefetched it already; called with the lock held
+static void lsprefetch_enqueue(ls_context_t* ctx, const lsmodule_file_t* file) {
+  lshash_data_t v;
+  if (ctx->lc_prefetched == NULL)
+    ctx->lc_prefetched = lshash_new(16);
+  else if (lshash_get(ctx->lc_prefetched, file->lmf_id, &v))
+    return;
+  lsprefetch_entry_t* entry = lsmalloc(sizeof(lsprefetch_entry_t));
+  entry->lpe_file           = file;
+  entry->lpe_ctx            = ctx;
+  entry->lpe_state          = LSPREFETCH_QUEUED;
+  entry->lpe_prog           = NULL;
+  entry->lpe_next           = NULL;
+  lshash_data_t oldv;
+  (void)lshash_put(ctx->lc_prefetched, file->lmf_id, entry, &oldv);
+  if (g_prefetch_tail != NULL)
+    g_prefetch_tail->lpe_next = entry;
+  else
+    g_prefetch_head = entry;
+  g_prefetch_tail = entry;
+  pthread_cond_signal(&g_prefetch_work);
+}
+
+// Parse one module and queue the modules it requires
+static void lsprefetch_run(lsprefetch_entry_t* entry) {
+  const lsprog_t*    prog  = ls_modcache_parse_file(entry->lpe_file->lmf_path);
+  lsprefetch_names_t names = { NULL, 0, 0 };
+  if (prog != NULL)
+    lsprefetch_scan(lsprog_get_expr(prog), &names);
+  const lsmodule_file_t** files =
+      names.lpn_count > 0 ? lsmalloc(names.lpn_count * sizeof(lsmodule_file_t*)) : NULL;
+  for (lssize_t i = 0; i < names.lpn_count; i++)
+    files[i] = ls_modules_find(names.lpn_names[i], NULL);
+  pthread_mutex_lock(&g_prefetch_lock);
+  entry->lpe_prog  = prog;
+  entry->lpe_state = LSPREFETCH_DONE;
+  pthread_cond_broadcast(&g_prefetch_done);
+  for (lssize_t i = 0; i < names.lpn_count; i++)
+    if (files[i] != NULL)
+      lsprefetch_enqueue(entry->lpe_ctx, files[i]);
+  pthread_mutex_unlock(&g_prefetch_lock);
+  if (files != NULL)
+    lsfree(files);
+  free(names.lpn_names);
+}
+
+static void* lsprefetch_worker(void* arg) {
+  (void)arg;
+  lsscan_set_quiet(1); // require reports the errors when it parses the module again
+  pthread_mutex_lock(&g_prefetch_lock);
+  for (;;) {
+    while (g_prefetch_head == NULL)
+      pthread_cond_wait(&g_prefetch_work, &g_prefetch_lock);
+    lsprefetch_entry_t* entry = g_prefetch_head;
+    g_prefetch_head           = entry->lpe_next;
+    if (g_prefetch_head == NULL)
+      g_prefetch_tail = NULL;
+    entry->lpe_next = NULL;
+    if (entry->lpe_state != LSPREFETCH_QUEUED)
+      continue;
+    entry->lpe_state = LSPREFETCH_RUNNING;
+    pthread_mutex_unlock(&g_prefetch_lock);
+    lsprefetch_run(entry);
+    pthread_mutex_lock(&g_prefetch_lock);
+  }
+  return NULL;
+}
+
+// Around fork: the child has no workers, and must not inherit the lock held
+static void lsprefetch_atfork_prepare(void) { pthread_mutex_lock(&g_prefetch_lock); }
+static void lsprefetch_atfork_parent(void) { pthread_mutex_unlock(&g_prefetch_lock); }
+static void lsprefetch_atfork_child(void) {
+  g_prefetch_workers = 0;
+  pthread_mutex_unlock(&g_prefetch_lock);
+}
+
+// Size of the pool: one thread less than ls_par_get_threads, 0 when prefetch is off
+static int lsprefetch_pool_size(void) {
+  const char* on = getenv("LAZYSCRIPT_PREFETCH");
+  if (on != NULL && strcmp(on, "0") == 0)
+    return 0;
+  int n = ls_par_get_threads() - 1;
+  return n > 0 ? n : 0;
+}
+
+static void lsprefetch_start(void) {
+  int n = lsprefetch_pool_size();
+  if (n == 0)
+    return;
+  pthread_atfork(lsprefetch_atfork_prepare, lsprefetch_atfork_parent, lsprefetch_atfork_child);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int started = 0;
+  for (int i = 0; i < n; i++) {
+    pthread_t tid;
+    if (pthread_create(&tid, &attr, lsprefetch_worker, NULL) != 0)
+      break;
+    started++;
+  }
+  pthread_attr_destroy(&attr);
+  pthread_mutex_lock(&g_prefetch_lock);
+  g_prefetch_workers = started;
+  pthread_mutex_unlock(&g_prefetch_lock);
+}
+
+void ls_prefetch_program(const lsprog_t* prog) {
+  if (prog == NULL || ls_par_threads_held() || lsprefetch_pool_size() == 0)
+    return;
+  lsprefetch_names_t names = { NULL, 0, 0 };
+  lsprefetch_scan(lsprog_get_expr(prog), &names);
+  if (names.lpn_count == 0)
+    return; // no pool for a program that requires nothing
+  pthread_once(&g_prefetch_once, lsprefetch_start);
+  pthread_mutex_lock(&g_prefetch_lock);
+  int workers = g_prefetch_workers;
+  pthread_mutex_unlock(&g_prefetch_lock);
+  if (workers == 0) {
+    free(names.lpn_names);
+    return;
+  }
+  ls_context_t* ctx = ls_context_current();
+  for (lssize_t i = 0; i < names.lpn_count; i++) {
+    const lsmodule_file_t* file = ls_modules_resolve(names.lpn_names[i]);
+    if (file == NULL || ls_modules_is_loaded(file))
+      continue;
+    pthread_mutex_lock(&g_prefetch_lock);
+    lsprefetch_enqueue(ctx, file);
+    pthread_mutex_unlock(&g_prefetch_lock);
+  }
+  free(names.lpn_names);
+}
+
+const lsprog_t* ls_prefetch_take(const lsmodule_file_t* file) {
+  ls_context_t*   ctx  = ls_context_current();
+  const lsprog_t* prog = NULL;
+  lshash_data_t   v;
+  pthread_mutex_lock(&g_prefetch_lock);
+  if (ctx->lc_prefetched != NULL && lshash_get(ctx->lc_prefetched, file->lmf_id, &v)) {
+    lsprefetch_entry_t* entry = (lsprefetch_entry_t*)v;
+    while (entry->lpe_state == LSPREFETCH_RUNNING && g_prefetch_workers > 0)
+      pthread_cond_wait(&g_prefetch_done, &g_prefetch_lock);
+    // Locations name the file as found: another spelling of it is parsed again
+    if (entry->lpe_state == LSPREFETCH_DONE &&
+        strcmp(entry->lpe_file->lmf_path, file->lmf_path) == 0)
+      prog = entry->lpe_prog;
+    entry->lpe_state = LSPREFETCH_TAKEN; // a queued entry is left to require: no wait
+    entry->lpe_prog  = NULL;
+  }
+  pthread_mutex_unlock(&g_prefetch_lock);
+  return prog;
+}
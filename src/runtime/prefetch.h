@@ -0,0 +1,31 @@
+#pragma once
+
+#include "misc/prog.h"
+#include "runtime/modules.h"
+
+// Module prefetch: before a program is evaluated, the modules it requires (applications of
+// require or include to a string literal) are parsed ahead on a pool of worker threads, and so
+// are the modules those require in turn. Evaluation is unchanged: require still loads modules
+// one at a time in program order and only takes the parsed program instead of parsing.
+//
+// Prefetch is a hint. A module that is not required after all costs a parse, and a module that
+// fails to parse ahead is parsed again by require, which reports the errors. The pool has one
+// thread less than ls_par_get_threads, so a single thread turns prefetch off, as do
+// LAZYSCRIPT_PREFETCH=0 and held threads (ls_par_hold_threads).
+
+/**
+ * Start parsing the modules a program requires
+ * Modules already loaded in the current context or already prefetched are skipped. The pool is
+ * started by the first program that requires a module.
+ * @param prog The program about to be evaluated
+ */
+void ls_prefetch_program(const lsprog_t* prog);
+
+/**
+ * Take the prefetched program of a module file
+ * Waits while a worker is parsing it. A file no worker has started yet is dropped from the queue
+ * and left to the caller.
+ * @param file The file
+ * @return The program, or NULL when the file was not parsed ahead or did not parse
+ */
+const lsprog_t* ls_prefetch_take(const lsmodule_file_t* file);
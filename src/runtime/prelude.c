@@ -0,0 +1,175 @@
+// Prelude plugin discovery and loading, shared by the lazyscript executable and liblazyscript
+#include "runtime/prelude.h"
+#include "common/io.h"
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef int (*ls_prelude_register_fn)(lstenv_t*);
+
+// The prelude linked into this binary (plugins/builtins_ns.c, also built as the plugin)
+int ls_prelude_register(lstenv_t* tenv);
+
+static void get_exe_dir(char* out, size_t outsz) {
+  if (!out || outsz == 0)
+    return;
+  ssize_t n = readlink("/proc/self/exe", out, outsz - 1);
+  if (n <= 0) {
+    out[0] = '\0';
+    return;
+  }
+  out[n] = '\0';
+  for (ssize_t i = n - 1; i >= 0; --i) {
+    if (out[i] == '/') {
+      out[i] = '\0';
+      break;
+    }
+  }
+}
+
+static int file_exists(const char* path) { return access(path, R_OK) == 0; }
+
+// safe join helper to avoid -Wformat-truncation on snprintf
+static int join2(char* out, size_t outsz, const char* a, const char* b) {
+  if (!out || outsz == 0)
+    return 0;
+  size_t al = a ? strnlen(a, outsz) : 0;
+  size_t bl = b ? strlen(b) : 0;
+  if (al + bl >= outsz) {
+    out[0] = '\0';
+    return 0;
+  }
+  if (a && al)
+    memcpy(out, a, al);
+  if (b && bl)
+    memcpy(out + al, b, bl);
+  out[al + bl] = '\0';
+  return 1;
+}
+
+static const char* ls_find_prelude_so(char* buf, size_t bufsz) {
+  if (!buf || bufsz == 0)
+    return NULL;
+  buf[0] = '\0';
+
+  const char* envp = getenv("LAZYSCRIPT_PRELUDE_PATH");
+  if (envp && envp[0]) {
+    const char* p = envp;
+    while (p && *p) {
+      const char* colon = strchr(p, ':');
+      size_t      len   = colon ? (size_t)(colon - p) : strlen(p);
+      char        dir[PATH_MAX];
+      if (len >= sizeof(dir))
+        len = sizeof(dir) - 1;
+      memcpy(dir, p, len);
+      dir[len] = '\0';
+      if (!join2(buf, bufsz, dir, "/liblazyscript_prelude.so")) {
+        buf[0] = '\0';
+      }
+      if (file_exists(buf))
+        return buf;
+      p = colon ? colon + 1 : NULL;
+    }
+  }
+  char exedir[PATH_MAX];
+  exedir[0] = '\0';
+  get_exe_dir(exedir, sizeof(exedir));
+  if (exedir[0]) {
+    if (!join2(buf, bufsz, exedir, "/plugins/liblazyscript_prelude.so")) {
+      buf[0] = '\0';
+    }
+    if (file_exists(buf))
+      return buf;
+    // When running from build tree, plugin resides in .libs/
+    if (!join2(buf, bufsz, exedir, "/plugins/.libs/liblazyscript_prelude.so")) {
+      buf[0] = '\0';
+    }
+    if (file_exists(buf))
+      return buf;
+    // Also try parent dir (exedir is usually src/.libs, plugin is in src/plugins/.libs)
+    char parent[PATH_MAX];
+    memcpy(parent, exedir, sizeof(parent));
+    parent[sizeof(parent) - 1] = '\0';
+    for (ssize_t i = (ssize_t)strlen(parent) - 1; i >= 0; --i) {
+      if (parent[i] == '/') {
+        parent[i] = '\0';
+        break;
+      }
+    }
+    if (!join2(buf, bufsz, parent, "/plugins/.libs/liblazyscript_prelude.so")) {
+      buf[0] = '\0';
+    }
+    if (file_exists(buf))
+      return buf;
+  }
+  snprintf(buf, bufsz, "/usr/local/lib/lazyscript/liblazyscript_prelude.so");
+  if (file_exists(buf))
+    return buf;
+  snprintf(buf, bufsz, "/usr/lib/lazyscript/liblazyscript_prelude.so");
+  if (file_exists(buf))
+    return buf;
+  buf[0] = '\0';
+  return NULL;
+}
+
+int ls_prelude_load(lstenv_t* tenv, const char* path, int verbose) {
+  const char* chosen = path;
+  const char* source = NULL; // for logging
+  if (chosen == NULL)
+    chosen = getenv("LAZYSCRIPT_PRELUDE_SO");
+  if (chosen && chosen[0])
+    source = "CLI/ENV";
+  char found[PATH_MAX];
+  if (chosen == NULL || chosen[0] == '\0') {
+    // Plugin probing is asked for by LAZYSCRIPT_PRELUDE_PATH; else the linked-in prelude serves
+    const char* probe = getenv("LAZYSCRIPT_PRELUDE_PATH");
+    if (probe == NULL || probe[0] == '\0') {
+      if (ls_prelude_register(tenv) != 0)
+        return 0;
+      if (verbose)
+        lsprintf(stderr, 0, "I: prelude: built in\n");
+      return 1;
+    }
+    // Try to find via LAZYSCRIPT_PRELUDE_PATH / standard locations
+    if (ls_find_prelude_so(found, sizeof(found))) {
+      chosen = found;
+      source = "AUTO";
+    }
+  }
+  if (chosen == NULL || chosen[0] == '\0') {
+    if (verbose)
+      lsprintf(stderr, 0, "I: prelude: plugin not found (auto-discovery)\n");
+    return 0;
+  }
+  void* handle = dlopen(chosen, RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    const char* err = dlerror();
+    lsprintf(stderr, 0, "W: prelude: dlopen failed: path=%s err=%s\n", chosen,
+             err ? err : "(null)");
+    return 0;
+  }
+  dlerror();
+  ls_prelude_register_fn reg = (ls_prelude_register_fn)dlsym(handle, "ls_prelude_register");
+  const char*            err = dlerror();
+  if (err != NULL || reg == NULL) {
+    lsprintf(stderr, 0, "W: prelude: dlsym(ls_prelude_register) failed: %s\n",
+             err ? err : "(null)");
+    dlclose(handle);
+    return 0;
+  }
+  int rc = reg(tenv);
+  if (rc != 0) {
+    lsprintf(stderr, 0, "W: prelude: plugin returned error: %d\n", rc);
+    // keep handle but report error; fall back
+    return 0;
+  }
+  if (verbose) {
+    lsprintf(stderr, 0, "I: prelude: plugin loaded: path=%s source=%s\n", chosen,
+             source ? source : "(n/a)");
+  }
+  // Keep handle open for the lifetime of process
+  return 1;
+}
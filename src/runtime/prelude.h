@@ -0,0 +1,16 @@
+#pragma once
+
+#include "thunk/tenv.h"
+
+/**
+ * Register the prelude into an environment
+ * The prelude comes from the plugin at path, else LAZYSCRIPT_PRELUDE_SO. Without either, it is
+ * the prelude linked into the binary, unless LAZYSCRIPT_PRELUDE_PATH is set: then
+ * liblazyscript_prelude.so is searched on it, next to the executable and in the standard
+ * library directories. Failures are reported on stderr as warnings.
+ * @param tenv The environment
+ * @param path The plugin path (nullable)
+ * @param verbose Whether to report where the plugin was found
+ * @return 1 when the prelude was registered, 0 otherwise
+ */
+int ls_prelude_load(lstenv_t* tenv, const char* path, int verbose);
@@ -0,0 +1,374 @@
+// Worker threads must be known to the collector: gc.h then redirects pthread_create
+#define GC_THREADS
+#include "runtime/serve.h"
+#include "common/io.h"
+#include "runtime/effects.h"
+#include <gc.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Largest request body accepted
+#define LSSERVE_MAX_BODY (64 * 1024 * 1024)
+// Most arguments of a call request
+#define LSSERVE_MAX_ARGS 64
+// Signal stack of a serving thread, where a request that overflows its stack is caught
+#define LSSERVE_ALTSTACK (64 * 1024)
+
+// A file compiled for call requests
+typedef struct lsserve_file {
+  struct lsserve_file* lsf_next;
+  char*                lsf_path;
+  struct timespec      lsf_mtime; // of the compiled version
+  ls_program_t*        lsf_prog;
+} lsserve_file_t;
+
+typedef struct lsserve_worker {
+  ls_runtime_t*            lsw_rt;
+  lsserve_file_t*          lsw_files;
+  unsigned                 lsw_nreqs; // numbers the programs of eval requests in diagnostics
+  const ls_runtime_opts_t* lsw_opts;  // of the runtime, to replace it after a failed request
+} lsserve_worker_t;
+
+// Accepted connections waiting for a worker
+typedef struct lsserve_conn {
+  struct lsserve_conn* lsc_next;
+  int                  lsc_fd;
+} lsserve_conn_t;
+
+static pthread_mutex_t g_serve_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_serve_cond = PTHREAD_COND_INITIALIZER;
+static lsserve_conn_t* g_serve_head = NULL;
+static lsserve_conn_t* g_serve_tail = NULL;
+
+// Where a fatal signal raised by the request of this thread resumes (NULL: outside requests)
+static __thread sigjmp_buf* g_serve_jmp        = NULL;
+static __thread int         g_serve_sig        = 0; // the signal, once resumed
+static pthread_once_t       g_serve_guard_once = PTHREAD_ONCE_INIT;
+
+static int                  lsserve_reply(FILE* out, const char* verb, const char* body) {
+  size_t len = strlen(body);
+  if (fprintf(out, "%s %zu\n", verb, len) < 0 || fwrite(body, 1, len, out) != len)
+    return -1;
+  return fflush(out) == 0 ? 0 : -1;
+}
+
+// Reply with a value and release it
+static int lsserve_reply_value(lsserve_worker_t* w, FILE* out, ls_value_t* v) {
+  char* text = ls_value_to_string(w->lsw_rt, v);
+  int   ret  = lsserve_reply(out, ls_value_kind(w->lsw_rt, v) == LS_VALUE_ERROR ? "err" : "ok",
+                             text != NULL ? text : "");
+  free(text);
+  ls_value_release(w->lsw_rt, v);
+  return ret;
+}
+
+// Evaluate a program; NULL with *err set when it does not parse or cannot be evaluated
+static ls_value_t* lsserve_eval(lsserve_worker_t* w, const char* src, const char** err) {
+  char name[32];
+  snprintf(name, sizeof(name), "<serve:#%u>", ++w->lsw_nreqs);
+  ls_program_t* prog = ls_program_compile(w->lsw_rt, name, src);
+  if (prog == NULL) {
+    *err = "syntax error";
+    return NULL;
+  }
+  ls_value_t* v = ls_program_run(w->lsw_rt, prog, 0, NULL);
+  ls_program_free(w->lsw_rt, prog);
+  if (v == NULL)
+    *err = "evaluation failed";
+  return v;
+}
+
+// The program of a file, compiled again when the file changed
+static ls_program_t* lsserve_file(lsserve_worker_t* w, const char* path) {
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return NULL;
+  lsserve_file_t* f = w->lsw_files;
+  while (f != NULL && strcmp(f->lsf_path, path) != 0)
+    f = f->lsf_next;
+  if (f != NULL && f->lsf_mtime.tv_sec == st.st_mtim.tv_sec &&
+      f->lsf_mtime.tv_nsec == st.st_mtim.tv_nsec)
+    return f->lsf_prog;
+  ls_program_t* prog = ls_program_compile_file(w->lsw_rt, path);
+  if (prog == NULL)
+    return NULL;
+  if (f == NULL) {
+    f            = calloc(1, sizeof(lsserve_file_t));
+    f->lsf_path  = strdup(path);
+    f->lsf_next  = w->lsw_files;
+    w->lsw_files = f;
+  } else {
+    ls_program_free(w->lsw_rt, f->lsf_prog);
+  }
+  f->lsf_prog  = prog;
+  f->lsf_mtime = st.st_mtim;
+  return prog;
+}
+
+static int lsserve_call(lsserve_worker_t* w, FILE* out, char* body) {
+  char* rest = strchr(body, '\n');
+  if (rest != NULL)
+    *rest++ = '\0';
+  ls_program_t* prog = lsserve_file(w, body);
+  if (prog == NULL)
+    return lsserve_reply(out, "err", "cannot compile the file");
+  ls_value_t* args[LSSERVE_MAX_ARGS];
+  int         argc = 0;
+  const char* err  = NULL;
+  while (rest != NULL && err == NULL) {
+    char* line = rest;
+    rest       = strchr(line, '\n');
+    if (rest != NULL)
+      *rest++ = '\0';
+    if (line[0] == '\0')
+      continue;
+    if (argc == LSSERVE_MAX_ARGS) {
+      err = "too many arguments";
+      break;
+    }
+    ls_value_t* arg = lsserve_eval(w, line, &err);
+    if (arg != NULL)
+      args[argc++] = arg;
+  }
+  ls_value_t* ret = err == NULL ? ls_program_run(w->lsw_rt, prog, argc, args) : NULL;
+  for (int i = 0; i < argc; i++)
+    ls_value_release(w->lsw_rt, args[i]);
+  if (err != NULL)
+    return lsserve_reply(out, "err", err);
+  if (ret == NULL)
+    return lsserve_reply(out, "err", "evaluation failed");
+  return lsserve_reply_value(w, out, ret);
+}
+
+static int lsserve_request(lsserve_worker_t* w, FILE* out, const char* verb, char* body) {
+  if (strcmp(verb, "eval") == 0) {
+    const char* err = NULL;
+    ls_value_t* v   = lsserve_eval(w, body, &err);
+    return v != NULL ? lsserve_reply_value(w, out, v) : lsserve_reply(out, "err", err);
+  }
+  if (strcmp(verb, "call") == 0)
+    return lsserve_call(w, out, body);
+  return lsserve_reply(out, "err", "unknown request");
+}
+
+static void lsserve_fatal(int sig) {
+  sigjmp_buf* jmp = g_serve_jmp;
+  if (jmp == NULL) {
+    // Not in a request: die of the signal as without the handler
+    signal(sig, SIG_DFL);
+    raise(sig);
+    return;
+  }
+  g_serve_jmp = NULL;
+  g_serve_sig = sig;
+  siglongjmp(*jmp, 1);
+}
+
+static void lsserve_guard_init(void) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = lsserve_fatal;
+  sa.sa_flags   = SA_ONSTACK;
+  sigemptyset(&sa.sa_mask);
+  const int sigs[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+  for (size_t i = 0; i < sizeof(sigs) / sizeof(sigs[0]); i++)
+    sigaction(sigs[i], &sa, NULL);
+}
+
+// Catch the fatal signals of requests on the calling thread, stack overflows included
+static void lsserve_guard(void) {
+  pthread_once(&g_serve_guard_once, lsserve_guard_init);
+  stack_t ss;
+  ss.ss_sp    = malloc(LSSERVE_ALTSTACK);
+  ss.ss_size  = LSSERVE_ALTSTACK;
+  ss.ss_flags = 0;
+  if (ss.ss_sp != NULL && sigaltstack(&ss, NULL) != 0)
+    free(ss.ss_sp);
+}
+
+// After a request died of a signal: its runtime may be half-updated, so it is abandoned (not
+// freed: its objects may be in any state) and the worker goes on with a new one. A request that
+// faults while holding a process-wide lock (string or hash-cons table) cannot be recovered.
+static int lsserve_recover(lsserve_worker_t* w, FILE* out) {
+  ls_effects_reset();
+  while (w->lsw_files != NULL) {
+    lsserve_file_t* f = w->lsw_files;
+    w->lsw_files      = f->lsf_next;
+    free(f->lsf_path);
+    free(f);
+  }
+  w->lsw_rt = ls_runtime_new(w->lsw_opts);
+  char msg[64];
+  snprintf(msg, sizeof(msg), "evaluation aborted (signal %d)", g_serve_sig);
+  if (lsserve_reply(out, "err", msg) != 0 || w->lsw_rt == NULL)
+    return -1;
+  return 0;
+}
+
+// Answer requests until end of input or a broken frame
+static void lsserve_session(lsserve_worker_t* w, FILE* in, FILE* out) {
+  char*  line = NULL;
+  size_t cap  = 0;
+  while (getline(&line, &cap, in) > 0) {
+    char   verb[16];
+    size_t len;
+    if (sscanf(line, "%15s %zu", verb, &len) != 2 || len > LSSERVE_MAX_BODY) {
+      lsserve_reply(out, "err", "malformed request");
+      break;
+    }
+    char* body = malloc(len + 1);
+    if (body == NULL || fread(body, 1, len, in) != len) {
+      free(body);
+      break;
+    }
+    body[len] = '\0';
+    int        ret;
+    sigjmp_buf jmp;
+    if (sigsetjmp(jmp, 1) == 0) {
+      g_serve_jmp = &jmp;
+      ret         = lsserve_request(w, out, verb, body);
+      g_serve_jmp = NULL;
+    } else {
+      ret = lsserve_recover(w, out);
+    }
+    free(body);
+    if (ret != 0)
+      break;
+  }
+  free(line);
+}
+
+static void lsserve_push(int fd) {
+  lsserve_conn_t* conn = malloc(sizeof(lsserve_conn_t));
+  conn->lsc_next       = NULL;
+  conn->lsc_fd         = fd;
+  pthread_mutex_lock(&g_serve_lock);
+  if (g_serve_tail != NULL)
+    g_serve_tail->lsc_next = conn;
+  else
+    g_serve_head = conn;
+  g_serve_tail = conn;
+  pthread_cond_signal(&g_serve_cond);
+  pthread_mutex_unlock(&g_serve_lock);
+}
+
+static int lsserve_pop(void) {
+  pthread_mutex_lock(&g_serve_lock);
+  while (g_serve_head == NULL)
+    pthread_cond_wait(&g_serve_cond, &g_serve_lock);
+  lsserve_conn_t* conn = g_serve_head;
+  g_serve_head         = conn->lsc_next;
+  if (g_serve_head == NULL)
+    g_serve_tail = NULL;
+  pthread_mutex_unlock(&g_serve_lock);
+  int fd = conn->lsc_fd;
+  free(conn);
+  return fd;
+}
+
+static void* lsserve_worker(void* arg) {
+  lsserve_worker_t* w = arg;
+  lsserve_guard();
+  for (;;) {
+    int   fd  = lsserve_pop();
+    int   fd2 = dup(fd);
+    FILE* in  = fdopen(fd, "r");
+    FILE* out = fd2 >= 0 ? fdopen(fd2, "w") : NULL;
+    if (in != NULL && out != NULL)
+      lsserve_session(w, in, out);
+    if (in != NULL)
+      fclose(in);
+    else
+      close(fd);
+    if (out != NULL)
+      fclose(out);
+    else if (fd2 >= 0)
+      close(fd2);
+  }
+  return NULL;
+}
+
+int ls_serve_listen(const char* path) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    lsprintf(stderr, 0, "E: serve: socket path too long: %s\n", path);
+    return -1;
+  }
+  strcpy(addr.sun_path, path);
+  // Replace the socket of an earlier server, but nothing else
+  struct stat st;
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+    perror(path);
+    if (fd >= 0)
+      close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int ls_serve(const ls_serve_opts_t* opts) {
+  if (opts->lso_socket == NULL) {
+    lsserve_worker_t w = { ls_runtime_new(&opts->lso_runtime), NULL, 0, &opts->lso_runtime };
+    if (w.lsw_rt == NULL)
+      return 1;
+    lsserve_guard();
+    // Responses own stdout; what programs print goes to stderr
+    fflush(stdout);
+    int   fd  = dup(STDOUT_FILENO);
+    FILE* out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (out == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+      perror("serve");
+      return 1;
+    }
+    lsserve_session(&w, stdin, out);
+    fclose(out);
+    ls_runtime_free(w.lsw_rt);
+    return 0;
+  }
+
+  int nworkers = opts->lso_workers;
+  if (nworkers <= 0) {
+    long n   = sysconf(_SC_NPROCESSORS_ONLN);
+    nworkers = n < 1 ? 1 : (int)n;
+  }
+  // Runtimes are set up before listening, so a missing prelude fails the server at once
+  lsserve_worker_t* workers = calloc(nworkers, sizeof(lsserve_worker_t));
+  for (int i = 0; i < nworkers; i++) {
+    workers[i].lsw_rt   = ls_runtime_new(&opts->lso_runtime);
+    workers[i].lsw_opts = &opts->lso_runtime;
+    if (workers[i].lsw_rt == NULL)
+      return 1;
+  }
+  int lfd = ls_serve_listen(opts->lso_socket);
+  if (lfd < 0)
+    return 1;
+  // A client that goes away must not take the server with it
+  signal(SIGPIPE, SIG_IGN);
+  for (int i = 0; i < nworkers; i++) {
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, lsserve_worker, &workers[i]) != 0) {
+      perror("serve");
+      return 1;
+    }
+    pthread_detach(tid);
+  }
+  for (;;) {
+    int fd = accept(lfd, NULL, NULL);
+    if (fd >= 0)
+      lsserve_push(fd);
+  }
+  return 0;
+}
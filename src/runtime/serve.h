@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lsapi.h"
+
+// Evaluation server (lazyscript --serve): runtimes with the prelude, the init script and the
+// modules loaded by require kept warm, answering framed requests.
+//
+// A frame is a header line "<verb> <length>\n" followed by <length> bytes.
+// Requests:
+//   eval <n>  the body is a program; its value is returned
+//   call <n>  the body is a file path and one argument expression per following line; the value
+//             of the file (compiled once per runtime, again when its mtime changes) is applied to
+//             the arguments
+// Responses:
+//   ok <n>    the body is the value, printed as the lazyscript executable prints results
+//   err <n>   the body is the bottom the request evaluated to, or why it could not be evaluated
+// Each request is evaluated in a fresh environment on top of the prelude. A request that dies of a
+// fatal signal (a stack overflow, a failed assertion) is answered with err, and its runtime is
+// replaced by a new one.
+
+typedef struct ls_serve_opts {
+  const char*       lso_socket;  // Unix domain socket to listen on (NULL: stdin and stdout)
+  int               lso_workers; // runtimes serving socket connections (<= 0: processors)
+  ls_runtime_opts_t lso_runtime; // options of every runtime
+} ls_serve_opts_t;
+
+/**
+ * Serve requests
+ * On stdin, one runtime answers on stdout until end of input; program output written to stdout
+ * goes to stderr instead. On a socket, every worker owns a runtime and serves one connection at
+ * a time, so connections are evaluated concurrently in isolated contexts.
+ * @param opts The options
+ * @return The exit status
+ */
+int ls_serve(const ls_serve_opts_t* opts);
+
+/**
+ * Listen on a Unix domain socket, replacing the socket of an earlier server
+ * @param path The socket
+ * @return The listening descriptor, or -1 (reported on stderr)
+ */
+int ls_serve_listen(const char* path);
@@ -1,6 +1,8 @@
 #include "runtime/trace.h"
 #include "common/io.h"
 #include "common/malloc.h"
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,6 +17,17 @@ static __thread int     g_has_pending_loc = 0;
 static __thread lsloc_t g_pending_loc;
 // Optional JSONL dump state
 static FILE* g_trace_dump_fp = NULL;
+// Node address -> trace id (open addressing, linear probing); keys are not GC roots. Shared by
+// the threads of the process (--serve workers create nodes concurrently): every access, reads
+// included since growing frees the old array, holds g_trace_ids_lock.
+typedef struct lstrace_id_entry {
+  uintptr_t key; // 0 = empty
+  int       id;
+} lstrace_id_entry_t;
+static pthread_mutex_t     g_trace_ids_lock = PTHREAD_MUTEX_INITIALIZER;
+static lstrace_id_entry_t* g_trace_ids      = NULL;
+static size_t              g_trace_ids_cap  = 0; // power of two
+static size_t              g_trace_ids_cnt  = 0;
 // Debug guard (opt-in via env): verbose push/pop logs to locate imbalance
 static __thread int g_trace_dbg_inited  = 0;
 static __thread int g_trace_dbg_enabled = 0;
@@ -48,6 +61,12 @@ void lstrace_free(void) {
   free_table(g_lstrace_table);
   g_lstrace_table = NULL;
   g_trace_top     = 0;
+  pthread_mutex_lock(&g_trace_ids_lock);
+  free(g_trace_ids);
+  g_trace_ids     = NULL;
+  g_trace_ids_cap = 0;
+  g_trace_ids_cnt = 0;
+  pthread_mutex_unlock(&g_trace_ids_lock);
   if (g_trace_dump_fp) {
     fclose(g_trace_dump_fp);
     g_trace_dump_fp = NULL;
@@ -182,6 +201,63 @@ lstrace_span_t lstrace_lookup(int index) {
   return g_lstrace_table->spans[index];
 }
 
+int lstrace_ids_enabled(void) { return g_lstrace_table != NULL; }
+
+static size_t trace_id_hash(uintptr_t key) {
+  key ^= key >> 33;
+  key *= (uintptr_t)0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (size_t)key;
+}
+
+static lstrace_id_entry_t* trace_id_find(lstrace_id_entry_t* ents, size_t cap, uintptr_t key) {
+  size_t i = trace_id_hash(key) & (cap - 1);
+  while (ents[i].key != 0 && ents[i].key != key)
+    i = (i + 1) & (cap - 1);
+  return &ents[i];
+}
+
+void lstrace_set_id(const void* node, int id) {
+  uintptr_t key = (uintptr_t)node;
+  if (key == 0)
+    return;
+  pthread_mutex_lock(&g_trace_ids_lock);
+  if ((g_trace_ids_cnt + 1) * 4 > g_trace_ids_cap * 3) {
+    size_t              ncap = g_trace_ids_cap ? g_trace_ids_cap * 2 : 1024;
+    lstrace_id_entry_t* nent = (lstrace_id_entry_t*)calloc(ncap, sizeof(lstrace_id_entry_t));
+    if (!nent) {
+      pthread_mutex_unlock(&g_trace_ids_lock);
+      return;
+    }
+    for (size_t i = 0; i < g_trace_ids_cap; i++) {
+      if (g_trace_ids[i].key != 0)
+        *trace_id_find(nent, ncap, g_trace_ids[i].key) = g_trace_ids[i];
+    }
+    free(g_trace_ids);
+    g_trace_ids     = nent;
+    g_trace_ids_cap = ncap;
+  }
+  lstrace_id_entry_t* e = trace_id_find(g_trace_ids, g_trace_ids_cap, key);
+  if (e->key == 0) {
+    e->key = key;
+    g_trace_ids_cnt++;
+  }
+  e->id = id;
+  pthread_mutex_unlock(&g_trace_ids_lock);
+}
+
+int lstrace_get_id(const void* node) {
+  int id = -1;
+  pthread_mutex_lock(&g_trace_ids_lock);
+  if (g_trace_ids) {
+    lstrace_id_entry_t* e = trace_id_find(g_trace_ids, g_trace_ids_cap, (uintptr_t)node);
+    if (e->key != 0)
+      id = e->id;
+  }
+  pthread_mutex_unlock(&g_trace_ids_lock);
+  return id;
+}
+
 void lstrace_print_frame(FILE* fp, lstrace_span_t s) {
   fprintf(fp, "%s:%d:%d", s.filename ? s.filename : "<unknown>", s.first_line, s.first_column);
 }
@@ -43,6 +43,15 @@ int lstrace_current(void);
 void lstrace_push(int id);
 void lstrace_pop(void);
 
+// --- Per-node trace ids (side table) ---
+// Node ids are recorded only while a trace table is loaded; they are looked up by node address.
+// Returns non-zero when ids should be recorded.
+int lstrace_ids_enabled(void);
+// Record the trace id of a node (overwrites any previous entry at the same address).
+void lstrace_set_id(const void* node, int id);
+// Returns the recorded trace id of a node or -1 if none.
+int lstrace_get_id(const void* node);
+
 // Print up to max_depth frames from the current stack (top-first), each prefixed with " at ".
 void lstrace_print_stack(FILE* fp, int max_depth);
 
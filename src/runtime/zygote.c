@@ -0,0 +1,237 @@
+#include "runtime/zygote.h"
+#include "common/io.h"
+#include "runtime/modules.h"
+#include "runtime/serve.h"
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// A request is a 32-bit payload length and the payload: the working directory and the arguments,
+// each NUL-terminated. The client's standard streams travel with it (SCM_RIGHTS). The answer is
+// the 32-bit exit status, sent by the server once it has reaped the child, so a child that calls
+// exit() or dies of a signal (128 + its number) is answered too.
+
+// Largest request payload accepted
+#define LSZYGOTE_MAX_PAYLOAD (1024 * 1024)
+
+// A child still running, with the connection its status goes to
+typedef struct lszygote_proc {
+  struct lszygote_proc* lzp_next;
+  pid_t                 lzp_pid;
+  int                   lzp_conn;
+} lszygote_proc_t;
+
+typedef union lszygote_ctl {
+  char           lzc_buf[CMSG_SPACE(3 * sizeof(int))];
+  struct cmsghdr lzc_align;
+} lszygote_ctl_t;
+
+static int lszygote_read_full(int fd, void* buf, size_t len) {
+  for (size_t done = 0; done < len;) {
+    ssize_t n = read(fd, (char*)buf + done, len - done);
+    if (n <= 0)
+      return -1;
+    done += n;
+  }
+  return 0;
+}
+
+static int lszygote_write_full(int fd, const void* buf, size_t len) {
+  for (size_t done = 0; done < len;) {
+    ssize_t n = write(fd, (const char*)buf + done, len - done);
+    if (n <= 0)
+      return -1;
+    done += n;
+  }
+  return 0;
+}
+
+// In the child: take the request off the connection, install it and run it
+static int lszygote_child(int conn, ls_zygote_run_t run, void* data) {
+  uint32_t       len;
+  lszygote_ctl_t ctl;
+  struct iovec   iov = { &len, sizeof(len) };
+  struct msghdr  msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = ctl.lzc_buf;
+  msg.msg_controllen = sizeof(ctl.lzc_buf);
+  if (recvmsg(conn, &msg, MSG_WAITALL) != sizeof(len))
+    return 1;
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)) || len == 0 || len > LSZYGOTE_MAX_PAYLOAD)
+    return 1;
+  int fds[3];
+  memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  char* payload = malloc(len);
+  if (payload == NULL || lszygote_read_full(conn, payload, len) != 0 || payload[len - 1] != '\0')
+    return 1;
+  int argc = -1; // the working directory comes first
+  for (uint32_t i = 0; i < len; i++)
+    argc += payload[i] == '\0';
+  char** argv = malloc((argc + 1) * sizeof(char*));
+  char*  p    = payload + strlen(payload) + 1;
+  for (int i = 0; i < argc; i++, p += strlen(p) + 1)
+    argv[i] = p;
+  argv[argc] = NULL;
+  for (int i = 0; i < 3; i++) {
+    dup2(fds[i], i);
+    close(fds[i]);
+  }
+  if (chdir(payload) != 0) {
+    perror(payload);
+    return 1;
+  }
+  ls_modules_chdir();
+  return run(argc, argv, data);
+}
+
+// Answer the clients of the children that have exited
+static void lszygote_reap(lszygote_proc_t** children) {
+  int   wstatus;
+  pid_t pid;
+  while ((pid = waitpid(-1, &wstatus, WNOHANG)) > 0) {
+    lszygote_proc_t** pc = children;
+    while (*pc != NULL && (*pc)->lzp_pid != pid)
+      pc = &(*pc)->lzp_next;
+    if (*pc == NULL)
+      continue;
+    lszygote_proc_t* child  = *pc;
+    int32_t          status = WIFEXITED(wstatus)     ? WEXITSTATUS(wstatus)
+                              : WIFSIGNALED(wstatus) ? 128 + WTERMSIG(wstatus)
+                                                     : 1;
+    (void)lszygote_write_full(child->lzp_conn, &status, sizeof(status));
+    close(child->lzp_conn);
+    *pc = child->lzp_next;
+    free(child);
+  }
+}
+
+static void lszygote_on_child(int sig) { (void)sig; }
+
+int ls_zygote_serve(const char* path, ls_zygote_run_t run, void* data) {
+  int lfd = ls_serve_listen(path);
+  if (lfd < 0)
+    return 1;
+  // SIGCHLD is only let through while waiting for a connection, where it ends the wait
+  sigset_t chld, orig;
+  sigemptyset(&chld);
+  sigaddset(&chld, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &chld, &orig);
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = lszygote_on_child;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGCHLD, &sa, NULL);
+  signal(SIGPIPE, SIG_IGN); // a client that went away must not end the server
+  fflush(stdout);
+  fflush(stderr);
+  lszygote_proc_t* children = NULL;
+  for (;;) {
+    lszygote_reap(&children);
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(lfd, &rfds);
+    if (pselect(lfd + 1, &rfds, NULL, NULL, NULL, &orig) <= 0)
+      continue;
+    int conn = accept(lfd, NULL, NULL);
+    if (conn < 0)
+      continue;
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(lfd);
+      for (lszygote_proc_t* c = children; c != NULL; c = c->lzp_next)
+        close(c->lzp_conn);
+      signal(SIGCHLD, SIG_DFL);
+      signal(SIGPIPE, SIG_DFL);
+      sigprocmask(SIG_SETMASK, &orig, NULL);
+      int status = lszygote_child(conn, run, data);
+      fflush(stdout);
+      fflush(stderr);
+      _exit(status);
+    }
+    lszygote_proc_t* child = pid > 0 ? malloc(sizeof(lszygote_proc_t)) : NULL;
+    if (child == NULL) {
+      if (pid < 0)
+        perror("fork");
+      close(conn);
+      continue;
+    }
+    child->lzp_pid  = pid;
+    child->lzp_conn = conn;
+    child->lzp_next = children;
+    children        = child;
+  }
+  return 0;
+}
+
+int ls_zygote_connect(const char* path, int argc, char** argv) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    lsprintf(stderr, 0, "E: connect: socket path too long: %s\n", path);
+    return 1;
+  }
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    perror(path);
+    return 1;
+  }
+  char cwd[PATH_MAX];
+  if (getcwd(cwd, sizeof(cwd)) == NULL)
+    strcpy(cwd, "/");
+  size_t len = strlen(cwd) + 1;
+  for (int i = 0; i < argc; i++)
+    len += strlen(argv[i]) + 1;
+  char* buf = malloc(sizeof(uint32_t) + len);
+  if (buf == NULL || len > LSZYGOTE_MAX_PAYLOAD) {
+    lsprintf(stderr, 0, "E: connect: request too large\n");
+    return 1;
+  }
+  uint32_t len32 = (uint32_t)len;
+  memcpy(buf, &len32, sizeof(len32));
+  char* p = buf + sizeof(len32);
+  p       = stpcpy(p, cwd) + 1;
+  for (int i = 0; i < argc; i++)
+    p = stpcpy(p, argv[i]) + 1;
+
+  // The streams go with the length; the rest of the payload follows as plain data
+  lszygote_ctl_t ctl;
+  struct iovec   iov = { buf, sizeof(len32) };
+  struct msghdr  msg;
+  memset(&msg, 0, sizeof(msg));
+  memset(&ctl, 0, sizeof(ctl));
+  msg.msg_iov          = &iov;
+  msg.msg_iovlen       = 1;
+  msg.msg_control      = ctl.lzc_buf;
+  msg.msg_controllen   = sizeof(ctl.lzc_buf);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level     = SOL_SOCKET;
+  cmsg->cmsg_type      = SCM_RIGHTS;
+  cmsg->cmsg_len       = CMSG_LEN(3 * sizeof(int));
+
+  int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  int32_t status;
+  if (sendmsg(fd, &msg, 0) != sizeof(len32) ||
+      lszygote_write_full(fd, buf + sizeof(len32), len) != 0 ||
+      lszygote_read_full(fd, &status, sizeof(status)) != 0) {
+    lsprintf(stderr, 0, "E: connect: request failed\n");
+    return 1;
+  }
+  free(buf);
+  close(fd);
+  return status;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Fork server (lazyscript --zygote): a process that has loaded the prelude, the init script and
+// preloaded modules forks one child per request, so children start from the warmed heap
+// (shared copy-on-write) instead of initializing again.
+//
+// A client (lazyscript --connect=<socket>) sends its working directory, its arguments and its
+// standard input, output and error over a Unix domain socket. The child runs with them and the
+// client exits with the child's status.
+
+// Run a request in the forked child: argc/argv are the client's arguments
+typedef int (*ls_zygote_run_t)(int argc, char** argv, void* data);
+
+/**
+ * Serve requests on a socket, forking a child running run for each; does not return on success
+ * The calling process must be single-threaded.
+ * @param path The socket
+ * @param run The request handler (in the child)
+ * @param data Passed to run
+ * @return The exit status when the socket cannot be set up
+ */
+int ls_zygote_serve(const char* path, ls_zygote_run_t run, void* data);
+
+/**
+ * Have a fork server run a request with the caller's working directory and standard streams
+ * @param path The socket
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return The exit status of the request (1 when the server cannot be reached)
+ */
+int ls_zygote_connect(const char* path, int argc, char** argv);
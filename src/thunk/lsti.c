@@ -135,58 +135,74 @@ int lsti_write(FILE* fp, struct lsthunk* const* roots, lssize_t rootc,
   vec_u32_t  edges = { 0 }; // flattened child id list; we'll write per-node later
   vec_pool_t spool = { 0 }; // string blob: STR values and BOTTOM messages
   vec_pool_t ypool = { 0 }; // symbol blob: SYMBOL literals and ALGE constructors
+  vec_u32_t  ytags = { 0 }; // constructor tag -> ypool index + 1 (0 = not cached)
 
   // add to string pool if not exists; return index
 #define ADD_SPOOL(BYTES, LEN, OUT_IDX)                                                             \
   do {                                                                                             \
     const char* __b = (const char*)(BYTES);                                                        \
     lssize_t    __l = (LEN);                                                                       \
-    int         __idx = -1;                                                                        \
+    int         __sp_idx = -1;                                                                     \
     if (__b && __l >= 0) {                                                                         \
       for (lssize_t __i = 0; __i < spool.size; ++__i) {                                            \
         if (spool.data[__i].len == __l &&                                                          \
             ((__l == 0) || memcmp(spool.data[__i].bytes, __b, (size_t)__l) == 0)) {                \
-          __idx = (int)__i;                                                                        \
+          __sp_idx = (int)__i;                                                                     \
           break;                                                                                   \
         }                                                                                          \
       }                                                                                            \
     }                                                                                              \
-    if (__idx < 0) {                                                                               \
+    if (__sp_idx < 0) {                                                                            \
       pool_ent_t __e;                                                                              \
       __e.bytes = __b;                                                                             \
       __e.len   = __l;                                                                             \
       __e.off   = 0u;                                                                              \
       VEC_PUSH(spool, __e, pool_ent_t);                                                            \
-      __idx = (int)(spool.size - 1);                                                               \
+      __sp_idx = (int)(spool.size - 1);                                                            \
     }                                                                                              \
-    (OUT_IDX) = __idx;                                                                             \
+    (OUT_IDX) = __sp_idx;                                                                          \
   } while (0)
 
   // add to symbol pool if not exists; return index
 #define ADD_YPOOL(LSSTR, OUT_IDX)                                                                  \
   do {                                                                                             \
     const lsstr_t* __s = (LSSTR);                                                                  \
-    int            __idx = -1;                                                                     \
+    int            __yp_idx = -1;                                                                  \
     if (__s) {                                                                                     \
       const char* __b = lsstr_get_buf(__s);                                                        \
       lssize_t    __l = lsstr_get_len(__s);                                                        \
       for (lssize_t __i = 0; __i < ypool.size; ++__i) {                                            \
         if (ypool.data[__i].len == __l &&                                                          \
             ((__l == 0) || memcmp(ypool.data[__i].bytes, __b, (size_t)__l) == 0)) {                \
-          __idx = (int)__i;                                                                        \
+          __yp_idx = (int)__i;                                                                     \
           break;                                                                                   \
         }                                                                                          \
       }                                                                                            \
-      if (__idx < 0) {                                                                             \
+      if (__yp_idx < 0) {                                                                          \
         pool_ent_t __e;                                                                            \
         __e.bytes = __b;                                                                           \
         __e.len   = __l;                                                                           \
         __e.off   = 0u;                                                                            \
         VEC_PUSH(ypool, __e, pool_ent_t);                                                          \
-        __idx = (int)(ypool.size - 1);                                                             \
+        __yp_idx = (int)(ypool.size - 1);                                                          \
       }                                                                                            \
     }                                                                                              \
-    (OUT_IDX) = __idx;                                                                             \
+    (OUT_IDX) = __yp_idx;                                                                          \
+  } while (0)
+
+  // add a constructor name to symbol pool, looking it up by tag first; return index
+#define ADD_YPOOL_CONSTR(LSSTR, OUT_IDX)                                                           \
+  do {                                                                                             \
+    const lsstr_t* __c   = (LSSTR);                                                                \
+    int            __tag = lsstr_get_tag(__c);                                                     \
+    if (__tag < ytags.size && ytags.data[__tag] > 0) {                                             \
+      (OUT_IDX) = (int)ytags.data[__tag] - 1;                                                      \
+    } else {                                                                                       \
+      ADD_YPOOL(__c, OUT_IDX);                                                                     \
+      while (ytags.size <= __tag)                                                                  \
+        VEC_PUSH(ytags, 0u, uint32_t);                                                             \
+      ytags.data[__tag] = (uint32_t)(OUT_IDX) + 1u;                                                \
+    }                                                                                              \
   } while (0)
 
   // find existing node id in nodes or -1
@@ -234,7 +250,7 @@ int lsti_write(FILE* fp, struct lsthunk* const* roots, lssize_t rootc,
     }
     case LSTTYPE_ALGE: {
       const lsstr_t* c = lsthunk_get_constr(t);
-      if (c) { int __idx; ADD_YPOOL(c, __idx); (void)__idx; }
+      if (c) { int __idx; ADD_YPOOL_CONSTR(c, __idx); (void)__idx; }
       lssize_t ac = lsthunk_get_argc(t);
       lsthunk_t* const* as = lsthunk_get_args(t);
       for (lssize_t i = 0; i < ac; ++i) {
@@ -443,7 +459,7 @@ int lsti_write(FILE* fp, struct lsthunk* const* roots, lssize_t rootc,
       case LSPTYPE_ALGE: {
         const lsstr_t* c = lstpat_get_constr(p);
         int            yi;
-        ADD_YPOOL(c, yi);
+        ADD_YPOOL_CONSTR(c, yi);
         uint32_t clen = (uint32_t)lsstr_get_len(c);
         uint32_t coff = (uint32_t)ypool.data[yi].off;
         uint32_t argc = (uint32_t)lstpat_get_argc(p);
@@ -708,7 +724,7 @@ int lsti_write(FILE* fp, struct lsthunk* const* roots, lssize_t rootc,
       const lsstr_t* c = lsthunk_get_constr(t);
       if (c) {
         int idx;
-        ADD_YPOOL(c, idx);
+        ADD_YPOOL_CONSTR(c, idx);
         hdr2.extra          = (uint32_t)ypool.data[idx].off;
         pay_len_or_reserved = (uint32_t)lsstr_get_len(c);
       }
@@ -946,6 +962,7 @@ int lsti_write(FILE* fp, struct lsthunk* const* roots, lssize_t rootc,
   free(nodes.data);
   free(spool.data);
   free(ypool.data);
+  free(ytags.data);
   free(ppool.data);
   return 0;
 }
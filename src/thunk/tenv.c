@@ -117,4 +117,16 @@ void lstenv_put_builtin(lstenv_t* tenv, const lsstr_t* name, lssize_t arity, lst
   lstpat_t*               tpat   = lstpat_new_ref(lsref_new(name, loc));
   lstref_target_t*        target = lstref_target_new(origin, tpat);
   lstenv_put(tenv, name, target);
+}
+
+void lstenv_put_dispatcher(lstenv_t* tenv, const lsstr_t* name, lstbuiltin_func_t func,
+                           void* data, lstbuiltin_lookup_t lookup) {
+  assert(tenv != NULL);
+  assert(name != NULL);
+  assert(func != NULL);
+  lstref_target_origin_t* origin = lstref_target_origin_new_dispatcher(name, func, data, lookup);
+  lsloc_t                 loc    = lsloc("<builtin>", 1, 1, 1, 1);
+  lstpat_t*               tpat   = lstpat_new_ref(lsref_new(name, loc));
+  lstref_target_t*        target = lstref_target_new(origin, tpat);
+  lstenv_put(tenv, name, target);
 }
\ No newline at end of file
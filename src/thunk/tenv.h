@@ -18,3 +18,7 @@ lssize_t         lstenv_get_nfatals(const lstenv_t* tenv);
 void             lstenv_print(FILE* fp, const lstenv_t* tenv);
 void lstenv_put_builtin(lstenv_t* tenv, const lsstr_t* name, lssize_t arity, lstbuiltin_func_t func,
                         void* data);
+// A one-argument builtin mapping names to builtins; lookup tells what it maps a name to without
+// calling it
+void lstenv_put_dispatcher(lstenv_t* tenv, const lsstr_t* name, lstbuiltin_func_t func,
+                           void* data, lstbuiltin_lookup_t lookup);
@@ -9,7 +9,10 @@
 #include "runtime/error.h"
 #include "runtime/trace.h"
 #include "runtime/effects.h"
+#include "runtime/context.h"
 #include <assert.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <string.h>
 #include "expr/enslit.h"
@@ -31,30 +34,90 @@
 
 struct lstalge {
   const lsstr_t* lta_constr;
+  int            lta_tag; // lsstr_get_tag(lta_constr)
   lssize_t       lta_argc;
   lsthunk_t*     lta_args[0];
 };
 
 struct lstappl {
   lsthunk_t* lta_func;
+  lsthunk_t* lta_whnf; // memoized result; NULL until evaluated
   lssize_t   lta_argc;
   lsthunk_t* lta_args[0];
 };
 
+typedef struct lstchoice_dispatch lstchoice_dispatch_t;
+
 struct lstchoice {
-  lsthunk_t* ltc_left;
-  lsthunk_t* ltc_right;
-  int        ltc_kind; // 1=lambda-choice ('|'), 2=expr-choice ('||')
+  lsthunk_t*                  ltc_left;
+  lsthunk_t*                  ltc_right;
+  int                         ltc_kind; // 1=lambda-choice ('|'), 2=expr-choice ('||')
+  const lstchoice_dispatch_t* ltc_dispatch; // lambda-choice only; NULL until first applied
+  lsthunk_t*                  ltc_whnf;     // memoized result; NULL until evaluated
+};
+
+// Head of the first parameter of one lambda-choice arm.
+typedef enum lstarm_head {
+  LSTARM_ANY = 0, // ref, wildcard, as, or, caret: must be tried
+  LSTARM_ALGE,
+  LSTARM_INT,
+  LSTARM_STR,
+} lstarm_head_t;
+
+typedef struct lstchoice_arm {
+  lsthunk_t*     lca_thunk; // the lambda
+  lstarm_head_t  lca_head;
+  int            lca_tag;   // LSTARM_ALGE: constructor tag
+  lssize_t       lca_argc;  // LSTARM_ALGE
+  const lsint_t* lca_int;   // LSTARM_INT
+  const lsstr_t* lca_str;   // LSTARM_STR
+  lssize_t       lca_next;  // LSTARM_ALGE: next arm with the same tag, or lcd_armc
+  lssize_t       lca_other; // first arm from this one on that is not LSTARM_ALGE, or lcd_armc
+} lstchoice_arm_t;
+
+// Flattened view of a right-associative chain \P1 -> E1 | \P2 -> E2 | ... built when the
+// outermost choice is first applied, so that evaluation can go straight to the arms whose
+// first-parameter head can match.
+struct lstchoice_dispatch {
+  lssize_t        lcd_armc;
+  int             lcd_tagmin; // constructor tags of the arms lie in [lcd_tagmin, +lcd_tagc)
+  int             lcd_tagc;
+  lssize_t*       lcd_bytag;  // first arm of each tag, or lcd_armc
+  lstchoice_arm_t lcd_arms[0];
 };
 
+// ltc_dispatch of a choice that cannot be dispatched
+static const lstchoice_dispatch_t lstchoice_nodispatch_s;
+#define LSTCHOICE_NODISPATCH (&lstchoice_nodispatch_s)
+
 struct lstbind {
   lstpat_t*  ltb_lhs;
   lsthunk_t* ltb_rhs;
 };
 
+// Uncurried view of a chain of directly nested lambdas \P1 -> \P2 -> ... -> \Pn -> body (n >= 2).
+// The nested LAMBDA nodes are kept for partial application; this view lets a saturated
+// application bind all parameters in one step.
+typedef struct lstlambda_nary {
+  lssize_t   lln_arity;
+  lsthunk_t* lln_body;
+  lstpat_t*  lln_params[0];
+} lstlambda_nary_t;
+
+// Strictness summary of a lambda (chain): the parameters its body forces before anything else
+// can happen, in the order it forces them. A saturated application evaluates those arguments
+// up front so the parameters are bound to values instead of suspensions.
+typedef struct lstlambda_strict {
+  lssize_t lls_arity; // arguments a call needs for the summary to apply
+  lssize_t lls_count;
+  lssize_t lls_order[0];
+} lstlambda_strict_t;
+
 struct lstlambda {
-  lstpat_t*  ltl_param;
-  lsthunk_t* ltl_body;
+  lstpat_t*                 ltl_param;
+  lsthunk_t*                ltl_body;
+  const lstlambda_nary_t*   ltl_nary;   // NULL unless ltl_body is itself a lambda
+  const lstlambda_strict_t* ltl_strict; // NULL until the first saturated application
 };
 
 struct lstref_target_origin {
@@ -75,14 +138,16 @@ struct lstref {
   const lsref_t*   ltr_ref;
   lstref_target_t* ltr_target;
   const lstenv_t*  ltr_env;
+  lsthunk_t*       ltr_whnf; // memoized result; NULL until evaluated
 };
 
 struct lstbuiltin {
-  const lsstr_t*    lti_name;
-  lssize_t          lti_arity;
-  lstbuiltin_func_t lti_func;
-  void*             lti_data;
-  lsbuiltin_attr_t  lti_attr;
+  const lsstr_t*      lti_name;
+  lssize_t            lti_arity;
+  lstbuiltin_func_t   lti_func;
+  void*               lti_data;
+  lsbuiltin_attr_t    lti_attr;
+  lstbuiltin_lookup_t lti_lookup; // dispatchers: what a name maps to (NULL: not a dispatcher)
 };
 
 typedef struct lsbotrel {
@@ -90,10 +155,21 @@ typedef struct lsbotrel {
   lsthunk_t** lbr_args; // related thunks (opaque)
 } lsbotrel_t;
 
+// Header flags (lt_flags)
+#define LSTHDR_WHNF     0x1u // the node itself is in WHNF
+#define LSTHDR_TRACED   0x2u // a trace id is recorded in the trace side table
+#define LSTHDR_HASHCONS 0x4u // canonical node of the hash-consing table
+// Parallel mode only: a thread is evaluating the suspension. The claiming thread's owner id
+// (lsthunk_par_owner) is kept in the bits from LSTHDR_OWNER_SHIFT until the WHNF is published.
+#define LSTHDR_BLACKHOLE   0x8u
+#define LSTHDR_OWNER_SHIFT 8
+#define LSTHDR_OWNER_MASK  (~0u << LSTHDR_OWNER_SHIFT)
+
 struct lsthunk {
-  lsttype_t  lt_type;
-  lsthunk_t* lt_whnf;
-  int        lt_trace_id;
+  // 8-byte header: type tag and flags. Suspensions (APPL, REF, CHOICE, BUILTIN) keep their
+  // memoized WHNF in the payload; values carry LSTHDR_WHNF instead.
+  lsttype_t lt_type;
+  uint32_t  lt_flags;
   union {
     lstalge_t           lt_alge;
     lstappl_t           lt_appl;
@@ -103,28 +179,303 @@ struct lsthunk {
     const lsint_t*      lt_int;
     const lsstr_t*      lt_str;
     const lsstr_t*      lt_symbol;
-    const lstbuiltin_t* lt_builtin;
     struct {
-      const char* lt_msg;
+      const lstbuiltin_t* ltb_def;
+      lsthunk_t*          ltb_whnf; // memoized result of a zero-arity call
+    } lt_builtin;
+    struct {
+      const char* lt_msg; // NULL until rendered (merge and raise nodes)
       lsloc_t     lt_loc;
-      lsbotrel_t  lt_rel;
+      lsbotrel_t  lt_rel;    // merge nodes: LSBOTREL_PENDING until flattened
+      lsthunk_t*  lt_sub[2]; // merge nodes: the two merged bottoms; NULL otherwise
     } lt_bottom;
   };
 };
 
-static int g_trace_next_id = 0;
+// Parallel evaluation (lsthunk_set_parallel): suspensions are claimed before evaluation
+static int               g_par_enabled    = 0;
+static uint32_t          g_par_owner_next = 0; // owner ids handed out
+static __thread uint32_t g_par_owner      = 0; // this thread's owner id (0: none yet)
+
+// Threads waiting for another thread's claim sleep on g_par_released, which is broadcast when a
+// claim is dropped while g_par_waiters is non-zero
+static pthread_mutex_t g_par_wait_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_par_released  = PTHREAD_COND_INITIALIZER;
+static int             g_par_waiters   = 0;
+
+void lsthunk_set_parallel(int enabled) {
+  __atomic_store_n(&g_par_enabled, enabled != 0, __ATOMIC_SEQ_CST);
+}
+
+// The calling thread's owner id, shifted into place; every thread takes its own on first use,
+// pool workers and host threads (serve workers, embedders) alike. Ids wrap after 2^24 - 1.
+static uint32_t lsthunk_par_owner(void) {
+  if (g_par_owner == 0) {
+    uint32_t n  = __atomic_add_fetch(&g_par_owner_next, 1, __ATOMIC_RELAXED);
+    g_par_owner = (n % (LSTHDR_OWNER_MASK >> LSTHDR_OWNER_SHIFT) + 1) << LSTHDR_OWNER_SHIFT;
+  }
+  return g_par_owner;
+}
+
+// Take the next creation-order trace id of the current context. The id is kept (in the trace
+// side table) only while a trace table is loaded, so untraced runs pay nothing per node for it.
+static void lsthunk_trace_assign(lsthunk_t* t) {
+  int* next = &ls_context_current()->lc_trace_next_id;
+  int  id   = g_par_enabled ? __atomic_fetch_add(next, 1, __ATOMIC_RELAXED) : (*next)++;
+  if (lstrace_ids_enabled()) {
+    lstrace_set_id(t, id);
+    t->lt_flags |= LSTHDR_TRACED;
+  }
+}
+
+// Slot holding the memoized WHNF of a suspension; NULL for other nodes
+static lsthunk_t** lsthunk_memo_slot(lsthunk_t* t) {
+  switch (t->lt_type) {
+  case LSTTYPE_APPL:
+    return &t->lt_appl.lta_whnf;
+  case LSTTYPE_REF:
+    return &t->lt_ref.ltr_whnf;
+  case LSTTYPE_CHOICE:
+    return &t->lt_choice.ltc_whnf;
+  case LSTTYPE_BUILTIN:
+    return &t->lt_builtin.ltb_whnf;
+  default:
+    return NULL;
+  }
+}
+
+// Memoized WHNF of a thunk without forcing it; NULL while a suspension is unevaluated. The
+// acquire loads pair with the release stores of lsthunk_eval0, which may run on another thread.
+static lsthunk_t* lsthunk_whnf_peek(lsthunk_t* t) {
+  if (__atomic_load_n(&t->lt_flags, __ATOMIC_ACQUIRE) & LSTHDR_WHNF)
+    return t;
+  lsthunk_t** slot = lsthunk_memo_slot(t);
+  return slot != NULL ? __atomic_load_n(slot, __ATOMIC_ACQUIRE) : NULL;
+}
+
+static void lsthunk_trace_copy(lsthunk_t* dst, const lsthunk_t* src) {
+  if (src->lt_flags & LSTHDR_TRACED) {
+    lstrace_set_id(dst, lstrace_get_id(src));
+    dst->lt_flags |= LSTHDR_TRACED;
+  }
+}
+
+static int lsthunk_trace_id(const lsthunk_t* t) {
+  return (t->lt_flags & LSTHDR_TRACED) ? lstrace_get_id(t) : -1;
+}
+
+// --- Hash-consing (opt-in) ------------------------------------------------
+//
+// INT/STR/SYMBOL values and ALGE values whose arguments are all hash-consed are interned by
+// structure, so structurally equal values share one node (LSTHDR_HASHCONS). The table lives in
+// libc memory and holds weak links only: it never keeps a value alive. Disabled while a trace
+// map is loaded, since shared nodes would lose their per-site trace ids.
+
+typedef struct lshc_entry lshc_entry_t;
+
+struct lshc_entry {
+  lshc_entry_t* lhe_next;
+  unsigned int  lhe_hash;
+  lsthunk_t*    lhe_node; // weak; cleared by the collector when the node dies
+};
+
+// Each context has its own table (lc_hashcons_table), created on first use; it is locked in
+// parallel mode, when sparks of one context intern on several threads.
+typedef struct lshc_table {
+  pthread_mutex_t lht_lock;
+  lshc_entry_t**  lht_buckets;
+  lssize_t        lht_cap; // power of two
+  lssize_t        lht_count;
+} lshc_table_t;
+
+static pthread_mutex_t g_hc_init_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Get the table of the current context, creating it when missing
+static lshc_table_t* lshc_table(void) {
+  ls_context_t* ctx = ls_context_current();
+  lshc_table_t* tbl = __atomic_load_n((lshc_table_t**)&ctx->lc_hashcons_table, __ATOMIC_ACQUIRE);
+  if (tbl != NULL)
+    return tbl;
+  pthread_mutex_lock(&g_hc_init_lock);
+  tbl = ctx->lc_hashcons_table;
+  if (tbl == NULL && (tbl = calloc(1, sizeof(lshc_table_t))) != NULL) {
+    pthread_mutex_init(&tbl->lht_lock, NULL);
+    __atomic_store_n((lshc_table_t**)&ctx->lc_hashcons_table, tbl, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&g_hc_init_lock);
+  return tbl;
+}
+
+void lsthunk_set_hashcons(int enabled) { ls_context_current()->lc_hashcons = enabled != 0; }
+
+int lsthunk_is_hashconsed(const lsthunk_t* thunk) {
+  return thunk != NULL && (thunk->lt_flags & LSTHDR_HASHCONS) != 0;
+}
+
+static unsigned int lshc_mix(unsigned int h, uintptr_t v) {
+  h ^= (unsigned int)(v ^ (v >> 32));
+  return h * 0x9e3779b1u;
+}
+
+// Compute the structural hash of a value; returns 0 when it cannot be hash-consed.
+// ALGE arguments that are evaluated suspensions are replaced by their (canonical) WHNF.
+static int lshc_hash(lsthunk_t* t, unsigned int* phash) {
+  unsigned int h = lshc_mix(0, (uintptr_t)t->lt_type);
+  switch (t->lt_type) {
+  case LSTTYPE_INT:
+    *phash = lshc_mix(h, (uintptr_t)(unsigned int)lsint_get(t->lt_int));
+    return 1;
+  case LSTTYPE_STR:
+    *phash = lshc_mix(h, lsstr_calc_hash(t->lt_str));
+    return 1;
+  case LSTTYPE_SYMBOL:
+    *phash = lshc_mix(h, lsstr_calc_hash(t->lt_symbol));
+    return 1;
+  case LSTTYPE_ALGE:
+    h = lshc_mix(h, (uintptr_t)t->lt_alge.lta_tag);
+    for (lssize_t i = 0; i < t->lt_alge.lta_argc; i++) {
+      lsthunk_t* arg = t->lt_alge.lta_args[i];
+      lsthunk_t* v   = arg != NULL ? lsthunk_whnf_peek(arg) : NULL;
+      if (v == NULL || !(v->lt_flags & LSTHDR_HASHCONS))
+        return 0;
+      t->lt_alge.lta_args[i] = v;
+      h                      = lshc_mix(h, (uintptr_t)v);
+    }
+    *phash = h;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+static int lshc_equal(const lsthunk_t* a, const lsthunk_t* b) {
+  if (a->lt_type != b->lt_type)
+    return 0;
+  switch (a->lt_type) {
+  case LSTTYPE_INT:
+    return lsint_eq(a->lt_int, b->lt_int);
+  case LSTTYPE_STR:
+    return lsstrcmp(a->lt_str, b->lt_str) == 0;
+  case LSTTYPE_SYMBOL:
+    return lsstrcmp(a->lt_symbol, b->lt_symbol) == 0;
+  case LSTTYPE_ALGE:
+    if (a->lt_alge.lta_tag != b->lt_alge.lta_tag || a->lt_alge.lta_argc != b->lt_alge.lta_argc)
+      return 0;
+    // Arguments are canonical, so identity is structural equality
+    for (lssize_t i = 0; i < a->lt_alge.lta_argc; i++) {
+      if (a->lt_alge.lta_args[i] != b->lt_alge.lta_args[i])
+        return 0;
+    }
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+static void lshc_grow(lshc_table_t* tbl) {
+  lssize_t       ncap = tbl->lht_cap ? tbl->lht_cap * 2 : 1024;
+  lshc_entry_t** nbkt = calloc(ncap, sizeof(lshc_entry_t*));
+  if (nbkt == NULL)
+    return;
+  for (lssize_t i = 0; i < tbl->lht_cap; i++) {
+    lshc_entry_t* e = tbl->lht_buckets[i];
+    while (e != NULL) {
+      lshc_entry_t* next = e->lhe_next;
+      lssize_t      j    = e->lhe_hash & (ncap - 1);
+      e->lhe_next        = nbkt[j];
+      nbkt[j]            = e;
+      e                  = next;
+    }
+  }
+  free(tbl->lht_buckets);
+  tbl->lht_buckets = nbkt;
+  tbl->lht_cap     = ncap;
+}
+
+// Look up t (with its structural hash) in the table, adding it when no equal node is found
+static lsthunk_t* lshc_intern(lshc_table_t* tbl, lsthunk_t* t, unsigned int hash) {
+  if ((tbl->lht_count + 1) * 4 > tbl->lht_cap * 3)
+    lshc_grow(tbl);
+  if (tbl->lht_cap == 0)
+    return t;
+  lshc_entry_t** pe = &tbl->lht_buckets[hash & (tbl->lht_cap - 1)];
+  while (*pe != NULL) {
+    lshc_entry_t* e = *pe;
+    if (e->lhe_node == NULL) {
+      // the node was collected; drop its entry
+      *pe = e->lhe_next;
+      free(e);
+      tbl->lht_count--;
+      continue;
+    }
+    if (e->lhe_hash == hash && lshc_equal(e->lhe_node, t)) {
+      lsfree(t);
+      return e->lhe_node;
+    }
+    pe = &e->lhe_next;
+  }
+  lshc_entry_t* e = malloc(sizeof(lshc_entry_t));
+  if (e == NULL)
+    return t;
+  e->lhe_hash = hash;
+  e->lhe_node = t;
+  e->lhe_next = *pe;
+  *pe         = e;
+  tbl->lht_count++;
+  lsweak_link((void**)&e->lhe_node, t);
+  t->lt_flags |= LSTHDR_HASHCONS;
+  return t;
+}
+
+/**
+ * Return the canonical node for a freshly built value
+ * @param t The value; released when an equal canonical node already exists
+ * @return The canonical node, or t itself when hash-consing is off or t is not eligible
+ */
+static lsthunk_t* lsthunk_hashcons(lsthunk_t* t) {
+  if (!ls_context_current()->lc_hashcons || lstrace_ids_enabled())
+    return t;
+  unsigned int hash = 0;
+  if (!lshc_hash(t, &hash))
+    return t;
+  lshc_table_t* tbl = lshc_table();
+  if (tbl == NULL)
+    return t;
+  if (!g_par_enabled)
+    return lshc_intern(tbl, t, hash);
+  pthread_mutex_lock(&tbl->lht_lock);
+  lsthunk_t* ret = lshc_intern(tbl, t, hash);
+  pthread_mutex_unlock(&tbl->lht_lock);
+  return ret;
+}
 
 // --- Bottom (⊥) -----------------------------------------------------------
+//
+// Diagnostics are kept as a tree and rendered only when asked for:
+//  - leaf:  lt_msg set, lt_sub[0] == NULL
+//  - raise: lt_msg NULL until rendered as "raise: <deep print of lt_rel[0]>"
+//  - merge: lt_sub = { a, b }; message is a's and b's joined with "; ", related thunks are a's
+//           followed by b's. Both are computed on first access and cached on the node.
+
+#define LSBOTREL_PENDING ((lssize_t)-1)
+
+static lsthunk_t* lsthunk_alloc_bottom_node(lsloc_t loc) {
+  lsthunk_t* t = lsmalloc(lssizeof(lsthunk_t, lt_bottom));
+  t->lt_type   = LSTTYPE_BOTTOM;
+  t->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(t);
+  lstrace_emit_loc(loc.filename ? loc : lstrace_take_pending_or_unknown());
+  t->lt_bottom.lt_msg    = "";
+  t->lt_bottom.lt_loc    = loc;
+  t->lt_bottom.lt_sub[0] = NULL;
+  t->lt_bottom.lt_sub[1] = NULL;
+  return t;
+}
 
 lsthunk_t* lsthunk_new_bottom(const char* message, lsloc_t loc, lssize_t argc,
                               lsthunk_t* const* args) {
-  lsthunk_t* t   = lsmalloc(sizeof(lsthunk_t));
-  t->lt_type     = LSTTYPE_BOTTOM;
-  t->lt_whnf     = t; // bottom is WHNF
-  t->lt_trace_id = g_trace_next_id++;
-  lstrace_emit_loc(loc.filename ? loc : lstrace_take_pending_or_unknown());
+  lsthunk_t* t                 = lsthunk_alloc_bottom_node(loc);
   t->lt_bottom.lt_msg          = message ? message : "";
-  t->lt_bottom.lt_loc          = loc;
   t->lt_bottom.lt_rel.lbr_argc = argc;
   if (argc > 0) {
     t->lt_bottom.lt_rel.lbr_args = lsmalloc(sizeof(lsthunk_t*) * argc);
@@ -140,21 +491,151 @@ lsthunk_t* lsthunk_bottom_here(const char* message) {
   return lsthunk_new_bottom(message, lstrace_take_pending_or_unknown(), 0, NULL);
 }
 
+// Bottom raised with a payload; the "raise: ..." message is printed only if someone asks
+static lsthunk_t* lsthunk_new_raise_bottom(lsthunk_t* payload, lsloc_t loc) {
+  lsthunk_t* t                    = lsthunk_new_bottom(NULL, loc, 1, &payload);
+  t->lt_bottom.lt_msg             = NULL;
+  return t;
+}
+
+static int lsbottom_is_merge(const lsthunk_t* t) { return t->lt_bottom.lt_sub[0] != NULL; }
+
+// Visit the leaves (and raise nodes) of a bottom tree left to right without recursion
+static void lsbottom_each_leaf(lsthunk_t* t, void (*fn)(lsthunk_t* leaf, void* data),
+                               void* data) {
+  lssize_t    sp    = 0;
+  lssize_t    cap   = 16;
+  lsthunk_t** stack = lsmalloc(sizeof(lsthunk_t*) * cap);
+  stack[sp++]       = t;
+  while (sp > 0) {
+    lsthunk_t* n = stack[--sp];
+    if (!lsbottom_is_merge(n)) {
+      fn(n, data);
+      continue;
+    }
+    if (sp + 2 > cap) {
+      lsthunk_t** ns = lsmalloc(sizeof(lsthunk_t*) * cap * 2);
+      memcpy(ns, stack, sizeof(lsthunk_t*) * sp);
+      lsfree(stack);
+      stack = ns;
+      cap *= 2;
+    }
+    stack[sp++] = n->lt_bottom.lt_sub[1];
+    stack[sp++] = n->lt_bottom.lt_sub[0];
+  }
+  lsfree(stack);
+}
+
+typedef struct lsbottom_render {
+  FILE* lbr_fp;
+  int   lbr_first;
+} lsbottom_render_t;
+
+static void lsbottom_render_leaf(lsthunk_t* leaf, void* data) {
+  lsbottom_render_t* r = data;
+  const char*        m = leaf->lt_bottom.lt_msg;
+  if (m != NULL && m[0] == '\0')
+    return;
+  if (!r->lbr_first)
+    lsprintf(r->lbr_fp, 0, "; ");
+  r->lbr_first = 0;
+  if (m != NULL) {
+    lsprintf(r->lbr_fp, 0, "%s", m);
+    return;
+  }
+  lsprintf(r->lbr_fp, 0, "raise: ");
+  lsthunk_deep_print(r->lbr_fp, LSPREC_LOWEST, 0, leaf->lt_bottom.lt_rel.lbr_args[0]);
+}
+
+// The message is published like the flattened args: another thread may render it too
+static const char* lsbottom_render(lsthunk_t* t) {
+  const char* msg = __atomic_load_n(&t->lt_bottom.lt_msg, __ATOMIC_ACQUIRE);
+  if (msg != NULL)
+    return msg;
+  char*             buf = NULL;
+  size_t            bl  = 0;
+  lsbottom_render_t r   = { lsopen_memstream_gc(&buf, &bl), 1 };
+  lsbottom_each_leaf(t, lsbottom_render_leaf, &r);
+  fclose(r.lbr_fp);
+  msg = buf ? buf : "";
+  __atomic_store_n(&t->lt_bottom.lt_msg, msg, __ATOMIC_RELEASE);
+  return msg;
+}
+
+typedef struct lsbottom_flatten {
+  lsthunk_t** lbf_args;
+  lssize_t    lbf_argc;
+} lsbottom_flatten_t;
+
+static void lsbottom_count_leaf(lsthunk_t* leaf, void* data) {
+  ((lsbottom_flatten_t*)data)->lbf_argc += leaf->lt_bottom.lt_rel.lbr_argc;
+}
+
+static void lsbottom_collect_leaf(lsthunk_t* leaf, void* data) {
+  lsbottom_flatten_t* f = data;
+  for (lssize_t i = 0; i < leaf->lt_bottom.lt_rel.lbr_argc; i++)
+    f->lbf_args[f->lbf_argc++] = leaf->lt_bottom.lt_rel.lbr_args[i];
+}
+
+// Under par, two threads may flatten one node at once: both publish the same count, each with
+// its own array, so readers load both with acquire (see lsthunk_bottom_get_argc/args)
+static void lsbottom_flatten(lsthunk_t* t) {
+  if (__atomic_load_n(&t->lt_bottom.lt_rel.lbr_argc, __ATOMIC_ACQUIRE) != LSBOTREL_PENDING)
+    return;
+  lsbottom_flatten_t f = { NULL, 0 };
+  lsbottom_each_leaf(t, lsbottom_count_leaf, &f);
+  lssize_t argc = f.lbf_argc;
+  f.lbf_args    = argc ? lsmalloc(sizeof(lsthunk_t*) * argc) : NULL;
+  f.lbf_argc    = 0;
+  lsbottom_each_leaf(t, lsbottom_collect_leaf, &f);
+  __atomic_store_n(&t->lt_bottom.lt_rel.lbr_args, f.lbf_args, __ATOMIC_RELEASE);
+  __atomic_store_n(&t->lt_bottom.lt_rel.lbr_argc, argc, __ATOMIC_RELEASE);
+}
+
+// Whether the rendered message would be empty / equal to s, without rendering merge nodes.
+// The right operand is followed in a loop and only the left one recurses: choice failures merge
+// a leaf on the left onto the rest, so the recursion is shallow, not a guarantee for any tree.
+static int lsbottom_msg_empty(const lsthunk_t* t) {
+  while (lsbottom_is_merge(t)) {
+    if (!lsbottom_msg_empty(t->lt_bottom.lt_sub[0]))
+      return 0;
+    t = t->lt_bottom.lt_sub[1];
+  }
+  return t->lt_bottom.lt_msg != NULL && t->lt_bottom.lt_msg[0] == '\0';
+}
+
+static int lsbottom_msg_equals(lsthunk_t* t, const char* s) {
+  while (lsbottom_is_merge(t) && __atomic_load_n(&t->lt_bottom.lt_msg, __ATOMIC_ACQUIRE) == NULL) {
+    if (lsbottom_msg_empty(t->lt_bottom.lt_sub[0]))
+      t = t->lt_bottom.lt_sub[1];
+    else if (lsbottom_msg_empty(t->lt_bottom.lt_sub[1]))
+      t = t->lt_bottom.lt_sub[0];
+    else
+      return 0; // both sides contribute, so the message contains "; " and s is a single message
+  }
+  return strcmp(lsbottom_render(t), s) == 0;
+}
+
 int lsthunk_is_bottom(const lsthunk_t* thunk) { return thunk && thunk->lt_type == LSTTYPE_BOTTOM; }
 const char* lsthunk_bottom_get_message(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BOTTOM) ? thunk->lt_bottom.lt_msg : NULL;
+  // Rendering only fills caches on the node; the bottom itself does not change
+  return (thunk && thunk->lt_type == LSTTYPE_BOTTOM) ? lsbottom_render((lsthunk_t*)thunk) : NULL;
 }
 lsloc_t lsthunk_bottom_get_loc(const lsthunk_t* thunk) {
   return (thunk && thunk->lt_type == LSTTYPE_BOTTOM) ? thunk->lt_bottom.lt_loc
                                                      : lstrace_take_pending_or_unknown();
 }
 lssize_t lsthunk_bottom_get_argc(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BOTTOM) ? thunk->lt_bottom.lt_rel.lbr_argc : 0;
+  if (!thunk || thunk->lt_type != LSTTYPE_BOTTOM)
+    return 0;
+  lsbottom_flatten((lsthunk_t*)thunk);
+  return __atomic_load_n(&thunk->lt_bottom.lt_rel.lbr_argc, __ATOMIC_ACQUIRE);
 }
 lsthunk_t* const* lsthunk_bottom_get_args(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BOTTOM)
-             ? (lsthunk_t* const*)thunk->lt_bottom.lt_rel.lbr_args
-             : NULL;
+  if (!thunk || thunk->lt_type != LSTTYPE_BOTTOM)
+    return NULL;
+  lsbottom_flatten((lsthunk_t*)thunk);
+  return (lsthunk_t* const*)__atomic_load_n(&thunk->lt_bottom.lt_rel.lbr_args, __ATOMIC_ACQUIRE);
 }
 
 static lsloc_t earlier_loc(lsloc_t a, lsloc_t b) {
@@ -173,47 +654,26 @@ lsthunk_t* lsthunk_bottom_merge(lsthunk_t* a, lsthunk_t* b) {
     return a;
   if (!lsthunk_is_bottom(b))
     return b;
-  // Merge messages with "; "
-  const char* ma  = lsthunk_bottom_get_message(a);
-  const char* mb  = lsthunk_bottom_get_message(b);
-  size_t      na  = ma ? strlen(ma) : 0;
-  size_t      nb  = mb ? strlen(mb) : 0;
-  char*       m   = lsmalloc(na + (na && nb ? 2 : 0) + nb + 1);
-  size_t      off = 0;
-  if (na) {
-    memcpy(m + off, ma, na);
-    off += na;
-  }
-  if (na && nb) {
-    m[off++] = ';';
-    m[off++] = ' ';
-  }
-  if (nb) {
-    memcpy(m + off, mb, nb);
-    off += nb;
-  }
-  m[off] = '\0';
-  // Concatenate args
-  lssize_t    ca = lsthunk_bottom_get_argc(a), cb = lsthunk_bottom_get_argc(b);
-  lssize_t    cn = ca + cb;
-  lsthunk_t** xs = cn ? lsmalloc(sizeof(lsthunk_t*) * cn) : NULL;
-  for (lssize_t i = 0; i < ca; i++)
-    xs[i] = a->lt_bottom.lt_rel.lbr_args[i];
-  for (lssize_t i = 0; i < cb; i++)
-    xs[ca + i] = b->lt_bottom.lt_rel.lbr_args[i];
-  lsloc_t loc = earlier_loc(a->lt_bottom.lt_loc, b->lt_bottom.lt_loc);
-  return lsthunk_new_bottom(m, loc, cn, xs);
+  // O(1): message ("; "-joined) and related args (concatenated) are produced on demand
+  lsthunk_t* t = lsthunk_alloc_bottom_node(earlier_loc(a->lt_bottom.lt_loc, b->lt_bottom.lt_loc));
+  t->lt_bottom.lt_msg          = NULL;
+  t->lt_bottom.lt_rel.lbr_argc = LSBOTREL_PENDING;
+  t->lt_bottom.lt_rel.lbr_args = NULL;
+  t->lt_bottom.lt_sub[0]       = a;
+  t->lt_bottom.lt_sub[1]       = b;
+  return t;
 }
 
 // --- Internal-friendly constructors for two-phase wiring ---
 lsthunk_t* lsthunk_alloc_alge(const lsstr_t* constr, lssize_t argc) {
   lsthunk_t* thunk =
       lsmalloc(lssizeof(lsthunk_t, lt_alge) + (argc > 0 ? (size_t)argc : 0) * sizeof(lsthunk_t*));
-  thunk->lt_type     = LSTTYPE_ALGE;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
+  thunk->lt_type  = LSTTYPE_ALGE;
+  thunk->lt_flags = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
   thunk->lt_alge.lta_constr = constr;
+  thunk->lt_alge.lta_tag    = lsstr_get_tag(constr);
   thunk->lt_alge.lta_argc   = argc;
   // Leave args uninitialized for the caller to fill via setter
   return thunk;
@@ -228,13 +688,8 @@ void lsthunk_set_alge_arg(lsthunk_t* thunk, lssize_t idx, lsthunk_t* arg) {
 }
 
 lsthunk_t* lsthunk_alloc_bottom(const char* message, lsloc_t loc, lssize_t argc) {
-  lsthunk_t* t   = lsmalloc(sizeof(lsthunk_t));
-  t->lt_type     = LSTTYPE_BOTTOM;
-  t->lt_whnf     = t; // bottom is WHNF
-  t->lt_trace_id = g_trace_next_id++;
-  lstrace_emit_loc(loc.filename ? loc : lstrace_take_pending_or_unknown());
+  lsthunk_t* t                 = lsthunk_alloc_bottom_node(loc);
   t->lt_bottom.lt_msg          = message ? message : "";
-  t->lt_bottom.lt_loc          = loc;
   t->lt_bottom.lt_rel.lbr_argc = argc;
   if (argc > 0) {
     t->lt_bottom.lt_rel.lbr_args = lsmalloc(sizeof(lsthunk_t*) * (size_t)argc);
@@ -259,12 +714,13 @@ void lsthunk_set_bottom_related(lsthunk_t* thunk, lssize_t idx, lsthunk_t* arg)
 lsthunk_t* lsthunk_alloc_appl(lssize_t argc) {
   if (argc < 0)
     return NULL;
-  lsthunk_t* t   = lsmalloc(lssizeof(lsthunk_t, lt_appl) + (size_t)argc * sizeof(lsthunk_t*));
-  t->lt_type     = LSTTYPE_APPL;
-  t->lt_whnf     = NULL;
-  t->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* t = lsmalloc(lssizeof(lsthunk_t, lt_appl) + (size_t)argc * sizeof(lsthunk_t*));
+  t->lt_type   = LSTTYPE_APPL;
+  t->lt_flags  = 0;
+  lsthunk_trace_assign(t);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
   t->lt_appl.lta_func = NULL;
+  t->lt_appl.lta_whnf = NULL;
   t->lt_appl.lta_argc = argc;
   for (lssize_t i = 0; i < argc; i++)
     t->lt_appl.lta_args[i] = NULL;
@@ -294,14 +750,16 @@ lsthunk_t* lsthunk_get_appl_func(const lsthunk_t* thunk) {
 // --- CHOICE helpers -------------------------------------------------------
 
 lsthunk_t* lsthunk_alloc_choice(int kind) {
-  lsthunk_t* t   = lsmalloc(lssizeof(lsthunk_t, lt_choice));
-  t->lt_type     = LSTTYPE_CHOICE;
-  t->lt_whnf     = NULL;
-  t->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* t = lsmalloc(lssizeof(lsthunk_t, lt_choice));
+  t->lt_type   = LSTTYPE_CHOICE;
+  t->lt_flags  = 0;
+  lsthunk_trace_assign(t);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  t->lt_choice.ltc_left  = NULL;
-  t->lt_choice.ltc_right = NULL;
-  t->lt_choice.ltc_kind  = kind;
+  t->lt_choice.ltc_left     = NULL;
+  t->lt_choice.ltc_right    = NULL;
+  t->lt_choice.ltc_kind     = kind;
+  t->lt_choice.ltc_dispatch = LSTCHOICE_NODISPATCH; // arms are set by the loader
+  t->lt_choice.ltc_whnf     = NULL;
   return t;
 }
 
@@ -346,13 +804,15 @@ const lsstr_t* lsthunk_get_ref_name(const lsthunk_t* thunk) {
 // --- LAMBDA helpers (two-phase wiring) -----------------------------------
 
 lsthunk_t* lsthunk_alloc_lambda(lstpat_t* param) {
-  lsthunk_t* t   = lsmalloc(sizeof(lsthunk_t));
-  t->lt_type     = LSTTYPE_LAMBDA;
-  t->lt_whnf     = t;
-  t->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* t = lsmalloc(lssizeof(lsthunk_t, lt_lambda));
+  t->lt_type   = LSTTYPE_LAMBDA;
+  t->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(t);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  t->lt_lambda.ltl_param = param;
-  t->lt_lambda.ltl_body  = NULL;
+  t->lt_lambda.ltl_param  = param;
+  t->lt_lambda.ltl_body   = NULL;
+  t->lt_lambda.ltl_nary   = NULL;
+  t->lt_lambda.ltl_strict = NULL;
   return t;
 }
 
@@ -365,16 +825,17 @@ void lsthunk_set_lambda_body(lsthunk_t* thunk, lsthunk_t* body) {
 lsthunk_t* lsthunk_new_ealge(const lsealge_t* ealge, lstenv_t* tenv) {
   lssize_t               eargc = lsealge_get_argc(ealge);
   const lsexpr_t* const* eargs = lsealge_get_args(ealge);
-  lsthunk_t* thunk   = lsmalloc(lssizeof(lsthunk_t, lt_alge) + eargc * sizeof(lsthunk_t*));
-  thunk->lt_type     = LSTTYPE_ALGE;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_alge) + eargc * sizeof(lsthunk_t*));
+  thunk->lt_type   = LSTTYPE_ALGE;
+  thunk->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
   thunk->lt_alge.lta_constr = lsealge_get_constr(ealge);
+  thunk->lt_alge.lta_tag    = lsstr_get_tag(thunk->lt_alge.lta_constr);
   thunk->lt_alge.lta_argc   = eargc;
   for (lssize_t i = 0; i < eargc; i++)
     thunk->lt_alge.lta_args[i] = lsthunk_new_expr(eargs[i], tenv);
-  return thunk;
+  return lsthunk_hashcons(thunk);
 }
 
 lsthunk_t* lsthunk_new_eappl(const lseappl_t* eappl, lstenv_t* tenv) {
@@ -389,29 +850,141 @@ lsthunk_t* lsthunk_new_eappl(const lseappl_t* eappl, lstenv_t* tenv) {
     if (args_buf[i] == NULL)
       return NULL;
   }
-  lsthunk_t* thunk   = lsmalloc(lssizeof(lsthunk_t, lt_appl) + eargc * sizeof(lsthunk_t*));
-  thunk->lt_type     = LSTTYPE_APPL;
-  thunk->lt_whnf     = NULL;
-  thunk->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_appl) + eargc * sizeof(lsthunk_t*));
+  thunk->lt_type   = LSTTYPE_APPL;
+  thunk->lt_flags  = 0;
+  lsthunk_trace_assign(thunk);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
   thunk->lt_appl.lta_func = func;
+  thunk->lt_appl.lta_whnf = NULL;
   thunk->lt_appl.lta_argc = eargc;
   for (lssize_t i = 0; i < eargc; i++)
     thunk->lt_appl.lta_args[i] = args_buf[i];
   return thunk;
 }
 
+static lstarm_head_t lstchoice_arm_classify(const lstpat_t* param, lstchoice_arm_t* arm) {
+  switch (lstpat_get_type(param)) {
+  case LSPTYPE_ALGE:
+    arm->lca_tag  = lstpat_get_constr_tag(param);
+    arm->lca_argc = lstpat_get_argc(param);
+    return LSTARM_ALGE;
+  case LSPTYPE_INT:
+    arm->lca_int = lstpat_get_int(param);
+    return LSTARM_INT;
+  case LSPTYPE_STR:
+    arm->lca_str = lstpat_get_str(param);
+    return LSTARM_STR;
+  default:
+    return LSTARM_ANY;
+  }
+}
+
+/**
+ * Build the dispatch table of a lambda-choice chain
+ * @param thunk The outermost choice thunk (its arms must already be constructed)
+ * @return The dispatch table, or NULL when no arm can be skipped by its head
+ */
+static const lstchoice_dispatch_t* lstchoice_dispatch_new(lsthunk_t* thunk) {
+  if (thunk->lt_choice.ltc_kind != 1 /* LSECHOICE_LAMBDA */)
+    return NULL;
+  lssize_t   armc = 1;
+  lsthunk_t* node = thunk;
+  while (node->lt_type == LSTTYPE_CHOICE) {
+    if (node->lt_choice.ltc_kind != 1 || node->lt_choice.ltc_left == NULL ||
+        node->lt_choice.ltc_left->lt_type != LSTTYPE_LAMBDA || node->lt_choice.ltc_right == NULL)
+      return NULL;
+    armc++;
+    node = node->lt_choice.ltc_right;
+  }
+  if (node->lt_type != LSTTYPE_LAMBDA)
+    return NULL;
+  lstchoice_dispatch_t* d =
+      lsmalloc(sizeof(lstchoice_dispatch_t) + sizeof(lstchoice_arm_t) * (size_t)armc);
+  d->lcd_armc = armc;
+  node        = thunk;
+  int keyed   = 0;
+  int tagmin = INT_MAX, tagmax = 0;
+  for (lssize_t i = 0; i < armc; i++) {
+    lstchoice_arm_t* arm = &d->lcd_arms[i];
+    memset(arm, 0, sizeof(*arm));
+    arm->lca_thunk = i + 1 < armc ? node->lt_choice.ltc_left : node;
+    arm->lca_head  = lstchoice_arm_classify(arm->lca_thunk->lt_lambda.ltl_param, arm);
+    keyed |= arm->lca_head != LSTARM_ANY;
+    if (arm->lca_head == LSTARM_ALGE) {
+      tagmin = arm->lca_tag < tagmin ? arm->lca_tag : tagmin;
+      tagmax = arm->lca_tag > tagmax ? arm->lca_tag : tagmax;
+    }
+    if (i + 1 < armc)
+      node = node->lt_choice.ltc_right;
+  }
+  if (!keyed)
+    return NULL;
+  // Link the arms of each tag back to front, so every tag finds its first arm in one lookup
+  d->lcd_tagmin = tagmax > 0 ? tagmin : 0;
+  d->lcd_tagc   = tagmax > 0 ? tagmax - tagmin + 1 : 0;
+  d->lcd_bytag  = lsmalloc_atomic(sizeof(lssize_t) * (size_t)(d->lcd_tagc + 1));
+  for (int t = 0; t < d->lcd_tagc; t++)
+    d->lcd_bytag[t] = armc;
+  lssize_t other = armc;
+  for (lssize_t i = armc; i-- > 0;) {
+    lstchoice_arm_t* arm = &d->lcd_arms[i];
+    if (arm->lca_head == LSTARM_ALGE) {
+      arm->lca_next                              = d->lcd_bytag[arm->lca_tag - d->lcd_tagmin];
+      d->lcd_bytag[arm->lca_tag - d->lcd_tagmin] = i;
+    } else {
+      other = i;
+    }
+    arm->lca_other = other;
+  }
+  return d;
+}
+
+/**
+ * Get the dispatch table of a lambda-choice, building it on first use
+ * Only the outermost choice of a chain is ever applied as a whole, so the nested choices
+ * never pay for a table of their own.
+ * @return The dispatch table, or NULL when the choice is applied stepwise
+ */
+static const lstchoice_dispatch_t* lstchoice_dispatch_get(lsthunk_t* thunk) {
+  const lstchoice_dispatch_t* d = __atomic_load_n(&thunk->lt_choice.ltc_dispatch, __ATOMIC_ACQUIRE);
+  if (d == NULL) {
+    // Threads racing here build equal tables; any of them may be kept
+    d = lstchoice_dispatch_new(thunk);
+    if (d == NULL)
+      d = LSTCHOICE_NODISPATCH;
+    __atomic_store_n(&thunk->lt_choice.ltc_dispatch, d, __ATOMIC_RELEASE);
+  }
+  return d == LSTCHOICE_NODISPATCH ? NULL : d;
+}
+
+/**
+ * Find the first arm at or after an index that a constructor can reach
+ * @param tag Constructor tag of the argument, or 0 when it is not a constructor
+ * @return Index of the arm, or d->lcd_armc when none is left
+ */
+static lssize_t lstchoice_dispatch_seek(const lstchoice_dispatch_t* d, int tag, lssize_t i) {
+  lssize_t j = d->lcd_armc;
+  if (tag >= d->lcd_tagmin && tag - d->lcd_tagmin < d->lcd_tagc)
+    for (j = d->lcd_bytag[tag - d->lcd_tagmin]; j < i;)
+      j = d->lcd_arms[j].lca_next;
+  lssize_t other = i < d->lcd_armc ? d->lcd_arms[i].lca_other : d->lcd_armc;
+  return j < other ? j : other;
+}
+
 lsthunk_t* lsthunk_new_echoice(const lsechoice_t* echoice, lstenv_t* tenv) {
   // Allocate enough space to include the 'choice' union member
-  lsthunk_t* thunk   = lsmalloc(lssizeof(lsthunk_t, lt_choice));
-  thunk->lt_type     = LSTTYPE_CHOICE;
-  thunk->lt_whnf     = NULL;
-  thunk->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_choice));
+  thunk->lt_type   = LSTTYPE_CHOICE;
+  thunk->lt_flags  = 0;
+  lsthunk_trace_assign(thunk);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
   thunk->lt_choice.ltc_left  = lsthunk_new_expr(lsechoice_get_left(echoice), tenv);
   thunk->lt_choice.ltc_right = lsthunk_new_expr(lsechoice_get_right(echoice), tenv);
   // Persist kind from AST to runtime
-  thunk->lt_choice.ltc_kind = (int)lsechoice_get_kind(echoice);
+  thunk->lt_choice.ltc_kind     = (int)lsechoice_get_kind(echoice);
+  thunk->lt_choice.ltc_dispatch = NULL;
+  thunk->lt_choice.ltc_whnf     = NULL;
   return thunk;
 }
 
@@ -427,6 +1000,7 @@ lsthunk_t* lsthunk_new_eclosure(const lseclosure_t* eclosure, lstenv_t* tenv) {
     origins[i]->lrto_bind.ltb_lhs = lstpat_new_pat(lhs, tenv, origins[i]);
     if (origins[i]->lrto_bind.ltb_lhs == NULL)
       return NULL;
+    lstpat_share_binds(origins[i]->lrto_bind.ltb_lhs);
   }
   for (lssize_t i = 0; i < ebindc; i++) {
     const lsexpr_t* rhs           = lsbind_get_rhs(ebinds[i]);
@@ -441,11 +1015,12 @@ lsthunk_t* lsthunk_new_ref(const lsref_t* ref, lstenv_t* tenv) {
   lstref_target_t* target  = lstenv_get(tenv, lsref_get_name(ref));
   lsthunk_t*       thunk   = lsmalloc(lssizeof(lsthunk_t, lt_ref));
   thunk->lt_type           = LSTTYPE_REF;
-  thunk->lt_whnf           = NULL;
-  thunk->lt_trace_id       = g_trace_next_id++;
+  thunk->lt_flags          = 0;
+  lsthunk_trace_assign(thunk);
   thunk->lt_ref.ltr_ref    = ref;
   thunk->lt_ref.ltr_target = target; // may be NULL; resolve lazily at eval
   thunk->lt_ref.ltr_env    = tenv;
+  thunk->lt_ref.ltr_whnf   = NULL;
   // Prefer pending loc; fallback to ref's own loc
   {
     lsloc_t loc = lstrace_take_pending_or_unknown();
@@ -458,33 +1033,55 @@ lsthunk_t* lsthunk_new_ref(const lsref_t* ref, lstenv_t* tenv) {
 }
 
 lsthunk_t* lsthunk_new_int(const lsint_t* intval) {
-  lsthunk_t* thunk   = lsmalloc(sizeof(lsthunk_t));
-  thunk->lt_type     = LSTTYPE_INT;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
-  thunk->lt_int      = intval;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_int));
+  thunk->lt_type   = LSTTYPE_INT;
+  thunk->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
+  thunk->lt_int = intval;
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  return thunk;
+  return lsthunk_hashcons(thunk);
 }
 
 lsthunk_t* lsthunk_new_str(const lsstr_t* strval) {
-  lsthunk_t* thunk   = lsmalloc(sizeof(lsthunk_t));
-  thunk->lt_type     = LSTTYPE_STR;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
-  thunk->lt_str      = strval;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_str));
+  thunk->lt_type   = LSTTYPE_STR;
+  thunk->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
+  thunk->lt_str = strval;
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  return thunk;
+  return lsthunk_hashcons(thunk);
 }
 
 lsthunk_t* lsthunk_new_symbol(const lsstr_t* sym) {
-  lsthunk_t* thunk   = lsmalloc(sizeof(lsthunk_t));
-  thunk->lt_type     = LSTTYPE_SYMBOL;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
-  thunk->lt_symbol   = sym;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_symbol));
+  thunk->lt_type   = LSTTYPE_SYMBOL;
+  thunk->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
+  thunk->lt_symbol = sym;
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  return thunk;
+  return lsthunk_hashcons(thunk);
+}
+
+/**
+ * Build the uncurried view of a lambda whose body is directly another lambda
+ * @param lam The outermost lambda (with its body already set)
+ * @return The view, or NULL when the lambda takes a single parameter
+ */
+static const lstlambda_nary_t* lsthunk_lambda_nary_new(const lsthunk_t* lam) {
+  lssize_t         arity = 1;
+  const lsthunk_t* body  = lam->lt_lambda.ltl_body;
+  for (; body && body->lt_type == LSTTYPE_LAMBDA; body = body->lt_lambda.ltl_body)
+    arity++;
+  if (arity < 2 || body == NULL)
+    return NULL;
+  lstlambda_nary_t* nary =
+      lsmalloc(lssizeof(lstlambda_nary_t, lln_params) + arity * sizeof(lstpat_t*));
+  nary->lln_arity        = arity;
+  nary->lln_body         = (lsthunk_t*)body;
+  body                   = lam;
+  for (lssize_t i = 0; i < arity; i++, body = body->lt_lambda.ltl_body)
+    nary->lln_params[i] = body->lt_lambda.ltl_param;
+  return nary;
 }
 
 lsthunk_t* lsthunk_new_elambda(const lselambda_t* elambda, lstenv_t* tenv) {
@@ -496,16 +1093,20 @@ lsthunk_t* lsthunk_new_elambda(const lselambda_t* elambda, lstenv_t* tenv) {
   origin->lrto_lambda.ltl_param  = lstpat_new_pat(pparam, tenv, origin);
   if (origin->lrto_lambda.ltl_param == NULL)
     return NULL;
-  origin->lrto_lambda.ltl_body = lsthunk_new_expr(ebody, tenv);
+  origin->lrto_lambda.ltl_nary   = NULL;
+  origin->lrto_lambda.ltl_strict = NULL;
+  origin->lrto_lambda.ltl_body   = lsthunk_new_expr(ebody, tenv);
   if (origin->lrto_lambda.ltl_body == NULL)
     return NULL;
-  lsthunk_t* thunk   = lsmalloc(sizeof(lsthunk_t));
-  thunk->lt_type     = LSTTYPE_LAMBDA;
-  thunk->lt_whnf     = thunk;
-  thunk->lt_trace_id = g_trace_next_id++;
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_lambda));
+  thunk->lt_type   = LSTTYPE_LAMBDA;
+  thunk->lt_flags  = LSTHDR_WHNF;
+  lsthunk_trace_assign(thunk);
   lstrace_emit_loc(lstrace_take_pending_or_unknown());
-  thunk->lt_lambda.ltl_param = origin->lrto_lambda.ltl_param;
-  thunk->lt_lambda.ltl_body  = origin->lrto_lambda.ltl_body;
+  thunk->lt_lambda.ltl_param  = origin->lrto_lambda.ltl_param;
+  thunk->lt_lambda.ltl_body   = origin->lrto_lambda.ltl_body;
+  thunk->lt_lambda.ltl_nary   = lsthunk_lambda_nary_new(thunk);
+  thunk->lt_lambda.ltl_strict = NULL;
   return thunk;
 }
 
@@ -568,15 +1169,8 @@ lsthunk_t* lsthunk_new_expr(const lsexpr_t* expr, lstenv_t* tenv) {
     aval = lsthunk_eval0(aval);
     if (lsthunk_is_bottom(aval))
       return aval;
-    // Build message via deep print: "raise: <aval>"
-    char*  buf = NULL;
-    size_t bl  = 0;
-    FILE*  fp  = lsopen_memstream_gc(&buf, &bl);
-    lsprintf(fp, 0, "raise: ");
-    lsthunk_deep_print(fp, LSPREC_LOWEST, 0, aval);
-    fclose(fp);
-    lsthunk_t* rel[1] = { aval };
-    return lsthunk_new_bottom(buf ? buf : "raise", lstrace_take_pending_or_unknown(), 1, rel);
+    // Message "raise: <aval>" is deep-printed only when the bottom is shown
+    return lsthunk_new_raise_bottom(aval, lstrace_take_pending_or_unknown());
   }
   }
   assert(0);
@@ -592,6 +1186,11 @@ const lsstr_t* lsthunk_get_constr(const lsthunk_t* thunk) {
   return thunk->lt_alge.lta_constr;
 }
 
+int lsthunk_get_constr_tag(const lsthunk_t* thunk) {
+  assert(thunk->lt_type == LSTTYPE_ALGE);
+  return thunk->lt_alge.lta_tag;
+}
+
 // removed: lsthunk_get_func (unused)
 
 lssize_t lsthunk_get_argc(const lsthunk_t* thunk) {
@@ -641,9 +1240,7 @@ lsmres_t lsthunk_match_alge(lsthunk_t* thunk, lstpat_t* tpat) {
   lsttype_t  ttype      = lsthunk_get_type(thunk_whnf);
   if (ttype != LSTTYPE_ALGE)
     return LSMATCH_FAILURE; // TODO: match as list or string
-  const lsstr_t* tconstr = lsthunk_get_constr(thunk_whnf);
-  const lsstr_t* pconstr = lstpat_get_constr(tpat);
-  if (lsstrcmp(pconstr, tconstr) != 0)
+  if (lstpat_get_constr_tag(tpat) != thunk_whnf->lt_alge.lta_tag)
     return LSMATCH_FAILURE;
   lssize_t pargc = lstpat_get_argc(tpat);
   lssize_t targc = lsthunk_get_argc(thunk_whnf);
@@ -775,17 +1372,17 @@ static lsthunk_t* lsthunk_eval_alge(lsthunk_t* thunk, lssize_t argc, lsthunk_t*
   // Allocate enough space for existing args + new args
   lsthunk_t* thunk_new =
       lsmalloc(lssizeof(lsthunk_t, lt_alge) + (targc + argc) * sizeof(lsthunk_t*));
-  thunk_new->lt_type = LSTTYPE_ALGE;
-  // This node is already in WHNF; point to self, not the old thunk
-  thunk_new->lt_whnf            = thunk_new;
-  thunk_new->lt_trace_id        = thunk->lt_trace_id;
+  thunk_new->lt_type  = LSTTYPE_ALGE;
+  thunk_new->lt_flags = LSTHDR_WHNF;
+  lsthunk_trace_copy(thunk_new, thunk);
   thunk_new->lt_alge.lta_constr = thunk->lt_alge.lta_constr;
+  thunk_new->lt_alge.lta_tag    = thunk->lt_alge.lta_tag;
   thunk_new->lt_alge.lta_argc   = targc + argc;
   for (lssize_t i = 0; i < targc; i++)
     thunk_new->lt_alge.lta_args[i] = thunk->lt_alge.lta_args[i];
   for (lssize_t i = 0; i < argc; i++)
     thunk_new->lt_alge.lta_args[targc + i] = args[i];
-  return thunk_new;
+  return lsthunk_hashcons(thunk_new);
 }
 
 static lsthunk_t* lsthunk_eval_appl(lsthunk_t* thunk, lssize_t argc, lsthunk_t* const* args) {
@@ -794,6 +1391,10 @@ static lsthunk_t* lsthunk_eval_appl(lsthunk_t* thunk, lssize_t argc, lsthunk_t*
   assert(thunk->lt_type == LSTTYPE_APPL);
   if (argc == 0)
     return lsthunk_eval0(thunk);
+  // A head whose value is already known (e.g. ~~add evaluated by an earlier use) is applied
+  // directly rather than re-evaluated with the extra arguments
+  if (thunk->lt_appl.lta_whnf != NULL)
+    return lsthunk_eval(thunk->lt_appl.lta_whnf, argc, args);
   lsthunk_t*        func1 = thunk->lt_appl.lta_func;
   lssize_t          argc1 = thunk->lt_appl.lta_argc + argc;
   lsthunk_t* const* args1 = (lsthunk_t* const*)lsa_concata(
@@ -802,7 +1403,289 @@ static lsthunk_t* lsthunk_eval_appl(lsthunk_t* thunk, lssize_t argc, lsthunk_t*
   return lsthunk_eval(func1, argc1, args1);
 }
 
-static lsthunk_t* lsthunk_eval_lambda(lsthunk_t* thunk, lssize_t argc, lsthunk_t* const* args) {
+// Returned by lsthunk_eval_lambda_guard when the parameter does not match the first argument.
+// Never escapes the evaluator: callers either handle it or turn it into a bottom.
+static lsthunk_t g_match_failure;
+#define LSTHUNK_NOMATCH (&g_match_failure)
+
+static lsthunk_t* lsthunk_new_match_failure(lsthunk_t* arg) {
+  // Carry arg as related context
+  lsthunk_t* rels[1] = { arg };
+  return lsthunk_new_bottom("lambda match failure", lstrace_take_pending_or_unknown(), 1, rels);
+}
+
+static lsthunk_t* lsthunk_subst_params(lsthunk_t* thunk, lstpat_t* const* params,
+                                       lssize_t nparams);
+
+// --- Strictness analysis ---------------------------------------------------
+
+// Longest lambda chain whose arguments are evaluated eagerly (bounds the on-stack copy)
+#define LSTSTRICT_MAX_PARAMS 8
+// Deepest chain of callee summaries computed from inside one another
+#define LSTSTRICT_MAX_DEPTH 16
+
+static const lstlambda_strict_t g_lstrict_none = { 0 };
+
+// Lambdas whose summary is being computed; a callee found here is recursive and is treated as
+// forcing nothing, which keeps the summaries sound without a fixpoint.
+static __thread const lsthunk_t* g_lstrict_active[LSTSTRICT_MAX_DEPTH];
+static __thread int              g_lstrict_depth = 0;
+
+typedef struct lststrict_scan {
+  lstpat_t* const* lss_params;
+  lssize_t         lss_nparams;
+  lssize_t         lss_count;
+  lssize_t         lss_order[LSTSTRICT_MAX_PARAMS];
+} lststrict_scan_t;
+
+static const lstlambda_strict_t* lsthunk_lambda_strict(lsthunk_t* lam);
+
+static lstref_target_t* lsthunk_ref_target(const lsthunk_t* ref) {
+  lstref_target_t* target = ref->lt_ref.ltr_target;
+  return target ? target : lstenv_get(ref->lt_ref.ltr_env, lsref_get_name(ref->lt_ref.ltr_ref));
+}
+
+// Index of the parameter a reference names, or -1
+static int lststrict_param(const lststrict_scan_t* s, const lsthunk_t* t) {
+  if (t->lt_type != LSTTYPE_REF)
+    return -1;
+  lstref_target_t* target = lsthunk_ref_target(t);
+  if (target == NULL || target->lrt_origin->lrto_type != LSTRTYPE_LAMBDA)
+    return -1;
+  for (int i = 0; i < (int)s->lss_nparams; i++)
+    if (s->lss_params[i] == target->lrt_pat)
+      return i;
+  return -1;
+}
+
+// A callee known to the analysis: a lambda, or the arity and attributes of a builtin
+typedef struct lststrict_callee {
+  lsthunk_t*       lsc_lambda; // NULL for a builtin
+  lssize_t         lsc_arity;
+  lsbuiltin_attr_t lsc_attr;
+} lststrict_callee_t;
+
+// The callee when the value v is a lambda or builtin
+static int lststrict_value(lststrict_callee_t* c, lsthunk_t* v) {
+  if (v == NULL || (v->lt_type != LSTTYPE_LAMBDA && v->lt_type != LSTTYPE_BUILTIN))
+    return 0;
+  c->lsc_lambda = v->lt_type == LSTTYPE_LAMBDA ? v : NULL;
+  if (c->lsc_lambda == NULL) {
+    c->lsc_arity = v->lt_builtin.ltb_def->lti_arity;
+    c->lsc_attr  = v->lt_builtin.ltb_def->lti_attr;
+  }
+  return 1;
+}
+
+/**
+ * Resolve the head of an application to the function it calls, without evaluating anything
+ * Heads are lambdas, references to bindings of lambdas, and references to environment
+ * builtins: directly, through the memoized result of a zero-arity getter made by import, or as
+ * a dispatcher applied to a name (~~add is (~prelude add)), which its lookup resolves.
+ * @param head The head of the application
+ * @param c Set to the callee
+ * @return 1 when the callee is known, 0 otherwise
+ */
+static int lststrict_callee(lsthunk_t* head, lststrict_callee_t* c) {
+  if (head->lt_type == LSTTYPE_LAMBDA)
+    return lststrict_value(c, head);
+  lsthunk_t* f = head;
+  if (head->lt_type == LSTTYPE_APPL) {
+    if (head->lt_appl.lta_whnf != NULL)
+      return lststrict_value(c, head->lt_appl.lta_whnf);
+    for (lssize_t i = 0; i < head->lt_appl.lta_argc; i++)
+      if (!(head->lt_appl.lta_args[i]->lt_flags & LSTHDR_WHNF))
+        return 0;
+    f = head->lt_appl.lta_func;
+  }
+  if (f->lt_type != LSTTYPE_REF)
+    return 0;
+  lstref_target_t* target = lsthunk_ref_target(f);
+  if (target == NULL)
+    return 0;
+  lstref_target_origin_t* origin = target->lrt_origin;
+  if (origin->lrto_type == LSTRTYPE_BIND && f == head) {
+    lsthunk_t* rhs = lstpat_get_refbound(target->lrt_pat);
+    if (rhs == NULL && origin->lrto_bind.ltb_lhs == target->lrt_pat)
+      rhs = origin->lrto_bind.ltb_rhs;
+    return rhs != NULL && rhs->lt_type == LSTTYPE_LAMBDA && lststrict_value(c, rhs);
+  }
+  if (origin->lrto_type != LSTRTYPE_BUILTIN || lstpat_get_refbound(target->lrt_pat) != NULL)
+    return 0;
+  lsthunk_t*          b   = origin->lrto_builtin;
+  const lstbuiltin_t* def = b->lt_builtin.ltb_def;
+  if (f == head) // the builtin, or the value of a getter that has already been called
+    return lststrict_value(c, def->lti_arity > 0 ? b : b->lt_builtin.ltb_whnf);
+  if (def->lti_lookup == NULL || head->lt_appl.lta_argc != 1)
+    return 0;
+  const lsthunk_t* arg  = head->lt_appl.lta_args[0];
+  const lsstr_t*   name = NULL;
+  if (arg->lt_type == LSTTYPE_SYMBOL)
+    name = arg->lt_symbol;
+  else if (arg->lt_type == LSTTYPE_ALGE && arg->lt_alge.lta_argc == 0)
+    name = arg->lt_alge.lta_constr;
+  c->lsc_lambda = NULL;
+  return name != NULL && def->lti_lookup(name, &c->lsc_arity, &c->lsc_attr);
+}
+
+/**
+ * Record the parameters forced first when evaluating a thunk to WHNF
+ * @param s The scan state (parameters and the forcing order found so far)
+ * @param t The thunk
+ * @return 1 when evaluating t forces nothing beyond the recorded parameters and has no effect,
+ *         so whatever is evaluated after t is still forced first; 0 when the prefix ends here
+ */
+static int lststrict_scan(lststrict_scan_t* s, lsthunk_t* t) {
+  if (t->lt_flags & LSTHDR_WHNF)
+    return 1;
+  int i = lststrict_param(s, t);
+  if (i < 0 && t->lt_type == LSTTYPE_APPL)
+    i = lststrict_param(s, t->lt_appl.lta_func);
+  if (i >= 0) {
+    int seen = 0;
+    for (lssize_t j = 0; j < s->lss_count; j++)
+      seen |= s->lss_order[j] == (lssize_t)i;
+    if (!seen)
+      s->lss_order[s->lss_count++] = i;
+    return t->lt_type == LSTTYPE_REF;
+  }
+  if (t->lt_type != LSTTYPE_APPL)
+    return 0;
+  lssize_t          argc = t->lt_appl.lta_argc;
+  lsthunk_t* const* args = t->lt_appl.lta_args;
+  lststrict_callee_t c;
+  if (!lststrict_callee(t->lt_appl.lta_func, &c))
+    return 0;
+  if (c.lsc_lambda == NULL) {
+    // A strict builtin forces its arguments left to right, then computes without effects
+    if (!(c.lsc_attr & LSBATTR_STRICT) || c.lsc_arity != argc)
+      return 0;
+    for (lssize_t k = 0; k < argc; k++)
+      if (!lststrict_scan(s, args[k]))
+        return 0;
+    return !(c.lsc_attr & LSBATTR_EFFECT);
+  }
+  // A known lambda forces its own strict parameters, then does what its body does
+  const lstlambda_strict_t* callee = lsthunk_lambda_strict(c.lsc_lambda);
+  if (argc >= callee->lls_arity)
+    for (lssize_t k = 0; k < callee->lls_count; k++)
+      if (!lststrict_scan(s, args[callee->lls_order[k]]))
+        break;
+  return 0;
+}
+
+/**
+ * Compute which parameters a lambda (chain) is strict in
+ * Only chains whose parameters are all plain variables are analysed: a refutable pattern must
+ * get the chance to fail before any argument is evaluated on its behalf. Summaries are cached
+ * on the lambda; substituted copies inherit them, since substitution only replaces references
+ * the analysis already treats as unknown. Threads racing on the cache compute equal summaries.
+ * @param lam The lambda
+ * @return The summary (never NULL)
+ */
+static const lstlambda_strict_t* lsthunk_lambda_strict(lsthunk_t* lam) {
+  const lstlambda_strict_t* cached = __atomic_load_n(&lam->lt_lambda.ltl_strict, __ATOMIC_ACQUIRE);
+  if (cached != NULL)
+    return cached;
+  for (int i = 0; i < g_lstrict_depth; i++)
+    if (g_lstrict_active[i] == lam)
+      return &g_lstrict_none;
+  if (g_lstrict_depth == LSTSTRICT_MAX_DEPTH)
+    return &g_lstrict_none;
+  const lstlambda_nary_t* nary = lam->lt_lambda.ltl_nary;
+  lststrict_scan_t        s    = {
+    .lss_params  = nary ? nary->lln_params : &lam->lt_lambda.ltl_param,
+    .lss_nparams = nary ? nary->lln_arity : 1,
+    .lss_count   = 0,
+  };
+  const lstlambda_strict_t* strict = &g_lstrict_none;
+  int                       simple = s.lss_nparams <= LSTSTRICT_MAX_PARAMS;
+  for (lssize_t i = 0; simple && i < s.lss_nparams; i++)
+    simple = lstpat_get_type(s.lss_params[i]) == LSPTYPE_REF;
+  if (simple) {
+    g_lstrict_active[g_lstrict_depth++] = lam;
+    lststrict_scan(&s, nary ? nary->lln_body : lam->lt_lambda.ltl_body);
+    g_lstrict_depth--;
+  }
+  if (s.lss_count > 0) {
+    lstlambda_strict_t* r =
+        lsmalloc(lssizeof(lstlambda_strict_t, lls_order) + s.lss_count * sizeof(lssize_t));
+    r->lls_arity = s.lss_nparams;
+    r->lls_count = s.lss_count;
+    for (lssize_t i = 0; i < s.lss_count; i++)
+      r->lls_order[i] = s.lss_order[i];
+    strict = r;
+  }
+  __atomic_store_n(&lam->lt_lambda.ltl_strict, strict, __ATOMIC_RELEASE);
+  return strict;
+}
+
+/**
+ * Evaluate the arguments of a saturated application that the lambda forces first
+ * Evaluation follows the body's own order and stops at the first argument that fails, so
+ * the body still reports that failure and never sees a later argument evaluated early.
+ * @param lam The lambda
+ * @param args The arguments, one per parameter; updated in place with their WHNF
+ */
+static void lsthunk_force_strict(lsthunk_t* lam, lsthunk_t** args) {
+  const lstlambda_strict_t* strict = lsthunk_lambda_strict(lam);
+  for (lssize_t i = 0; i < strict->lls_count; i++) {
+    lssize_t   k = strict->lls_order[i];
+    lsthunk_t* v = lsthunk_eval0(args[k]);
+    if (v == NULL || lsthunk_is_bottom(v))
+      return;
+    args[k] = v;
+  }
+}
+
+/**
+ * Apply a chain of nested lambdas to at least as many arguments as it has parameters
+ * @param lam The outermost lambda of the chain (with an uncurried view)
+ * @param argc The number of arguments (>= its arity)
+ * @param args The arguments
+ * @return The result, or LSTHUNK_NOMATCH when the first parameter does not match args[0]
+ */
+static lsthunk_t* lsthunk_eval_lambda_nary(lsthunk_t* lam, lssize_t argc,
+                                           lsthunk_t* const* args) {
+  // eval (\p1 -> ... -> \pn -> body) x1 ... xn y ... = eval (body[p1 := x1, ..., pn := xn]) y ...
+  const lstlambda_nary_t* nary   = lam->lt_lambda.ltl_nary;
+  lssize_t                n      = nary->lln_arity;
+  lstpat_t* const*        params = nary->lln_params;
+  lsthunk_t* const*       xs     = args;
+  lsthunk_t*              forced[LSTSTRICT_MAX_PARAMS];
+  if (n <= LSTSTRICT_MAX_PARAMS) {
+    for (lssize_t i = 0; i < n; i++)
+      forced[i] = args[i];
+    lsthunk_force_strict(lam, forced);
+    xs = forced;
+  }
+  for (lssize_t i = 0; i < n; i++) {
+    if (lsthunk_match_pat(xs[i], params[i]) != LSMATCH_SUCCESS) {
+      for (lssize_t j = 0; j <= i; j++)
+        lstpat_clear_binds(params[j]);
+      // A later parameter failing is what the inner lambda would have reported
+      return i == 0 ? LSTHUNK_NOMATCH : lsthunk_new_match_failure(xs[i]);
+    }
+  }
+  // Evaluate an instance of the body (see lsthunk_eval_lambda_guard)
+  lsthunk_t* body = lsthunk_subst_params(nary->lln_body, params, n);
+  lsthunk_t* ret  = lsthunk_eval(body, argc - n, argc > n ? args + n : NULL);
+  if (ret != NULL)
+    ret = lsthunk_subst_params(ret, params, n);
+  for (lssize_t i = 0; i < n; i++)
+    lstpat_clear_binds(params[i]);
+  return ret;
+}
+
+/**
+ * Apply a lambda, reporting a mismatch of its parameter without allocating
+ * @param thunk The lambda
+ * @param argc The number of arguments (> 0)
+ * @param args The arguments
+ * @return The result, or LSTHUNK_NOMATCH when the parameter does not match args[0]
+ */
+static lsthunk_t* lsthunk_eval_lambda_guard(lsthunk_t* thunk, lssize_t argc,
+                                            lsthunk_t* const* args) {
   // eval (\param -> body) x y ... = eval (body[param := x]) y ...
   assert(thunk != NULL);
   assert(thunk->lt_type == LSTTYPE_LAMBDA);
@@ -811,11 +1694,18 @@ static lsthunk_t* lsthunk_eval_lambda(lsthunk_t* thunk, lssize_t argc, lsthunk_t
 #if LS_TRACE
   lsprintf(stderr, 0, "DBG lambda: apply argc=%ld\n", (long)argc);
 #endif
+  // Saturated application of a lambda chain: bind every parameter at once. Traced chains
+  // take the stepwise path so each inner lambda still gets its own trace frame.
+  const lstlambda_nary_t* nary = thunk->lt_lambda.ltl_nary;
+  if (nary && argc >= nary->lln_arity && !(thunk->lt_flags & LSTHDR_TRACED))
+    return lsthunk_eval_lambda_nary(thunk, argc, args);
   lstpat_t*         param = lsthunk_get_param(thunk);
   lsthunk_t*        body  = lsthunk_get_body(thunk);
   lsthunk_t*        arg;
   lsthunk_t* const* args1 =
       (lsthunk_t* const*)lsa_shift(argc, (const void* const*)args, (const void**)&arg);
+  if (arg && nary == NULL)
+    lsthunk_force_strict(thunk, &arg);
   if (arg) {
 #if LS_TRACE
     const char* at = "?";
@@ -851,21 +1741,21 @@ static lsthunk_t* lsthunk_eval_lambda(lsthunk_t* thunk, lssize_t argc, lsthunk_t
   // Bind directly on the lambda's original parameter pattern so that
   // references inside body (which point to the same pattern objects via env)
   // observe the binding.
-  body          = lsthunk_clone(body);
   lsmres_t mres = lsthunk_match_pat(arg, param);
   if (mres != LSMATCH_SUCCESS) {
 #if LS_TRACE
     lsprintf(stderr, 0, "DBG lambda: match failed\n");
 #endif
-    // Pattern mismatch -> bottom (no match), carry arg as related context
     // Clear bindings established during a failed match attempt to avoid leaking into siblings
     lstpat_clear_binds(param);
-    lsthunk_t* rels[1] = { arg };
-    return lsthunk_new_bottom("lambda match failure", lstrace_take_pending_or_unknown(), 1, rels);
+    return LSTHUNK_NOMATCH;
   }
 #if LS_TRACE
   lsprintf(stderr, 0, "DBG lambda: eval body\n");
 #endif
+  // Evaluate an instance of the body with the parameter substituted, so that suspensions
+  // memoized along the way are not shared with other applications of this lambda
+  body           = lsthunk_subst_param(body, param);
   lsthunk_t* ret = lsthunk_eval(body, argc - 1, args1);
   if (ret == NULL) {
 #if LS_TRACE
@@ -917,6 +1807,12 @@ static lsthunk_t* lsthunk_eval_lambda(lsthunk_t* thunk, lssize_t argc, lsthunk_t
   return ret;
 }
 
+static lsthunk_t* lsthunk_eval_lambda(lsthunk_t* thunk, lssize_t argc, lsthunk_t* const* args) {
+  lsthunk_t* ret = lsthunk_eval_lambda_guard(thunk, argc, args);
+  // Pattern mismatch -> bottom (no match)
+  return ret == LSTHUNK_NOMATCH ? lsthunk_new_match_failure(args[0]) : ret;
+}
+
 static lsthunk_t* lsthunk_eval_builtin(lsthunk_t* thunk, lssize_t argc, lsthunk_t* const* args) {
   assert(thunk != NULL);
   assert(thunk->lt_type == LSTTYPE_BUILTIN);
@@ -927,23 +1823,24 @@ static lsthunk_t* lsthunk_eval_builtin(lsthunk_t* thunk, lssize_t argc, lsthunk_
     lsstr_print_bare(stderr, LSPREC_LOWEST, 0, bname);
   else
     lsprintf(stderr, 0, "<anon>");
-  lsprintf(stderr, 0, " argc=%ld (arity=%ld)\n", (long)argc, (long)thunk->lt_builtin->lti_arity);
+  lsprintf(stderr, 0, " argc=%ld (arity=%ld)\n", (long)argc,
+           (long)thunk->lt_builtin.ltb_def->lti_arity);
 #endif
   if (argc == 0) {
     // For zero-arity builtins, invoke immediately to obtain the value.
-    if (thunk->lt_builtin->lti_arity == 0) {
-      lstbuiltin_func_t f0   = thunk->lt_builtin->lti_func;
-      void*             d0   = thunk->lt_builtin->lti_data;
+    if (thunk->lt_builtin.ltb_def->lti_arity == 0) {
+      lstbuiltin_func_t f0   = thunk->lt_builtin.ltb_def->lti_func;
+      void*             d0   = thunk->lt_builtin.ltb_def->lti_data;
       lsthunk_t*        ret0 = f0(0, NULL, d0);
       return ret0 ? lsthunk_eval0(ret0) : ls_make_err("builtin: null");
     }
     // Otherwise, it's a function waiting for more args.
     return thunk;
   }
-  lssize_t          arity = thunk->lt_builtin->lti_arity;
-  lstbuiltin_func_t func  = thunk->lt_builtin->lti_func;
-  void*             data  = thunk->lt_builtin->lti_data;
-  lsbuiltin_attr_t  attr  = thunk->lt_builtin->lti_attr;
+  lssize_t          arity = thunk->lt_builtin.ltb_def->lti_arity;
+  lstbuiltin_func_t func  = thunk->lt_builtin.ltb_def->lti_func;
+  void*             data  = thunk->lt_builtin.ltb_def->lti_data;
+  lsbuiltin_attr_t  attr  = thunk->lt_builtin.ltb_def->lti_attr;
   // Central attribute guards
   if ((attr & LSBATTR_EFFECT) && !ls_effects_allowed()) {
     lsprintf(stderr, 0, "E: builtin: effects not allowed\n");
@@ -955,8 +1852,9 @@ static lsthunk_t* lsthunk_eval_builtin(lsthunk_t* thunk, lssize_t argc, lsthunk_
   if (argc < arity) {
     lsthunk_t* ret        = lsmalloc(lssizeof(lsthunk_t, lt_appl) + argc * sizeof(lsthunk_t*));
     ret->lt_type          = LSTTYPE_APPL;
-    ret->lt_whnf          = ret;
+    ret->lt_flags         = LSTHDR_WHNF;
     ret->lt_appl.lta_func = thunk;
+    ret->lt_appl.lta_whnf = NULL;
     ret->lt_appl.lta_argc = argc;
     for (lssize_t i = 0; i < argc; i++)
       ret->lt_appl.lta_args[i] = args[i];
@@ -1049,8 +1947,102 @@ static lsthunk_t* lsthunk_eval_ref(lsthunk_t* thunk, lssize_t argc, lsthunk_t* c
 static int is_lambda_match_failure_err(lsthunk_t* err) {
   if (!lsthunk_is_bottom(err))
     return 0;
-  const char* m = lsthunk_bottom_get_message(err);
-  return m && strcmp(m, "lambda match failure") == 0;
+  return lsbottom_msg_equals(err, "lambda match failure");
+}
+
+/**
+ * Apply one arm of a lambda-choice
+ * Lambda arms report a first-parameter mismatch as LSTHUNK_NOMATCH without allocating; other
+ * arms (nested choices, loaded graphs) are evaluated normally and their failure bottom is
+ * mapped to LSTHUNK_NOMATCH.
+ */
+static lsthunk_t* lsthunk_eval_arm(lsthunk_t* arm, lssize_t argc, lsthunk_t* const* args) {
+  if (arm->lt_type != LSTTYPE_LAMBDA) {
+    lsthunk_t* r = lsthunk_eval(arm, argc, args);
+    return r != NULL && is_lambda_match_failure_err(r) ? LSTHUNK_NOMATCH : r;
+  }
+  int traced = (arm->lt_flags & LSTHDR_TRACED) != 0;
+  if (traced)
+    lstrace_push(lsthunk_trace_id(arm));
+  lsthunk_t* r = lsthunk_eval_lambda_guard(arm, argc, args);
+  if (traced)
+    lstrace_pop();
+  return r;
+}
+
+/**
+ * Check whether an arm's first parameter head can never match the argument
+ * @param arm The arm
+ * @param arg The argument as passed
+ * @param parg_whnf WHNF of the argument; forced on first need and cached across arms
+ * @return Non-zero when matching the arm would fail
+ */
+static int lstchoice_arm_rejects(const lstchoice_arm_t* arm, lsthunk_t* arg,
+                                 lsthunk_t** parg_whnf) {
+  switch (arm->lca_head) {
+  case LSTARM_ALGE: {
+    // Same forcing as lsthunk_match_alge would do, but only once for the whole chain
+    if (*parg_whnf == NULL)
+      *parg_whnf = lsthunk_eval0(arg);
+    lsthunk_t* v = *parg_whnf;
+    return v == NULL || v->lt_type != LSTTYPE_ALGE || v->lt_alge.lta_tag != arm->lca_tag ||
+           v->lt_alge.lta_argc != arm->lca_argc;
+  }
+  case LSTARM_INT:
+    // Mirrors lsthunk_match_int: the argument itself is inspected
+    return arg->lt_type != LSTTYPE_INT || !lsint_eq(arg->lt_int, arm->lca_int);
+  case LSTARM_STR:
+    return arg->lt_type != LSTTYPE_STR || lsstrcmp(arg->lt_str, arm->lca_str) != 0;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Apply a dispatchable lambda-choice chain
+ * Equivalent to the stepwise first-argument guard of lsthunk_eval_choice, except that arms
+ * whose head rejects the argument are skipped without being tried at all. A constructor
+ * argument finds the arms of its tag through the table instead of passing the others.
+ * @param d The dispatch table of the outermost choice
+ */
+static lsthunk_t* lsthunk_eval_choice_dispatch(const lstchoice_dispatch_t* d, lssize_t argc,
+                                               lsthunk_t* const* args) {
+  lsthunk_t* arg     = args[0];
+  lsthunk_t* argwhnf = NULL;
+  for (lssize_t i = 0; i < d->lcd_armc; i++) {
+    if (d->lcd_arms[i].lca_head == LSTARM_ALGE) {
+      // Once the argument is forced, go straight to the next arm its constructor can reach
+      if (argwhnf == NULL)
+        argwhnf = lsthunk_eval0(arg);
+      int tag = argwhnf != NULL && argwhnf->lt_type == LSTTYPE_ALGE ? argwhnf->lt_alge.lta_tag : 0;
+      if (tag != d->lcd_arms[i].lca_tag) {
+        i = lstchoice_dispatch_seek(d, tag, i);
+        if (i == d->lcd_armc)
+          break;
+      }
+    }
+    int        last = i + 1 == d->lcd_armc;
+    lsthunk_t* arm  = d->lcd_arms[i].lca_thunk;
+    if (lstchoice_arm_rejects(&d->lcd_arms[i], arg, &argwhnf))
+      continue;
+    if (last) {
+      // Last arm takes all args at once, as the right arm of the innermost choice does
+      lsthunk_t* r = lsthunk_eval_arm(arm, argc, args);
+      if (r == LSTHUNK_NOMATCH)
+        break;
+      if (r != NULL && lsthunk_is_bottom(r))
+        return lsthunk_bottom_merge(lsthunk_new_match_failure(arg), r);
+      return r;
+    }
+    lsthunk_t* r = lsthunk_eval_arm(arm, 1, &args[0]);
+    if (r == NULL || r == LSTHUNK_NOMATCH)
+      continue;
+    if (lsthunk_is_err(r))
+      return r;
+    return lsthunk_eval(r, argc - 1, args + 1);
+  }
+  // No arm matched: the failure escapes the choice, so materialize it now
+  return lsthunk_new_match_failure(arg);
 }
 
 static lsthunk_t* lsthunk_eval_choice(lsthunk_t* thunk, lssize_t argc, lsthunk_t* const* args) {
@@ -1072,23 +2064,27 @@ static lsthunk_t* lsthunk_eval_choice(lsthunk_t* thunk, lssize_t argc, lsthunk_t
   assert(argc == 0 || args != NULL);
   // Lambda-choice: special stepwise handling for first-arg guard
   if (thunk->lt_choice.ltc_kind == 1 /* LSECHOICE_LAMBDA */ && argc > 0) {
+    const lstchoice_dispatch_t* d = lstchoice_dispatch_get(thunk);
+    if (d != NULL)
+      return lsthunk_eval_choice_dispatch(d, argc, args);
     // Apply only the first argument to the left arm
-    lsthunk_t* left1 = lsthunk_eval(thunk->lt_choice.ltc_left, 1, &args[0]);
+    lsthunk_t* left1 = lsthunk_eval_arm(thunk->lt_choice.ltc_left, 1, &args[0]);
     if (left1 == NULL) {
       // Treat as left failure and try right with full args
       return lsthunk_eval(thunk->lt_choice.ltc_right, argc, args);
     }
-    if (lsthunk_is_err(left1)) {
-      // Fallback ONLY when the first-parameter match failed
-      if (is_lambda_match_failure_err(left1)) {
-        lsthunk_t* right = lsthunk_eval(thunk->lt_choice.ltc_right, argc, args);
-        if (right == NULL)
-          return right;
-        if (lsthunk_is_bottom(right)) {
-          return lsthunk_bottom_merge(left1, right);
-        }
+    // Fallback ONLY when the first-parameter match failed
+    if (left1 == LSTHUNK_NOMATCH) {
+      lsthunk_t* right = lsthunk_eval(thunk->lt_choice.ltc_right, argc, args);
+      if (right == NULL)
         return right;
+      if (lsthunk_is_bottom(right)) {
+        // Both arms failed: only now does the left failure need a bottom of its own
+        return lsthunk_bottom_merge(lsthunk_new_match_failure(args[0]), right);
       }
+      return right;
+    }
+    if (lsthunk_is_err(left1)) {
       // Other bottoms (if any) commit to left; do not fallback
       return left1;
     }
@@ -1141,113 +2137,198 @@ static lsthunk_t* lsthunk_eval_choice(lsthunk_t* thunk, lssize_t argc, lsthunk_t
 lsthunk_t* lsthunk_eval(lsthunk_t* func, lssize_t argc, lsthunk_t* const* args) {
   assert(func != NULL);
   // Enter trace context for this evaluation
-  if (func->lt_trace_id >= 0)
-    lstrace_push(func->lt_trace_id);
+  int traced = (func->lt_flags & LSTHDR_TRACED) != 0;
+  if (traced)
+    lstrace_push(lsthunk_trace_id(func));
   if (lsthunk_is_err(func)) {
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return func;
   }
   if (argc == 0) {
     lsthunk_t* r = lsthunk_eval0(func);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   switch (lsthunk_get_type(func)) {
   case LSTTYPE_ALGE: {
     lsthunk_t* r = lsthunk_eval_alge(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   case LSTTYPE_APPL: {
     lsthunk_t* r = lsthunk_eval_appl(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   case LSTTYPE_LAMBDA: {
     lsthunk_t* r = lsthunk_eval_lambda(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   case LSTTYPE_REF: {
     lsthunk_t* r = lsthunk_eval_ref(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   case LSTTYPE_CHOICE: {
     lsthunk_t* r = lsthunk_eval_choice(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   case LSTTYPE_INT:
     lsprintf(stderr, 0, "F: cannot apply for integer\n");
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return NULL;
   case LSTTYPE_STR:
     lsprintf(stderr, 0, "F: cannot apply for string\n");
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return NULL;
   case LSTTYPE_SYMBOL:
     lsprintf(stderr, 0, "F: cannot apply for symbol\n");
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return NULL;
   case LSTTYPE_BOTTOM:
     // Bottom applied is still bottom
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return func;
   case LSTTYPE_BUILTIN: {
     lsthunk_t* r = lsthunk_eval_builtin(func, argc, args);
-    if (func->lt_trace_id >= 0)
+    if (traced)
       lstrace_pop();
     return r;
   }
   }
-  if (func->lt_trace_id >= 0)
+  if (traced)
     lstrace_pop();
   return NULL;
 }
 
-lsthunk_t* lsthunk_eval0(lsthunk_t* thunk) {
-  assert(thunk != NULL);
-  if (thunk->lt_whnf != NULL)
-    return thunk->lt_whnf;
-  if (thunk->lt_trace_id >= 0)
-    lstrace_push(thunk->lt_trace_id);
+// Evaluate a suspension (no memoization); other nodes already are in WHNF
+static lsthunk_t* lsthunk_eval0_run(lsthunk_t* thunk) {
   switch (thunk->lt_type) {
   case LSTTYPE_APPL:
-    thunk->lt_whnf =
-        lsthunk_eval(thunk->lt_appl.lta_func, thunk->lt_appl.lta_argc, thunk->lt_appl.lta_args);
-    break;
+    return lsthunk_eval(thunk->lt_appl.lta_func, thunk->lt_appl.lta_argc, thunk->lt_appl.lta_args);
   case LSTTYPE_REF:
-    thunk->lt_whnf = lsthunk_eval_ref(thunk, 0, NULL);
-    break;
+    return lsthunk_eval_ref(thunk, 0, NULL);
   case LSTTYPE_CHOICE:
-    thunk->lt_whnf = lsthunk_eval_choice(thunk, 0, NULL);
-    break;
-  case LSTTYPE_BOTTOM:
-    thunk->lt_whnf = thunk;
-    break;
+    return lsthunk_eval_choice(thunk, 0, NULL);
   case LSTTYPE_BUILTIN:
-    thunk->lt_whnf = lsthunk_eval_builtin(thunk, 0, NULL);
-    break;
+    return lsthunk_eval_builtin(thunk, 0, NULL);
   default:
-    // it already is in WHNF
-    thunk->lt_whnf = thunk;
-    break;
+    return thunk;
   }
-  if (thunk->lt_trace_id >= 0)
+}
+
+// Evaluate a thunk and memoize its WHNF; the release stores publish it to other threads
+static lsthunk_t* lsthunk_eval0_memo(lsthunk_t* thunk) {
+  int traced = (thunk->lt_flags & LSTHDR_TRACED) != 0;
+  if (traced)
+    lstrace_push(lsthunk_trace_id(thunk));
+  lsthunk_t*  whnf = lsthunk_eval0_run(thunk);
+  lsthunk_t** slot = lsthunk_memo_slot(thunk);
+  if (slot != NULL)
+    __atomic_store_n(slot, whnf, __ATOMIC_RELEASE);
+  if (whnf == thunk)
+    __atomic_fetch_or(&thunk->lt_flags, LSTHDR_WHNF, __ATOMIC_RELEASE);
+  if (traced)
     lstrace_pop();
-  return thunk->lt_whnf;
+  return whnf;
+}
+
+// Drop this thread's claim on a thunk (its WHNF is published) and wake the waiting threads.
+// The claim is cleared and the waiters are counted sequentially consistently, so either the
+// waiter sees the claim gone or this thread sees the waiter.
+static void lsthunk_par_release(lsthunk_t* thunk) {
+  __atomic_fetch_and(&thunk->lt_flags, ~(LSTHDR_BLACKHOLE | LSTHDR_OWNER_MASK), __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&g_par_waiters, __ATOMIC_SEQ_CST) > 0) {
+    pthread_mutex_lock(&g_par_wait_lock);
+    pthread_cond_broadcast(&g_par_released);
+    pthread_mutex_unlock(&g_par_wait_lock);
+  }
+}
+
+// Sleep until the claim seen in flags is dropped
+static void lsthunk_par_wait(lsthunk_t* thunk, uint32_t flags) {
+  uint32_t claim = flags & (LSTHDR_BLACKHOLE | LSTHDR_OWNER_MASK);
+  __atomic_fetch_add(&g_par_waiters, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_lock(&g_par_wait_lock);
+  while ((__atomic_load_n(&thunk->lt_flags, __ATOMIC_SEQ_CST) &
+          (LSTHDR_BLACKHOLE | LSTHDR_OWNER_MASK)) == claim)
+    pthread_cond_wait(&g_par_released, &g_par_wait_lock);
+  pthread_mutex_unlock(&g_par_wait_lock);
+  __atomic_fetch_sub(&g_par_waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Evaluate a thunk to WHNF in parallel mode
+ * A suspension is claimed by setting LSTHDR_BLACKHOLE and the thread's id in its header, so
+ * two threads never evaluate it both: a thread that needs a suspension another thread has
+ * claimed waits until its WHNF is published. A thread that meets its own claim (a thunk that
+ * demands itself) evaluates it again, as the sequential evaluator does.
+ * @param thunk The thunk
+ * @param wait Whether to wait for another thread's claim; NULL is returned otherwise
+ * @return The WHNF
+ */
+static lsthunk_t* lsthunk_eval0_par(lsthunk_t* thunk, int wait) {
+  if (lsthunk_memo_slot(thunk) == NULL)
+    return lsthunk_eval0_memo(thunk);
+  uint32_t owner   = lsthunk_par_owner();
+  uint32_t flags   = __atomic_load_n(&thunk->lt_flags, __ATOMIC_ACQUIRE);
+  int      claimed = 0;
+  for (;;) {
+    lsthunk_t* whnf = lsthunk_whnf_peek(thunk);
+    if (whnf != NULL) {
+      if (claimed)
+        lsthunk_par_release(thunk);
+      return whnf;
+    }
+    if (claimed || (flags & LSTHDR_OWNER_MASK) == owner)
+      break;
+    if (!(flags & LSTHDR_BLACKHOLE)) {
+      // On success, look at the memo once more: it may have been published since the peek
+      claimed = __atomic_compare_exchange_n(&thunk->lt_flags, &flags,
+                                            flags | LSTHDR_BLACKHOLE | owner, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+      continue;
+    }
+    if (!wait)
+      return NULL;
+    lsthunk_par_wait(thunk, flags);
+    flags = __atomic_load_n(&thunk->lt_flags, __ATOMIC_ACQUIRE);
+  }
+  lsthunk_t* whnf = lsthunk_eval0_memo(thunk);
+  if (claimed)
+    lsthunk_par_release(thunk);
+  return whnf;
+}
+
+lsthunk_t* lsthunk_eval0(lsthunk_t* thunk) {
+  assert(thunk != NULL);
+  lsthunk_t* whnf = lsthunk_whnf_peek(thunk);
+  if (whnf != NULL)
+    return whnf;
+  if (g_par_enabled)
+    return lsthunk_eval0_par(thunk, 1);
+  return lsthunk_eval0_memo(thunk);
+}
+
+lsthunk_t* lsthunk_eval_spark(lsthunk_t* thunk) {
+  assert(thunk != NULL);
+  lsthunk_t* whnf = lsthunk_whnf_peek(thunk);
+  if (whnf != NULL)
+    return whnf;
+  return lsthunk_eval0_par(thunk, 0);
 }
 
 lstref_target_t* lstref_target_new(lstref_target_origin_t* origin, lstpat_t* pat) {
@@ -1261,20 +2342,21 @@ lstpat_t*  lstref_target_get_pat(lstref_target_t* target) { return target->lrt_p
 
 lsthunk_t* lsthunk_new_builtin(const lsstr_t* name, lssize_t arity, lstbuiltin_func_t func,
                                void* data) {
-  lsthunk_t* thunk = lsmalloc(sizeof(lsthunk_t));
+  lsthunk_t* thunk = lsmalloc(lssizeof(lsthunk_t, lt_builtin));
   thunk->lt_type   = LSTTYPE_BUILTIN;
   // Do not mark builtins as WHNF at construction. This allows eval0 to
   // execute zero-arity builtins and cache their resulting value, keeping
   // wrappers (e.g., namespace member getters) transparent when printing.
-  thunk->lt_whnf        = NULL;
-  thunk->lt_trace_id    = -1;
-  lstbuiltin_t* builtin = lsmalloc(sizeof(lstbuiltin_t));
-  builtin->lti_name     = name;
-  builtin->lti_arity    = arity;
-  builtin->lti_func     = func;
-  builtin->lti_data     = data;
-  builtin->lti_attr     = LSBATTR_PURE;
-  thunk->lt_builtin     = builtin;
+  thunk->lt_flags            = 0;
+  lstbuiltin_t* builtin      = lsmalloc(sizeof(lstbuiltin_t));
+  builtin->lti_name          = name;
+  builtin->lti_arity         = arity;
+  builtin->lti_func          = func;
+  builtin->lti_data          = data;
+  builtin->lti_attr          = LSBATTR_PURE;
+  builtin->lti_lookup        = NULL;
+  thunk->lt_builtin.ltb_def  = builtin;
+  thunk->lt_builtin.ltb_whnf = NULL;
   return thunk;
 }
 
@@ -1282,7 +2364,7 @@ lsthunk_t* lsthunk_new_builtin_attr(const lsstr_t* name, lssize_t arity, lstbuil
                                     void* data, lsbuiltin_attr_t attr) {
   lsthunk_t* t = lsthunk_new_builtin(name, arity, func, data);
   if (t && t->lt_type == LSTTYPE_BUILTIN) {
-    ((lstbuiltin_t*)t->lt_builtin)->lti_attr = attr;
+    ((lstbuiltin_t*)t->lt_builtin.ltb_def)->lti_attr = attr;
   }
   return t;
 }
@@ -1295,21 +2377,29 @@ lstref_target_origin_t* lstref_target_origin_new_builtin(const lsstr_t* name, ls
   return origin;
 }
 
+lstref_target_origin_t* lstref_target_origin_new_dispatcher(const lsstr_t* name,
+                                                            lstbuiltin_func_t func, void* data,
+                                                            lstbuiltin_lookup_t lookup) {
+  lstref_target_origin_t* origin = lstref_target_origin_new_builtin(name, 1, func, data);
+  ((lstbuiltin_t*)origin->lrto_builtin->lt_builtin.ltb_def)->lti_lookup = lookup;
+  return origin;
+}
+
 int lsthunk_is_builtin(const lsthunk_t* thunk) {
   return thunk && thunk->lt_type == LSTTYPE_BUILTIN;
 }
 
 lstbuiltin_func_t lsthunk_get_builtin_func(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin->lti_func : NULL;
+  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin.ltb_def->lti_func : NULL;
 }
 
 void* lsthunk_get_builtin_data(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin->lti_data : NULL;
+  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin.ltb_def->lti_data : NULL;
 }
 
 // cppcheck-suppress unusedFunction
 const lsstr_t* lsthunk_get_builtin_name(const lsthunk_t* thunk) {
-  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin->lti_name : NULL;
+  return (thunk && thunk->lt_type == LSTTYPE_BUILTIN) ? thunk->lt_builtin.ltb_def->lti_name : NULL;
 }
 
 lsthunk_t* lsprog_eval(const lsprog_t* prog, lstenv_t* tenv) {
@@ -1349,13 +2439,19 @@ static lsthunk_colle_t* lsthunk_colle_new(lsthunk_t* thunk, lsthunk_colle_t* hea
   switch (mode) {
   case LSPM_SHARROW:
     break;
-  case LSPM_ASIS:
-    thunk = thunk->lt_whnf != NULL ? thunk->lt_whnf : thunk;
+  case LSPM_ASIS: {
+    lsthunk_t* whnf = lsthunk_whnf_peek(thunk);
+    thunk           = whnf != NULL ? whnf : thunk;
     break;
+  }
   case LSPM_DEEP:
     thunk = lsthunk_eval0(thunk);
     break;
   }
+  // Hash-consed values are shared by construction, not by the program, and cannot be cyclic:
+  // always print them inline
+  if (thunk->lt_flags & LSTHDR_HASHCONS)
+    return head;
   lsthunk_colle_t** pcolle = lsthunk_colle_find(&head, thunk);
   if (*pcolle != NULL) {
     (*pcolle)->ltc_id = (*pid)++;
@@ -1410,9 +2506,11 @@ static void lsthunk_print_internal(FILE* fp, lsprec_t prec, int indent, lsthunk_
   switch (mode) {
   case LSPM_SHARROW:
     break;
-  case LSPM_ASIS:
-    thunk = thunk->lt_whnf != NULL ? thunk->lt_whnf : thunk;
+  case LSPM_ASIS: {
+    lsthunk_t* whnf = lsthunk_whnf_peek(thunk);
+    thunk           = whnf != NULL ? whnf : thunk;
     break;
+  }
   case LSPM_DEEP:
     thunk = lsthunk_eval0(thunk);
     break;
@@ -1431,12 +2529,13 @@ static void lsthunk_print_internal(FILE* fp, lsprec_t prec, int indent, lsthunk_
         break;
     }
   }
-  assert(colle_found != NULL);
+  // Not collected: a hash-consed value, or a list element forced while printing (an error in
+  // place of an unevaluated reference); printed inline
 
   if (has_dup)
     lsprintf(fp, ++indent, "(\n");
 
-  if (!force_print && colle_found->ltc_count > 1)
+  if (!force_print && colle_found != NULL && colle_found->ltc_count > 1)
     lsprintf(fp, 0, "~__ref%u", colle_found->ltc_id);
   else
     switch (thunk->lt_type) {
@@ -1623,7 +2722,7 @@ static void lsthunk_print_internal(FILE* fp, lsprec_t prec, int indent, lsthunk_
         for (lssize_t i = 0; i < ac; i++) {
           if (i)
             lsprintf(fp, 0, ", ");
-          lsthunk_print_internal(fp, LSPREC_LOWEST, indent, thunk->lt_bottom.lt_rel.lbr_args[i],
+          lsthunk_print_internal(fp, LSPREC_LOWEST, indent, lsthunk_bottom_get_args(thunk)[i],
                                  level + 1, colle, mode, 0);
         }
         lsprintf(fp, 0, "]");
@@ -1632,8 +2731,8 @@ static void lsthunk_print_internal(FILE* fp, lsprec_t prec, int indent, lsthunk_
       break;
     }
     case LSTTYPE_BUILTIN:
-      lsprintf(fp, indent, "~%s{-builtin/%d-}", lsstr_get_buf(thunk->lt_builtin->lti_name),
-               thunk->lt_builtin->lti_arity);
+      lsprintf(fp, indent, "~%s{-builtin/%d-}", lsstr_get_buf(thunk->lt_builtin.ltb_def->lti_name),
+               thunk->lt_builtin.ltb_def->lti_arity);
       break;
     }
   if (has_dup) {
@@ -1679,27 +2778,49 @@ typedef struct subst_entry {
   struct subst_entry* next;
 } subst_entry_t;
 
-static lsthunk_t* subst_lookup(subst_entry_t* m, const lsthunk_t* k) {
-  for (; m; m = m->next)
-    if (m->key == k)
-      return m->val;
+// Nodes visited by one substitution, mapped to their copy (or to themselves when they mention
+// no parameter). The first entries live on the caller's stack, so substituting into a small
+// lambda body allocates nothing but the copied nodes.
+#define SUBST_LOCAL 32
+
+typedef struct subst_memo {
+  lssize_t       sm_count;
+  subst_entry_t  sm_local[SUBST_LOCAL];
+  subst_entry_t* sm_more;
+} subst_memo_t;
+
+static subst_entry_t* subst_lookup(subst_memo_t* m, const lsthunk_t* k) {
+  lssize_t n = m->sm_count < SUBST_LOCAL ? m->sm_count : SUBST_LOCAL;
+  for (lssize_t i = 0; i < n; i++)
+    if (m->sm_local[i].key == k)
+      return &m->sm_local[i];
+  for (subst_entry_t* e = m->sm_more; e; e = e->next)
+    if (e->key == k)
+      return e;
   return NULL;
 }
 
-static subst_entry_t* subst_bind(subst_entry_t* m, const lsthunk_t* k, lsthunk_t* v) {
-  subst_entry_t* e = lsmalloc(sizeof(subst_entry_t));
-  e->key           = k;
-  e->val           = v;
-  e->next          = m;
+static subst_entry_t* subst_bind(subst_memo_t* m, const lsthunk_t* k, lsthunk_t* v) {
+  subst_entry_t* e =
+      m->sm_count < SUBST_LOCAL ? &m->sm_local[m->sm_count] : lsmalloc(sizeof(subst_entry_t));
+  m->sm_count++;
+  e->key  = k;
+  e->val  = v;
+  e->next = NULL;
+  if (m->sm_count > SUBST_LOCAL) {
+    e->next    = m->sm_more;
+    m->sm_more = e;
+  }
   return e;
 }
 
-static lsthunk_t* lsthunk_subst_param_rec(lsthunk_t* t, lstpat_t* param, subst_entry_t** pmemo) {
+static lsthunk_t* lsthunk_subst_param_rec(lsthunk_t* t, lstpat_t* const* params, lssize_t nparams,
+                                          subst_memo_t* memo) {
   if (t == NULL)
     return NULL;
-  lsthunk_t* memo = subst_lookup(*pmemo, t);
-  if (memo)
-    return memo;
+  subst_entry_t* seen = subst_lookup(memo, t);
+  if (seen)
+    return seen->val;
 
   switch (t->lt_type) {
   case LSTTYPE_REF: {
@@ -1716,63 +2837,105 @@ static lsthunk_t* lsthunk_subst_param_rec(lsthunk_t* t, lstpat_t* param, subst_e
       // If this reference belongs to the same lambda parameter (including any subpattern
       // inside the parameter), capture the currently bound thunk for that specific ref.
       lstref_target_origin_t* org = target->lrt_origin;
-      if (org && org->lrto_type == LSTRTYPE_LAMBDA && org->lrto_lambda.ltl_param == param) {
-        lstpat_t*  pref  = target->lrt_pat; // the concrete ref node within the param pattern
-        lsthunk_t* bound = pref ? lstpat_get_refbound(pref) : NULL;
-        if (bound)
-          return bound;
+      if (org && org->lrto_type == LSTRTYPE_LAMBDA) {
+        for (lssize_t i = 0; i < nparams; i++) {
+          if (org->lrto_lambda.ltl_param != params[i])
+            continue;
+          lstpat_t*  pref  = target->lrt_pat; // the concrete ref node within the param pattern
+          lsthunk_t* bound = pref ? lstpat_get_refbound(pref) : NULL;
+          if (!bound)
+            break;
+          // Curried application would substitute the enclosing parameters into the bound
+          // thunk afterwards; do the same for the parameters outside params[i].
+          return i > 0 ? lsthunk_subst_params(bound, params, i) : bound;
+        }
       }
     }
     return t;
   }
   case LSTTYPE_ALGE: {
-    lssize_t   n           = t->lt_alge.lta_argc;
+    // Nodes that mention no parameter are shared rather than copied, so closed values (and
+    // canonical hash-consed ones in particular) keep their identity
+    lssize_t       n = t->lt_alge.lta_argc;
+    lsthunk_t*     args[n];
+    int            changed = 0;
+    subst_entry_t* e       = subst_bind(memo, t, t);
+    for (lssize_t i = 0; i < n; i++) {
+      args[i] = lsthunk_subst_param_rec(t->lt_alge.lta_args[i], params, nparams, memo);
+      changed |= args[i] != t->lt_alge.lta_args[i];
+    }
+    if (!changed)
+      return t;
     lsthunk_t* nt          = lsmalloc(lssizeof(lsthunk_t, lt_alge) + n * sizeof(lsthunk_t*));
     nt->lt_type            = LSTTYPE_ALGE;
-    nt->lt_whnf            = nt;
-    nt->lt_trace_id        = -1;
+    nt->lt_flags           = LSTHDR_WHNF;
     nt->lt_alge.lta_constr = t->lt_alge.lta_constr;
+    nt->lt_alge.lta_tag    = t->lt_alge.lta_tag;
     nt->lt_alge.lta_argc   = n;
-    *pmemo                 = subst_bind(*pmemo, t, nt);
     for (lssize_t i = 0; i < n; i++)
-      nt->lt_alge.lta_args[i] = lsthunk_subst_param_rec(t->lt_alge.lta_args[i], param, pmemo);
+      nt->lt_alge.lta_args[i] = args[i];
+    e->val = nt;
     return nt;
   }
   case LSTTYPE_APPL: {
-    lssize_t   n         = t->lt_appl.lta_argc;
+    lssize_t       n = t->lt_appl.lta_argc;
+    lsthunk_t*     args[n];
+    subst_entry_t* e       = subst_bind(memo, t, t);
+    lsthunk_t*     func    = lsthunk_subst_param_rec(t->lt_appl.lta_func, params, nparams, memo);
+    int            changed = func != t->lt_appl.lta_func;
+    for (lssize_t i = 0; i < n; i++) {
+      args[i] = lsthunk_subst_param_rec(t->lt_appl.lta_args[i], params, nparams, memo);
+      changed |= args[i] != t->lt_appl.lta_args[i];
+    }
+    if (!changed)
+      return t;
     lsthunk_t* nt        = lsmalloc(lssizeof(lsthunk_t, lt_appl) + n * sizeof(lsthunk_t*));
     nt->lt_type          = LSTTYPE_APPL;
-    nt->lt_whnf          = NULL;
-    nt->lt_trace_id      = -1;
-    nt->lt_appl.lta_func = lsthunk_subst_param_rec(t->lt_appl.lta_func, param, pmemo);
+    nt->lt_flags         = 0;
+    nt->lt_appl.lta_whnf = NULL;
+    nt->lt_appl.lta_func = func;
     nt->lt_appl.lta_argc = n;
-    *pmemo               = subst_bind(*pmemo, t, nt);
     for (lssize_t i = 0; i < n; i++)
-      nt->lt_appl.lta_args[i] = lsthunk_subst_param_rec(t->lt_appl.lta_args[i], param, pmemo);
+      nt->lt_appl.lta_args[i] = args[i];
+    e->val = nt;
     return nt;
   }
   case LSTTYPE_CHOICE: {
-    lsthunk_t* nt           = lsmalloc(sizeof(lsthunk_t));
+    subst_entry_t* e     = subst_bind(memo, t, t);
+    lsthunk_t*     left  = lsthunk_subst_param_rec(t->lt_choice.ltc_left, params, nparams, memo);
+    lsthunk_t*     right = lsthunk_subst_param_rec(t->lt_choice.ltc_right, params, nparams, memo);
+    if (left == t->lt_choice.ltc_left && right == t->lt_choice.ltc_right)
+      return t;
+    lsthunk_t* nt           = lsmalloc(lssizeof(lsthunk_t, lt_choice));
     nt->lt_type             = LSTTYPE_CHOICE;
-    nt->lt_whnf             = NULL;
-    nt->lt_trace_id         = -1;
-    *pmemo                  = subst_bind(*pmemo, t, nt);
-    nt->lt_choice.ltc_left  = lsthunk_subst_param_rec(t->lt_choice.ltc_left, param, pmemo);
-    nt->lt_choice.ltc_right = lsthunk_subst_param_rec(t->lt_choice.ltc_right, param, pmemo);
+    nt->lt_flags            = 0;
+    nt->lt_choice.ltc_whnf  = NULL;
+    nt->lt_choice.ltc_left  = left;
+    nt->lt_choice.ltc_right = right;
     // Preserve choice operator kind to keep evaluation semantics ('|' vs '||')
     nt->lt_choice.ltc_kind = t->lt_choice.ltc_kind;
+    // The table points at the arms, so the copy builds its own when applied
+    nt->lt_choice.ltc_dispatch = t->lt_choice.ltc_dispatch == LSTCHOICE_NODISPATCH
+                                     ? LSTCHOICE_NODISPATCH
+                                     : NULL;
+    e->val                     = nt;
     return nt;
   }
   case LSTTYPE_LAMBDA: {
     // Capture references to the outer parameter even across lambda boundaries by
     // substituting inside the lambda body. Keep the parameter pattern as-is.
-    lsthunk_t* nt           = lsmalloc(sizeof(lsthunk_t));
-    nt->lt_type             = LSTTYPE_LAMBDA;
-    nt->lt_whnf             = nt;
-    nt->lt_trace_id         = -1;
-    nt->lt_lambda.ltl_param = t->lt_lambda.ltl_param;
-    *pmemo                  = subst_bind(*pmemo, t, nt);
-    nt->lt_lambda.ltl_body  = lsthunk_subst_param_rec(t->lt_lambda.ltl_body, param, pmemo);
+    subst_entry_t* e    = subst_bind(memo, t, t);
+    lsthunk_t*     body = lsthunk_subst_param_rec(t->lt_lambda.ltl_body, params, nparams, memo);
+    if (body == t->lt_lambda.ltl_body)
+      return t;
+    lsthunk_t* nt            = lsmalloc(lssizeof(lsthunk_t, lt_lambda));
+    nt->lt_type              = LSTTYPE_LAMBDA;
+    nt->lt_flags             = LSTHDR_WHNF;
+    nt->lt_lambda.ltl_param  = t->lt_lambda.ltl_param;
+    nt->lt_lambda.ltl_body   = body;
+    nt->lt_lambda.ltl_nary   = t->lt_lambda.ltl_nary ? lsthunk_lambda_nary_new(nt) : NULL;
+    nt->lt_lambda.ltl_strict = t->lt_lambda.ltl_strict;
+    e->val                   = nt;
     return nt;
   }
   case LSTTYPE_INT:
@@ -1783,9 +2946,16 @@ static lsthunk_t* lsthunk_subst_param_rec(lsthunk_t* t, lstpat_t* param, subst_e
   }
 }
 
+static lsthunk_t* lsthunk_subst_params(lsthunk_t* thunk, lstpat_t* const* params,
+                                       lssize_t nparams) {
+  subst_memo_t memo;
+  memo.sm_count = 0;
+  memo.sm_more  = NULL;
+  return lsthunk_subst_param_rec(thunk, params, nparams, &memo);
+}
+
 lsthunk_t* lsthunk_subst_param(lsthunk_t* thunk, lstpat_t* param) {
-  subst_entry_t* memo = NULL;
-  return lsthunk_subst_param_rec(thunk, param, &memo);
+  return lsthunk_subst_params(thunk, &param, 1);
 }
 
 // --- Thunk Binary (LSTB) I/O (subset v0.1) -------------------------------
@@ -1902,17 +3072,21 @@ static int thvec_push(thvec_t* v, lsthunk_t* t) {
   v->items[v->size++] = t;
   return 0;
 }
+
+// Returned by the pool and node lookups below when the item is absent
+#define LSTB_NOIDX ((lssize_t)-1)
+
 static lssize_t thvec_index_of(const thvec_t* v, const lsthunk_t* t) {
   for (lssize_t i = 0; i < v->size; i++)
     if (v->items[i] == t)
       return i;
-  return -1;
+  return LSTB_NOIDX;
 }
 
 static int collect_subset(thvec_t* order, lsthunk_t* t) {
   if (!t)
     return 0;
-  if (thvec_index_of(order, t) >= 0)
+  if (thvec_index_of(order, t) != LSTB_NOIDX)
     return 0;
   if (thvec_push(order, t) != 0)
     return -1;
@@ -1938,27 +3112,35 @@ typedef struct {
   const char** items;
   lssize_t     size;
   lssize_t     cap;
+  lssize_t*    tagidx; // constructor tag -> index + 1 (0 = not cached)
+  lssize_t     tagcap;
 } strpool_t;
 static void strpool_init(strpool_t* p) {
-  p->items = NULL;
-  p->size  = 0;
-  p->cap   = 0;
+  p->items  = NULL;
+  p->size   = 0;
+  p->cap    = 0;
+  p->tagidx = NULL;
+  p->tagcap = 0;
 }
 static void strpool_free(strpool_t* p) {
   if (p->items)
     free(p->items);
-  p->items = NULL;
+  if (p->tagidx)
+    free(p->tagidx);
+  p->tagidx = NULL;
+  p->tagcap = 0;
+  p->items  = NULL;
   p->size = p->cap = 0;
 }
 static lssize_t strpool_index_of(const strpool_t* p, const char* s) {
   for (lssize_t i = 0; i < p->size; i++)
     if (strcmp(p->items[i], s) == 0)
       return i;
-  return -1;
+  return LSTB_NOIDX;
 }
 static int strpool_add(strpool_t* p, const char* s, lssize_t* out_id) {
   lssize_t idx = strpool_index_of(p, s);
-  if (idx >= 0) {
+  if (idx != LSTB_NOIDX) {
     if (out_id)
       *out_id = idx;
     return 0;
@@ -1978,6 +3160,47 @@ static int strpool_add(strpool_t* p, const char* s, lssize_t* out_id) {
   return 0;
 }
 
+// Constructor names are looked up by tag so that repeated constructors skip the string scan
+static int strpool_add_constr(strpool_t* p, const lsstr_t* constr, lssize_t* out_id) {
+  int tag = lsstr_get_tag(constr);
+  if (tag < p->tagcap && p->tagidx[tag] > 0) {
+    if (out_id)
+      *out_id = p->tagidx[tag] - 1;
+    return 0;
+  }
+  lssize_t idx;
+  if (strpool_add(p, lsstr_get_buf(constr), &idx) != 0)
+    return -1;
+  if (tag >= p->tagcap) {
+    lssize_t ncap = p->tagcap ? p->tagcap : 32;
+    while (ncap <= tag)
+      ncap *= 2;
+    lssize_t* nt = (lssize_t*)realloc(p->tagidx, sizeof(lssize_t) * (size_t)ncap);
+    if (!nt)
+      return -1;
+    memset(nt + p->tagcap, 0, sizeof(lssize_t) * (size_t)(ncap - p->tagcap));
+    p->tagidx = nt;
+    p->tagcap = ncap;
+  }
+  p->tagidx[tag] = idx + 1;
+  if (out_id)
+    *out_id = idx;
+  return 0;
+}
+
+// Symbol-pool index of a constructor added by strpool_add_constr; never adds one
+static lssize_t strpool_constr_index(const strpool_t* p, const lsstr_t* constr) {
+  int tag = lsstr_get_tag(constr);
+  return tag < p->tagcap && p->tagidx[tag] > 0 ? p->tagidx[tag] - 1 : LSTB_NOIDX;
+}
+
+// The pools are written before the nodes, so emitting a node may only look up what the
+// pre-pass collected; a miss would leave a node pointing past its pool.
+static void lstb_write_miss(const char* what, const char* s) {
+  lsprintf(stderr, 0, "E: lstb_write: %s not collected before the pools were written: %s\n", what,
+           s);
+}
+
 static int pool_collect_from_thunk(strpool_t* sp, strpool_t* yp, lsthunk_t* t) {
   if (!t)
     return 0;
@@ -1989,7 +3212,7 @@ static int pool_collect_from_thunk(strpool_t* sp, strpool_t* yp, lsthunk_t* t) {
   case LSTTYPE_SYMBOL:
     return strpool_add(yp, lsstr_get_buf(t->lt_symbol), NULL);
   case LSTTYPE_ALGE: {
-    if (strpool_add(yp, lsstr_get_buf(t->lt_alge.lta_constr), NULL) != 0)
+    if (strpool_add_constr(yp, t->lt_alge.lta_constr, NULL) != 0)
       return -1;
     for (lssize_t i = 0; i < t->lt_alge.lta_argc; i++)
       if (pool_collect_from_thunk(sp, yp, t->lt_alge.lta_args[i]) != 0)
@@ -1997,11 +3220,11 @@ static int pool_collect_from_thunk(strpool_t* sp, strpool_t* yp, lsthunk_t* t) {
     return 0;
   }
   case LSTTYPE_BOTTOM: {
-    const char* m = t->lt_bottom.lt_msg ? t->lt_bottom.lt_msg : "";
+    const char* m = lsthunk_bottom_get_message(t);
     if (strpool_add(sp, m, NULL) != 0)
       return -1;
-    for (lssize_t i = 0; i < t->lt_bottom.lt_rel.lbr_argc; i++)
-      if (pool_collect_from_thunk(sp, yp, t->lt_bottom.lt_rel.lbr_args[i]) != 0)
+    for (lssize_t i = 0; i < lsthunk_bottom_get_argc(t); i++)
+      if (pool_collect_from_thunk(sp, yp, lsthunk_bottom_get_args(t)[i]) != 0)
         return -1;
     return 0;
   }
@@ -2185,7 +3408,7 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
       return -1;
     }
     uint8_t eflags = 0;
-    if (t->lt_whnf == t)
+    if (t->lt_flags & LSTHDR_WHNF)
       eflags |= LSTB_EF_WHNF;
     if (fputc(eflags, fp) == EOF) {
       thvec_free(&order);
@@ -2212,7 +3435,8 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
     }
     case LSTTYPE_STR: {
       lssize_t sid = strpool_index_of(&sp, lsstr_get_buf(t->lt_str));
-      if (sid < 0) {
+      if (sid == LSTB_NOIDX) {
+        lstb_write_miss("string", lsstr_get_buf(t->lt_str));
         thvec_free(&order);
         strpool_free(&sp);
         strpool_free(&yp);
@@ -2228,7 +3452,8 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
     }
     case LSTTYPE_SYMBOL: {
       lssize_t yid = strpool_index_of(&yp, lsstr_get_buf(t->lt_symbol));
-      if (yid < 0) {
+      if (yid == LSTB_NOIDX) {
+        lstb_write_miss("symbol", lsstr_get_buf(t->lt_symbol));
         thvec_free(&order);
         strpool_free(&sp);
         strpool_free(&yp);
@@ -2243,8 +3468,9 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
       break;
     }
     case LSTTYPE_ALGE: {
-      lssize_t yid = strpool_index_of(&yp, lsstr_get_buf(t->lt_alge.lta_constr));
-      if (yid < 0) {
+      lssize_t yid = strpool_constr_index(&yp, t->lt_alge.lta_constr);
+      if (yid == LSTB_NOIDX) {
+        lstb_write_miss("constructor", lsstr_get_buf(t->lt_alge.lta_constr));
         thvec_free(&order);
         strpool_free(&sp);
         strpool_free(&yp);
@@ -2264,7 +3490,7 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
       }
       for (lssize_t j = 0; j < t->lt_alge.lta_argc; j++) {
         lssize_t id = thvec_index_of(&order, t->lt_alge.lta_args[j]);
-        if (id < 0) {
+        if (id == LSTB_NOIDX) {
           thvec_free(&order);
           strpool_free(&sp);
           strpool_free(&yp);
@@ -2280,9 +3506,10 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
       break;
     }
     case LSTTYPE_BOTTOM: {
-      const char* m   = t->lt_bottom.lt_msg ? t->lt_bottom.lt_msg : "";
+      const char* m   = lsthunk_bottom_get_message(t);
       lssize_t    sid = strpool_index_of(&sp, m);
-      if (sid < 0) {
+      if (sid == LSTB_NOIDX) {
+        lstb_write_miss("string", m);
         thvec_free(&order);
         strpool_free(&sp);
         strpool_free(&yp);
@@ -2300,15 +3527,15 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
         strpool_free(&yp);
         return -1;
       }
-      if (write_varuint(fp, (uint64_t)t->lt_bottom.lt_rel.lbr_argc) != 0) {
+      if (write_varuint(fp, (uint64_t)lsthunk_bottom_get_argc(t)) != 0) {
         thvec_free(&order);
         strpool_free(&sp);
         strpool_free(&yp);
         return -1;
       }
-      for (lssize_t j = 0; j < t->lt_bottom.lt_rel.lbr_argc; j++) {
-        lssize_t id = thvec_index_of(&order, t->lt_bottom.lt_rel.lbr_args[j]);
-        if (id < 0) {
+      for (lssize_t j = 0; j < lsthunk_bottom_get_argc(t); j++) {
+        lssize_t id = thvec_index_of(&order, lsthunk_bottom_get_args(t)[j]);
+        if (id == LSTB_NOIDX) {
           thvec_free(&order);
           strpool_free(&sp);
           strpool_free(&yp);
@@ -2336,7 +3563,7 @@ int lstb_write(FILE* fp, lsthunk_t* const* roots, lssize_t rootc, unsigned file_
   }
   for (lssize_t i = 0; i < rootc; i++) {
     lssize_t id = thvec_index_of(&order, roots[i]);
-    if (id < 0) {
+    if (id == LSTB_NOIDX) {
       thvec_free(&order);
       strpool_free(&sp);
       strpool_free(&yp);
@@ -2488,11 +3715,12 @@ int lstb_read(FILE* fp, lsthunk_t*** out_roots, lssize_t* out_rootc, unsigned* o
       if (read_varuint(fp, &argc64) != 0)
         goto fail;
       lssize_t   argc = (lssize_t)argc64;
-      lsthunk_t* t    = lsmalloc(lssizeof(lsthunk_t, lt_alge) + (size_t)argc * sizeof(lsthunk_t*));
-      t->lt_type      = LSTTYPE_ALGE;
-      t->lt_whnf      = t;
-      t->lt_trace_id  = g_trace_next_id++;
+      lsthunk_t* t = lsmalloc(lssizeof(lsthunk_t, lt_alge) + (size_t)argc * sizeof(lsthunk_t*));
+      t->lt_type   = LSTTYPE_ALGE;
+      t->lt_flags  = LSTHDR_WHNF;
+      lsthunk_trace_assign(t);
       t->lt_alge.lta_constr = lsstr_new(yp[yid], (lssize_t)strlen(yp[yid]));
+      t->lt_alge.lta_tag    = lsstr_get_tag(t->lt_alge.lta_constr);
       t->lt_alge.lta_argc   = argc;
       nodes[i]              = t;
       if (argc > 0) {
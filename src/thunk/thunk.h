@@ -13,6 +13,7 @@ typedef struct lstbuiltin           lstbuiltin_t;
 
 typedef enum lstrtype { LSTRTYPE_BIND, LSTRTYPE_LAMBDA, LSTRTYPE_BUILTIN } lstrtype_t;
 
+#include "common/str.h"
 #include "lstypes.h"
 
 typedef lsthunk_t* (*lstbuiltin_func_t)(lssize_t, lsthunk_t* const*, void*);
@@ -22,13 +23,26 @@ typedef lsthunk_t* (*lstbuiltin_func_t)(lssize_t, lsthunk_t* const*, void*);
 //  - EFFECT: performs side-effects (requires effects to be allowed)
 //  - ENV_READ: reads from environment via data pointer
 //  - ENV_WRITE: mutates environment via data pointer
+//  - STRICT: forces every argument, left to right, before doing anything else; lambdas whose
+//    body is a saturated call of such a builtin get their arguments evaluated eagerly
 typedef enum lsbuiltin_attr {
   LSBATTR_PURE      = 0,
   LSBATTR_EFFECT    = 1 << 0,
   LSBATTR_ENV_READ  = 1 << 1,
   LSBATTR_ENV_WRITE = 1 << 2,
+  LSBATTR_STRICT    = 1 << 3,
 } lsbuiltin_attr_t;
 
+/**
+ * What a dispatcher builtin (one argument, a name) returns for a name, without calling it
+ * @param name The name
+ * @param parity Set to the arity of the builtin the name maps to
+ * @param pattr Set to its attributes
+ * @return 1 when the name maps to a builtin, 0 when it is not known
+ */
+typedef int (*lstbuiltin_lookup_t)(const lsstr_t* name, lssize_t* parity,
+                                   lsbuiltin_attr_t* pattr);
+
 #include "common/int.h"
 #include "common/str.h"
 #include "expr/ealge.h"
@@ -156,8 +170,8 @@ const char*       lsthunk_bottom_get_message(const lsthunk_t* thunk);
 lsloc_t           lsthunk_bottom_get_loc(const lsthunk_t* thunk);
 lssize_t          lsthunk_bottom_get_argc(const lsthunk_t* thunk);
 lsthunk_t* const* lsthunk_bottom_get_args(const lsthunk_t* thunk);
-// Merge/accumulate two bottoms: concatenates messages with "; " and appends args; chooses earlier
-// location
+// Merge/accumulate two bottoms in O(1): the message reads as both messages joined with "; " and
+// the args as both arg lists appended (both built on first access); chooses earlier location
 lsthunk_t* lsthunk_bottom_merge(lsthunk_t* a, lsthunk_t* b);
 
 // Internal-friendly constructors for two-phase wiring (used by loaders/materializers)
@@ -216,6 +230,13 @@ lsttype_t lsthunk_get_type(const lsthunk_t* thunk);
  */
 const lsstr_t* lsthunk_get_constr(const lsthunk_t* thunk);
 
+/**
+ * Get the constructor tag of an algebraic thunk
+ * @param thunk The thunk
+ * @return The tag (see lsstr_get_tag); equal tags mean equal constructor names
+ */
+int lsthunk_get_constr_tag(const lsthunk_t* thunk);
+
 /**
  * Get the arguments of a thunk
  * @param thunk The thunk
@@ -311,6 +332,21 @@ lsmres_t lsthunk_match_pat(lsthunk_t* thunk, lstpat_t* tpat);
  */
 lsthunk_t* lsthunk_eval0(lsthunk_t* thunk);
 
+/**
+ * Evaluate a sparked thunk to WHNF unless another thread is already evaluating it
+ * @param thunk The thunk
+ * @return The WHNF, or NULL when the spark fizzled (another thread holds the thunk)
+ */
+lsthunk_t* lsthunk_eval_spark(lsthunk_t* thunk);
+
+/**
+ * Enable or disable parallel evaluation (off by default)
+ * While enabled, lsthunk_eval0 claims a suspension before evaluating it, so that threads share
+ * each WHNF instead of computing it twice. Enable before the first worker starts.
+ * @param enabled Non-zero to enable
+ */
+void lsthunk_set_parallel(int enabled);
+
 /**
  * Apply a thunk to a list of arguments
  * @param func The function thunk
@@ -328,6 +364,12 @@ lstpat_t*               lstref_target_get_pat(lstref_target_t* target);
 lstref_target_origin_t* lstref_target_origin_new_builtin(const lsstr_t* name, lssize_t arity,
                                                          lstbuiltin_func_t func, void* data);
 
+// A one-argument builtin mapping names to builtins; the strictness analysis asks lookup what a
+// name maps to instead of calling func
+lstref_target_origin_t* lstref_target_origin_new_dispatcher(const lsstr_t* name,
+                                                            lstbuiltin_func_t func, void* data,
+                                                            lstbuiltin_lookup_t lookup);
+
 lsthunk_t*              lsprog_eval(const lsprog_t* prog, lstenv_t* tenv);
 
 void                    lsthunk_print(FILE* fp, lsprec_t prec, int indent, lsthunk_t* thunk);
@@ -336,6 +378,20 @@ void                    lsthunk_dprint(FILE* fp, lsprec_t prec, int indent, lsth
 // Deep print: recursively evaluate substructures while printing (used by to_string)
 void lsthunk_deep_print(FILE* fp, lsprec_t prec, int indent, lsthunk_t* thunk);
 
+/**
+ * Enable or disable hash-consing of fully evaluated values in the current context (off by
+ * default)
+ * @param enabled Non-zero to share structurally equal INT/STR/SYMBOL/ALGE values
+ */
+void lsthunk_set_hashcons(int enabled);
+
+/**
+ * Check whether a thunk is a hash-consed (canonical) value
+ * @param thunk The thunk
+ * @return Non-zero if canonical; two canonical values are equal iff they are the same node
+ */
+int lsthunk_is_hashconsed(const lsthunk_t* thunk);
+
 // For now, cloning a thunk returns the same pointer (immutable semantics).
 // If thunk mutability is introduced, replace with a deep copy.
 lsthunk_t* lsthunk_clone(lsthunk_t* thunk);
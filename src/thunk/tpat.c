@@ -4,6 +4,8 @@
 #include "common/io.h"
 #include <assert.h>
 #include <stddef.h>
+#include <pthread.h>
+#include <stdint.h>
 
 // Internal thunk-side pattern representation
 struct lstpat {
@@ -11,6 +13,7 @@ struct lstpat {
   union {
     struct {
       const lsstr_t* constr;
+      int            tag; // lsstr_get_tag(constr)
       lssize_t       argc;
       lstpat_t*      args[0];
     } alge;
@@ -22,7 +25,8 @@ struct lstpat {
     const lsstr_t* strval;
     struct {
       const lsref_t* ref;
-      lsthunk_t*     bound; // set when matched
+      lsthunk_t*     bound;  // set when matched
+      int            shared; // bound here on every thread (lstpat_share_binds)
     } r;
     struct {
       int wild;
@@ -42,7 +46,40 @@ static int              ls_or_mark_present_s;
 static int              ls_or_mark_used_s;
 static lsthunk_t* const ls_or_mark_present = (lsthunk_t*)&ls_or_mark_present_s;
 static lsthunk_t* const ls_or_mark_used    = (lsthunk_t*)&ls_or_mark_used_s;
-static int              ls_or_newvar_seen  = 0;
+static __thread int     ls_or_newvar_seen  = 0;
+
+// REF bindings. The first thread to bind (the main thread) binds in the patterns themselves;
+// every other thread (parallel workers, serve workers, embedding hosts) keeps its bindings in a
+// table of its own, so that two threads can apply one lambda at once and never see each other's
+// bindings. Clearing a binding removes its entry, so a table holds the bindings in scope on its
+// thread; it is freed when the thread exits. Closure bindings are never cleared (they memoize their
+// right-hand side for the life of the program), so they are bound in the patterns on every thread.
+typedef struct lstpat_bind {
+  const lstpat_t* lpb_pat;
+  lsthunk_t*      lpb_bound;
+} lstpat_bind_t;
+
+typedef struct lstpat_binds {
+  lstpat_bind_t*       lpbs_ents;
+  lssize_t             lpbs_cap; // power of two
+  lssize_t             lpbs_count;
+  struct lstpat_binds* lpbs_next; // g_lstpat_tables
+} lstpat_binds_t;
+
+typedef enum lstpat_binds_mode {
+  LSTPAT_BINDS_UNSET,   // the thread has not bound yet
+  LSTPAT_BINDS_INPLACE, // in the patterns
+  LSTPAT_BINDS_PRIVATE, // in g_lstpat_private
+} lstpat_binds_mode_t;
+
+// Tables of the running threads, linked so that the collector sees their bindings
+static pthread_mutex_t              g_lstpat_lock    = PTHREAD_MUTEX_INITIALIZER;
+static lstpat_binds_t*              g_lstpat_tables  = NULL;
+static pthread_key_t                g_lstpat_key;
+static pthread_once_t               g_lstpat_once    = PTHREAD_ONCE_INIT;
+static int                          g_lstpat_inplace = 0; // a thread binds in the patterns
+static __thread lstpat_binds_mode_t g_lstpat_mode    = LSTPAT_BINDS_UNSET;
+static __thread lstpat_binds_t*     g_lstpat_private = NULL;
 
 // Forward decls for internal helpers
 static void      lstpat_mark_refs_present(lstpat_t* pat);
@@ -93,6 +130,7 @@ static lstpat_t* lstpat_new_alge_internal(const lsstr_t* constr, lssize_t argc,
   lstpat_t* pat    = lsmalloc(offsetof(lstpat_t, alge.args) + sizeof(lstpat_t*) * argc);
   pat->ltp_type    = LSPTYPE_ALGE;
   pat->alge.constr = constr;
+  pat->alge.tag    = lsstr_get_tag(constr);
   pat->alge.argc   = argc;
   for (lssize_t i = 0; i < argc; i++)
     pat->alge.args[i] = args[i];
@@ -286,6 +324,7 @@ lstpat_t* lstpat_new_ref(const lsref_t* ref) {
   ret->ltp_type = LSPTYPE_REF;
   ret->r.ref    = ref;
   ret->r.bound  = NULL;
+  ret->r.shared = 0;
   return ret;
 }
 
@@ -296,6 +335,11 @@ const lsstr_t* lstpat_get_constr(const lstpat_t* pat) {
   return pat->alge.constr;
 }
 
+int lstpat_get_constr_tag(const lstpat_t* pat) {
+  assert(pat->ltp_type == LSPTYPE_ALGE);
+  return pat->alge.tag;
+}
+
 lssize_t lstpat_get_argc(const lstpat_t* pat) {
   assert(pat->ltp_type == LSPTYPE_ALGE);
   return pat->alge.argc;
@@ -338,14 +382,146 @@ const lsref_t* lstpat_get_refref(const lstpat_t* pat) {
   return pat->r.ref;
 }
 
+// Unlink the table of an exiting thread
+static void lstpat_binds_release(void* data) {
+  lstpat_binds_t* b = data;
+  pthread_mutex_lock(&g_lstpat_lock);
+  for (lstpat_binds_t** p = &g_lstpat_tables; *p != NULL; p = &(*p)->lpbs_next) {
+    if (*p == b) {
+      *p = b->lpbs_next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&g_lstpat_lock);
+  if (b->lpbs_ents != NULL)
+    lsfree(b->lpbs_ents);
+  lsfree(b);
+}
+
+static void lstpat_binds_init(void) { pthread_key_create(&g_lstpat_key, lstpat_binds_release); }
+
+void lstpat_use_private_binds(void) {
+  if (g_lstpat_mode == LSTPAT_BINDS_PRIVATE)
+    return;
+  assert(g_lstpat_mode == LSTPAT_BINDS_UNSET);
+  pthread_once(&g_lstpat_once, lstpat_binds_init);
+  lstpat_binds_t* b = lsmalloc(sizeof(lstpat_binds_t));
+  b->lpbs_ents      = NULL;
+  b->lpbs_cap       = 0;
+  b->lpbs_count     = 0;
+  pthread_mutex_lock(&g_lstpat_lock);
+  b->lpbs_next    = g_lstpat_tables;
+  g_lstpat_tables = b;
+  pthread_mutex_unlock(&g_lstpat_lock);
+  pthread_setspecific(g_lstpat_key, b);
+  g_lstpat_private = b;
+  g_lstpat_mode    = LSTPAT_BINDS_PRIVATE;
+}
+
+// The calling thread's table, or NULL when it binds in the patterns
+static lstpat_binds_t* lstpat_binds_self(void) {
+  if (g_lstpat_mode != LSTPAT_BINDS_UNSET)
+    return g_lstpat_private;
+  int unset = 0;
+  if (__atomic_compare_exchange_n(&g_lstpat_inplace, &unset, 1, 0, __ATOMIC_ACQ_REL,
+                                  __ATOMIC_ACQUIRE)) {
+    g_lstpat_mode = LSTPAT_BINDS_INPLACE;
+    return NULL;
+  }
+  lstpat_use_private_binds();
+  return g_lstpat_private;
+}
+
+static lssize_t lstpat_bind_index(const lstpat_t* pat, lssize_t cap) {
+  uintptr_t h = (uintptr_t)pat >> 4;
+  return (lssize_t)((h * 0x9e3779b1u) & (cap - 1));
+}
+
+static void lstpat_binds_grow(lstpat_binds_t* b) {
+  lssize_t       ncap  = b->lpbs_cap ? b->lpbs_cap * 2 : 64;
+  lstpat_bind_t* nents = lsmalloc(ncap * sizeof(lstpat_bind_t));
+  for (lssize_t i = 0; i < ncap; i++)
+    nents[i] = (lstpat_bind_t){ NULL, NULL };
+  for (lssize_t i = 0; i < b->lpbs_cap; i++) {
+    lstpat_bind_t e = b->lpbs_ents[i];
+    if (e.lpb_pat == NULL)
+      continue;
+    lssize_t j = lstpat_bind_index(e.lpb_pat, ncap);
+    while (nents[j].lpb_pat != NULL)
+      j = (j + 1) & (ncap - 1);
+    nents[j] = e;
+  }
+  if (b->lpbs_ents != NULL)
+    lsfree(b->lpbs_ents);
+  b->lpbs_ents = nents;
+  b->lpbs_cap  = ncap;
+}
+
+// Entry of pat in a thread's table; added (unbound) when insert is set
+static lstpat_bind_t* lstpat_private_entry(lstpat_binds_t* b, const lstpat_t* pat, int insert) {
+  if (insert && (b->lpbs_count + 1) * 2 > b->lpbs_cap)
+    lstpat_binds_grow(b);
+  if (b->lpbs_cap == 0)
+    return NULL;
+  for (lssize_t i = lstpat_bind_index(pat, b->lpbs_cap);; i = (i + 1) & (b->lpbs_cap - 1)) {
+    lstpat_bind_t* e = &b->lpbs_ents[i];
+    if (e->lpb_pat == pat)
+      return e;
+    if (e->lpb_pat == NULL) {
+      if (!insert)
+        return NULL;
+      e->lpb_pat = pat;
+      b->lpbs_count++;
+      return e;
+    }
+  }
+}
+
+// Remove the entry of pat; the entries after it in its probe run move back over the hole
+static void lstpat_private_remove(lstpat_binds_t* b, const lstpat_t* pat) {
+  lstpat_bind_t* e = lstpat_private_entry(b, pat, 0);
+  if (e == NULL)
+    return;
+  lssize_t mask = b->lpbs_cap - 1;
+  lssize_t hole = e - b->lpbs_ents;
+  for (lssize_t j = (hole + 1) & mask; b->lpbs_ents[j].lpb_pat != NULL; j = (j + 1) & mask) {
+    // An entry moves unless its home slot lies cyclically in (hole, j]
+    lssize_t home = lstpat_bind_index(b->lpbs_ents[j].lpb_pat, b->lpbs_cap);
+    int      stay = hole < j ? hole < home && home <= j : hole < home || home <= j;
+    if (!stay) {
+      b->lpbs_ents[hole] = b->lpbs_ents[j];
+      hole               = j;
+    }
+  }
+  b->lpbs_ents[hole] = (lstpat_bind_t){ NULL, NULL };
+  b->lpbs_count--;
+}
+
 void lstpat_set_refbound(lstpat_t* pat, lsthunk_t* thunk) {
   assert(pat->ltp_type == LSPTYPE_REF);
-  pat->r.bound = thunk;
+  if (pat->r.shared) {
+    // Every thread that matches a closure binding binds the same thunks
+    __atomic_store_n(&pat->r.bound, thunk, __ATOMIC_RELEASE);
+    return;
+  }
+  lstpat_binds_t* b = lstpat_binds_self();
+  if (b == NULL)
+    pat->r.bound = thunk;
+  else if (thunk == NULL)
+    lstpat_private_remove(b, pat);
+  else
+    lstpat_private_entry(b, pat, 1)->lpb_bound = thunk;
 }
 
 lsthunk_t* lstpat_get_refbound(const lstpat_t* pat) {
   assert(pat->ltp_type == LSPTYPE_REF);
-  return pat->r.bound;
+  if (pat->r.shared)
+    return __atomic_load_n(&pat->r.bound, __ATOMIC_ACQUIRE);
+  lstpat_binds_t* b = lstpat_binds_self();
+  if (b == NULL)
+    return pat->r.bound;
+  lstpat_bind_t* e = lstpat_private_entry(b, pat, 0);
+  return e != NULL ? e->lpb_bound : NULL;
 }
 
 lstpat_t* lstpat_get_or_left(const lstpat_t* pat) {
@@ -372,7 +548,7 @@ static void lstpat_clear_binds_internal(lstpat_t* pat) {
   case LSPTYPE_STR:
     break;
   case LSPTYPE_REF:
-    pat->r.bound = NULL;
+    lstpat_set_refbound(pat, NULL);
     break;
   case LSPTYPE_WILDCARD:
     break;
@@ -388,6 +564,31 @@ static void lstpat_clear_binds_internal(lstpat_t* pat) {
 
 void             lstpat_clear_binds(lstpat_t* pat) { lstpat_clear_binds_internal(pat); }
 
+void lstpat_share_binds(lstpat_t* pat) {
+  switch (pat->ltp_type) {
+  case LSPTYPE_ALGE:
+    for (lssize_t i = 0; i < pat->alge.argc; i++)
+      lstpat_share_binds(pat->alge.args[i]);
+    break;
+  case LSPTYPE_AS:
+    lstpat_share_binds(pat->as.ref);
+    lstpat_share_binds(pat->as.aspattern);
+    break;
+  case LSPTYPE_REF:
+    pat->r.shared = 1;
+    break;
+  case LSPTYPE_OR:
+    lstpat_share_binds(pat->orp.left);
+    lstpat_share_binds(pat->orp.right);
+    break;
+  case LSPTYPE_CARET:
+    lstpat_share_binds(pat->caret.inner);
+    break;
+  default:
+    break;
+  }
+}
+
 static lstpat_t* lstpat_clone_internal(const lstpat_t* pat) {
   switch (pat->ltp_type) {
   case LSPTYPE_ALGE: {
@@ -426,7 +627,9 @@ static lstpat_t* lstpat_clone_internal(const lstpat_t* pat) {
     lstpat_t* ret = lsmalloc(sizeof(lstpat_t));
     ret->ltp_type = LSPTYPE_REF;
     ret->r.ref    = pat->r.ref;
-    ret->r.bound  = pat->r.bound;
+    ret->r.bound  = NULL;
+    ret->r.shared = pat->r.shared;
+    lstpat_set_refbound(ret, lstpat_get_refbound(pat));
     return ret;
   }
   case LSPTYPE_WILDCARD: {
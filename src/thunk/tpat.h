@@ -40,6 +40,7 @@ lsptype_t lstpat_get_type(const lstpat_t* pat);
 
 // ALGE
 const lsstr_t*   lstpat_get_constr(const lstpat_t* pat);
+int              lstpat_get_constr_tag(const lstpat_t* pat);
 lssize_t         lstpat_get_argc(const lstpat_t* pat);
 lstpat_t* const* lstpat_get_args(const lstpat_t* pat);
 
@@ -71,9 +72,20 @@ lstpat_t* lstpat_get_caret_inner(const lstpat_t* pat);
 void       lstpat_set_refbound(lstpat_t* pat, lsthunk_t* thunk);
 lsthunk_t* lstpat_get_refbound(const lstpat_t* pat);
 
+/**
+ * Keep the calling thread's REF bindings in a table of its own
+ * Only the first thread to bind binds in the patterns; any other thread gets a table on its
+ * first binding. Parallel workers call this before evaluating so they never bind in place.
+ */
+void lstpat_use_private_binds(void);
+
 // Utilities
 lstpat_t* lstpat_clone(const lstpat_t* pat);
 void      lstpat_print(FILE* fp, lsprec_t prec, int indent, const lstpat_t* pat);
 
 // Clear all REF bindings inside the pattern (for lambda reuse)
 void lstpat_clear_binds(lstpat_t* pat);
+
+// Bind the REFs inside the pattern in place on every thread (closure bindings, which are never
+// cleared and bind the same thunks on whichever thread matches them first)
+void lstpat_share_binds(lstpat_t* pat);
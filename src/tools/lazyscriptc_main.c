@@ -2,6 +2,7 @@
 #include "parser/parser.h"
 #include "parser/lexer.h"
 #include "coreir/coreir.h"
+#include "llvmir/llvmir.h"
 #include "runtime/effects.h"
 #include <getopt.h>
 #include <gc.h>
@@ -60,13 +61,17 @@ int main(int argc, char** argv) {
   int           do_typecheck = 0;
   int           debug        = 0;
   int           strict       = 0;
+  int           emit_llvm    = 0;
+  int           emit_c       = 0;
+  int           opt_level    = 0;
   struct option longopts[]   = {
       { "eval", required_argument, NULL, 'e' },     { "typecheck", no_argument, NULL, 't' },
       { "strict-effects", no_argument, NULL, 's' }, { "debug", no_argument, NULL, 'd' },
+      { "emit-llvm", no_argument, NULL, 1001 },     { "emit-c", no_argument, NULL, 1002 },
       { "help", no_argument, NULL, 'h' },           { 0, 0, 0, 0 }
   };
   int opt;
-  while ((opt = getopt_long(argc, argv, "e:tsdh", longopts, NULL)) != -1) {
+  while ((opt = getopt_long(argc, argv, "e:tsdO:h", longopts, NULL)) != -1) {
     switch (opt) {
     case 'e':
       eval_str = optarg;
@@ -81,8 +86,24 @@ int main(int argc, char** argv) {
       debug = 1;
       (void)debug;
       break;
+    case 'O':
+      opt_level = atoi(optarg);
+      break;
+    case 1001:
+      emit_llvm = 1;
+      break;
+    case 1002:
+      emit_c = 1;
+      break;
     case 'h':
-      printf("Usage: %s [--typecheck|-t] [--strict-effects|-s] [FILE|-e STR]\n", argv[0]);
+      printf("Usage: %s [--typecheck|-t] [--strict-effects|-s] [-O1|-O2] [--emit-llvm|--emit-c] "
+             "[FILE|-e STR]\n",
+             argv[0]);
+      printf("  -O1          fuse map/filter/foldr pipelines, beta-reduce, fold add/sub/lt, resolve\n"
+             "               known matches, drop dead lets\n");
+      printf("  -O2          -O1 plus inlining of small lambdas\n");
+      printf("  --emit-llvm  print LLVM IR that links against liblazyscript_rt instead of Core IR\n");
+      printf("  --emit-c     print C that links against liblazyscript_rt instead of Core IR\n");
       return 0;
     default:
       break;
@@ -118,6 +139,11 @@ int main(int argc, char** argv) {
   if (do_typecheck) {
     return lscir_typecheck(stdout, cir);
   }
+  cir = lscir_optimize(cir, opt_level);
+  if (emit_llvm)
+    return lsllvm_emit_text(stdout, cir);
+  if (emit_c)
+    return lscir_emit_c(stdout, cir);
   fprintf(stdout, "; %s\n", LCIR_TEXT_HEADER);
   lscir_print(stdout, 0, cir);
   return 0;
@@ -30,8 +30,10 @@ int main(int argc, char** argv) {
   int           strict     = 0;
   int           from_ls    = 0;
   int           debug      = 0;
+  int           use_vm     = 0;
   struct option longopts[] = { { "strict-effects", no_argument, NULL, 's' },
                                { "from-ls", required_argument, NULL, 1000 },
+                               { "vm", no_argument, NULL, 1001 },
                                { "debug", no_argument, NULL, 'd' },
                                { "help", no_argument, NULL, 'h' },
                                { 0, 0, 0, 0 } };
@@ -46,12 +48,16 @@ int main(int argc, char** argv) {
       from_ls      = 1;
       from_ls_path = optarg;
       break;
+    case 1001:
+      use_vm = 1;
+      break;
     case 'd':
       debug = 1;
       (void)debug;
       break;
     case 'h':
-      printf("Usage: %s [--from-ls FILE] [--strict-effects]\n", argv[0]);
+      printf("Usage: %s [--from-ls FILE] [--strict-effects] [--vm]\n", argv[0]);
+      printf("  --vm  run on the register bytecode VM instead of the tree-walking evaluator\n");
       return 0;
     default:
       break;
@@ -75,7 +81,10 @@ int main(int argc, char** argv) {
         return 1;
       }
     }
-    lscir_eval(stdout, cir);
+    if (use_vm)
+      lscir_eval_vm(stdout, cir);
+    else
+      lscir_eval(stdout, cir);
     return 0;
   }
 
@@ -90,5 +99,5 @@ int main(int argc, char** argv) {
       return 1;
     }
   }
-  return lscir_eval(stdout, cir);
+  return use_vm ? lscir_eval_vm(stdout, cir) : lscir_eval(stdout, cir);
 }
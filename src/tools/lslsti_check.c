@@ -34,6 +34,15 @@ int main(int argc, char** argv) {
   const lsexpr_t*  args1[1] = { arg_e };
   const lsealge_t* e_ok     = lsealge_new(lsstr_cstr(".Ok"), 1, args1);
   lsthunk_t*       talge    = lsthunk_new_ealge(e_ok, env);
+  // Constructors seen again are found by their tag in the symbol pool: (.Ok "hello") shares the
+  // entry of (.Ok 42), and (Pair 42 "hello") twice shares a second one
+  const lsexpr_t*  arg_s    = lsexpr_new_str(s_hello);
+  const lsexpr_t*  args2[1] = { arg_s };
+  lsthunk_t*       talge2   = lsthunk_new_ealge(lsealge_new(lsstr_cstr(".Ok"), 1, args2), env);
+  const lsexpr_t*  args3[2] = { arg_e, arg_s };
+  const lsealge_t* e_pair   = lsealge_new(lsstr_cstr("Pair"), 2, args3);
+  lsthunk_t*       tpair    = lsthunk_new_ealge(e_pair, env);
+  lsthunk_t*       tpair2   = lsthunk_new_ealge(e_pair, env);
   // BOTTOM: message and one related using public API
   lsthunk_t* related[1] = { ts };
   lsthunk_t* tbot       = lsthunk_new_bottom("boom", lstrace_take_pending_or_unknown(), 1, related);
@@ -47,7 +56,7 @@ int main(int argc, char** argv) {
   lsthunk_t*      lam   = lsthunk_alloc_lambda(xpat);
   lsthunk_t*      xref  = lsthunk_new_ref(xr, env);
   lsthunk_set_lambda_body(lam, xref);
-  lsthunk_t* roots[7]   = { ti, ts, ty, talge, tbot, tbi, lam };
+  lsthunk_t* roots[10]  = { ti, ts, ty, talge, tbot, tbi, lam, talge2, tpair, tpair2 };
 
   FILE*      fp = fopen(path, "wb");
   if (!fp) {
@@ -55,7 +64,7 @@ int main(int argc, char** argv) {
     return 1;
   }
   lsti_write_opts_t opt = { .align_log2 = LSTI_ALIGN_8, .flags = 0 };
-  int               rc  = lsti_write(fp, roots, 7, &opt);
+  int               rc  = lsti_write(fp, roots, 10, &opt);
   fclose(fp);
   if (rc != 0) {
     fprintf(stderr, "lsti_write rc=%d\n", rc);
@@ -116,6 +125,8 @@ int main(int argc, char** argv) {
     }
     fclose(a); fclose(b);
     printf("roundtrip: %s\n", equal ? "equal" : "different");
+    if (!equal)
+      return 8;
   }
   lsti_unmap(&img);
   (void)env; // quiet unused for now
@@ -0,0 +1,182 @@
+// Test of the embedding API (lsapi.h): compile, run with arguments, read the results and
+// release them, on two runtimes at once; compile errors are reported and give no program.
+// Built and run by `make check`.
+#include "lsapi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int g_failed = 0;
+
+static void check(int ok, const char* what) {
+  printf("%s - %s\n", ok ? "ok" : "not ok", what);
+  if (!ok)
+    g_failed = 1;
+}
+
+static int value_is_int(ls_runtime_t* rt, ls_value_t* v, int expected) {
+  int n = 0;
+  return v != NULL && ls_value_get_int(rt, v, &n) == 0 && n == expected;
+}
+
+static int value_is_str(ls_runtime_t* rt, ls_value_t* v, const char* expected) {
+  char* s  = v != NULL ? ls_value_get_str(rt, v) : NULL;
+  int   ok = s != NULL && strcmp(s, expected) == 0;
+  free(s);
+  return ok;
+}
+
+static int value_prints(ls_runtime_t* rt, ls_value_t* v, const char* expected) {
+  char* s  = v != NULL ? ls_value_to_string(rt, v) : NULL;
+  int   ok = s != NULL && strcmp(s, expected) == 0;
+  free(s);
+  return ok;
+}
+
+// Compile source that must fail; whether it gave no program and wrote a diagnostic to stderr
+static int compile_fails(ls_runtime_t* rt, const char* name, const char* source) {
+  FILE* diag  = tmpfile();
+  int   saved = dup(STDERR_FILENO);
+  if (diag == NULL || saved < 0)
+    return 0;
+  fflush(stderr);
+  dup2(fileno(diag), STDERR_FILENO);
+  ls_program_t* prog = ls_program_compile(rt, name, source);
+  fflush(stderr);
+  dup2(saved, STDERR_FILENO);
+  close(saved);
+  off_t len = lseek(fileno(diag), 0, SEEK_END);
+  fclose(diag);
+  return prog == NULL && len > 0;
+}
+
+static int write_file(const char* dir, const char* name, const char* text) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  FILE* fp = fopen(path, "w");
+  if (fp == NULL)
+    return -1;
+  fputs(text, fp);
+  return fclose(fp);
+}
+
+// A module name stays resolved in a runtime; once its file is gone, the name is probed again.
+// A candidate that does not parse is passed over for the later ones.
+static void test_module_moved(ls_runtime_t* rt) {
+  char tmp[] = "/tmp/lsapi_test.XXXXXX";
+  char here[512], path[512], cwd[512];
+  if (mkdtemp(tmp) == NULL || getcwd(cwd, sizeof(cwd)) == NULL) {
+    check(0, "module moved: temporary directory");
+    return;
+  }
+  snprintf(here, sizeof(here), "%s/here", tmp);
+  snprintf(path, sizeof(path), "%s/path", tmp);
+  mkdir(here, 0700);
+  mkdir(path, 0700);
+  write_file(here, "moved.ls", "\"here\"\n");
+  write_file(path, "moved.ls", "\"path\"\n");
+  write_file(here, "broken.ls", "(\n");
+  write_file(path, "broken.ls", "\"path\"\n");
+  setenv("LAZYSCRIPT_PATH", path, 1);
+  ls_program_t* prog = chdir(here) == 0
+                           ? ls_program_compile(rt, "<include>", "~~include \"moved.ls\"")
+                           : NULL;
+  ls_value_t* v = prog != NULL ? ls_program_run(rt, prog, 0, NULL) : NULL;
+  check(value_is_str(rt, v, "here"), "include from the working directory");
+  ls_value_release(rt, v);
+  unlink("moved.ls");
+  v = prog != NULL ? ls_program_run(rt, prog, 0, NULL) : NULL;
+  check(value_is_str(rt, v, "path"), "include again once the file is gone");
+  ls_value_release(rt, v);
+  ls_program_free(rt, prog);
+  prog = ls_program_compile(rt, "<include>", "~~include \"broken.ls\"");
+  v    = prog != NULL ? ls_program_run(rt, prog, 0, NULL) : NULL;
+  check(value_is_str(rt, v, "path"), "include past a file that does not parse");
+  ls_value_release(rt, v);
+  ls_program_free(rt, prog);
+  unlink("broken.ls");
+  unlink("../path/broken.ls");
+  unlink("../path/moved.ls");
+  if (chdir(cwd) != 0)
+    check(0, "module moved: working directory");
+  rmdir(here);
+  rmdir(path);
+  rmdir(tmp);
+}
+
+int main(void) {
+  ls_runtime_t*           rt1  = ls_runtime_new(NULL);
+  const ls_runtime_opts_t opts = { NULL, NULL, 0, 1 };
+  ls_runtime_t*           rt2  = ls_runtime_new(&opts);
+  check(rt1 != NULL && rt2 != NULL, "two runtimes");
+  if (rt1 == NULL || rt2 == NULL)
+    return 1;
+  const ls_runtime_opts_t bad = { NULL, "/nonexistent/lsapi_init.ls", 0, 0 };
+  check(ls_runtime_new(&bad) == NULL, "missing init script");
+
+  // The same source compiled on both runtimes, run with host arguments
+  const char*   add   = "\\~x ~y -> ~~add ~x ~y";
+  ls_program_t* prog1 = ls_program_compile(rt1, "<add1>", add);
+  ls_program_t* prog2 = ls_program_compile(rt2, "<add2>", add);
+  check(prog1 != NULL && prog2 != NULL, "compile");
+  ls_value_t* args1[] = { ls_value_new_int(rt1, 40), ls_value_new_int(rt1, 2) };
+  ls_value_t* args2[] = { ls_value_new_int(rt2, -7), ls_value_new_int(rt2, 3) };
+  ls_value_t* ret1    = ls_program_run(rt1, prog1, 2, args1);
+  ls_value_t* ret2    = ls_program_run(rt2, prog2, 2, args2);
+  check(value_is_int(rt1, ret1, 42), "run with int arguments");
+  check(value_is_int(rt2, ret2, -4), "run with int arguments on the second runtime");
+  ls_value_t* again = ls_program_run(rt1, prog1, 2, args1);
+  check(value_is_int(rt1, again, 42), "run a program twice");
+  ls_value_release(rt1, again);
+  for (int i = 0; i < 2; i++) {
+    ls_value_release(rt1, args1[i]);
+    ls_value_release(rt2, args2[i]);
+  }
+  ls_value_release(rt1, ret1);
+  ls_value_release(rt2, ret2);
+  ls_program_free(rt1, prog1);
+  ls_program_free(rt2, prog2);
+
+  // Strings and constructors
+  ls_program_t* pair = ls_program_compile(rt1, "<pair>", "\\~s -> Pair ~s \"b\"");
+  ls_value_t*   str  = ls_value_new_str(rt1, "a");
+  ls_value_t*   val  = pair != NULL ? ls_program_run(rt1, pair, 1, &str) : NULL;
+  check(val != NULL && ls_value_kind(rt1, val) == LS_VALUE_CONSTR, "constructor kind");
+  const char* constr = val != NULL ? ls_value_get_constr(rt1, val) : NULL;
+  check(constr != NULL && strcmp(constr, "Pair") == 0, "constructor name");
+  check(val != NULL && ls_value_get_constr(rt1, val) == constr, "constructor name kept once");
+  check(val != NULL && ls_value_get_argc(rt1, val) == 2, "constructor arity");
+  check(val != NULL && value_is_str(rt1, ls_value_get_arg(rt1, val, 0), "a"), "string argument");
+  check(val != NULL && value_is_str(rt1, ls_value_get_arg(rt1, val, 1), "b"), "string result");
+  check(value_prints(rt1, val, "Pair \"a\" \"b\""), "print a value");
+  check(val != NULL && ls_value_get_str(rt1, val) == NULL, "string of a constructor");
+  ls_value_release(rt1, val);
+  ls_value_release(rt1, str);
+  ls_program_free(rt1, pair);
+
+  // Errors raised by a program are values
+  ls_program_t* raise = ls_program_compile(rt2, "<raise>", "~~add 1 \"x\"");
+  ls_value_t*   err   = raise != NULL ? ls_program_run(rt2, raise, 0, NULL) : NULL;
+  check(err != NULL && ls_value_kind(rt2, err) == LS_VALUE_ERROR, "evaluation error");
+  ls_value_release(rt2, err);
+  ls_program_free(rt2, raise);
+
+  // Compile errors give no program and are reported
+  check(compile_fails(rt1, "<syntax>", "(~~add 1"), "syntax error");
+  check(compile_fails(rt1, "<empty>", ""), "empty program");
+  check(ls_program_compile_file(rt1, "/nonexistent/lsapi_test.ls") == NULL, "missing file");
+
+  test_module_moved(rt1);
+
+  // A runtime still works once the other is gone
+  ls_runtime_free(rt2);
+  ls_program_t* one = ls_program_compile(rt1, "<one>", "~~add 1 0");
+  ls_value_t*   v   = one != NULL ? ls_program_run(rt1, one, 0, NULL) : NULL;
+  check(value_is_int(rt1, v, 1), "run after freeing the other runtime");
+  ls_value_release(rt1, v);
+  ls_program_free(rt1, one);
+  ls_runtime_free(rt1);
+  return g_failed;
+}
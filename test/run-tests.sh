@@ -38,7 +38,8 @@ run_with_timeout_capture() {
 
 pass=0; fail=0
 
-# Normalize absolute paths in outputs so CI and local paths compare stably
+# Normalize absolute paths in outputs so CI and local paths compare stably, and the times of
+# --startup-profile
 normalize_stream() {
   # Prefer GITHUB_WORKSPACE when available (e.g., CI: /home/runner/work/<repo>/<repo>)
   local gw="${GITHUB_WORKSPACE:-}"
@@ -47,18 +48,22 @@ normalize_stream() {
       -e "s|$ROOT|<ROOT>|g" \
       -e "s|$gw|<ROOT>|g" \
   -e 's|/workspaces/lazyscript|<ROOT>|g' \
-      -e 's|/home/runner/work/[^/]+/[^/]+|<ROOT>|g'
+      -e 's|/home/runner/work/[^/]+/[^/]+|<ROOT>|g' \
+      -e 's/^startup: ([a-z]+) +[-0-9.]+ ms/startup: \1 <MS> ms/'
   else
     sed -E \
       -e "s|$ROOT|<ROOT>|g" \
   -e 's|/workspaces/lazyscript|<ROOT>|g' \
-      -e 's|/home/runner/work/[^/]+/[^/]+|<ROOT>|g'
+      -e 's|/home/runner/work/[^/]+/[^/]+|<ROOT>|g' \
+      -e 's/^startup: ([a-z]+) +[-0-9.]+ ms/startup: \1 <MS> ms/'
   fi
 }
 
 # Discover interpreter tests automatically: any test/**/*.ls that has a matching .out
-# Backward compatible with flat layout. Stable sort for deterministic order.
-mapfile -t case_files < <(find "$DIR" -type f -name '*.ls' -printf '%P\n' | sort)
+# Backward compatible with flat layout. Stable sort for deterministic order. test/fixtures holds
+# modules that tests load, not tests.
+mapfile -t case_files < <(find "$DIR" -path "$DIR/fixtures" -prune -o -type f -name '*.ls' \
+  -printf '%P\n' | sort)
 cases=()
 for rel in "${case_files[@]}"; do
   base_noext="${rel%.ls}"
@@ -100,7 +105,8 @@ for name in "${cases[@]}"; do
       continue 2
     fi
   done
-  # Optional per-test env file (key=value per line)
+  # Optional per-test env file (key=value per line). CLI args and prefetch apply to their test only.
+  unset LAZYSCRIPT_ARGS LAZYSCRIPT_PREFETCH
   if [[ -f "$base.env" ]]; then
     # shellcheck source=/dev/null
     source "$base.env"
@@ -247,6 +253,217 @@ if "$BIN" --help 2>&1 | grep -q -- "--eval-coreir"; then
   fi
 fi
 
+# Optional: Core IR VM (lscoreir --vm) against the tree-walking evaluator on every test/coreir
+# case. The .out files are the thunk interpreter's output, which needs prelude builtins the Core IR
+# evaluators do not resolve; the VM's contract is to print what lscoreir prints.
+RUNIR="$ROOT/src/lscoreir"
+if [[ -x "$RUNIR" ]]; then
+  for rel in "${case_files[@]}"; do
+    [[ "$rel" == coreir/* ]] || continue
+    name="${rel%.ls}"
+    for s in "${skip[@]}"; do
+      [[ "$name" == "$s" ]] && continue 2
+    done
+    exp="$(run_with_timeout_capture "$RUNIR" --from-ls "$DIR/$name.ls"; echo "exit=$?")"
+    out="$(run_with_timeout_capture "$RUNIR" --vm --from-ls "$DIR/$name.ls"; echo "exit=$?")"
+    if [[ "$out" == "$exp" ]]; then
+      echo "ok - vm $name"
+      ((pass++))
+    else
+      echo "not ok - vm $name"
+      echo "--- got"; printf "%s\n" "$out"; echo "--- exp"; printf "%s\n" "$exp"; echo "---";
+      ((fail++))
+    fi
+  done
+fi
+
+# Optional: Core IR text cases (test/coreir/*.cir, read on stdin). Both evaluators must print the
+# case's .out, so constructs the .ls cases cannot produce (e.g. effect applications of lambdas)
+# are compared too.
+if [[ -x "$RUNIR" ]]; then
+  for cir in "$DIR"/coreir/*.cir; do
+    [[ -f "$cir" ]] || continue
+    name="coreir/$(basename "${cir%.cir}")"
+    exp="$(cat "$DIR/$name.out"; echo "exit=0")"
+    for mode in eval vm; do
+      flags=()
+      [[ "$mode" == vm ]] && flags=(--vm)
+      out="$(run_with_timeout_capture "$RUNIR" "${flags[@]}" < "$cir"; echo "exit=$?")"
+      if [[ "$out" == "$exp" ]]; then
+        echo "ok - cir-$mode $name"
+        ((pass++))
+      else
+        echo "not ok - cir-$mode $name"
+        echo "--- got"; printf "%s\n" "$out"; echo "--- exp"; printf "%s\n" "$exp"; echo "---";
+        ((fail++))
+      fi
+    done
+  done
+fi
+
+# Optional: the framed protocol of `lazyscript --serve` on stdin. Requests are "<verb> <len>\n"
+# and a body; replies are "ok|err <len>\n" and a body, shown here one per line. A request that
+# dies of a signal (here a stack overflow) gets an error reply and the next one is answered. A
+# malformed frame gets an error reply and ends the session.
+if "$BIN" --help 2>&1 | grep -q -- "--serve"; then
+  SERVE_TMP="$(mktemp -d)"
+  printf '%s\n' '\~x ~y -> ~~add ~x ~y' > "$SERVE_TMP/add.ls"
+  frame() { printf '%s %d\n%s' "$1" "${#2}" "$2"; }
+  replies() {
+    local verb len body
+    while read -r verb len; do
+      IFS= read -r -N "$len" body || break
+      printf '%s %s: %s\n' "$verb" "$len" "$body"
+    done
+  }
+  out="$({
+    frame eval '~~add 1 2'
+    frame eval 'Pair "a" [1, 2]'
+    frame call "$SERVE_TMP/add.ls"$'\n40\n2'
+    frame eval '~~add 1 "x"'
+    frame eval '(~~add'
+    frame call "$SERVE_TMP/missing.ls"
+    frame eval '[~nosuch]'
+    frame eval '(~f 0; ~f = \~n -> ~~add 1 (~f (~~add ~n 1)))'
+    frame hello 'x'
+    frame eval '~~add 2 2'
+    printf 'eval x\n'
+    frame eval '1'
+  } | timeout -k 1 "${TEST_TIMEOUT}s" "$BIN" --serve 2> "$SERVE_TMP/stderr" | replies
+    echo "exit=${PIPESTATUS[1]}")"
+  # Diagnostics name the program of the request (the 7th evaluated, counting call arguments)
+  out+=$'\n'"$(grep -c '^E: <serve:#7>:1.2-9: undefined reference: ~nosuch$' "$SERVE_TMP/stderr")"
+  exp='ok 1: 3
+ok 15: Pair "a" [1, 2]
+ok 2: 42
+err 51: <bottom msg="add: invalid type" at <unknown>:1.1: >
+err 12: syntax error
+err 23: cannot compile the file
+ok 55: [<bottom msg="undefined reference" at <unknown>:1.1: >]
+err 30: evaluation aborted (signal 11)
+err 15: unknown request
+ok 1: 4
+err 17: malformed request
+exit=0
+1'
+  if [[ "$out" == "$exp" ]]; then
+    echo "ok - serve stdin"
+    ((pass++))
+  else
+    echo "not ok - serve stdin"
+    echo "--- got"; printf "%s\n" "$out"; echo "--- exp"; printf "%s\n" "$exp"; echo "---";
+    ((fail++))
+  fi
+  rm -rf "$SERVE_TMP"
+fi
+
+# Optional: a fork server (--zygote) and its client (--connect). Requests run in the client's
+# working directory with its streams and exit status; the server forks single-threaded even
+# with --threads, and each child starts its own pools.
+if "$BIN" --help 2>&1 | grep -q -- "--zygote"; then
+  ZYGOTE_TMP="$(mktemp -d)"
+  mkdir "$ZYGOTE_TMP/work"
+  printf '%s\n' '!println "m loaded";' > "$ZYGOTE_TMP/work/m.ls"
+  printf '%s\n' '!{ !require "m.ls"; !println (~~to_str (~~parMap (\~x -> ~~add ~x 1) [1, 2, 3])) };' \
+    > "$ZYGOTE_TMP/work/p.ls"
+  "$BIN" --threads 4 --zygote="$ZYGOTE_TMP/z.sock" > /dev/null 2>&1 &
+  zygote_pid=$!
+  for _ in $(seq 100); do
+    [[ -S "$ZYGOTE_TMP/z.sock" ]] && break
+    sleep 0.05
+  done
+  out="$(cd "$ZYGOTE_TMP/work" && {
+    connect() { timeout -k 1 "${TEST_TIMEOUT}s" "$BIN" --connect="$ZYGOTE_TMP/z.sock" "$@" 2>&1; echo "exit=$?"; }
+    connect p.ls
+    connect -e '~~add 1 2'
+    connect missing.ls
+    connect -e '!{ !println "bye"; ~~exit 3 }'
+    connect -e '"still serving"'
+  })"
+  threads=1
+  [[ -d "/proc/$zygote_pid/task" ]] && threads="$(ls "/proc/$zygote_pid/task" | wc -l)"
+  kill "$zygote_pid" 2> /dev/null
+  wait "$zygote_pid" 2> /dev/null
+  out+=$'\n'"server threads=$threads"
+  exp='m loaded
+[2, 3, 4]
+()
+exit=0
+3
+exit=0
+missing.ls: No such file or directory
+exit=1
+bye
+exit=1
+"still serving"
+exit=0
+server threads=1'
+  if [[ "$out" == "$exp" ]]; then
+    echo "ok - zygote connect"
+    ((pass++))
+  else
+    echo "not ok - zygote connect"
+    echo "--- got"; printf "%s\n" "$out"; echo "--- exp"; printf "%s\n" "$exp"; echo "---";
+    ((fail++))
+  fi
+  rm -rf "$ZYGOTE_TMP"
+fi
+
+# Compiled module cache: a module with every syntax node kind is required with an empty cache
+# (parsed, image written), then again (image loaded); both must print what a run without the
+# cache prints. The module is then edited in place: while its index entry (identity, mtime, size)
+# still matches, the image is used; once the mtime changes, the module is parsed again.
+MODCACHE_TMP="$(mktemp -d)"
+cp "$DIR/fixtures/modcache_nodes.ls" "$MODCACHE_TMP/nodes.ls"
+printf '%s\n' '!{ !require "nodes.ls"; !println "main done" };' > "$MODCACHE_TMP/main.ls"
+modcache_run() {
+  (cd "$MODCACHE_TMP" &&
+    LAZYSCRIPT_CACHE_DIR="$MODCACHE_TMP/cache" run_with_timeout_capture "$BIN" "$@" main.ls)
+}
+ref="$(LAZYSCRIPT_MODULE_CACHE=0 modcache_run)"
+cold="$(modcache_run)"
+warm="$(modcache_run)"
+nimages="$(ls "$MODCACHE_TMP/cache"/*.lsmi 2> /dev/null | wc -l)"
+touch -r "$MODCACHE_TMP/nodes.ls" "$MODCACHE_TMP/stamp"
+# Same size, same inode, same mtime: the index still matches
+sed 's/~f 41;/~f 42;/' "$MODCACHE_TMP/nodes.ls" > "$MODCACHE_TMP/edited"
+cat "$MODCACHE_TMP/edited" > "$MODCACHE_TMP/nodes.ls"
+touch -r "$MODCACHE_TMP/stamp" "$MODCACHE_TMP/nodes.ls"
+kept="$(modcache_run)"
+touch -m -d '2001-01-01' "$MODCACHE_TMP/nodes.ls"
+stale="$(modcache_run)"
+nstale="$(ls "$MODCACHE_TMP/cache"/*.lsmi 2> /dev/null | wc -l)"
+if [[ "$cold" == "$ref" && "$warm" == "$ref" && "$nimages" == 1 && "$kept" == "$ref" &&
+  "$stale" == "${ref/$'\n'41$'\n'/$'\n'42$'\n'}" && "$stale" != "$ref" && "$nstale" == 2 ]]; then
+  echo "ok - modcache cold/warm/stale"
+  ((pass++))
+else
+  echo "not ok - modcache cold/warm/stale"
+  echo "--- ref"; printf "%s\n" "$ref"; echo "--- cold"; printf "%s\n" "$cold"
+  echo "--- warm"; printf "%s\n" "$warm"; echo "--- kept"; printf "%s\n" "$kept"
+  echo "--- stale"; printf "%s\n" "$stale"; echo "--- images: $nimages, then $nstale"; echo "---"
+  ((fail++))
+fi
+rm -rf "$MODCACHE_TMP"
+
+# Optional: LSTI image round trip (lslsti_check writes a graph with repeated constructors, maps,
+# materializes and writes it again; both images must be byte-equal)
+LSTI_BIN="$ROOT/src/lslsti_check"
+if [[ -x "$LSTI_BIN" ]]; then
+  LSTI_TMP="$(mktemp -d)"
+  lsti_out="$(cd "$LSTI_TMP" && run_with_timeout_capture "$LSTI_BIN" "$LSTI_TMP/a.lsti")"
+  lsti_rc=$?
+  if [[ $lsti_rc -eq 0 && "$lsti_out" == *"roundtrip: equal"* ]]; then
+    echo "ok - lsti roundtrip"
+    ((pass++))
+  else
+    echo "not ok - lsti roundtrip"
+    echo "--- got (rc=$lsti_rc)"; printf "%s\n" "$lsti_out"; echo "---"
+    ((fail++))
+  fi
+  rm -rf "$LSTI_TMP"
+fi
+
 # Optional: Core IR typechecker tests (if available)
 if "$BIN" --help 2>&1 | grep -q -- "--typecheck"; then
   # Discover any test/*.ls that has a matching .type.out
@@ -278,7 +495,6 @@ fi
 
 # Optional: Core IR pipe tests (lazyscriptc | lscoreir) for marked cases
 COMP="$ROOT/src/lazyscriptc"
-RUNIR="$ROOT/src/lscoreir"
 if [[ -x "$COMP" && -x "$RUNIR" ]]; then
   mapfile -t pipe_marks < <(find "$DIR" -type f -name '*.pipe.ok' -printf '%P\n' | sort)
   for mark in "${pipe_marks[@]}"; do
@@ -297,6 +513,91 @@ if [[ -x "$COMP" && -x "$RUNIR" ]]; then
   done
 fi
 
+# Optional: Core IR optimizer tests (lazyscriptc -O2) for any test/**/*.ls with a .opt.out
+if [[ -x "$COMP" ]]; then
+  for rel in "${case_files[@]}"; do
+    name="${rel%.ls}"
+    exp="$DIR/$name.opt.out"
+    [[ -f "$exp" ]] || continue
+    out="$(run_with_timeout_capture "$COMP" -O2 "$DIR/$name.ls")"
+    if diff -u <(printf "%s\n" "$out" | normalize_stream) <(normalize_stream < "$exp") >/dev/null; then
+      echo "ok - opt $name"
+      ((pass++))
+    else
+      echo "not ok - opt $name"
+      echo "--- got"; printf "%s\n" "$out" | normalize_stream; echo "--- exp"; normalize_stream < "$exp"; echo "---";
+      ((fail++))
+    fi
+  done
+fi
+
+# Optional: native tests (lazyscriptc --emit-llvm, linked against liblazyscript_rt) for any
+# test/**/*.ls that has a matching .native.out. Skipped without clang or llc, or without the
+# runtime library (override with LSRT_LIB and LSRT_LDLIBS).
+LSRT_LIB="${LSRT_LIB:-$ROOT/src/.libs/liblazyscript_rt.a}"
+LSRT_LDLIBS="${LSRT_LDLIBS:--lgc -ldl -lm -lpthread}"
+if [[ -x "$COMP" && -f "$LSRT_LIB" ]] && { command -v clang || command -v llc; } >/dev/null 2>&1; then
+  NATIVE_TMP="$(mktemp -d)"
+  for rel in "${case_files[@]}"; do
+    name="${rel%.ls}"
+    exp="$DIR/$name.native.out"
+    [[ -f "$exp" ]] || continue
+    exe="$NATIVE_TMP/$(basename "$name")"
+    "$COMP" --emit-llvm "$DIR/$name.ls" > "$exe.ll" 2> "$exe.err"
+    if command -v clang >/dev/null 2>&1; then
+      # shellcheck disable=SC2086
+      clang -x ir "$exe.ll" -o "$exe" "$LSRT_LIB" $LSRT_LDLIBS >> "$exe.err" 2>&1
+    else
+      # shellcheck disable=SC2086
+      llc -relocation-model=pic -filetype=obj "$exe.ll" -o "$exe.o" >> "$exe.err" 2>&1 &&
+        cc "$exe.o" -o "$exe" "$LSRT_LIB" $LSRT_LDLIBS >> "$exe.err" 2>&1
+    fi
+    if [[ -x "$exe" ]]; then
+      out="$(run_with_timeout_capture "$exe")"
+    else
+      out="$(cat "$exe.err")"
+    fi
+    if diff -u <(printf "%s\n" "$out" | normalize_stream) <(normalize_stream < "$exp") >/dev/null; then
+      echo "ok - native $name"
+      ((pass++))
+    else
+      echo "not ok - native $name"
+      echo "--- got"; printf "%s\n" "$out" | normalize_stream; echo "--- exp"; normalize_stream < "$exp"; echo "---";
+      ((fail++))
+    fi
+  done
+  rm -rf "$NATIVE_TMP"
+fi
+
+# Optional: the C backend (lazyscriptc --emit-c) must produce the same .native.out output.
+# Skipped without cc or without the runtime library.
+if [[ -x "$COMP" && -f "$LSRT_LIB" ]] && command -v cc >/dev/null 2>&1; then
+  NATIVE_TMP="$(mktemp -d)"
+  for rel in "${case_files[@]}"; do
+    name="${rel%.ls}"
+    exp="$DIR/$name.native.out"
+    [[ -f "$exp" ]] || continue
+    exe="$NATIVE_TMP/$(basename "$name")"
+    "$COMP" --emit-c "$DIR/$name.ls" > "$exe.c" 2> "$exe.err" &&
+      # shellcheck disable=SC2086
+      cc -std=c99 "$exe.c" -o "$exe" "$LSRT_LIB" $LSRT_LDLIBS >> "$exe.err" 2>&1
+    if [[ -x "$exe" ]]; then
+      out="$(run_with_timeout_capture "$exe")"
+    else
+      out="$(cat "$exe.err")"
+    fi
+    if diff -u <(printf "%s\n" "$out" | normalize_stream) <(normalize_stream < "$exp") >/dev/null; then
+      echo "ok - emit-c $name"
+      ((pass++))
+    else
+      echo "not ok - emit-c $name"
+      echo "--- got"; printf "%s\n" "$out" | normalize_stream; echo "--- exp"; normalize_stream < "$exp"; echo "---";
+      ((fail++))
+    fi
+  done
+  rm -rf "$NATIVE_TMP"
+fi
+
 if [[ $fail -eq 0 ]]; then
   exit 0
 else